@@ -0,0 +1,290 @@
+#pragma once
+
+#include <constants.h>
+
+#include <Eigen/Dense>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief AsyncWriterStatistics summarizes how much a producer waited on its writer
+   */
+  struct AsyncWriterStatistics {
+    /** number of buffers handed to the writer thread **/
+    long long submitted = 0;
+    /** number of buffers the sink finished writing **/
+    long long written = 0;
+    /** number of submissions that blocked because every buffer was in flight **/
+    long long stalls = 0;
+    /** total time the producer spent blocked **/
+    double stallSeconds = 0;
+  };
+
+  /**
+   * @brief AsyncWriter moves output off the compute thread. It owns a fixed set of equally sized
+   * buffers (two for double buffering, three for triple buffering): the producer fills the
+   * current buffer, Submit() queues it for a background thread and swaps in a free buffer by
+   * pointer, and the background thread hands queued buffers to the sink in submission order.
+   * The producer only blocks when every other buffer is still queued or being written, which is
+   * the backpressure that bounds memory when I/O is slower than compute.
+   *
+   * The sink runs on the writer thread. If it throws, later buffers are dropped and the first
+   * exception is rethrown by the next Submit() or Flush().
+   *
+   * @tparam Scalar : scalar type of the buffers
+   */
+  template <typename Scalar> class AsyncWriter {
+  public:
+    using Matrix = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+    /** receives a submitted buffer, its tag and the number of leading columns filled **/
+    using Sink = function<void(const Matrix& buffer, long long tag, Eigen::Index numCols)>;
+
+    /**
+     * AsyncWriter allocates its buffers and starts the writer thread
+     *
+     * @param  {Eigen::Index} rows : number of rows of every buffer
+     * @param  {Eigen::Index} cols : number of columns of every buffer
+     * @param  {Sink} sink         : writes a buffer, called on the writer thread
+     * @param  {int} numBuffers    : number of buffers, at least 2
+     */
+    AsyncWriter(Eigen::Index rows, Eigen::Index cols, Sink sink,
+                int numBuffers = DEFAULT_ASYNC_WRITER_BUFFERS)
+        : m_sink(std::move(sink)) {
+      if (numBuffers < 2) throw invalid_argument("async writer needs at least two buffers");
+      if (!m_sink) throw invalid_argument("async writer requires a sink");
+
+      m_current = make_unique<Matrix>(rows, cols);
+      for (int buffer = 1; buffer < numBuffers; buffer++) {
+        m_free.push_back(make_unique<Matrix>(rows, cols));
+      }
+      m_thread = thread(&AsyncWriter::Run, this);
+    }
+
+    AsyncWriter(const AsyncWriter&) = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+    ~AsyncWriter() {
+      {
+        lock_guard<mutex> lock(m_mutex);
+        m_stop = true;
+      }
+      m_wakeWriter.notify_one();
+      // queued buffers are still written before the thread exits
+      m_thread.join();
+    }
+
+    /**
+     * Current returns the buffer the producer is filling
+     * @return {Matrix}  : buffer owned by the producer until the next Submit()
+     */
+    Matrix& Current() { return *m_current; }
+
+    /**
+     * Submit queues the current buffer and swaps in a free one, blocking while none is free
+     *
+     * @param  {long long} tag        : passed through to the sink, e.g. the first time index
+     * @param  {Eigen::Index} numCols : number of leading columns of the buffer to write
+     */
+    void Submit(long long tag, Eigen::Index numCols) {
+      unique_lock<mutex> lock(m_mutex);
+      RethrowSinkError();
+
+      m_pending.push_back(Pending{std::move(m_current), tag, numCols});
+      m_statistics.submitted++;
+      m_wakeWriter.notify_one();
+
+      if (m_free.empty()) {
+        const auto start = chrono::steady_clock::now();
+        m_bufferFreed.wait(lock, [this]() { return !m_free.empty(); });
+        m_statistics.stalls++;
+        m_statistics.stallSeconds
+            += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+      }
+      m_current = std::move(m_free.back());
+      m_free.pop_back();
+    }
+
+    /**
+     * Flush waits until every submitted buffer is written and rethrows a sink failure
+     */
+    void Flush() {
+      unique_lock<mutex> lock(m_mutex);
+      m_bufferFreed.wait(lock, [this]() { return m_pending.empty() && !m_writing; });
+      RethrowSinkError();
+    }
+
+    AsyncWriterStatistics GetStatistics() const {
+      lock_guard<mutex> lock(m_mutex);
+      return m_statistics;
+    }
+
+  private:
+    struct Pending {
+      unique_ptr<Matrix> buffer;
+      long long tag;
+      Eigen::Index numCols;
+    };
+
+    /** rethrows the first sink exception once, m_mutex must be held **/
+    void RethrowSinkError() {
+      if (!m_error) return;
+      exception_ptr error = m_error;
+      m_error = nullptr;
+      rethrow_exception(error);
+    }
+
+    void Run() {
+      unique_lock<mutex> lock(m_mutex);
+      while (true) {
+        m_wakeWriter.wait(lock, [this]() { return m_stop || !m_pending.empty(); });
+        if (m_pending.empty()) return;
+
+        Pending pending = std::move(m_pending.front());
+        m_pending.pop_front();
+        m_writing = true;
+        const bool failed = m_failed;
+        lock.unlock();
+
+        exception_ptr error;
+        if (!failed) {
+          try {
+            m_sink(*pending.buffer, pending.tag, pending.numCols);
+          } catch (...) {
+            error = current_exception();
+          }
+        }
+
+        lock.lock();
+        if (error) {
+          m_failed = true;
+          m_error = error;
+        } else if (!failed) {
+          m_statistics.written++;
+        }
+        m_writing = false;
+        m_free.push_back(std::move(pending.buffer));
+        m_bufferFreed.notify_all();
+      }
+    }
+
+    Sink m_sink;
+    unique_ptr<Matrix> m_current;
+    vector<unique_ptr<Matrix>> m_free;
+    deque<Pending> m_pending;
+    bool m_writing = false;
+    bool m_stop = false;
+    bool m_failed = false;
+    exception_ptr m_error;
+    AsyncWriterStatistics m_statistics;
+    mutable mutex m_mutex;
+    condition_variable m_wakeWriter;
+    condition_variable m_bufferFreed;
+    thread m_thread;
+  };
+
+  /**
+   * @brief AsyncFieldWriter streams the time rows of a pair of (position, time) fields through an
+   * AsyncWriter in blocks of consecutive time rows. Its Observer() plugs straight into
+   * StabilitySolver::SetRowObserver so the march only pays for a column copy per row.
+   *
+   * @tparam Scalar : storage scalar type of the fields
+   */
+  template <typename Scalar> class AsyncFieldWriter {
+  public:
+    using Matrix = typename AsyncWriter<Scalar>::Matrix;
+    using ConstBlock = Eigen::Ref<const Matrix>;
+    /** receives blockTimes (fewer for the last block) consecutive time rows of A and B **/
+    using Sink = function<void(long long firstTime, const ConstBlock& blockA,
+                               const ConstBlock& blockB)>;
+    using RowObserver
+        = function<void(int timeIndex, const Eigen::Ref<Matrix>& fieldA,
+                        const Eigen::Ref<Matrix>& fieldB)>;
+
+    /**
+     * AsyncFieldWriter instantiates a writer for fields of a given number of positions
+     *
+     * @param  {Eigen::Index} numPositions : number of positions of the fields
+     * @param  {Eigen::Index} blockTimes   : number of time rows per submitted block
+     * @param  {Sink} sink                 : writes a block, called on the writer thread
+     * @param  {int} numBuffers            : number of buffers, at least 2
+     */
+    AsyncFieldWriter(Eigen::Index numPositions, Eigen::Index blockTimes, Sink sink,
+                     int numBuffers = DEFAULT_ASYNC_WRITER_BUFFERS)
+        : m_numPositions(numPositions),
+          m_writer(2 * numPositions, blockTimes, BlockSink(numPositions, std::move(sink)),
+                   numBuffers) {}
+
+    /**
+     * PushRow copies one time row of A and B into the current block, submitting it once full.
+     * A row that does not follow the previous one starts a new block.
+     *
+     * @param  {long long} timeIndex : time index of the row
+     * @param  {Vector} rowA         : A at every position
+     * @param  {Vector} rowB         : B at every position
+     */
+    template <typename DerivedA, typename DerivedB>
+    void PushRow(long long timeIndex, const Eigen::MatrixBase<DerivedA>& rowA,
+                 const Eigen::MatrixBase<DerivedB>& rowB) {
+      if (m_numRows > 0 && timeIndex != m_firstTime + m_numRows) Submit();
+      if (m_numRows == 0) m_firstTime = timeIndex;
+
+      Matrix& block = m_writer.Current();
+      block.col(m_numRows).head(m_numPositions) = rowA;
+      block.col(m_numRows).tail(m_numPositions) = rowB;
+      if (++m_numRows == block.cols()) Submit();
+    }
+
+    /**
+     * Observer returns a row observer pushing every row the solver completes. The writer must
+     * outlive the solve.
+     *
+     * @return {RowObserver}  : observer for StabilitySolver::SetRowObserver
+     */
+    RowObserver Observer() {
+      return [this](int timeIndex, const Eigen::Ref<Matrix>& fieldA,
+                    const Eigen::Ref<Matrix>& fieldB) {
+        PushRow(timeIndex, fieldA.col(timeIndex), fieldB.col(timeIndex));
+      };
+    }
+
+    /**
+     * Flush submits a partially filled block and waits until everything is written
+     */
+    void Flush() {
+      if (m_numRows > 0) Submit();
+      m_writer.Flush();
+    }
+
+    AsyncWriterStatistics GetStatistics() const { return m_writer.GetStatistics(); }
+
+  private:
+    static typename AsyncWriter<Scalar>::Sink BlockSink(Eigen::Index numPositions, Sink sink) {
+      return [numPositions, sink](const Matrix& buffer, long long firstTime, Eigen::Index rows) {
+        sink(firstTime, buffer.topLeftCorner(numPositions, rows),
+             buffer.bottomLeftCorner(numPositions, rows));
+      };
+    }
+
+    void Submit() {
+      const Eigen::Index numRows = m_numRows;
+      m_numRows = 0;
+      m_writer.Submit(m_firstTime, numRows);
+    }
+
+    Eigen::Index m_numPositions;
+    Eigen::Index m_numRows = 0;
+    long long m_firstTime = 0;
+    AsyncWriter<Scalar> m_writer;
+  };
+}  // namespace CGLE
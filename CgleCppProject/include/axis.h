@@ -0,0 +1,161 @@
+#pragma once
+
+#include <memoryAccounting.h>
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+using namespace std;
+
+namespace CGLE {
+  class Axis;
+
+  /**
+   * @brief AxisIterator walks the coordinates of an axis, computing uniform coordinates on the fly
+   */
+  class AxisIterator {
+  public:
+    using iterator_category = forward_iterator_tag;
+    using value_type = double;
+    using difference_type = ptrdiff_t;
+    using pointer = const double*;
+    using reference = double;
+
+    AxisIterator(const Axis* axis, int index) : m_axis(axis), m_index(index) {}
+
+    double operator*() const;
+    AxisIterator& operator++() {
+      m_index++;
+      return *this;
+    }
+    AxisIterator operator++(int) {
+      AxisIterator previous = *this;
+      m_index++;
+      return previous;
+    }
+    bool operator==(const AxisIterator& other) const { return m_index == other.m_index; }
+    bool operator!=(const AxisIterator& other) const { return m_index != other.m_index; }
+
+  private:
+    const Axis* m_axis;
+    int m_index;
+  };
+
+  /**
+   * @brief AxisRange is a view of the contiguous points [begin, end) of an axis
+   */
+  struct AxisRange {
+    const Axis* axis = nullptr;
+    int begin = 0;
+    int end = 0;
+
+    int size() const { return end - begin; }
+    double operator[](int index) const;
+    AxisIterator cbegin() const { return AxisIterator(axis, begin); }
+    AxisIterator cend() const { return AxisIterator(axis, end); }
+  };
+
+  /**
+   * @brief Axis holds the coordinates of one grid axis. A uniform axis only stores its first
+   * point, its last point and its number of points; coordinates are computed on demand as
+   * first + (last - first) * i / (n - 1), so both endpoints and the midpoint of a symmetric axis
+   * are exact and no error accumulates along the axis. Non-uniform meshes keep their explicit
+   * points, charged to MemorySubsystem::GridDetails.
+   */
+  class Axis {
+  public:
+    Axis() = default;
+
+    /**
+     * Linspace creates a uniform axis of count points from first to last (both included)
+     *
+     * @param  {double} first : first coordinate
+     * @param  {double} last  : last coordinate
+     * @param  {int} count    : number of points
+     * @return {Axis}         : uniform axis
+     */
+    static Axis Linspace(double first, double last, int count);
+
+    /**
+     * Explicit creates a non-uniform axis from its points
+     * @param  {vector<double>} points : coordinates of the axis
+     * @return {Axis}                  : non-uniform axis
+     */
+    static Axis Explicit(vector<double> points);
+
+    /**
+     * Reads the coordinate of a point, without bounds checks
+     * @param  {int} index : index of the point
+     * @return {double}    : coordinate of the point
+     */
+    double operator[](int index) const {
+      if (!m_uniform) return m_points[static_cast<size_t>(index)];
+      if (index == m_intervals) return m_last;
+      return m_first + ((m_last - m_first) * index) / m_intervals;
+    }
+
+    /**
+     * At reads the coordinate of a point
+     * @param  {int} index : index of the point, throws out_of_range outside the axis
+     * @return {double}    : coordinate of the point
+     */
+    double At(int index) const;
+
+    int size() const { return m_uniform ? m_intervals + 1 : static_cast<int>(m_points.size()); }
+    bool empty() const { return size() == 0; }
+    bool IsUniform() const { return m_uniform; }
+
+    /**
+     * GetStep returns the spacing of a uniform axis, or the spacing between the first two points
+     * of a non-uniform one (grid.Dx / grid.Dt in the MATLAB scripts)
+     * @return {double}  : spacing between points, 0 for axes with fewer than 2 points
+     */
+    double GetStep() const;
+
+    /**
+     * Find returns the indices of every point whose coordinate is exactly a value. Uniform axes
+     * compute the candidate index directly instead of scanning.
+     *
+     * @param  {double} value : coordinate to look up
+     * @return {vector<int>}  : matching indices in increasing order
+     */
+    vector<int> Find(double value) const;
+
+    /**
+     * Range returns a view of the points [begin, end)
+     * @param  {int} begin : first point of the range
+     * @param  {int} end   : one past the last point of the range
+     * @return {AxisRange} : view of the range
+     */
+    AxisRange Range(int begin, int end) const;
+
+    /**
+     * Tiles splits the axis into consecutive ranges of at most tileSize points
+     * @param  {int} tileSize      : max number of points per tile
+     * @return {vector<AxisRange>} : tiles covering the axis in order
+     */
+    vector<AxisRange> Tiles(int tileSize) const;
+
+    /**
+     * ToVector materializes the coordinates, for writers and non hot paths
+     * @return {vector<double>}  : coordinates of every point
+     */
+    vector<double> ToVector() const;
+
+    AxisIterator begin() const { return AxisIterator(this, 0); }
+    AxisIterator end() const { return AxisIterator(this, size()); }
+
+  private:
+    bool m_uniform = true;
+    double m_first = 0;
+    double m_last = 0;
+    /** number of points minus one, -1 for an empty uniform axis **/
+    int m_intervals = -1;
+    vector<double, TrackingAllocator<double, MemorySubsystem::GridDetails>> m_points;
+  };
+
+  inline double AxisIterator::operator*() const { return (*m_axis)[m_index]; }
+
+  inline double AxisRange::operator[](int index) const { return (*axis)[begin + index]; }
+}  // namespace CGLE
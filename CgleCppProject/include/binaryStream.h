@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * WriteBinary writes the raw bytes of a trivially copyable value
+   * @param  {ostream} stream : stream to write to
+   * @param  {T} value        : value to write
+   */
+  template <typename T> void WriteBinary(ostream& stream, const T& value) {
+    static_assert(is_trivially_copyable<T>::value, "only trivially copyable values are written");
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  /**
+   * ReadBinary reads the raw bytes of a trivially copyable value, throwing on a truncated stream
+   * @param  {istream} stream : stream to read from
+   * @return {T}              : value read
+   */
+  template <typename T> T ReadBinary(istream& stream) {
+    static_assert(is_trivially_copyable<T>::value, "only trivially copyable values are read");
+    T value;
+    if (!stream.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+      throw runtime_error("unexpected end of file");
+    }
+    return value;
+  }
+
+  /**
+   * WriteBinaryString writes a length prefixed string
+   * @param  {ostream} stream : stream to write to
+   * @param  {string} value   : string to write
+   */
+  inline void WriteBinaryString(ostream& stream, const string& value) {
+    WriteBinary<uint32_t>(stream, static_cast<uint32_t>(value.size()));
+    stream.write(value.data(), static_cast<streamsize>(value.size()));
+  }
+
+  /**
+   * ReadBinaryString reads a length prefixed string
+   * @param  {istream} stream : stream to read from
+   * @return {string}         : string read
+   */
+  inline string ReadBinaryString(istream& stream) {
+    string value(ReadBinary<uint32_t>(stream), '\0');
+    if (!stream.read(&value[0], static_cast<streamsize>(value.size()))) {
+      throw runtime_error("unexpected end of file");
+    }
+    return value;
+  }
+}  // namespace CGLE
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <memoryAccounting.h>
+
+#include <Eigen/Dense>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief PoolStatistics summarizes the allocation activity of a buffer pool
+   */
+  struct PoolStatistics {
+    /** number of acquisitions that had to allocate a new buffer **/
+    size_t allocations = 0;
+    /** number of acquisitions served from a previously released buffer **/
+    size_t reuses = 0;
+    /** number of buffers handed back to the pool **/
+    size_t releases = 0;
+    /** number of released buffers freed because the pool was at capacity **/
+    size_t evictions = 0;
+    /** total bytes obtained from the system allocator **/
+    size_t bytesAllocated = 0;
+    /** bytes currently cached in the pool waiting to be reused **/
+    size_t bytesPooled = 0;
+    /** high water mark of bytesPooled **/
+    size_t peakBytesPooled = 0;
+  };
+
+  /**
+   * @brief BufferPool is a per-thread size-class pool of Eigen matrices. Grids and solvers acquire
+   * their fields and scratch buffers from the pool of the calling thread and hand them back when
+   * they are destroyed, so batches of identically sized jobs stop hitting malloc/free after the
+   * first job. Size classes are exact element counts: a cached buffer is reshaped (never
+   * reallocated) to any rows x cols with the same number of elements.
+   *
+   * Leased bytes are charged to the subsystem named at acquisition and cached bytes to
+   * MemorySubsystem::BufferPool, see MemoryAccountant.
+   *
+   * @tparam Scalar : scalar type of the pooled matrices
+   */
+  template <typename Scalar> class BufferPool {
+  public:
+    using Matrix = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+
+    /**
+     * @brief Releaser refunds a leased buffer to its subsystem and returns it to the pool of the
+     * releasing thread
+     */
+    struct Releaser {
+      MemorySubsystem subsystem = MemorySubsystem::Other;
+      size_t bytes = 0;
+
+      void operator()(Matrix* matrix) const {
+        MemoryAccountant::Refund(subsystem, bytes);
+        BufferPool* pool = BufferPool::LocalOrNull();
+        if (pool == nullptr) {
+          // the thread's pool is already destroyed (thread teardown), free directly
+          delete matrix;
+          return;
+        }
+        pool->Release(unique_ptr<Matrix>(matrix));
+      }
+    };
+
+    /** buffer leased from the pool, released automatically when it goes out of scope **/
+    using Lease = unique_ptr<Matrix, Releaser>;
+
+    BufferPool() = default;
+    ~BufferPool() {
+      MemoryAccountant::Refund(MemorySubsystem::BufferPool, m_statistics.bytesPooled);
+    }
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    /**
+     * Local returns the pool owned by the calling thread
+     * @return {BufferPool}  : pool of the calling thread
+     */
+    static BufferPool& Local() {
+      struct ThreadPool {
+        ~ThreadPool() { IsDestroyed() = true; }
+        BufferPool pool;
+      };
+      thread_local ThreadPool local;
+      return local.pool;
+    }
+
+    /**
+     * Acquire leases a buffer of a given shape. The contents of the buffer are unspecified.
+     *
+     * @param  {Eigen::Index} rows           : number of rows of the buffer
+     * @param  {Eigen::Index} cols           : number of columns of the buffer
+     * @param  {MemorySubsystem} subsystem   : subsystem the buffer is charged to while leased
+     * @return {Lease}                       : leased buffer
+     */
+    Lease Acquire(Eigen::Index rows, Eigen::Index cols,
+                  MemorySubsystem subsystem = MemorySubsystem::Other) {
+      const Eigen::Index elements = rows * cols;
+      const size_t bytes = BytesOf(elements);
+      auto it = m_free.find(elements);
+      if (it != m_free.end() && !it->second.empty()) {
+        unique_ptr<Matrix> matrix = std::move(it->second.back());
+        it->second.pop_back();
+        matrix->resize(rows, cols);
+
+        m_statistics.bytesPooled -= bytes;
+        m_statistics.reuses++;
+        Global().reuses++;
+        MemoryAccountant::Refund(MemorySubsystem::BufferPool, bytes);
+        MemoryAccountant::Charge(subsystem, bytes);
+        return Lease(matrix.release(), Releaser{subsystem, bytes});
+      }
+
+      m_statistics.allocations++;
+      m_statistics.bytesAllocated += bytes;
+      Global().allocations++;
+      Global().bytesAllocated += bytes;
+      Lease lease(new Matrix(rows, cols), Releaser{subsystem, bytes});
+      MemoryAccountant::Charge(subsystem, bytes);
+      return lease;
+    }
+
+    /**
+     * AcquireShared leases a buffer that can be shared between several owners. The buffer returns
+     * to the pool of the thread releasing the last reference.
+     *
+     * @param  {Eigen::Index} rows           : number of rows of the buffer
+     * @param  {Eigen::Index} cols           : number of columns of the buffer
+     * @param  {MemorySubsystem} subsystem   : subsystem the buffer is charged to while leased
+     * @return {shared_ptr<Matrix>}          : leased buffer
+     */
+    shared_ptr<Matrix> AcquireShared(Eigen::Index rows, Eigen::Index cols,
+                                     MemorySubsystem subsystem = MemorySubsystem::Other) {
+      Lease lease = Acquire(rows, cols, subsystem);
+      const Releaser releaser = lease.get_deleter();
+      return shared_ptr<Matrix>(lease.release(), releaser);
+    }
+
+    /**
+     * Release hands a buffer back to the pool so a later acquisition of the same size can reuse it.
+     * A buffer detached from its lease is not refunded to the subsystem it was leased for.
+     *
+     * @param  {unique_ptr<Matrix>} matrix : buffer to cache
+     */
+    void Release(unique_ptr<Matrix> matrix) {
+      if (!matrix) return;
+
+      const Eigen::Index elements = matrix->size();
+      const size_t bytes = BytesOf(elements);
+      m_statistics.releases++;
+      Global().releases++;
+
+      if (elements == 0 || (m_capacity != 0 && m_statistics.bytesPooled + bytes > m_capacity)) {
+        m_statistics.evictions++;
+        Global().evictions++;
+        return;
+      }
+
+      m_free[elements].push_back(std::move(matrix));
+      m_statistics.bytesPooled += bytes;
+      MemoryAccountant::Charge(MemorySubsystem::BufferPool, bytes);
+      m_statistics.peakBytesPooled = max(m_statistics.peakBytesPooled, m_statistics.bytesPooled);
+    }
+
+    /**
+     * Clear frees every cached buffer
+     */
+    void Clear() {
+      m_free.clear();
+      MemoryAccountant::Refund(MemorySubsystem::BufferPool, m_statistics.bytesPooled);
+      m_statistics.bytesPooled = 0;
+    }
+
+    /**
+     * SetCapacity bounds the number of bytes the pool keeps cached, 0 means unbounded
+     * @param  {size_t} maxPooledBytes : max number of cached bytes
+     */
+    void SetCapacity(size_t maxPooledBytes) { m_capacity = maxPooledBytes; }
+
+    /**
+     * GetStatistics returns the statistics of this thread's pool
+     * @return {PoolStatistics}  : allocation statistics
+     */
+    PoolStatistics GetStatistics() const { return m_statistics; }
+
+    /**
+     * GetAggregateStatistics returns allocation counters summed over every thread's pool. Cached
+     * byte counts are per thread and are not aggregated.
+     *
+     * @return {PoolStatistics}  : allocation statistics
+     */
+    static PoolStatistics GetAggregateStatistics() {
+      PoolStatistics statistics;
+      statistics.allocations = Global().allocations.load();
+      statistics.reuses = Global().reuses.load();
+      statistics.releases = Global().releases.load();
+      statistics.evictions = Global().evictions.load();
+      statistics.bytesAllocated = Global().bytesAllocated.load();
+      return statistics;
+    }
+
+  private:
+    struct GlobalCounters {
+      atomic<size_t> allocations{0}, reuses{0}, releases{0}, evictions{0}, bytesAllocated{0};
+    };
+
+    static GlobalCounters& Global() {
+      static GlobalCounters counters;
+      return counters;
+    }
+
+    static bool& IsDestroyed() {
+      thread_local bool destroyed = false;
+      return destroyed;
+    }
+
+    static BufferPool* LocalOrNull() { return IsDestroyed() ? nullptr : &Local(); }
+
+    static size_t BytesOf(Eigen::Index elements) {
+      return static_cast<size_t>(elements) * sizeof(Scalar);
+    }
+
+    unordered_map<Eigen::Index, vector<unique_ptr<Matrix>>> m_free;
+    PoolStatistics m_statistics;
+    size_t m_capacity = 0;
+  };
+}  // namespace CGLE
@@ -23,7 +23,9 @@ namespace CGLE {
      */
     Cell(int xVal, int yVal) : x(xVal), y(yVal) {}
 
-    bool operator==(const Cell& that) const { return x == that.x && y == that.x; }
+    bool operator==(const Cell& that) const { return x == that.x && y == that.y; }
+
+    bool operator!=(const Cell& that) const { return !(*this == that); }
 
     int x, y;
   };
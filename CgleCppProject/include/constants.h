@@ -1,3 +1,6 @@
+#pragma once
+
+#include <cstdint>
 #include <string>
 
 using namespace std;
@@ -12,4 +15,18 @@ namespace CGLE {
   const double DEFAULT_GRID_DX = 1.0;
   const double DEFAULT_GRID_DY = 1.0;
   const int DEFAULT_NUM_PTS = 100;
+  const int DEFAULT_FIELD_TILE_SIZE = 64;
+  const int MAX_FIXED_GRID_CELLS = 128 * 128;
+  const int DEFAULT_ENSEMBLE_LANES = 8;
+  const double DEFAULT_DIVERGENCE_FACTOR = 10.0;
+  const int PARALLEL_TRIDIAGONAL_THRESHOLD = 1 << 16;
+  const double SEPARABLE_EXPONENT_LIMIT = 170.0;
+  const int ERROR_METRIC_CHUNK_CELLS = 1 << 16;
+  const int LOD_MIN_LEVEL_SIZE = 64;
+  const size_t MAT_WRITE_CHUNK_BYTES = 1 << 20;
+  const int DEFAULT_ASYNC_WRITER_BUFFERS = 3;
+  const uintmax_t DEFAULT_RESULT_CACHE_BYTES = uintmax_t(1) << 32;
+  const int RESULT_CACHE_VERSION = 1;
+  const int RESULT_CACHE_STALE_SECONDS = 3600;
+  const int DEFAULT_CODEC_TILE_ELEMENTS = 1 << 16;
 }  // namespace CGLE
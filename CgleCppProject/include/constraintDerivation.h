@@ -0,0 +1,180 @@
+#pragma once
+
+#include <constants.h>
+#include <constraint.h>
+
+#include <Eigen/Dense>
+#include <complex>
+#include <functional>
+#include <string>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief ConstraintInputs holds one parameter set exactly as ComputeConstraints.m writes it,
+   * before the L dependent terms are derived. Gamma1 = gamma1 + gamma1Scaled / L^2 (and likewise
+   * for Gamma1'), which reproduces both forms the MATLAB tables use.
+   */
+  struct ConstraintInputs {
+    int caseType = 1;
+    string caseLetter = "A";
+    string waveType = BRIGHT_BRIGHT;
+    int version = 2;
+
+    int startTime = 0;
+    int endTime = 0;
+    int startPosition = 0;
+    int endPosition = 0;
+
+    double L = 1;
+    complex<double> k1;
+    double K1 = 0, K2 = 0;
+    complex<double> W1;
+    double eta = 0;
+    double mu = 0;
+    double omega1 = 0;
+    double omega2 = 0;
+    double beta = 0;
+    double alpha = 0;
+    double q2r = 0;
+    /** part of Gamma1 used as is **/
+    complex<double> gamma1;
+    /** part of Gamma1 divided by L^2 **/
+    complex<double> gamma1Scaled;
+    /** part of Gamma1' used as is **/
+    complex<double> gamma1Prime;
+    /** part of Gamma1' divided by L^2 **/
+    complex<double> gamma1PrimeScaled;
+    complex<double> p1, p1Prime;
+    complex<double> q1, q2;
+    complex<double> q1Prime, q2Prime;
+  };
+
+  /**
+   * GetConstraintInputs returns the parameter set ComputeConstraints.m defines for a solution type
+   *
+   * @param  {string} waveType   : Bright-Bright, Dark-Dark or Front-Front
+   * @param  {int} caseType      : case of the wave type, 1 or 2
+   * @param  {int} version       : paper version, only version 2 is defined
+   * @return {ConstraintInputs}  : parameter set before derivation
+   */
+  ConstraintInputs GetConstraintInputs(const string& waveType, int caseType, int version = 2);
+
+  /**
+   * DeriveConstraint derives the L dependent terms of a parameter set
+   * @param  {ConstraintInputs} inputs : parameter set to derive
+   * @return {Constraint}              : derived constraint
+   */
+  Constraint DeriveConstraint(const ConstraintInputs& inputs);
+
+  /**
+   * ComputeConstraints is the native port of ComputeConstraints.m
+   *
+   * @param  {string} waveType   : Bright-Bright, Dark-Dark or Front-Front
+   * @param  {int} caseType      : case of the wave type, 1 or 2
+   * @param  {int} version       : paper version, only version 2 is defined
+   * @return {Constraint}        : derived constraint
+   */
+  Constraint ComputeConstraints(const string& waveType, int caseType, int version = 2);
+
+  /**
+   * @brief ConstraintBatch stores a batch of candidate parameter sets as one array per parameter
+   * (structure of arrays) so the derived terms of the whole batch are evaluated with vectorized
+   * Eigen array expressions. A batch starts as a broadcast of a base parameter set; a sweep then
+   * overwrites the arrays of the parameters it varies and calls Derive().
+   */
+  class ConstraintBatch {
+  public:
+    using RealArray = Eigen::ArrayXd;
+    using ComplexArray = Eigen::ArrayXcd;
+    using BoolArray = Eigen::Array<bool, Eigen::Dynamic, 1>;
+
+    /**
+     * @brief Fill sets the swept parameters of a batch, offset is the index of its first set
+     */
+    using Fill = std::function<void(ConstraintBatch& batch, long long offset)>;
+
+    /**
+     * @brief Consume receives a derived batch, offset is the index of its first set
+     */
+    using Consume = std::function<void(const ConstraintBatch& batch, long long offset)>;
+
+    ConstraintBatch() = default;
+
+    /**
+     * ConstraintBatch instantiates a batch where every set equals a base parameter set
+     *
+     * @param  {ConstraintInputs} base : parameter set broadcast to every entry
+     * @param  {Eigen::Index} size     : number of parameter sets
+     */
+    ConstraintBatch(const ConstraintInputs& base, Eigen::Index size);
+
+    /**
+     * Broadcast resizes the batch and resets every set to a base parameter set
+     *
+     * @param  {ConstraintInputs} base : parameter set broadcast to every entry
+     * @param  {Eigen::Index} size     : number of parameter sets
+     */
+    void Broadcast(const ConstraintInputs& base, Eigen::Index size);
+
+    /**
+     * Derive evaluates Gamma1 and Gamma1' for the whole batch and flags the sets whose L is not
+     * positive or whose derived terms are not finite as invalid
+     */
+    void Derive();
+
+    /**
+     * At builds the constraint of one derived set
+     * @param  {Eigen::Index} index : index of the set in the batch
+     * @return {Constraint}         : constraint of the set
+     */
+    Constraint At(Eigen::Index index) const;
+
+    Eigen::Index GetSize() const { return m_L.size(); }
+
+    /**
+     * Generate streams count parameter sets through batches of at most batchSize sets. Each batch
+     * is broadcast from the base, filled, derived and handed to consume before the next one is
+     * built, so memory stays bounded by a single batch however many sets are generated.
+     *
+     * @param  {ConstraintInputs} base : parameter set every batch starts from
+     * @param  {long long} count       : total number of parameter sets
+     * @param  {Eigen::Index} batchSize: max number of sets per batch
+     * @param  {Fill} fill             : sets the swept parameters of a batch
+     * @param  {Consume} consume       : receives every derived batch
+     */
+    static void Generate(const ConstraintInputs& base, long long count, Eigen::Index batchSize,
+                         const Fill& fill, const Consume& consume);
+
+    /** metadata shared by every set of the batch **/
+    int m_CaseType = 1;
+    string m_CaseLetter;
+    string m_WaveType;
+    int m_Version = 2;
+    int m_StartTime = 0;
+    int m_EndTime = 0;
+    int m_StartPosition = 0;
+    int m_EndPosition = 0;
+
+    /** inputs, one entry per set **/
+    RealArray m_L;
+    ComplexArray m_k1;
+    RealArray m_K1, m_K2;
+    ComplexArray m_W1;
+    RealArray m_Eta, m_Mu;
+    RealArray m_Omega1, m_Omega2;
+    RealArray m_Beta, m_Alpha;
+    RealArray m_Q2r;
+    ComplexArray m_Gamma1Unscaled, m_Gamma1Scaled;
+    ComplexArray m_Gamma1PrimeUnscaled, m_Gamma1PrimeScaled;
+    ComplexArray m_P1, m_P1Prime;
+    ComplexArray m_Q1, m_Q2;
+    ComplexArray m_Q1Prime, m_Q2Prime;
+
+    /** derived terms, filled by Derive() **/
+    ComplexArray m_Gamma1;
+    ComplexArray m_Gamma1Prime;
+    BoolArray m_Valid;
+  };
+}  // namespace CGLE
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <axis.h>
+#include <constraint.h>
+#include <grid.h>
+#include <gridDetails.h>
+#include <precision.h>
+#include <stabilitySolver.h>
+
+#include <Eigen/Dense>
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "helper.h"
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief GridResampler interpolates (position, time) fields between two grids bilinearly. The
+   * bracketing source points and weights of every target point are computed once per axis, so
+   * resampling a field is a separable pass over the target columns, each reading two consecutive
+   * source columns, split across threads by column.
+   */
+  class GridResampler {
+  public:
+    /**
+     * GridResampler precomputes the interpolation between two grids. Targets outside a source
+     * axis take the value of its nearest end.
+     *
+     * @param  {GridDetails} source : grid the fields are given on
+     * @param  {GridDetails} target : grid the fields are resampled onto
+     */
+    GridResampler(const GridDetails& source, const GridDetails& target);
+
+    /**
+     * Resample interpolates a field onto the target grid
+     *
+     * @param  {Source} source  : field on the source grid
+     * @param  {Target} target  : field on the target grid, resized if needed
+     * @param  {int} numThreads : number of threads, 0 means one per hardware thread
+     */
+    template <typename Source, typename Target>
+    void Resample(const Source& source, Target& target, int numThreads = 0) const {
+      if (source.rows() != m_numSourcePositions || source.cols() != m_numSourceTimes) {
+        throw invalid_argument("field does not match the source grid");
+      }
+      using TargetScalar = typename Target::Scalar;
+      const int numPositions = static_cast<int>(m_positions.size());
+      const int numTimes = static_cast<int>(m_times.size());
+      target.resize(numPositions, numTimes);
+
+      Helper::ParallelFor(numTimes, numThreads, [&](int col) {
+        const Bracket& time = m_times[static_cast<size_t>(col)];
+        const int later = min(time.index + 1, m_numSourceTimes - 1);
+        for (int row = 0; row < numPositions; row++) {
+          const Bracket& position = m_positions[static_cast<size_t>(row)];
+          const int next = min(position.index + 1, m_numSourcePositions - 1);
+          auto at = [&source](int sourceRow, int sourceCol) {
+            return complex<double>(source(sourceRow, sourceCol));
+          };
+          const complex<double> earlierValue
+              = (1 - position.weight) * at(position.index, time.index)
+                + position.weight * at(next, time.index);
+          const complex<double> laterValue
+              = (1 - position.weight) * at(position.index, later)
+                + position.weight * at(next, later);
+          target(row, col)
+              = TargetScalar((1 - time.weight) * earlierValue + time.weight * laterValue);
+        }
+      });
+    }
+
+  private:
+    /** interpolation of one target point between source points index and index + 1 **/
+    struct Bracket {
+      int index = 0;
+      double weight = 0;
+    };
+
+    static vector<Bracket> BuildBrackets(const Axis& source, const Axis& target);
+
+    vector<Bracket> m_positions;
+    vector<Bracket> m_times;
+    int m_numSourcePositions = 0;
+    int m_numSourceTimes = 0;
+  };
+
+  /**
+   * CoarsenGridDetails builds a grid with about 1 / factor of the points of another along both
+   * axes and the same extent. Uniform axes stay uniform, non-uniform ones keep every factor-th
+   * point.
+   *
+   * @param  {GridDetails} details : fine grid
+   * @param  {int} factor          : coarsening factor, at least 2
+   * @return {GridDetails}         : coarse grid of (n - 1) / factor + 1 points per axis
+   */
+  GridDetails CoarsenGridDetails(const GridDetails& details, int factor);
+
+  /**
+   * @brief ContinuationOptions configures a coarse-to-fine continuation
+   */
+  struct ContinuationOptions {
+    /** number of grids solved, the last one being the target grid **/
+    int numLevels = 3;
+    /** each level has refinement times fewer intervals than the next along both axes **/
+    int refinement = 2;
+    double pertubationCoefficient = 0.2;
+    /** seed of the noise of every level **/
+    uint64_t seed = 0;
+    /**
+     * start the Newton iterations of every level from the interpolated solution of the previous
+     * one, requires the NewtonKrylov scheme. The solution of a level does not change, only the
+     * iterations it takes.
+     */
+    bool warmStart = false;
+    StepScheme scheme = StepScheme::SemiImplicit;
+    BoundaryCondition boundaryCondition = BoundaryCondition::Dirichlet;
+    /** number of threads of the solves and the resampling, 0 means one per hardware thread **/
+    int numThreads = 0;
+  };
+
+  /**
+   * @brief ContinuationLevel records one level of a continuation. Differences compare the solved
+   * fields against the previous level's solution interpolated onto this grid over the interior
+   * (first and last position and time trimmed), and are zero on the first level. The previous
+   * level's last time row is never computed by the march, so it is left out of the
+   * interpolation and later times take the value of the last computed row.
+   */
+  struct ContinuationLevel {
+    int numPositions = 0;
+    int numTimes = 0;
+    /** ||solved - interpolated||_2 / ||solved||_2 of A and B **/
+    double relativeL2A = 0;
+    double relativeL2B = 0;
+    /** max |solved - interpolated| of A and B **/
+    double linfA = 0;
+    double linfB = 0;
+    /** Newton iterations of the level's implicit rows, zero for semi-implicit solves **/
+    int newtonIterations = 0;
+    /** wall time of the level's ground truth, resampling and solve **/
+    double seconds = 0;
+  };
+
+  /**
+   * @brief ContinuationResult holds every level of a continuation, coarsest first
+   */
+  struct ContinuationResult {
+    vector<ContinuationLevel> levels;
+  };
+
+  /**
+   * @brief Continuation solves a case on a ladder of grids refined towards a target grid and
+   * measures the differences between consecutive levels against the coarser solution
+   * interpolated by a GridResampler, which gives convergence data for the target grid. The
+   * rows ahead of the march are part of the scheme (PerformNovelStabilityAnalysis.m reads them
+   * as the estimate of the current and next time rows), so they always keep the perturbed
+   * ground truth and every level solves exactly the case a cold solve of its grid would. With
+   * warmStart the interpolated solution is only the initial iterate of the implicit rows of a
+   * NewtonKrylov solve. Warm starts halve the Newton iterations of the finer levels, but the
+   * solves dominate the cost of a level and the ladder pays for every level, so it is no faster
+   * than a cold solve of the target grid alone: on one thread a 257 x 257 Bright-Bright case
+   * takes 256 instead of 510 iterations on its target level and 0.036 s for three levels against
+   * 0.040 s cold, and a 513 x 513 one is slower warm. Use it for the convergence data, not speed.
+   *
+   * @tparam Policy : PrecisionPolicy selecting the storage and accumulator scalar types
+   */
+  template <typename Policy> class Continuation {
+  public:
+    using FieldMatrix = typename Policy::FieldMatrix;
+
+    /**
+     * Continuation instantiates a continuation towards a target grid
+     *
+     * @param  {Constraint} constraint : constraints of the case
+     * @param  {GridDetails} target    : finest grid
+     */
+    Continuation(const Constraint& constraint, const GridDetails& target);
+
+    /**
+     * Run solves every level, coarsest first
+     * @param  {ContinuationOptions} options : continuation configuration
+     * @return {ContinuationResult}          : level to level differences and timings
+     */
+    ContinuationResult Run(const ContinuationOptions& options);
+
+    /** solved grid of the finest level of the last run, throws before the first run **/
+    const BasicGrid<Policy>& GetGrid() const;
+
+  private:
+    Constraint m_constraint;
+    GridDetails m_target;
+    unique_ptr<BasicGrid<Policy>> m_grid;
+  };
+
+  extern template class Continuation<MixedPrecision>;
+  extern template class Continuation<DoublePrecision>;
+}  // namespace CGLE
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <constraint.h>
+#include <domainDecomposition.h>
+#include <grid.h>
+#include <gridDetails.h>
+#include <memoryAccounting.h>
+#include <precision.h>
+#include <stabilitySolver.h>
+
+#include <Eigen/Dense>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief DomainDecomposition describes the positions one rank owns when the x-axis is split
+   * across ranks. The unknowns are split exactly like the SPIKE blocks of
+   * DistributedTridiagonalSolver; with Dirichlet boundaries the first rank also owns position 0
+   * and the last rank position numPositions - 1, which are pinned to zero and never solved for.
+   */
+  struct DomainDecomposition {
+    int numPositions = 0;
+    int rank = 0;
+    int size = 1;
+    BoundaryCondition boundary = BoundaryCondition::Dirichlet;
+    /** first position and number of positions held by the rank, its local rows **/
+    int firstPosition = 0;
+    int numLocalPositions = 0;
+    /** local row of the first unknown of the rank and number of unknowns it solves for **/
+    int firstLocalUnknown = 0;
+    int numLocalUnknowns = 0;
+
+    /**
+     * Split computes the positions of a rank
+     *
+     * @param  {int} numPositions           : number of positions of the whole grid
+     * @param  {BoundaryCondition} boundary : boundary condition
+     * @param  {int} rank                   : rank in [0, size)
+     * @param  {int} size                   : number of ranks, at most half the unknowns
+     * @return {DomainDecomposition}        : positions of the rank
+     */
+    static DomainDecomposition Split(int numPositions, BoundaryCondition boundary, int rank,
+                                     int size);
+
+    /** neighbouring ranks holding the positions before and after the local ones, or NO_RANK **/
+    int GetLeftNeighbour() const;
+    int GetRightNeighbour() const;
+  };
+
+  /**
+   * @brief DistributedStabilitySolver runs the time march of StabilitySolver with the x-axis
+   * split across the ranks of a DomainCommunicator. A grid only has to fit in the memory of all
+   * ranks together when every rank builds its own rows with ComputePerturbedRows, solves them
+   * with the local Solve overload and, if needed, gathers the result on one rank with
+   * GatherRows; the BasicGrid overload holds the whole grid on every rank. Before every time row
+   * the ranks exchange a one cell halo of both fields with their neighbours, which is all the
+   * stencil of ComputeAtCurrentTimeAndPosition reaches beyond the local rows, and AA / BB are
+   * solved with the distributed SPIKE solvers. With N ranks the result is identical to
+   * StabilitySolver using N threads for every solve.
+   *
+   * @tparam Policy : PrecisionPolicy selecting the storage and accumulator scalar types
+   */
+  template <typename Policy> class DistributedStabilitySolver {
+  public:
+    using AccumulatorType = typename Policy::AccumulatorType;
+    using AccumulatorComplex = typename Policy::AccumulatorComplex;
+    using AccumulatorVector = typename Policy::AccumulatorVector;
+    using StorageComplex = typename Policy::StorageComplex;
+    using FieldMatrix = typename Policy::FieldMatrix;
+    using Coefficients = CoefficientMatrix<AccumulatorType>;
+
+    /**
+     * DistributedStabilitySolver instantiates the solver of one rank
+     *
+     * @param  {Constraint} constraint           : constraints of the run
+     * @param  {GridDetails} details             : grid details providing Dx and Dt
+     * @param  {DomainCommunicator} communicator : communicator connecting the ranks, must outlive
+     *                                             the solver
+     */
+    DistributedStabilitySolver(const Constraint& constraint, const GridDetails& details,
+                               DomainCommunicator& communicator);
+
+    /**
+     * SetBoundaryCondition selects the boundary condition of subsequent solves
+     * @param  {BoundaryCondition} boundary : Dirichlet (default) or Periodic
+     */
+    void SetBoundaryCondition(BoundaryCondition boundary);
+
+    BoundaryCondition GetBoundaryCondition() const { return m_boundary; }
+
+    /**
+     * GetDecomposition returns the positions owned by the calling rank
+     * @param  {int} numPositions     : number of positions of the whole grid
+     * @return {DomainDecomposition}  : positions of the rank
+     */
+    DomainDecomposition GetDecomposition(int numPositions) const;
+
+    /**
+     * Solve runs the stability analysis in place on the local rows of a pair of fields,
+     * collectively over all ranks
+     *
+     * @param  {Eigen::Ref<FieldMatrix>} localA : rows of the perturbed A field owned by the rank
+     * @param  {Eigen::Ref<FieldMatrix>} localB : rows of the perturbed B field owned by the rank
+     * @param  {int} numPositions               : number of positions of the whole grid
+     */
+    void Solve(Eigen::Ref<FieldMatrix> localA, Eigen::Ref<FieldMatrix> localB, int numPositions);
+
+    /**
+     * Solve runs the stability analysis on a grid every rank holds in full: each rank marches
+     * its own rows and the solved rows of all ranks are gathered back into the grid
+     *
+     * @param  {BasicGrid<Policy>} grid : perturbed grid, identical on every rank
+     */
+    void Solve(BasicGrid<Policy>& grid);
+
+    /**
+     * GatherRows assembles the local rows of every rank into the whole field on one rank,
+     * collectively over all ranks. The other ranks only send their own rows.
+     *
+     * @param  {Eigen::Ref<const FieldMatrix>} local : rows of the field owned by the calling rank
+     * @param  {int} numPositions                    : number of positions of the whole grid
+     * @param  {FieldMatrix} field                   : receives the whole field on the root,
+     *                                                 untouched on the other ranks
+     * @param  {int} root                            : rank assembling the field
+     */
+    void GatherRows(const Eigen::Ref<const FieldMatrix>& local, int numPositions,
+                    FieldMatrix& field, int root = 0) const;
+
+  private:
+    /**
+     * Factorize factorizes AA and BB for a given number of unknowns if not already done
+     */
+    void Factorize(int numUnknowns);
+
+    /**
+     * ExchangeHalo receives the A and B values of the positions just before and just after the
+     * local rows at a time row from the neighbouring ranks
+     */
+    void ExchangeHalo(const DomainDecomposition& decomposition,
+                      const Eigen::Ref<FieldMatrix>& localA, const Eigen::Ref<FieldMatrix>& localB,
+                      int timeIndex, StorageComplex (&left)[2], StorageComplex (&right)[2]);
+
+    DomainCommunicator* m_communicator;
+    Coefficients m_coeffA;
+    Coefficients m_coeffB;
+    DistributedTridiagonalSolver<AccumulatorComplex> m_systemA;
+    DistributedTridiagonalSolver<AccumulatorComplex> m_systemB;
+    DistributedCyclicTridiagonalSolver<AccumulatorComplex> m_cyclicA;
+    DistributedCyclicTridiagonalSolver<AccumulatorComplex> m_cyclicB;
+    BoundaryCondition m_boundary = BoundaryCondition::Dirichlet;
+    int m_numUnknowns = 0;
+    AccumulatorVector m_da;
+    AccumulatorVector m_db;
+    MemoryCharge m_charge{MemorySubsystem::Solver};
+  };
+
+  extern template class DistributedStabilitySolver<MixedPrecision>;
+  extern template class DistributedStabilitySolver<DoublePrecision>;
+}  // namespace CGLE
@@ -0,0 +1,303 @@
+#pragma once
+
+#include <tridiagonal.h>
+
+#include <Eigen/Dense>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#ifdef CGLE_WITH_MPI
+#  include <mpi.h>
+#endif
+
+using namespace std;
+
+namespace CGLE {
+  /** rank standing for no neighbour, exchanges with it are skipped **/
+  const int NO_RANK = -1;
+
+  /**
+   * @brief DomainCommunicator is the message passing the distributed solvers are written against.
+   * MpiCommunicator maps it onto MPI; LocalCommunicatorGroup runs every rank as a thread of one
+   * process, which is how single node builds without MPI exercise the distributed code paths.
+   * Every call is collective over the ranks taking part in it and matches its calls in order.
+   */
+  class DomainCommunicator {
+  public:
+    virtual ~DomainCommunicator() = default;
+
+    virtual int GetRank() const = 0;
+    virtual int GetSize() const = 0;
+
+    /**
+     * SendReceive sends a buffer to one rank while receiving a buffer of the same size from
+     * another one, which may be the calling rank itself
+     *
+     * @param  {void*} send        : bytes to send
+     * @param  {size_t} bytes      : number of bytes sent and received
+     * @param  {int} destination   : rank to send to, NO_RANK to only receive
+     * @param  {void*} receive     : buffer receiving the bytes
+     * @param  {int} source        : rank to receive from, NO_RANK to only send
+     */
+    virtual void SendReceive(const void* send, size_t bytes, int destination, void* receive,
+                             int source)
+        = 0;
+
+    /**
+     * AllGather concatenates an equally sized buffer of every rank, in rank order, on every rank
+     *
+     * @param  {void*} send    : bytes of the calling rank
+     * @param  {size_t} bytes  : number of bytes contributed by every rank
+     * @param  {void*} receive : buffer of GetSize() * bytes receiving all contributions
+     */
+    virtual void AllGather(const void* send, size_t bytes, void* receive) = 0;
+  };
+
+  /**
+   * AllGather gathers a trivially copyable value of every rank, in rank order
+   * @param  {DomainCommunicator} communicator : communicator
+   * @param  {T} value                         : value of the calling rank
+   * @return {vector<T>}                       : value of every rank
+   */
+  template <typename T> vector<T> AllGather(DomainCommunicator& communicator, const T& value) {
+    static_assert(is_trivially_copyable<T>::value, "gathered values must be trivially copyable");
+    vector<T> values(communicator.GetSize());
+    communicator.AllGather(&value, sizeof(T), values.data());
+    return values;
+  }
+
+  /**
+   * @brief LocalCommunicatorGroup connects a fixed number of ranks living in the same process.
+   * Messages are buffered, so a send never waits for its receiver. Each rank must be driven by its
+   * own thread.
+   */
+  class LocalCommunicatorGroup {
+  public:
+    /**
+     * LocalCommunicatorGroup creates the communicators of a group of ranks
+     * @param  {int} size : number of ranks, at least 1
+     */
+    explicit LocalCommunicatorGroup(int size);
+    ~LocalCommunicatorGroup();
+
+    int GetSize() const { return static_cast<int>(m_communicators.size()); }
+
+    /**
+     * GetCommunicator returns the communicator of a rank
+     * @param  {int} rank             : rank in [0, GetSize())
+     * @return {DomainCommunicator}   : communicator of the rank
+     */
+    DomainCommunicator& GetCommunicator(int rank);
+
+  private:
+    struct State;
+    class Communicator;
+
+    shared_ptr<State> m_state;
+    vector<unique_ptr<Communicator>> m_communicators;
+  };
+
+#ifdef CGLE_WITH_MPI
+  /**
+   * @brief MpiSession initializes MPI for the lifetime of the object unless the application
+   * already did, and finalizes it only in the former case
+   */
+  class MpiSession {
+  public:
+    MpiSession(int* argc, char*** argv);
+    ~MpiSession();
+    MpiSession(const MpiSession&) = delete;
+    MpiSession& operator=(const MpiSession&) = delete;
+
+  private:
+    bool m_owned = false;
+  };
+
+  /**
+   * @brief MpiCommunicator runs the distributed solvers over an MPI communicator, one rank per
+   * process. MPI must be initialized, see MpiSession.
+   */
+  class MpiCommunicator : public DomainCommunicator {
+  public:
+    explicit MpiCommunicator(MPI_Comm communicator = MPI_COMM_WORLD);
+
+    int GetRank() const override { return m_rank; }
+    int GetSize() const override { return m_size; }
+    void SendReceive(const void* send, size_t bytes, int destination, void* receive,
+                     int source) override;
+    void AllGather(const void* send, size_t bytes, void* receive) override;
+
+  private:
+    MPI_Comm m_communicator;
+    int m_rank = 0;
+    int m_size = 1;
+  };
+#endif
+
+  /**
+   * @brief DistributedTridiagonalSolver solves the constant coefficient systems of
+   * PartitionedTridiagonalSolver with every SPIKE block on its own rank. Each rank solves its
+   * block, the first and last unknowns of all blocks are gathered, and every rank solves the small
+   * reduced system redundantly before correcting its block, so a solve costs one gather of two
+   * values per rank. With as many partitions as ranks the result is identical to
+   * PartitionedTridiagonalSolver.
+   *
+   * @tparam Scalar : scalar type of the system (typically complex<double>)
+   */
+  template <typename Scalar> class DistributedTridiagonalSolver {
+  public:
+    using Vector = typename TridiagonalSolver<Scalar>::Vector;
+    using Pair = typename SpikePartition<Scalar>::Pair;
+
+    explicit DistributedTridiagonalSolver(DomainCommunicator& communicator)
+        : m_communicator(&communicator) {}
+
+    /**
+     * Factorize precomputes the block factors, the spikes and the reduced system
+     *
+     * @param  {int} size       : number of unknowns over all ranks, at least two per rank
+     * @param  {Scalar} sub     : coefficient on the sub diagonal (a)
+     * @param  {Scalar} diag    : coefficient on the main diagonal (b)
+     * @param  {Scalar} super   : coefficient on the super diagonal (c)
+     */
+    void Factorize(int size, Scalar sub, Scalar diag, Scalar super) {
+      m_partition.Factorize(size, m_communicator->GetSize(), sub, diag, super);
+      m_size = size;
+      m_sub = sub;
+      m_super = super;
+    }
+
+    /**
+     * Solve solves the factorized system in place, collectively over all ranks
+     *
+     * @param  {Eigen::Ref<Vector>} rhs : unknowns of the calling rank, right hand side on input,
+     *                                    solution on output
+     */
+    void Solve(Eigen::Ref<Vector> rhs) const {
+      const int rank = m_communicator->GetRank();
+      if (rhs.size() != GetLocalSize()) {
+        throw invalid_argument("right hand side does not match the unknowns of the rank");
+      }
+
+      m_partition.GetBlockSolver(rank).Solve(rhs);
+      const array<Scalar, 2> local = {rhs[0], rhs[rhs.size() - 1]};
+      const vector<array<Scalar, 2>> gathered = AllGather(*m_communicator, local);
+
+      vector<Pair> ends(gathered.size());
+      for (size_t block = 0; block < gathered.size(); block++) {
+        ends[block] = Pair(gathered[block][0], gathered[block][1]);
+      }
+      m_partition.SolveReduced(ends);
+      m_partition.Correct(rank, rhs, ends);
+    }
+
+    int GetSize() const { return m_size; }
+    /** first unknown owned by the calling rank **/
+    int GetLocalStart() const { return m_partition.BlockStart(m_communicator->GetRank()); }
+    /** number of unknowns owned by the calling rank **/
+    int GetLocalSize() const { return m_partition.BlockLength(m_communicator->GetRank()); }
+    Scalar GetSub() const { return m_sub; }
+    Scalar GetSuper() const { return m_super; }
+    DomainCommunicator& GetCommunicator() const { return *m_communicator; }
+    /** bytes held by the block factorizations, the spikes and the reduced system **/
+    size_t GetBytes() const { return m_partition.GetBytes(); }
+
+  private:
+    DomainCommunicator* m_communicator;
+    SpikePartition<Scalar> m_partition;
+    int m_size = 0;
+    Scalar m_sub = Scalar(0), m_super = Scalar(0);
+  };
+
+  /**
+   * @brief DistributedCyclicTridiagonalSolver is the distributed counterpart of
+   * CyclicTridiagonalSolver. The correction vectors Z = T^-1 [e_1, e_n] are distributed like the
+   * unknowns; a solve gathers the first and last unknown of every rank to form the two coupling
+   * terms, so it costs two gathers.
+   *
+   * @tparam Scalar : scalar type of the system (typically complex<double>)
+   */
+  template <typename Scalar> class DistributedCyclicTridiagonalSolver {
+  public:
+    using Vector = typename TridiagonalSolver<Scalar>::Vector;
+    using Block = Eigen::Matrix<Scalar, 2, 2>;
+    using Pair = Eigen::Matrix<Scalar, 2, 1>;
+
+    explicit DistributedCyclicTridiagonalSolver(DomainCommunicator& communicator)
+        : m_system(communicator) {}
+
+    /**
+     * Factorize factorizes the tridiagonal part and precomputes the rank two correction,
+     * collectively over all ranks
+     *
+     * @param  {int} size       : number of unknowns over all ranks, at least two per rank and 3
+     * @param  {Scalar} sub     : coefficient on the sub diagonal and the top right corner (a)
+     * @param  {Scalar} diag    : coefficient on the main diagonal (b)
+     * @param  {Scalar} super   : coefficient on the super diagonal and the bottom left corner (c)
+     */
+    void Factorize(int size, Scalar sub, Scalar diag, Scalar super) {
+      if (size < 3) throw invalid_argument("cyclic tridiagonal system needs at least 3 unknowns");
+
+      m_system.Factorize(size, sub, diag, super);
+      const int localStart = m_system.GetLocalStart();
+      const int localSize = m_system.GetLocalSize();
+      m_first = Vector::Zero(localSize);
+      m_last = Vector::Zero(localSize);
+      if (localStart == 0) m_first[0] = Scalar(1);
+      if (localStart + localSize == size) m_last[localSize - 1] = Scalar(1);
+      m_system.Solve(m_first);
+      m_system.Solve(m_last);
+
+      // V^T = [sub e_n^T; super e_1^T]
+      const Pair firstEnds = GatherEnds(m_first);
+      const Pair lastEnds = GatherEnds(m_last);
+      Block capacitance;
+      capacitance << Scalar(1) + sub * firstEnds[1], sub * lastEnds[1], super * firstEnds[0],
+          Scalar(1) + super * lastEnds[0];
+      if (capacitance.determinant() == Scalar(0)) {
+        throw runtime_error("cyclic tridiagonal system is singular");
+      }
+      m_inverseCapacitance = capacitance.inverse();
+    }
+
+    /**
+     * Solve solves the factorized system in place, collectively over all ranks
+     *
+     * @param  {Eigen::Ref<Vector>} rhs : unknowns of the calling rank, right hand side on input,
+     *                                    solution on output
+     */
+    void Solve(Eigen::Ref<Vector> rhs) const {
+      m_system.Solve(rhs);
+
+      const Pair ends = GatherEnds(rhs);
+      const Pair coupling(m_system.GetSub() * ends[1], m_system.GetSuper() * ends[0]);
+      const Pair weights = m_inverseCapacitance * coupling;
+      rhs -= weights[0] * m_first + weights[1] * m_last;
+    }
+
+    int GetSize() const { return m_system.GetSize(); }
+    int GetLocalStart() const { return m_system.GetLocalStart(); }
+    int GetLocalSize() const { return m_system.GetLocalSize(); }
+    /** bytes held by the tridiagonal factorization and the rank two correction **/
+    size_t GetBytes() const {
+      const Eigen::Index corrections = m_first.size() + m_last.size();
+      return m_system.GetBytes() + static_cast<size_t>(corrections) * sizeof(Scalar);
+    }
+
+  private:
+    /** GatherEnds returns the first and the last unknown of a distributed vector **/
+    Pair GatherEnds(const Eigen::Ref<const Vector>& local) const {
+      const array<Scalar, 2> ends = {local[0], local[local.size() - 1]};
+      const vector<array<Scalar, 2>> gathered = AllGather(m_system.GetCommunicator(), ends);
+      return Pair(gathered.front()[0], gathered.back()[1]);
+    }
+
+    DistributedTridiagonalSolver<Scalar> m_system;
+    Vector m_first, m_last;
+    Block m_inverseCapacitance;
+  };
+}  // namespace CGLE
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <constants.h>
+#include <constraint.h>
+#include <grid.h>
+#include <gridDetails.h>
+#include <precision.h>
+#include <stabilitySolver.h>
+
+#include <Eigen/Dense>
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief RunningFieldStatistics accumulates the per cell mean, variance and max of a field's
+   * amplitude with Welford's update. Accumulators built from disjoint sets of members merge with
+   * the parallel (Chan et al.) update, so memory stays O(grid) however many members are added.
+   */
+  class RunningFieldStatistics {
+  public:
+    RunningFieldStatistics() = default;
+
+    /**
+     * RunningFieldStatistics instantiates an empty accumulator for fields of a given shape
+     *
+     * @param  {Eigen::Index} rows : number of rows of the accumulated fields
+     * @param  {Eigen::Index} cols : number of columns of the accumulated fields
+     */
+    RunningFieldStatistics(Eigen::Index rows, Eigen::Index cols);
+
+    /**
+     * Add accumulates |field| cell by cell
+     * @param  {Eigen::MatrixBase<Derived>} field : real or complex field of the accumulator's shape
+     */
+    template <typename Derived> void Add(const Eigen::MatrixBase<Derived>& field) {
+      if (field.rows() != m_mean.rows() || field.cols() != m_mean.cols()) {
+        throw invalid_argument("field does not match the accumulator shape");
+      }
+
+      m_count++;
+      const double count = static_cast<double>(m_count);
+      for (Eigen::Index col = 0; col < field.cols(); col++) {
+        for (Eigen::Index row = 0; row < field.rows(); row++) {
+          const double amplitude = static_cast<double>(std::abs(field(row, col)));
+          const double delta = amplitude - m_mean(row, col);
+          m_mean(row, col) += delta / count;
+          m_m2(row, col) += delta * (amplitude - m_mean(row, col));
+          if (m_count == 1 || amplitude > m_max(row, col)) m_max(row, col) = amplitude;
+        }
+      }
+    }
+
+    /**
+     * Merge folds the statistics of another accumulator of the same shape into this one
+     * @param  {RunningFieldStatistics} other : accumulator over a disjoint set of members
+     */
+    void Merge(const RunningFieldStatistics& other);
+
+    long long GetCount() const { return m_count; }
+    const Eigen::ArrayXXd& GetMean() const { return m_mean; }
+    const Eigen::ArrayXXd& GetMax() const { return m_max; }
+
+    /**
+     * GetVariance returns the per cell sample variance, zero while fewer than two members were
+     * accumulated
+     * @return {Eigen::ArrayXXd}  : sample variance of the amplitude
+     */
+    Eigen::ArrayXXd GetVariance() const;
+
+  private:
+    long long m_count = 0;
+    Eigen::ArrayXXd m_mean;
+    Eigen::ArrayXXd m_m2;
+    Eigen::ArrayXXd m_max;
+  };
+
+  /**
+   * @brief EnsembleOptions configures a Monte Carlo run of the stability analysis
+   */
+  struct EnsembleOptions {
+    /** number of noise realizations to run **/
+    long long numMembers = 100;
+    /** pertubation coefficient passed to PerturbGrid **/
+    double pertubationCoefficient = 0.2;
+    /** seed every member's noise is derived from **/
+    uint64_t seed = 0;
+    /** number of worker threads, 0 means one per hardware thread **/
+    int numThreads = 0;
+    /**
+     * number of reduction lanes. Member m is reduced into lane m % numLanes and the lanes are
+     * merged in order, so results depend on the seed and the lane count but never on the thread
+     * count. Each lane holds its own statistics, and at most numLanes threads do useful work.
+     */
+    int numLanes = DEFAULT_ENSEMBLE_LANES;
+    /** a member is unstable once its amplitude exceeds this factor times the ground truth max **/
+    double divergenceFactor = DEFAULT_DIVERGENCE_FACTOR;
+    /** boundary condition every member is solved with **/
+    BoundaryCondition boundaryCondition = BoundaryCondition::Dirichlet;
+  };
+
+  /**
+   * @brief EnsembleResult aggregates the solved fields of every member of an ensemble
+   */
+  struct EnsembleResult {
+    /** number of members run **/
+    long long numMembers = 0;
+    /** number of members that diverged or produced non finite values **/
+    long long numUnstable = 0;
+    /** per (x, t) statistics of |A|, over the members with finite solutions **/
+    RunningFieldStatistics amplitudeA;
+    /** per (x, t) statistics of |B|, over the members with finite solutions **/
+    RunningFieldStatistics amplitudeB;
+    /** per time step statistics of max(|A|, |B|) over x, over the members with finite solutions **/
+    RunningFieldStatistics stepMaxAmplitude;
+
+    double GetUnstableFraction() const {
+      return numMembers > 0 ? static_cast<double>(numUnstable) / numMembers : 0;
+    }
+  };
+
+  /**
+   * @brief EnsembleRunner runs N noise realizations of PerturbGrid followed by the stability
+   * solve and reduces them into running statistics without keeping any member's fields. Members
+   * fork a shared ground truth grid and draw their noise from an engine seeded with (seed, member
+   * index), so a given seed always produces the same result.
+   *
+   * @tparam Policy : PrecisionPolicy selecting the storage and accumulator scalar types
+   */
+  template <typename Policy> class EnsembleRunner {
+  public:
+    /**
+     * EnsembleRunner instantiates a runner and computes the shared ground truth
+     *
+     * @param  {Constraint} constraint : constraints of the case being simulated
+     * @param  {GridDetails} details   : grid dimensions and axis points
+     */
+    EnsembleRunner(const Constraint& constraint, const GridDetails& details);
+
+    /**
+     * Run runs the ensemble
+     * @param  {EnsembleOptions} options : ensemble configuration
+     * @return {EnsembleResult}          : aggregated statistics
+     */
+    EnsembleResult Run(const EnsembleOptions& options) const;
+
+    /**
+     * MemberEngine returns the random engine a member draws its noise from
+     * @param  {uint64_t} seed    : seed of the ensemble
+     * @param  {long long} member : index of the member
+     * @return {mt19937_64}       : seeded engine
+     */
+    static mt19937_64 MemberEngine(uint64_t seed, long long member);
+
+    double GetMaxGroundTruthAmplitude() const { return m_maxGroundTruthAmplitude; }
+
+  private:
+    /**
+     * Reduce folds a solved member into a lane's result
+     *
+     * @param  {BasicGrid<Policy>} grid    : solved member
+     * @param  {double} divergenceLimit    : amplitude above which the member is unstable
+     * @param  {Eigen::VectorXd} stepMax   : scratch vector of one entry per time step
+     * @param  {EnsembleResult} lane       : lane the member is reduced into
+     */
+    void Reduce(const BasicGrid<Policy>& grid, double divergenceLimit, Eigen::VectorXd& stepMax,
+                EnsembleResult& lane) const;
+
+    Constraint m_constraint;
+    BasicGrid<Policy> m_base;
+    double m_maxGroundTruthAmplitude = 0;
+  };
+
+  extern template class EnsembleRunner<MixedPrecision>;
+  extern template class EnsembleRunner<DoublePrecision>;
+}  // namespace CGLE
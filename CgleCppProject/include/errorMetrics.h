@@ -0,0 +1,57 @@
+#pragma once
+
+#include <constants.h>
+#include <grid.h>
+#include <precision.h>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief FieldErrorMetrics compares a solved perturbed field against its ground truth over the
+   * interior of the grid (first and last position and time trimmed, as PlotMesh.m does)
+   */
+  struct FieldErrorMetrics {
+    /** sum of |perturbed - ground truth| **/
+    double l1 = 0;
+    /** sqrt of the sum of |perturbed - ground truth|^2 **/
+    double l2 = 0;
+    /** max |perturbed - ground truth| **/
+    double linf = 0;
+    /** l2 / ||ground truth||_2, zero for a zero ground truth **/
+    double relativeL2 = 0;
+    /** linf / max |ground truth|, zero for a zero ground truth **/
+    double relativeLinf = 0;
+    /** max |perturbed| **/
+    double maxAmplitude = 0;
+    /** max |ground truth| **/
+    double maxReferenceAmplitude = 0;
+  };
+
+  /**
+   * @brief ErrorMetrics holds the metrics of both fields of a grid
+   */
+  struct ErrorMetrics {
+    FieldErrorMetrics a;
+    FieldErrorMetrics b;
+    /** number of interior cells the metrics were computed over **/
+    long long numCells = 0;
+  };
+
+  /**
+   * ComputeErrorMetrics computes the metrics of A and B in a single fused pass over the interior.
+   * The interior is cut into chunks of ERROR_METRIC_CHUNK_CELLS cells whose partial sums are
+   * combined in chunk order, so the result is bit for bit identical at any thread count. No field
+   * sized temporary is allocated; perturbed fields that were never materialized are read tile by
+   * tile.
+   *
+   * @param  {BasicGrid<Policy>} grid : solved grid
+   * @param  {int} numThreads         : number of threads, 0 means one per hardware thread
+   * @return {ErrorMetrics}           : metrics of both fields
+   */
+  template <typename Policy>
+  ErrorMetrics ComputeErrorMetrics(const BasicGrid<Policy>& grid, int numThreads = 0);
+
+  extern template ErrorMetrics ComputeErrorMetrics<MixedPrecision>(const Grid&, int);
+  extern template ErrorMetrics ComputeErrorMetrics<DoublePrecision>(const ReferenceGrid&, int);
+}  // namespace CGLE
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <constants.h>
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief FieldCompression selects how fields are stored. None stores the raw values and has no
+   * codec. Lossless reproduces every bit, NaN and infinities included. ErrorBounded quantizes the
+   * real and imaginary parts to a multiple of twice the error bound first, so each part is
+   * reproduced within the bound plus the rounding of the stored scalar type; planes of a tile
+   * holding non-finite or huge values stay lossless.
+   */
+  enum class FieldCompression : uint8_t { None = 0, Lossless = 1, ErrorBounded = 2 };
+
+  /**
+   * @brief FieldCodecOptions configures a FieldCodec
+   */
+  struct FieldCodecOptions {
+    FieldCompression compression = FieldCompression::None;
+    /** max absolute error of every real and imaginary part with ErrorBounded **/
+    double errorBound = 0;
+    /** number of elements coded independently of the others, the unit of parallelism **/
+    int tileElements = DEFAULT_CODEC_TILE_ELEMENTS;
+    /** number of threads, 0 means one per hardware thread **/
+    int numThreads = 0;
+  };
+
+  /**
+   * @brief FieldCodec compresses column-major fields of real or complex scalars. Fields are cut
+   * into tiles of consecutive elements coded in parallel. Within a tile the real and imaginary
+   * parts are coded as separate planes: each value is replaced by the zigzag encoded difference
+   * with its predecessor (of the raw bit patterns, or of the quantized values with ErrorBounded),
+   * so smooth fields along a column turn into small integers, and the differences are byte
+   * shuffled so that every byte position forms its own stream. Each stream is entropy coded with
+   * an order-0 rANS coder, stored raw when that does not pay off, or as a single byte when it is
+   * constant, which is how the zero imaginary planes of real amplitudes cost nothing.
+   */
+  class FieldCodec {
+  public:
+    /**
+     * FieldCodec instantiates a codec, throwing invalid_argument for FieldCompression::None
+     * @param  {FieldCodecOptions} options : compression mode, error bound, tiling and threads
+     */
+    explicit FieldCodec(const FieldCodecOptions& options);
+
+    /**
+     * Encode compresses a field
+     *
+     * @param  {Scalar} values       : column-major values, float, double or complex of either
+     * @param  {size_t} numElements  : number of values
+     * @return {vector<uint8_t>}     : self describing compressed stream
+     */
+    template <typename Scalar>
+    vector<uint8_t> Encode(const Scalar* values, size_t numElements) const;
+
+    /**
+     * Decode decompresses a stream produced by Encode with the same scalar type, throwing
+     * runtime_error on a truncated or foreign stream
+     *
+     * @param  {uint8_t} data        : compressed stream
+     * @param  {size_t} size         : size of the stream in bytes
+     * @param  {Scalar} values       : receives the values
+     * @param  {size_t} numElements  : number of values the stream must hold
+     */
+    template <typename Scalar>
+    void Decode(const uint8_t* data, size_t size, Scalar* values, size_t numElements) const;
+
+    const FieldCodecOptions& GetOptions() const { return m_options; }
+
+  private:
+    FieldCodecOptions m_options;
+  };
+
+  extern template vector<uint8_t> FieldCodec::Encode<float>(const float*, size_t) const;
+  extern template vector<uint8_t> FieldCodec::Encode<double>(const double*, size_t) const;
+  extern template vector<uint8_t> FieldCodec::Encode<complex<float>>(const complex<float>*,
+                                                                     size_t) const;
+  extern template vector<uint8_t> FieldCodec::Encode<complex<double>>(const complex<double>*,
+                                                                      size_t) const;
+  extern template void FieldCodec::Decode<float>(const uint8_t*, size_t, float*, size_t) const;
+  extern template void FieldCodec::Decode<double>(const uint8_t*, size_t, double*, size_t) const;
+  extern template void FieldCodec::Decode<complex<float>>(const uint8_t*, size_t,
+                                                          complex<float>*, size_t) const;
+  extern template void FieldCodec::Decode<complex<double>>(const uint8_t*, size_t,
+                                                           complex<double>*, size_t) const;
+}  // namespace CGLE
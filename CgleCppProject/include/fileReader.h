@@ -1,4 +1,5 @@
 #include <constraint.h>
+#include <memoryAccounting.h>
 
 #include <fstream>
 #include <memory>
@@ -26,6 +27,7 @@ namespace CGLE {
   private:
     string m_filePath;
     Constraint m_constraint;
+    MemoryCharge m_charge{MemorySubsystem::ConstraintReader};
 
     /**
      * ReadHelper helper function to read the contents of a constraint file
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <axis.h>
+#include <constants.h>
+#include <constraint.h>
+#include <functionHandler.h>
+#include <precision.h>
+
+#include <Eigen/Dense>
+#include <array>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+#include "helper.h"
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief FixedGridDetails is the compile time sized counterpart of GridDetails for small sweep
+   * cases. Both axes are uniform and computed on demand, so the details hold no heap storage.
+   *
+   * @tparam Nx : number of positional points
+   * @tparam Nt : number of time points
+   */
+  template <int Nx, int Nt> class FixedGridDetails {
+  public:
+    static_assert(Nx >= 3 && Nt >= 2, "a grid needs at least 3 positions and 2 time points");
+
+    /**
+     * FixedGridDetails spans the default domain, positions 0 to DEFAULT_MAX_POSITION and times 0
+     * to DEFAULT_MAX_TIME
+     */
+    FixedGridDetails() : FixedGridDetails(0, DEFAULT_MAX_POSITION, 0, DEFAULT_MAX_TIME) {}
+
+    /**
+     * FixedGridDetails spans a given domain, endpoints included
+     *
+     * @param  {double} startPosition : first positional point
+     * @param  {double} endPosition   : last positional point
+     * @param  {double} startTime     : first time point
+     * @param  {double} endTime       : last time point
+     */
+    FixedGridDetails(double startPosition, double endPosition, double startTime, double endTime)
+        : m_x_axis(Axis::Linspace(startPosition, endPosition, Nx)),
+          m_time_axis(Axis::Linspace(startTime, endTime, Nt)) {
+      if (endPosition <= startPosition || endTime <= startTime) {
+        throw invalid_argument("invalid input arguments");
+      }
+    }
+
+    static constexpr int GetNumXPts() { return Nx; }
+    static constexpr int GetNumYPts() { return Nt; }
+    double GetDx() const { return std::abs(m_x_axis.GetStep()); }
+    double GetDt() const { return std::abs(m_time_axis.GetStep()); }
+    const Axis& GetXAxis() const { return m_x_axis; }
+    const Axis& GetTimeAxis() const { return m_time_axis; }
+
+  private:
+    Axis m_x_axis;
+    Axis m_time_axis;
+  };
+
+  /**
+   * @brief FixedGrid is the compile time sized counterpart of BasicGrid for small sweep cases.
+   * Its ground truth and perturbed fields live in fixed capacity aligned arrays held inline and
+   * are exposed as fixed size Eigen maps, so every loop over a field has compile time bounds and
+   * the fields never touch the buffer pool or the heap. The function handler is held by value;
+   * its constraint is the only heap allocation a grid makes. It follows BasicGrid's API and
+   * reproduces its results draw for draw given the same engine and pointwise evaluation. The
+   * fields bind to the dynamic Eigen::Ref interfaces, e.g.
+   * StabilitySolver::Solve(grid.GetPerturbedA(), grid.GetPerturbedB()), the solver's scratch
+   * still comes from its BufferPool.
+   *
+   * A grid holds four Nx x Nt fields inline (640 KiB at the default 100 x 100 double precision
+   * size), so large instances belong in static or heap storage rather than on a thread's stack.
+   * Cases beyond MAX_FIXED_GRID_CELLS belong in BasicGrid.
+   *
+   * @tparam Nx     : number of positional points
+   * @tparam Nt     : number of time points
+   * @tparam Policy : PrecisionPolicy selecting the storage and accumulator scalar types
+   */
+  template <int Nx, int Nt, typename Policy = MixedPrecision> class FixedGrid {
+  public:
+    static_assert(static_cast<long long>(Nx) * Nt <= MAX_FIXED_GRID_CELLS,
+                  "FixedGrid supports up to MAX_FIXED_GRID_CELLS cells (e.g. 128 x 128), use "
+                  "BasicGrid for larger grids");
+
+    using Details = FixedGridDetails<Nx, Nt>;
+    using Scalar = typename Policy::StorageComplex;
+    /** the field type the maps view, never instantiated since it may exceed Eigen's stack limit **/
+    using FieldMatrix = Eigen::Matrix<Scalar, Nx, Nt>;
+    using FieldMap = Eigen::Map<FieldMatrix, Eigen::AlignedMax>;
+    using ConstFieldMap = Eigen::Map<const FieldMatrix, Eigen::AlignedMax>;
+
+    /**
+     * FixedGrid instantiates a grid and evaluates its ground truth
+     *
+     * @param  {Constraint} constraint : Object outlining grid constraints
+     * @param  {Details} details       : axes of the grid
+     */
+    explicit FixedGrid(const Constraint& constraint, const Details& details = Details())
+        : m_functHdl(constraint), m_details(details) {
+      ComputeGroundTruth();
+    }
+
+    /**
+     * PerturbGrid perturbs the x = 0 and t = 0 lines of the grid, see BasicGrid::PerturbGrid
+     * @param  {double} pertubationCoefficient : pertubation coefficient applied to the boundaries
+     */
+    void PerturbGrid(const double pertubationCoefficient) {
+      std::random_device seed;
+      mt19937_64 engine(seed());
+      PerturbGrid(pertubationCoefficient, engine);
+    }
+
+    /**
+     * PerturbGrid perturbs the grid drawing the jitter from a caller owned engine
+     *
+     * @param  {double} pertubationCoefficient : pertubation coefficient applied to the boundaries
+     * @param  {mt19937_64} engine             : random engine the jitter is drawn from
+     */
+    void PerturbGrid(const double pertubationCoefficient, mt19937_64& engine) {
+      m_perturbed_gridA = m_grid_groundtruthA;
+      m_perturbed_gridB = m_grid_groundtruthB;
+
+      // compile time bounds, scanning the axes is cheaper than locating the lines
+      const Axis& xPts = m_details.GetXAxis();
+      const Axis& timePts = m_details.GetTimeAxis();
+      for (int xPoint = 0; xPoint < Nx; xPoint++) {
+        if (xPts[xPoint] != 0) continue;
+        for (int timePoint = 0; timePoint < Nt; timePoint++) {
+          PerturbCell(xPoint, timePoint, pertubationCoefficient, engine);
+        }
+      }
+      for (int timePoint = 0; timePoint < Nt; timePoint++) {
+        if (timePts[timePoint] != 0) continue;
+        for (int xPoint = 0; xPoint < Nx; xPoint++) {
+          // cells on both lines were already perturbed by the loop above
+          if (xPts[xPoint] == 0) continue;
+          PerturbCell(xPoint, timePoint, pertubationCoefficient, engine);
+        }
+      }
+    }
+
+    /**
+     * ComputeGroundTruth evaluates A(x,t) and B(x,t) at every cell of the grid
+     */
+    void ComputeGroundTruth() {
+      const Axis& xPts = m_details.GetXAxis();
+      const Axis& timePts = m_details.GetTimeAxis();
+      if (timePts[0] < 0 || timePts[Nt - 1] < 0) throw invalid_argument("time cannot be negative");
+
+      const FnHandlerRetType& waveA = m_functHdl.A();
+      const FnHandlerRetType& waveB = m_functHdl.B();
+      FieldMap groundTruthA = GroundTruthA();
+      FieldMap groundTruthB = GroundTruthB();
+      for (int timePoint = 0; timePoint < Nt; timePoint++) {
+        for (int xPoint = 0; xPoint < Nx; xPoint++) {
+          typename Policy::AccumulatorComplex amplitudeA = waveA(xPts[xPoint], timePts[timePoint]);
+          typename Policy::AccumulatorComplex amplitudeB = waveB(xPts[xPoint], timePts[timePoint]);
+          groundTruthA(xPoint, timePoint) = Policy::ToStorage(amplitudeA);
+          groundTruthB(xPoint, timePoint) = Policy::ToStorage(amplitudeB);
+        }
+      }
+      m_perturbed_gridA = m_grid_groundtruthA;
+      m_perturbed_gridB = m_grid_groundtruthB;
+    }
+
+    const Details& GetDetails() const { return m_details; }
+    const Constraint& GetConstraint() const { return m_functHdl.GetConstraint(); }
+
+    FieldMap GetPerturbedA() { return FieldMap(m_perturbed_gridA.data()); }
+    FieldMap GetPerturbedB() { return FieldMap(m_perturbed_gridB.data()); }
+    ConstFieldMap GetPerturbedA() const { return ConstFieldMap(m_perturbed_gridA.data()); }
+    ConstFieldMap GetPerturbedB() const { return ConstFieldMap(m_perturbed_gridB.data()); }
+    ConstFieldMap GetGroundTruthA() const { return ConstFieldMap(m_grid_groundtruthA.data()); }
+    ConstFieldMap GetGroundTruthB() const { return ConstFieldMap(m_grid_groundtruthB.data()); }
+
+  private:
+    /** column-major cells of a field, aligned for Eigen's vectorized kernels **/
+    struct alignas(EIGEN_MAX_ALIGN_BYTES) FieldStorage : array<Scalar, Nx * Nt> {};
+
+    FieldMap GroundTruthA() { return FieldMap(m_grid_groundtruthA.data()); }
+    FieldMap GroundTruthB() { return FieldMap(m_grid_groundtruthB.data()); }
+
+    /**
+     * PerturbCell applies noise to a single cell of the perturbed fields
+     */
+    void PerturbCell(int xPoint, int timePoint, double pertubationCoefficient,
+                     mt19937_64& engine) {
+      const double position = m_details.GetXAxis()[xPoint];
+      const double time = m_details.GetTimeAxis()[timePoint];
+      typename Policy::AccumulatorComplex amplitudeA = m_functHdl.A()(position, time);
+      typename Policy::AccumulatorComplex amplitudeB = m_functHdl.B()(position, time);
+
+      double noise = Helper::GenerateRandomNumber<double>(0, 1, engine);
+      double noiseValue = 1 + (pertubationCoefficient * noise);
+      GetPerturbedA()(xPoint, timePoint) = Policy::ToStorage(amplitudeA * noiseValue);
+      GetPerturbedB()(xPoint, timePoint) = Policy::ToStorage(amplitudeB * noiseValue);
+    }
+
+    FunctionHandler m_functHdl;
+    Details m_details;
+    FieldStorage m_grid_groundtruthA, m_grid_groundtruthB;
+    FieldStorage m_perturbed_gridA, m_perturbed_gridB;
+  };
+}  // namespace CGLE
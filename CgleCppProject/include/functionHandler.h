@@ -1,5 +1,6 @@
 #pragma once
 #include <constraint.h>
+#include <memoryAccounting.h>
 
 #include <functional>
 #include <memory>
@@ -21,17 +22,25 @@ namespace CGLE {
      * Returns the function handle representing A(x,t)
      * @return {FnHandlerRetType}  :
      */
-    FnHandlerRetType A();
+    const FnHandlerRetType& A() const;
     /**
      * Returns the function handle representing B(x,t)
      * @return {FnHandlerRetType}  :
      */
-    FnHandlerRetType B();
+    const FnHandlerRetType& B() const;
+    /**
+     * Returns the constraint the wave forms were initialized from
+     * @return {Constraint}  :
+     */
+    const Constraint& GetConstraint() const;
 
   private:
+    /** shared by copies, the wave forms capture it rather than the handler so copies stay valid **/
     shared_ptr<Constraint> m_constraint;
     FnHandlerRetType m_A;
     FnHandlerRetType m_B;
+    MemoryCharge m_charge{MemorySubsystem::FunctionHandler,
+                          sizeof(FunctionHandler) + sizeof(Constraint)};
     /**
      * InitializeBrightBrightFunctors initializes the function definitions of the bright bright wave
      *
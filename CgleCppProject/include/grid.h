@@ -1,12 +1,20 @@
 #pragma once
 
+#include <bufferPool.h>
 #include <cell.h>
 #include <constraint.h>
 #include <functionHandler.h>
 #include <gridDetails.h>
+#include <numaPlacement.h>
+#include <precision.h>
+#include <separableEvaluator.h>
+#include <tiledField.h>
 
 #include <Eigen/Dense>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <random>
 #include <vector>
 
 #include "helper.h"
@@ -14,14 +22,52 @@
 using namespace std;
 
 namespace CGLE {
-  class Grid {
+  /**
+   * @brief BasicGrid holds the ground truth and perturbed A/B fields of a simulation. Fields are
+   * stored at the precision policy's storage type while amplitudes are computed at its accumulator
+   * type. Field storage is leased from the calling thread's BufferPool and handed back when the
+   * grid is destroyed so consecutive jobs of the same size reuse the same buffers.
+   *
+   * The perturbed fields are copy-on-write overlays of the ground truth: pertubation only touches
+   * the x = 0 and t = 0 lines, so only the tiles crossing those lines are ever copied until the
+   * solver materializes the fields. Fork() produces a grid sharing the ground truth, the base and
+   * every tile with this grid, which makes perturbation ensembles cheap.
+   *
+   * @tparam Policy : PrecisionPolicy selecting the storage and accumulator scalar types
+   */
+  template <typename Policy> class BasicGrid {
   public:
+    using FieldMatrix = typename Policy::FieldMatrix;
+    using FieldPool = BufferPool<typename Policy::StorageComplex>;
+    using PerturbedField = TiledField<typename Policy::StorageComplex>;
+
     /**
      * @brief generates a grid object
      *
      * @param  {Constraint} constraint : Object outlining grid constraints
      */
-    Grid(Constraint& constraint);
+    BasicGrid(Constraint& constraint);
+
+    /**
+     * @brief generates a grid object
+     *
+     * @param  {Constraint} constraint  : Object outlining grid constraints
+     * @param  {GridDetails} details    : grid dimensions and axis points
+     */
+    BasicGrid(Constraint& constraint, const GridDetails& details);
+
+    /**
+     * @brief generates a grid object whose fields are placed on the NUMA nodes of the workers
+     * computing them. Fields are allocated outside the buffer pool and every page is first
+     * touched by the worker owning it (see PlacementOptions); pointwise ground truth evaluation
+     * runs every page on the same worker.
+     *
+     * @param  {Constraint} constraint      : Object outlining grid constraints
+     * @param  {GridDetails} details        : grid dimensions and axis points
+     * @param  {PlacementOptions} placement : placement of the fields
+     */
+    BasicGrid(Constraint& constraint, const GridDetails& details,
+              const PlacementOptions& placement);
 
     /**
      * @brief generates a grid object
@@ -32,7 +78,7 @@ namespace CGLE {
      * @param  {int} num_pts   : total number of points across the entire grid
      * @param  {Constraint} constraint : Object outlining grid constraints
      */
-    Grid(int num_x_pts, int num_y_pts, int num_z_pts, int num_pts, Constraint& constraint);
+    BasicGrid(int num_x_pts, int num_y_pts, int num_z_pts, int num_pts, Constraint& constraint);
 
     /**
      * @brief generates a grid object
@@ -45,8 +91,8 @@ namespace CGLE {
      * @param  {double} dz     : space between points on z axis
      * @param  {Constraint} constraint : Object outlining grid constraints
      */
-    Grid(int num_x_pts, int num_y_pts, int num_z_pts, double dx, double dy, double dz,
-         Constraint& constraint);
+    BasicGrid(int num_x_pts, int num_y_pts, int num_z_pts, double dx, double dy, double dz,
+              Constraint& constraint);
 
     /**
      * PerturbGrid perturbs the grid meaning computes the amplitude with some jitter at
@@ -58,22 +104,174 @@ namespace CGLE {
      */
     void PerturbGrid(const double pertubationCoefficient);
 
+    /**
+     * PerturbGrid perturbs the grid drawing the jitter from a caller owned engine, so a seeded
+     * engine reproduces the exact same perturbed grid
+     *
+     * @param  {double} pertubationCoefficient : pertubation coefficient applied to the boundaries
+     * @param  {mt19937_64} engine             : random engine the jitter is drawn from
+     */
+    void PerturbGrid(const double pertubationCoefficient, mt19937_64& engine);
+
+    /**
+     * PerturbGrid perturbs the grid with the jitter of every cell drawn from Helper::CellNoise,
+     * so ComputePerturbedRows reproduces any block of its rows without building the grid
+     *
+     * @param  {double} pertubationCoefficient : pertubation coefficient applied to the boundaries
+     * @param  {uint64_t} seed                 : seed of the realization
+     */
+    void PerturbGrid(const double pertubationCoefficient, uint64_t seed);
+
+    /**
+     * ComputeGroundTruth evaluates A(x,t) and B(x,t) at every cell of the grid. Forks share the
+     * result so it is computed at most once per family of grids.
+     */
+    void ComputeGroundTruth();
+
+    /**
+     * SetFieldEvaluation selects how the ground truth is evaluated, Separable by default. Changing
+     * it discards an already computed ground truth.
+     *
+     * @param  {FieldEvaluation} evaluation : pointwise or separable evaluation
+     */
+    void SetFieldEvaluation(FieldEvaluation evaluation);
+
+    /**
+     * Fork creates a grid sharing this grid's constraint, details and ground truth by reference.
+     * The fork's perturbed fields start as copy-on-write views of this grid's perturbed fields, so
+     * re-perturbing the fork only copies the tiles crossing the x = 0 and t = 0 lines.
+     *
+     * @return {BasicGrid}  : forked grid
+     */
+    BasicGrid Fork() const;
+
+    /**
+     * GetExclusiveBytes returns the number of field bytes this grid holds that are not shared with
+     * any fork
+     * @return {size_t}  : bytes owned exclusively
+     */
+    size_t GetExclusiveBytes() const;
+
+    /**
+     * CopyFieldsFrom copies the perturbed and ground truth fields of a grid of another precision,
+     * converting every cell to this grid's storage type. Used to start a mixed precision run and a
+     * reference run from the exact same perturbed initial condition.
+     *
+     * @param  {BasicGrid<OtherPolicy>} other : grid of identical dimensions to copy from
+     */
+    template <typename OtherPolicy> void CopyFieldsFrom(const BasicGrid<OtherPolicy>& other) {
+      if (other.GetPerturbedA().rows() != m_perturbed_gridA.rows()
+          || other.GetPerturbedA().cols() != m_perturbed_gridA.cols()) {
+        throw invalid_argument("grids must have identical dimensions");
+      }
+
+      using StorageComplex = typename Policy::StorageComplex;
+      m_grid_groundtruthA = LeaseField();
+      m_grid_groundtruthB = LeaseField();
+      *m_grid_groundtruthA = other.GetGroundTruthA().template cast<StorageComplex>();
+      *m_grid_groundtruthB = other.GetGroundTruthB().template cast<StorageComplex>();
+      m_groundtruth_computed = true;
+
+      m_perturbed_gridA.Reset(m_grid_groundtruthA);
+      m_perturbed_gridB.Reset(m_grid_groundtruthB);
+      m_perturbed_gridA.Materialize() = other.GetPerturbedA().template cast<StorageComplex>();
+      m_perturbed_gridB.Materialize() = other.GetPerturbedB().template cast<StorageComplex>();
+    }
+
+    const GridDetails& GetDetails() const { return *m_details; }
+    const Constraint& GetConstraint() const { return m_functHdl->GetConstraint(); }
+
+    /** writable perturbed fields, materialized (and un-shared) on first access **/
+    FieldMatrix& GetPerturbedA() { return m_perturbed_gridA.Materialize(); }
+    FieldMatrix& GetPerturbedB() { return m_perturbed_gridB.Materialize(); }
+    /** read only perturbed fields, an unmodified field returns the shared ground truth **/
+    const FieldMatrix& GetPerturbedA() const { return m_perturbed_gridA.View(); }
+    const FieldMatrix& GetPerturbedB() const { return m_perturbed_gridB.View(); }
+    /** tile-aware perturbed fields, read cell by cell without materializing **/
+    const PerturbedField& GetPerturbedFieldA() const { return m_perturbed_gridA; }
+    const PerturbedField& GetPerturbedFieldB() const { return m_perturbed_gridB; }
+    const FieldMatrix& GetGroundTruthA() const { return *m_grid_groundtruthA; }
+    const FieldMatrix& GetGroundTruthB() const { return *m_grid_groundtruthB; }
+
   private:
+    BasicGrid() = default;
+
     /**
-     * PerturbGridHelper serves as a helper function for grid pertubation
+     * AllocateFields leases zeroed ground truth fields from the buffer pool and points the
+     * perturbed fields at them
+     */
+    void AllocateFields();
+
+    /**
+     * LeaseField leases a shareable field sized according to the grid details
+     * @return {shared_ptr<FieldMatrix>}  : leased field, contents unspecified
+     */
+    shared_ptr<FieldMatrix> LeaseField() const;
+
+    /**
+     * PerturbLines resets the perturbed fields to the ground truth and perturbs every cell of the
+     * x = 0 and t = 0 lines
+     *
+     * @param  {double} pertubationCoefficient : pertubation coefficient applied to the boundaries
+     * @param  {function} noise                : draws the noise in [0, 1) of a cell
+     */
+    void PerturbLines(double pertubationCoefficient, const function<double(const Cell&)>& noise);
+
+    /**
+     * PerturbGridHelper applies noise to a single cell of the perturbed fields
      *
      * @param  {double} position : positional point useful to generate amplitude
      * @param  {double} time     : time point useful to generate amplitude
      * @param  {Cell} cell       : cell delineating the positional point and time point where we
      * should generate the amplitude
+     * @param  {double} noiseValue : factor applied to the amplitudes of the cell
      */
     void PerturbGridHelper(const double& position, const double& time, const Cell& cell,
-                           double pertubationCoefficient);
+                           double noiseValue);
 
-    unique_ptr<FunctionHandler> m_functHdl;
-    unique_ptr<GridDetails> m_details;
-    Eigen::MatrixXcf m_grid, m_perturbed_gridA, m_perturbed_gridB, m_grid_groundtruthA,
-        m_grid_groundtruthB;
+    shared_ptr<FunctionHandler> m_functHdl;
+    shared_ptr<const GridDetails> m_details;
+    shared_ptr<FieldMatrix> m_grid_groundtruthA, m_grid_groundtruthB;
+    PerturbedField m_perturbed_gridA, m_perturbed_gridB;
+    bool m_groundtruth_computed = false;
+    FieldEvaluation m_evaluation = FieldEvaluation::Separable;
+    shared_ptr<const PlacementOptions> m_placement;
   };
 
-}  // namespace CGLE
\ No newline at end of file
+  /**
+   * ComputePerturbedRows evaluates a block of rows (positions) of the perturbed fields of a grid
+   * on its own, equal to the same rows of a BasicGrid perturbed by PerturbGrid with the same
+   * seed. The ranks of a distributed run use it to build only the rows they own.
+   *
+   * @param  {Constraint} constraint         : Object outlining grid constraints
+   * @param  {GridDetails} details           : grid dimensions and axis points
+   * @param  {int} firstPosition             : first position of the block
+   * @param  {int} numRows                   : number of positions of the block
+   * @param  {double} pertubationCoefficient : pertubation coefficient applied to the boundaries
+   * @param  {uint64_t} seed                 : seed of the realization
+   * @param  {FieldMatrix} fieldA            : receives the rows of the perturbed A field
+   * @param  {FieldMatrix} fieldB            : receives the rows of the perturbed B field
+   */
+  template <typename Policy>
+  void ComputePerturbedRows(const Constraint& constraint, const GridDetails& details,
+                            int firstPosition, int numRows, double pertubationCoefficient,
+                            uint64_t seed, typename Policy::FieldMatrix& fieldA,
+                            typename Policy::FieldMatrix& fieldB);
+
+  /** default grid: single precision storage with double precision kernels **/
+  using Grid = BasicGrid<MixedPrecision>;
+
+  /** all-double grid used as the reference when validating mixed precision runs **/
+  using ReferenceGrid = BasicGrid<DoublePrecision>;
+
+  extern template class BasicGrid<MixedPrecision>;
+  extern template class BasicGrid<DoublePrecision>;
+  extern template void ComputePerturbedRows<MixedPrecision>(const Constraint&, const GridDetails&,
+                                                            int, int, double, uint64_t,
+                                                            MixedPrecision::FieldMatrix&,
+                                                            MixedPrecision::FieldMatrix&);
+  extern template void ComputePerturbedRows<DoublePrecision>(const Constraint&, const GridDetails&,
+                                                             int, int, double, uint64_t,
+                                                             DoublePrecision::FieldMatrix&,
+                                                             DoublePrecision::FieldMatrix&);
+}  // namespace CGLE
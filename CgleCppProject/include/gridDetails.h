@@ -1,5 +1,6 @@
 #pragma once
 
+#include <axis.h>
 #include <constraint.h>
 #include <functionHandler.h>
 
@@ -55,6 +56,15 @@ namespace CGLE {
      * @param  {int} endPosition   :  end position of the simulation
      */
     GridDetails(int startTime, int endTime, int startPosition, int endPosition);
+
+    /**
+     * GridDetails defines a grid details object from its axes, uniform or not
+     *
+     * @param  {Axis} xAxis    : positional points, at least 2
+     * @param  {Axis} timeAxis : time points, at least 2
+     */
+    GridDetails(Axis xAxis, Axis timeAxis);
+
     /**
      * @brief Gets the number of x points on the grid details object
      * @return {int} : number of points on the x axis
@@ -66,10 +76,35 @@ namespace CGLE {
      * @return {int}  : number of points on the y axis
      */
     int GetNumYPts() const;
-    vector<double> m_time_pts;
-    vector<double> m_x_pts;
+
+    /**
+     * @brief Gets the spacing between consecutive points on the x axis (grid.Dx)
+     * @return {double}  : spacing between positional points
+     */
+    double GetDx() const;
+
+    /**
+     * @brief Gets the spacing between consecutive points on the time axis (grid.Dt)
+     * @return {double}  : spacing between time points
+     */
+    double GetDt() const;
+
+    /**
+     * @brief Gets the positional axis (grid.X)
+     * @return {Axis}  : positional points, uniform unless the mesh is not
+     */
+    const Axis& GetXAxis() const { return m_x_axis; }
+
+    /**
+     * @brief Gets the time axis (grid.T)
+     * @return {Axis}  : time points
+     */
+    const Axis& GetTimeAxis() const { return m_time_axis; }
 
   private:
+    Axis m_time_axis;
+    Axis m_x_axis;
+
     GridDimensions m_dimensions;
     int m_num_x_points;
     int m_num_y_points;
@@ -86,7 +121,7 @@ namespace CGLE {
      */
     void SetGridDimension();
     /**
-     * @brief Populates the time and positional vectors
+     * @brief Populates the time and positional axes
      * @param  {int} startTime           :  Start time of the simulation
      * @param  {int} endTime             :  End time of the simulation
      * @param  {int} startPosition       :  Start position of the simulation
@@ -1,9 +1,15 @@
+#pragma once
+
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <exception>
 #include <iomanip>
 #include <iostream>
 #include <map>
 #include <random>
 #include <string>
+#include <thread>
 #include <vector>
 using namespace std;
 
@@ -38,4 +44,83 @@ namespace Helper {
     T randomValue = uniform_dist(e1);
     return randomValue;
   }
+
+  /**
+   * Generates a random number in a specified range from a caller owned engine, making the draw
+   * reproducible for a seeded engine
+   * @param  {T} startRange       : the lower bound of the range
+   * @param  {T} endRange         : the upper bound of the range
+   * @param  {Engine} engine      : random engine to draw from
+   * @return {T}                  : the random number generated
+   */
+  template <typename T, typename Engine>
+  static T GenerateRandomNumber(T startRange, T endRange, Engine& engine) {
+    std::uniform_real_distribution<T> uniform_dist(startRange, endRange);
+    return uniform_dist(engine);
+  }
+
+  /**
+   * CellNoise draws a uniform number in [0, 1) that only depends on a seed and a cell, so any
+   * block of cells reproduces the draws of the whole grid on its own
+   * @param  {uint64_t} seed  : seed of the realization
+   * @param  {int} position   : position index of the cell
+   * @param  {int} time       : time index of the cell
+   * @return {double}         : the random number generated
+   */
+  inline double CellNoise(std::uint64_t seed, int position, int time) {
+    // splitmix64 finalizer over the seed and both indices
+    const std::uint64_t cell
+        = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(position)) << 32)
+          | static_cast<std::uint32_t>(time);
+    std::uint64_t value = seed + 0x9E3779B97F4A7C15ULL * (cell + 1);
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    value ^= value >> 31;
+    return static_cast<double>(value >> 11) * 0x1.0p-53;
+  }
+
+  /**
+   * GetNumThreads resolves a requested thread count, 0 meaning one thread per hardware thread
+   * @param  {int} requested : requested number of threads
+   * @return {int}           : number of threads to use, at least 1
+   */
+  static int GetNumThreads(int requested) {
+    if (requested > 0) return requested;
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }
+
+  /**
+   * ParallelFor calls body(index) for every index in [0, count). Indices are split into
+   * contiguous blocks, one per thread, so a given index always runs on the same block for a given
+   * thread count. The first exception thrown by the body is rethrown on the calling thread.
+   * @param  {int} count         : number of indices
+   * @param  {int} numThreads    : number of threads, 0 means one per hardware thread
+   * @param  {Function} body     : callable taking the index
+   */
+  template <typename Function> static void ParallelFor(int count, int numThreads, Function&& body) {
+    const int threads = std::min(GetNumThreads(numThreads), std::max(count, 1));
+    if (threads == 1) {
+      for (int index = 0; index < count; index++) body(index);
+      return;
+    }
+
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (int thread = 0; thread < threads; thread++) {
+      workers.emplace_back([&, thread]() {
+        const int begin = static_cast<int>(static_cast<long long>(count) * thread / threads);
+        const int end = static_cast<int>(static_cast<long long>(count) * (thread + 1) / threads);
+        try {
+          for (int index = begin; index < end; index++) body(index);
+        } catch (...) {
+          errors[thread] = std::current_exception();
+        }
+      });
+    }
+    for (std::thread& worker : workers) worker.join();
+    for (const std::exception_ptr& error : errors) {
+      if (error) std::rethrow_exception(error);
+    }
+  }
 }  // namespace Helper
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <constants.h>
+#include <grid.h>
+#include <precision.h>
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "helper.h"
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief LodLevel is one level of a level of detail pyramid. Every cell summarizes a
+   * 2^level x 2^level block of the full resolution amplitude |field| (smaller on the far edges).
+   */
+  struct LodLevel {
+    int level = 0;
+    Eigen::ArrayXXf min;
+    Eigen::ArrayXXf max;
+    Eigen::ArrayXXf mean;
+
+    Eigen::Index rows() const { return mean.rows(); }
+    Eigen::Index cols() const { return mean.cols(); }
+  };
+
+  /**
+   * @brief LodPyramid holds min, max and mean preserving reductions of a field's amplitude, each
+   * level halving both axes. Level 0 is the full resolution field itself and is not stored: it
+   * lives in the snapshot. The min, max and cell weighted mean of every level match those of the
+   * full resolution field exactly (up to float rounding of the stored values).
+   */
+  class LodPyramid {
+  public:
+    LodPyramid() = default;
+
+    /**
+     * Build reduces a field until both axes fit in minSize cells, each level built in parallel
+     *
+     * @param  {Eigen::MatrixBase<Derived>} field : real or complex field
+     * @param  {int} minSize                      : max size of the coarsest level along each axis
+     * @param  {int} numThreads                   : number of threads, 0 means one per core
+     * @return {LodPyramid}                       : pyramid of the field's amplitude
+     */
+    template <typename Derived>
+    static LodPyramid Build(const Eigen::MatrixBase<Derived>& field,
+                            int minSize = LOD_MIN_LEVEL_SIZE, int numThreads = 0) {
+      if (minSize <= 0) throw invalid_argument("min level size must be positive");
+
+      LodPyramid pyramid;
+      pyramid.m_baseRows = field.rows();
+      pyramid.m_baseCols = field.cols();
+
+      Eigen::Index rows = field.rows(), cols = field.cols();
+      for (int level = 1; rows > minSize || cols > minSize; level++) {
+        if (level == 1) {
+          auto base = [&field](Eigen::Index row, Eigen::Index col, float& min, float& max,
+                               double& mean) {
+            mean = static_cast<double>(std::abs(field(row, col)));
+            min = max = static_cast<float>(mean);
+          };
+          pyramid.m_levels.push_back(pyramid.Reduce(base, level, numThreads));
+        } else {
+          const LodLevel& finer = pyramid.m_levels.back();
+          auto previous = [&finer](Eigen::Index row, Eigen::Index col, float& min, float& max,
+                                   double& mean) {
+            min = finer.min(row, col);
+            max = finer.max(row, col);
+            mean = finer.mean(row, col);
+          };
+          LodLevel coarser = pyramid.Reduce(previous, level, numThreads);
+          pyramid.m_levels.push_back(std::move(coarser));
+        }
+        rows = pyramid.m_levels.back().rows();
+        cols = pyramid.m_levels.back().cols();
+      }
+      return pyramid;
+    }
+
+    /**
+     * SelectLevel returns the finest level whose size fits a viewport, 0 meaning the full
+     * resolution field fits
+     *
+     * @param  {Eigen::Index} maxRows : max number of rows the viewer displays
+     * @param  {Eigen::Index} maxCols : max number of columns the viewer displays
+     * @return {int}                  : level to fetch
+     */
+    int SelectLevel(Eigen::Index maxRows, Eigen::Index maxCols) const {
+      if (m_baseRows <= maxRows && m_baseCols <= maxCols) return 0;
+      for (const LodLevel& level : m_levels) {
+        if (level.rows() <= maxRows && level.cols() <= maxCols) return level.level;
+      }
+      return GetNumLevels();
+    }
+
+    /**
+     * GetLevel returns a stored level, levels are numbered from 1
+     * @param  {int} level : level to return
+     * @return {LodLevel}  : reduced level
+     */
+    const LodLevel& GetLevel(int level) const {
+      if (level < 1 || level > GetNumLevels()) throw out_of_range("pyramid level out of range");
+      return m_levels[level - 1];
+    }
+
+    int GetNumLevels() const { return static_cast<int>(m_levels.size()); }
+    Eigen::Index GetBaseRows() const { return m_baseRows; }
+    Eigen::Index GetBaseCols() const { return m_baseCols; }
+
+  private:
+    /**
+     * BlockSize returns the number of full resolution cells covered along an axis by the index-th
+     * cell of a level
+     */
+    static Eigen::Index BlockSize(Eigen::Index index, int level, Eigen::Index baseSize) {
+      const Eigen::Index span = Eigen::Index(1) << level;
+      return min(baseSize, (index + 1) * span) - index * span;
+    }
+
+    /**
+     * Reduce builds a level from the next finer one, read through a source accessor
+     */
+    template <typename Source> LodLevel Reduce(const Source& source, int level, int numThreads) {
+      const Eigen::Index finerRows = level == 1 ? m_baseRows : m_levels.back().rows();
+      const Eigen::Index finerCols = level == 1 ? m_baseCols : m_levels.back().cols();
+
+      LodLevel reduced;
+      reduced.level = level;
+      reduced.min.resize((finerRows + 1) / 2, (finerCols + 1) / 2);
+      reduced.max.resize(reduced.min.rows(), reduced.min.cols());
+      reduced.mean.resize(reduced.min.rows(), reduced.min.cols());
+
+      Helper::ParallelFor(static_cast<int>(reduced.cols()), numThreads, [&](int col) {
+        for (Eigen::Index row = 0; row < reduced.rows(); row++) {
+          float blockMin = numeric_limits<float>::infinity();
+          float blockMax = -numeric_limits<float>::infinity();
+          double weightedSum = 0, weight = 0;
+
+          const Eigen::Index lastCol = std::min<Eigen::Index>(2 * col + 2, finerCols);
+          const Eigen::Index lastRow = std::min<Eigen::Index>(2 * row + 2, finerRows);
+          for (Eigen::Index finerCol = 2 * col; finerCol < lastCol; finerCol++) {
+            for (Eigen::Index finerRow = 2 * row; finerRow < lastRow; finerRow++) {
+              float cellMin, cellMax;
+              double cellMean;
+              source(finerRow, finerCol, cellMin, cellMax, cellMean);
+              // finer cells on the far edges cover fewer full resolution cells
+              const double cellWeight
+                  = static_cast<double>(BlockSize(finerRow, level - 1, m_baseRows)
+                                        * BlockSize(finerCol, level - 1, m_baseCols));
+              blockMin = std::min(blockMin, cellMin);
+              blockMax = std::max(blockMax, cellMax);
+              weightedSum += cellMean * cellWeight;
+              weight += cellWeight;
+            }
+          }
+
+          reduced.min(row, col) = blockMin;
+          reduced.max(row, col) = blockMax;
+          reduced.mean(row, col) = static_cast<float>(weightedSum / weight);
+        }
+      });
+      return reduced;
+    }
+
+    Eigen::Index m_baseRows = 0;
+    Eigen::Index m_baseCols = 0;
+    vector<LodLevel> m_levels;
+  };
+
+  /**
+   * GetLodPath returns the path of the pyramid file stored next to a snapshot
+   * @param  {string} snapshotPath : path of the snapshot
+   * @return {string}              : path of the pyramid file
+   */
+  string GetLodPath(const string& snapshotPath);
+
+  /**
+   * @brief LodWriter streams named pyramids to a pyramid file. Every level is stored as three
+   * column-major float arrays (min, max, mean) so a reader can seek straight to a single level.
+   */
+  class LodWriter {
+  public:
+    /**
+     * LodWriter creates (or truncates) a pyramid file
+     * @param  {string} path : path of the pyramid file
+     */
+    explicit LodWriter(const string& path);
+    ~LodWriter();
+
+    LodWriter(const LodWriter&) = delete;
+    LodWriter& operator=(const LodWriter&) = delete;
+
+    /**
+     * WritePyramid appends the pyramid of a field
+     * @param  {string} name         : name of the field
+     * @param  {LodPyramid} pyramid  : pyramid to write
+     */
+    void WritePyramid(const string& name, const LodPyramid& pyramid);
+
+    /**
+     * Close finalizes the field count and closes the file, also called by the destructor
+     */
+    void Close();
+
+  private:
+    string m_path;
+    ofstream m_stream;
+    uint32_t m_numFields = 0;
+  };
+
+  /**
+   * @brief LodReader indexes a pyramid file and loads single levels on demand
+   */
+  class LodReader {
+  public:
+    /**
+     * LodReader opens a pyramid file and scans its index
+     * @param  {string} path : path of the pyramid file
+     */
+    explicit LodReader(const string& path);
+
+    /**
+     * GetFieldNames returns the names of the fields with a pyramid
+     * @return {vector<string>}  : field names
+     */
+    vector<string> GetFieldNames() const;
+
+    /**
+     * GetNumLevels returns the number of stored levels of a field
+     * @param  {string} name : name of the field
+     * @return {int}         : number of levels
+     */
+    int GetNumLevels(const string& name) const;
+
+    /**
+     * SelectLevel returns the finest level of a field whose size fits a viewport, 0 meaning the
+     * full resolution field in the snapshot fits
+     *
+     * @param  {string} name          : name of the field
+     * @param  {Eigen::Index} maxRows : max number of rows the viewer displays
+     * @param  {Eigen::Index} maxCols : max number of columns the viewer displays
+     * @return {int}                  : level to fetch
+     */
+    int SelectLevel(const string& name, Eigen::Index maxRows, Eigen::Index maxCols) const;
+
+    /**
+     * ReadLevel loads a single level of a field's pyramid
+     * @param  {string} name : name of the field
+     * @param  {int} level   : level to load, from 1
+     * @return {LodLevel}    : loaded level
+     */
+    LodLevel ReadLevel(const string& name, int level);
+
+  private:
+    struct LevelInfo {
+      int64_t rows, cols, offset;
+    };
+    struct FieldInfo {
+      string name;
+      int64_t baseRows, baseCols;
+      vector<LevelInfo> levels;
+    };
+
+    const FieldInfo& GetField(const string& name) const;
+
+    string m_path;
+    ifstream m_stream;
+    vector<FieldInfo> m_fields;
+  };
+
+  /**
+   * WriteLodPyramids builds the pyramids of the four fields of a grid and writes them next to the
+   * snapshot at snapshotPath, under the snapshot's field names
+   *
+   * @param  {BasicGrid<Policy>} grid : grid to reduce
+   * @param  {string} snapshotPath    : path of the grid's snapshot
+   * @param  {int} minSize            : max size of the coarsest level along each axis
+   * @param  {int} numThreads         : number of threads, 0 means one per hardware thread
+   */
+  template <typename Policy>
+  void WriteLodPyramids(const BasicGrid<Policy>& grid, const string& snapshotPath,
+                        int minSize = LOD_MIN_LEVEL_SIZE, int numThreads = 0);
+
+  extern template void WriteLodPyramids<MixedPrecision>(const Grid&, const string&, int, int);
+  extern template void WriteLodPyramids<DoublePrecision>(const ReferenceGrid&, const string&, int,
+                                                         int);
+}  // namespace CGLE
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <constants.h>
+#include <grid.h>
+#include <precision.h>
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <complex>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief MatClass is the MATLAB class of an array written to a .mat file
+   */
+  enum class MatClass : uint8_t { Struct = 2, Char = 4, Double = 6, Single = 7 };
+
+  /**
+   * @brief MatArray describes a MATLAB array without holding its data. The data is produced
+   * column-major by a callback at write time, so large fields are streamed in chunks instead of
+   * being converted to MATLAB's split real / imaginary layout up front.
+   */
+  struct MatArray {
+    /** receives a chunk of raw array data **/
+    using Sink = function<void(const char* data, size_t size)>;
+    /** writes the real (imaginary = false) or the imaginary part of the array column-major **/
+    using Producer = function<void(const Sink& sink, bool imaginary)>;
+
+    string name;
+    MatClass matClass = MatClass::Double;
+    bool isComplex = false;
+    int64_t rows = 0;
+    int64_t cols = 0;
+    Producer produce;
+
+    /**
+     * FromField describes a real or complex field stored at float or double precision. The
+     * field is referenced, not copied, and must outlive the write.
+     *
+     * @param  {string} name  : name of the array
+     * @param  {Matrix} field : field to write
+     * @return {MatArray}     : array description
+     */
+    template <typename Derived>
+    static MatArray FromField(const string& name, const Eigen::MatrixBase<Derived>& field) {
+      using Scalar = typename Derived::Scalar;
+      using Real = typename Eigen::NumTraits<Scalar>::Real;
+      static_assert(is_same<Real, float>::value || is_same<Real, double>::value,
+                    "only float and double fields can be written to a .mat file");
+
+      const Derived* source = &field.derived();
+      MatArray array;
+      array.name = name;
+      array.matClass = is_same<Real, float>::value ? MatClass::Single : MatClass::Double;
+      array.isComplex = Eigen::NumTraits<Scalar>::IsComplex;
+      array.rows = field.rows();
+      array.cols = field.cols();
+      array.produce = [source](const Sink& sink, bool imaginary) {
+        const auto chunkElements = static_cast<Eigen::Index>(MAT_WRITE_CHUNK_BYTES / sizeof(Real));
+        const Eigen::Index chunkCols
+            = max<Eigen::Index>(1, chunkElements / max<Eigen::Index>(source->rows(), 1));
+        Eigen::Matrix<Real, Eigen::Dynamic, Eigen::Dynamic> chunk;
+        for (Eigen::Index col = 0; col < source->cols(); col += chunkCols) {
+          const Eigen::Index numCols = min(chunkCols, source->cols() - col);
+          if (imaginary) {
+            chunk = source->middleCols(col, numCols).imag();
+          } else {
+            chunk = source->middleCols(col, numCols).real();
+          }
+          sink(reinterpret_cast<const char*>(chunk.data()), chunk.size() * sizeof(Real));
+        }
+      };
+      return array;
+    }
+
+    /**
+     * FromTransposedField describes the transpose of a real or complex field stored at float or
+     * double precision, streamed by chunks of field rows. Grid fields are stored positions x
+     * times while the MATLAB scripts index them (time, position). The field is referenced, not
+     * copied, and must outlive the write.
+     *
+     * @param  {string} name  : name of the array
+     * @param  {Matrix} field : field whose transpose is written
+     * @return {MatArray}     : array description
+     */
+    template <typename Derived>
+    static MatArray FromTransposedField(const string& name,
+                                        const Eigen::MatrixBase<Derived>& field) {
+      using Scalar = typename Derived::Scalar;
+      using Real = typename Eigen::NumTraits<Scalar>::Real;
+      static_assert(is_same<Real, float>::value || is_same<Real, double>::value,
+                    "only float and double fields can be written to a .mat file");
+
+      const Derived* source = &field.derived();
+      MatArray array;
+      array.name = name;
+      array.matClass = is_same<Real, float>::value ? MatClass::Single : MatClass::Double;
+      array.isComplex = Eigen::NumTraits<Scalar>::IsComplex;
+      array.rows = field.cols();
+      array.cols = field.rows();
+      array.produce = [source](const Sink& sink, bool imaginary) {
+        // a column of the transpose is a row of the field
+        const auto chunkElements = static_cast<Eigen::Index>(MAT_WRITE_CHUNK_BYTES / sizeof(Real));
+        const Eigen::Index chunkRows
+            = max<Eigen::Index>(1, chunkElements / max<Eigen::Index>(source->cols(), 1));
+        Eigen::Matrix<Real, Eigen::Dynamic, Eigen::Dynamic> chunk;
+        for (Eigen::Index row = 0; row < source->rows(); row += chunkRows) {
+          const Eigen::Index numRows = min(chunkRows, source->rows() - row);
+          if (imaginary) {
+            chunk = source->middleRows(row, numRows).imag().transpose();
+          } else {
+            chunk = source->middleRows(row, numRows).real().transpose();
+          }
+          sink(reinterpret_cast<const char*>(chunk.data()), chunk.size() * sizeof(Real));
+        }
+      };
+      return array;
+    }
+
+    /**
+     * FromVector describes a 1 x n row vector of doubles, the values are copied
+     * @param  {string} name           : name of the array
+     * @param  {vector<double>} values : values to write
+     * @return {MatArray}              : array description
+     */
+    static MatArray FromVector(const string& name, const vector<double>& values);
+
+    /**
+     * FromScalar describes a 1 x 1 double
+     * @param  {string} name   : name of the array
+     * @param  {double} value  : value to write
+     * @return {MatArray}      : array description
+     */
+    static MatArray FromScalar(const string& name, double value);
+
+    /**
+     * FromString describes a 1 x n char array
+     * @param  {string} name   : name of the array
+     * @param  {string} value  : ASCII text to write
+     * @return {MatArray}      : array description
+     */
+    static MatArray FromString(const string& name, const string& value);
+  };
+
+  /**
+   * @brief MatWriter writes MATLAB Level 5 (.mat v5) files without any MATLAB library. Every
+   * variable is streamed straight to disk; with a compression level each variable is wrapped in
+   * a zlib compressed element, which requires a build with zlib (CGLE_WITH_ZLIB). Level 5
+   * variables are limited to 4 GiB each, larger results need a v7.3 (HDF5) writer.
+   */
+  class MatWriter {
+  public:
+    /**
+     * MatWriter creates (or truncates) a .mat file and writes its header
+     *
+     * @param  {string} path           : path of the .mat file
+     * @param  {int} compressionLevel  : 0 for uncompressed variables, 1 (fastest) to 9 (smallest)
+     */
+    explicit MatWriter(const string& path, int compressionLevel = 0);
+    ~MatWriter();
+
+    MatWriter(const MatWriter&) = delete;
+    MatWriter& operator=(const MatWriter&) = delete;
+
+    /**
+     * WriteArray writes a top level variable
+     * @param  {MatArray} array : array to write
+     */
+    void WriteArray(const MatArray& array);
+
+    /**
+     * WriteStruct writes a top level 1 x 1 struct variable, fields are named after their arrays
+     *
+     * @param  {string} name              : name of the struct variable
+     * @param  {vector<MatArray>} fields  : fields of the struct, names of at most 31 characters
+     */
+    void WriteStruct(const string& name, const vector<MatArray>& fields);
+
+    /**
+     * Close flushes the file, writes after Close throw
+     */
+    void Close();
+
+    /**
+     * IsCompressionAvailable returns whether this build can write compressed variables
+     * @return {bool}  : true when built with zlib
+     */
+    static bool IsCompressionAvailable();
+
+  private:
+    struct Deflater;
+
+    void BeginVariable();
+    void EndVariable();
+    void Write(const char* data, size_t size);
+    void WriteTag(uint32_t type, uint64_t size);
+    void WritePadding(uint64_t size);
+    void WriteArrayHeader(MatClass matClass, bool isComplex, int64_t rows, int64_t cols,
+                          const string& name);
+    void WriteArrayBody(const MatArray& array, const string& name);
+
+    string m_path;
+    ofstream m_stream;
+    int m_compressionLevel = 0;
+    unique_ptr<Deflater> m_deflater;
+  };
+
+  /**
+   * WriteMatFile writes a grid as the `grid` struct the MATLAB scripts build (grid.X, grid.T,
+   * grid.Dx, grid.Dt, grid.Nx, grid.Nt, grid.WaveType, grid.GroundTruthA/B and
+   * grid.PerturbedGridAA/BB) so PlotGridResults.m and friends run on it unchanged. Fields are
+   * written Nt x Nx, indexed (time, position) like the MATLAB grid.
+   *
+   * @param  {BasicGrid<Policy>} grid : grid to write
+   * @param  {string} path            : path of the .mat file
+   * @param  {int} compressionLevel   : 0 for uncompressed, 1 (fastest) to 9 (smallest)
+   */
+  template <typename Policy>
+  void WriteMatFile(const BasicGrid<Policy>& grid, const string& path, int compressionLevel = 0);
+
+  extern template void WriteMatFile<MixedPrecision>(const Grid&, const string&, int);
+  extern template void WriteMatFile<DoublePrecision>(const ReferenceGrid&, const string&, int);
+}  // namespace CGLE
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <new>
+#include <string>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief MemorySubsystem identifies the owner memory is attributed to
+   */
+  enum class MemorySubsystem : int {
+    /** ground truth and perturbed fields of grids, their tiles and evaluation columns **/
+    GridFields = 0,
+    /** explicit axis points of grid details **/
+    GridDetails = 1,
+    /** function handlers and their constraint copies **/
+    FunctionHandler = 2,
+    /** constraint file readers **/
+    ConstraintReader = 3,
+    /** stability solver factorizations and right hand sides **/
+    Solver = 4,
+    /** released buffers cached by the per-thread buffer pools **/
+    BufferPool = 5,
+    /** buffers leased without an owner **/
+    Other = 6
+  };
+
+  const int NUM_MEMORY_SUBSYSTEMS = 7;
+
+  /**
+   * GetMemorySubsystemName returns the display name of a subsystem
+   * @param  {MemorySubsystem} subsystem : subsystem
+   * @return {string}                    : name of the subsystem
+   */
+  string GetMemorySubsystemName(MemorySubsystem subsystem);
+
+  /**
+   * @brief MemoryUsage holds the live and high water byte counts of a subsystem
+   */
+  struct MemoryUsage {
+    size_t liveBytes = 0;
+    size_t peakBytes = 0;
+  };
+
+  /**
+   * @brief MemoryAccountant keeps process wide live and peak byte counts per subsystem. Counters
+   * are atomic, so charges and refunds may come from any thread; a buffer released on another
+   * thread than the one that leased it is refunded to the same subsystem.
+   */
+  class MemoryAccountant {
+  public:
+    /**
+     * Charge attributes bytes to a subsystem
+     * @param  {MemorySubsystem} subsystem : owner of the bytes
+     * @param  {size_t} bytes              : number of bytes
+     */
+    static void Charge(MemorySubsystem subsystem, size_t bytes);
+
+    /**
+     * Refund releases bytes previously charged to a subsystem
+     * @param  {MemorySubsystem} subsystem : owner of the bytes
+     * @param  {size_t} bytes              : number of bytes
+     */
+    static void Refund(MemorySubsystem subsystem, size_t bytes);
+
+    static MemoryUsage GetUsage(MemorySubsystem subsystem);
+
+    /**
+     * GetTotalUsage returns the bytes live over every subsystem and the high water mark of that
+     * sum, which is at most the sum of the per subsystem peaks
+     * @return {MemoryUsage}  : total usage
+     */
+    static MemoryUsage GetTotalUsage();
+
+    /**
+     * ResetPeaks lowers every high water mark to the bytes currently live, so the peaks of the
+     * next job can be measured on their own
+     */
+    static void ResetPeaks();
+
+    /**
+     * GetReport formats the live and peak bytes of every subsystem, one line per subsystem
+     * @return {string}  : report
+     */
+    static string GetReport();
+  };
+
+  /**
+   * @brief MemoryCharge attributes a number of bytes to a subsystem for as long as it lives. It is
+   * meant as a member of the object owning the bytes: copies charge again, moves transfer the
+   * charge.
+   */
+  class MemoryCharge {
+  public:
+    explicit MemoryCharge(MemorySubsystem subsystem, size_t bytes = 0)
+        : m_subsystem(subsystem), m_bytes(bytes) {
+      MemoryAccountant::Charge(m_subsystem, m_bytes);
+    }
+    MemoryCharge(const MemoryCharge& other) : MemoryCharge(other.m_subsystem, other.m_bytes) {}
+    MemoryCharge(MemoryCharge&& other) noexcept
+        : m_subsystem(other.m_subsystem), m_bytes(other.m_bytes) {
+      other.m_bytes = 0;
+    }
+    MemoryCharge& operator=(const MemoryCharge& other) {
+      if (this != &other) {
+        MemoryAccountant::Refund(m_subsystem, m_bytes);
+        m_subsystem = other.m_subsystem;
+        m_bytes = other.m_bytes;
+        MemoryAccountant::Charge(m_subsystem, m_bytes);
+      }
+      return *this;
+    }
+    MemoryCharge& operator=(MemoryCharge&& other) noexcept {
+      if (this != &other) {
+        MemoryAccountant::Refund(m_subsystem, m_bytes);
+        m_subsystem = other.m_subsystem;
+        m_bytes = other.m_bytes;
+        other.m_bytes = 0;
+      }
+      return *this;
+    }
+    ~MemoryCharge() { MemoryAccountant::Refund(m_subsystem, m_bytes); }
+
+    /**
+     * Update changes the number of bytes charged
+     * @param  {size_t} bytes : new number of bytes
+     */
+    void Update(size_t bytes) {
+      if (bytes > m_bytes) MemoryAccountant::Charge(m_subsystem, bytes - m_bytes);
+      if (bytes < m_bytes) MemoryAccountant::Refund(m_subsystem, m_bytes - bytes);
+      m_bytes = bytes;
+    }
+
+    size_t GetBytes() const { return m_bytes; }
+
+  private:
+    MemorySubsystem m_subsystem;
+    size_t m_bytes;
+  };
+
+  /**
+   * @brief TrackingAllocator is a standard allocator charging every allocation to a subsystem
+   *
+   * @tparam T         : value type
+   * @tparam Subsystem : subsystem the allocations are attributed to
+   */
+  template <typename T, MemorySubsystem Subsystem> struct TrackingAllocator {
+    using value_type = T;
+
+    template <typename U> struct rebind {
+      using other = TrackingAllocator<U, Subsystem>;
+    };
+
+    TrackingAllocator() = default;
+    template <typename U> TrackingAllocator(const TrackingAllocator<U, Subsystem>&) {}
+
+    T* allocate(size_t count) {
+      T* values = static_cast<T*>(::operator new(count * sizeof(T)));
+      MemoryAccountant::Charge(Subsystem, count * sizeof(T));
+      return values;
+    }
+
+    void deallocate(T* values, size_t count) {
+      MemoryAccountant::Refund(Subsystem, count * sizeof(T));
+      ::operator delete(values);
+    }
+
+    template <typename U> bool operator==(const TrackingAllocator<U, Subsystem>&) const {
+      return true;
+    }
+    template <typename U> bool operator!=(const TrackingAllocator<U, Subsystem>&) const {
+      return false;
+    }
+  };
+}  // namespace CGLE
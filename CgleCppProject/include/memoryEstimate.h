@@ -0,0 +1,70 @@
+#pragma once
+
+#include <gridDetails.h>
+#include <memoryAccounting.h>
+#include <precision.h>
+#include <stabilitySolver.h>
+
+#include <array>
+#include <cstddef>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief MemoryEstimate holds the predicted peak bytes of every subsystem for one job
+   */
+  struct MemoryEstimate {
+    array<size_t, NUM_MEMORY_SUBSYSTEMS> bytes{};
+
+    size_t GetBytes(MemorySubsystem subsystem) const {
+      return bytes[static_cast<size_t>(subsystem)];
+    }
+
+    /**
+     * GetTotalBytes returns the sum of the subsystem estimates, an upper bound of the peak of the
+     * whole job
+     * @return {size_t}  : bytes
+     */
+    size_t GetTotalBytes() const;
+  };
+
+  /**
+   * EstimateMemory predicts, before anything is allocated, the peak bytes one grid and one
+   * stability solve attribute to each subsystem (see MemoryAccountant). The estimate is an upper
+   * bound of the tracked peaks: it includes the transient ground truth re-evaluation, the
+   * copy-on-write tiles of the pertubation and the partitioned factorizations the thread count
+   * selects. Buffers cached by the buffer pools after the job are not included.
+   *
+   * @param  {int} numXPts                : number of positional points
+   * @param  {int} numTimePts             : number of time points
+   * @param  {BoundaryCondition} boundary : boundary condition of the solve
+   * @param  {int} numThreads             : threads per tridiagonal solve, 0 means one per
+   *                                        hardware thread
+   * @return {MemoryEstimate}             : estimated peak bytes per subsystem
+   */
+  template <typename Policy>
+  MemoryEstimate EstimateMemory(int numXPts, int numTimePts,
+                                BoundaryCondition boundary = BoundaryCondition::Dirichlet,
+                                int numThreads = 0);
+
+  /**
+   * EstimateMemory predicts the peak bytes of a job on a given grid, including its explicit axes
+   *
+   * @param  {GridDetails} details        : grid dimensions and axis points
+   * @param  {BoundaryCondition} boundary : boundary condition of the solve
+   * @param  {int} numThreads             : threads per tridiagonal solve
+   * @return {MemoryEstimate}             : estimated peak bytes per subsystem
+   */
+  template <typename Policy>
+  MemoryEstimate EstimateMemory(const GridDetails& details,
+                                BoundaryCondition boundary = BoundaryCondition::Dirichlet,
+                                int numThreads = 0);
+
+  extern template MemoryEstimate EstimateMemory<MixedPrecision>(int, int, BoundaryCondition, int);
+  extern template MemoryEstimate EstimateMemory<DoublePrecision>(int, int, BoundaryCondition, int);
+  extern template MemoryEstimate EstimateMemory<MixedPrecision>(const GridDetails&,
+                                                                BoundaryCondition, int);
+  extern template MemoryEstimate EstimateMemory<DoublePrecision>(const GridDetails&,
+                                                                 BoundaryCondition, int);
+}  // namespace CGLE
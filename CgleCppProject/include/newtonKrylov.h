@@ -0,0 +1,128 @@
+#pragma once
+
+#include <memoryAccounting.h>
+
+#include <Eigen/Dense>
+#include <complex>
+#include <functional>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief NewtonKrylovOptions configures a Jacobian-free Newton-Krylov solve
+   */
+  struct NewtonKrylovOptions {
+    int maxNewtonIterations = 20;
+    /** the solve converges once the residual norm is reduced by this factor **/
+    double relativeTolerance = 1e-10;
+    /** size of the Krylov basis built between GMRES restarts **/
+    int krylovDimension = 30;
+    int maxKrylovRestarts = 4;
+    /** GMRES reduces the linearized residual by this factor on every Newton iteration **/
+    double forcingTerm = 1e-3;
+    /** times a Newton step is halved before the solve gives up on decreasing the residual **/
+    int maxBacktracks = 10;
+  };
+
+  /**
+   * @brief NewtonKrylovReport summarizes one or several Newton-Krylov solves
+   */
+  struct NewtonKrylovReport {
+    bool converged = true;
+    int newtonIterations = 0;
+    int krylovIterations = 0;
+    int residualEvaluations = 0;
+    /** residual norm of the initial guess and of the returned iterate **/
+    double initialResidual = 0;
+    double residual = 0;
+
+    /**
+     * Merge accumulates another report, keeping the iteration totals and the worst residuals
+     * @param  {NewtonKrylovReport} other : report of another solve
+     */
+    void Merge(const NewtonKrylovReport& other) {
+      converged = converged && other.converged;
+      newtonIterations += other.newtonIterations;
+      krylovIterations += other.krylovIterations;
+      residualEvaluations += other.residualEvaluations;
+      initialResidual = max(initialResidual, other.initialResidual);
+      residual = max(residual, other.residual);
+    }
+  };
+
+  /**
+   * @brief NewtonKrylovSolver solves a nonlinear system R(x) = 0 with an inexact Newton method.
+   * Jacobian-vector products are forward differences of the residual, so the Jacobian is never
+   * formed, and every Newton correction is computed by restarted right-preconditioned GMRES. The
+   * residual only has to be real differentiable: with complex unknowns GMRES works on the real
+   * and imaginary parts, using Re(x^H y) as inner product and real Hessenberg coefficients, so
+   * terms like |x|^2 x are handled exactly. Corrections are damped by backtracking until the
+   * residual norm decreases. The Krylov basis is kept between solves of the same size.
+   *
+   * @tparam Scalar : scalar type of the unknowns, double or complex<double>
+   */
+  template <typename Scalar> class NewtonKrylovSolver {
+  public:
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+    /** evaluates residual = R(x), residual is already sized like x **/
+    using Residual = function<void(const Vector& x, Vector& residual)>;
+    /** replaces v by an approximation of J^-1 v, an approximate inverse of the Jacobian **/
+    using Preconditioner = function<void(Vector& v)>;
+
+    explicit NewtonKrylovSolver(const NewtonKrylovOptions& options = NewtonKrylovOptions());
+
+    /**
+     * Solve refines an initial guess in place until the residual norm falls below
+     * max(relativeTolerance * |R(x0)|, absoluteTolerance), or the iterations run out, in which
+     * case the iterate with the smallest residual found is returned
+     *
+     * @param  {Residual} residual             : nonlinear residual R
+     * @param  {Preconditioner} precondition   : approximate inverse of the Jacobian
+     * @param  {Vector} x                      : initial guess, overwritten by the solution
+     * @param  {double} absoluteTolerance      : residual norm accepted regardless of reduction,
+     * typically the round-off level of the terms R balances
+     * @return {NewtonKrylovReport}            : iteration counts and residual norms
+     */
+    NewtonKrylovReport Solve(const Residual& residual, const Preconditioner& precondition,
+                             Vector& x, double absoluteTolerance = 0);
+
+    const NewtonKrylovOptions& GetOptions() const { return m_options; }
+
+  private:
+    using Real = typename Eigen::NumTraits<Scalar>::Real;
+    using RealMatrix = Eigen::Matrix<Real, Eigen::Dynamic, Eigen::Dynamic>;
+    using RealVector = Eigen::Matrix<Real, Eigen::Dynamic, 1>;
+
+    /**
+     * ApplyJacobian approximates J(x) v by a forward difference of the residual
+     *
+     * @param  {Vector} x            : point the Jacobian is taken at
+     * @param  {Vector} residualAtX  : R(x)
+     * @param  {Vector} v            : direction
+     * @param  {Vector} product      : receives J(x) v
+     */
+    void ApplyJacobian(const Residual& residual, const Vector& x, const Vector& residualAtX,
+                       const Vector& v, Vector& product);
+
+    /**
+     * Gmres solves J P^-1 y = rhs to the forcing term and stores the correction P^-1 y
+     * @return {int} : number of Krylov iterations
+     */
+    int Gmres(const Residual& residual, const Preconditioner& precondition, const Vector& x,
+              const Vector& residualAtX, const Vector& rhs, Vector& correction);
+
+    void Reserve(Eigen::Index size);
+
+    NewtonKrylovOptions m_options;
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> m_basis;
+    RealMatrix m_hessenberg;
+    RealVector m_cosines, m_sines, m_projection;
+    Vector m_work, m_direction, m_perturbed, m_perturbedResidual;
+    int m_residualEvaluations = 0;
+    MemoryCharge m_charge{MemorySubsystem::Solver};
+  };
+
+  extern template class NewtonKrylovSolver<double>;
+  extern template class NewtonKrylovSolver<complex<double>>;
+}  // namespace CGLE
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <memoryAccounting.h>
+#include <workerPool.h>
+
+#include <Eigen/Dense>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief PlacementOptions selects how large fields are placed on NUMA nodes. Every page of a
+   * field is owned by one worker: the worker whose Helper::ParallelFor block of positions holds
+   * the first element of the page. A worker therefore owns a page aligned range of positions of
+   * every column, plus the head of a column whose first page starts in the previous one (see
+   * GetPlacedRanges). Placement first touches every page on its owner, and placed computations
+   * run each range on the same worker. Linux places a page on the node of the thread touching it
+   * first, so with pinned workers every page lives on the node of the worker that computes it.
+   * The workers are a persistent pool shared by every placement and placed computation with the
+   * same options, see GetPlacementWorkers.
+   */
+  struct PlacementOptions {
+    /** number of workers, 0 means one per hardware thread **/
+    int numThreads = 0;
+    /** pin worker i to the i-th allowed CPU, CPUs ordered by NUMA node **/
+    bool pinThreads = true;
+    /**
+     * ask for transparent huge pages before first touch. Pages are then owned per huge page, so
+     * columns shorter than a huge page are placed and computed by a single worker each.
+     */
+    bool hugePages = false;
+  };
+
+  /**
+   * @brief FieldLayout describes where the columns of a column-major field lie in memory, which
+   * is all the page ownership of GetPlacedRanges depends on
+   */
+  struct FieldLayout {
+    /** address of the first element **/
+    uintptr_t address = 0;
+    size_t elementSize = 1;
+    Eigen::Index rows = 0;
+    /** number of elements between the starts of consecutive columns **/
+    Eigen::Index outerStride = 0;
+
+    template <typename Matrix> static FieldLayout Of(const Matrix& field) {
+      return {reinterpret_cast<uintptr_t>(field.data()), sizeof(*field.data()), field.rows(),
+              field.outerStride()};
+    }
+  };
+
+  /** ranges [first, second) of positions of a column owned by a worker, empty when equal **/
+  using PlacedRanges = array<pair<Eigen::Index, Eigen::Index>, 2>;
+
+  /**
+   * GetPlacementCpus returns the CPUs this process may run on, ordered by NUMA node and then by
+   * CPU number, so consecutive workers share a node
+   * @return {vector<int>}  : CPU numbers, empty where affinity is not supported
+   */
+  const vector<int>& GetPlacementCpus();
+
+  /**
+   * PinCurrentThread pins the calling thread to the CPU of a worker
+   * @param  {int} worker : worker index, wrapped around the allowed CPUs
+   * @return {bool}       : whether the thread was pinned
+   */
+  bool PinCurrentThread(int worker);
+
+  /**
+   * AdviseHugePages asks the kernel to back the whole pages of a range with transparent huge
+   * pages. Only pages that were never touched are affected.
+   *
+   * @param  {void*} data   : first byte of the range
+   * @param  {size_t} bytes : size of the range
+   * @return {bool}         : whether the advice was accepted
+   */
+  bool AdviseHugePages(void* data, size_t bytes);
+
+  /**
+   * ReleasePages hands the whole pages of a range back to the kernel, so the next write faults in
+   * fresh pages placed by the writing thread. The contents of those pages are lost; partial pages
+   * at both ends are left alone.
+   *
+   * @param  {void*} data   : first byte of the range
+   * @param  {size_t} bytes : size of the range
+   * @return {bool}         : whether the pages were released
+   */
+  bool ReleasePages(void* data, size_t bytes);
+
+  /**
+   * GetPlacementNode returns the NUMA node of the CPU a pinned worker runs on
+   * @param  {int} worker : worker index, wrapped around the allowed CPUs
+   * @return {int}        : node of the worker, -1 where affinity is not supported
+   */
+  int GetPlacementNode(int worker);
+
+  /**
+   * GetPageNodes asks the kernel which NUMA node every page of a range currently lives on
+   * @param  {void*} data   : first byte of the range
+   * @param  {size_t} bytes : size of the range
+   * @return {vector<int>}  : node of every page overlapping the range, a negative errno for pages
+   *                          not faulted in; empty where the kernel cannot be queried
+   */
+  vector<int> GetPageNodes(const void* data, size_t bytes);
+
+  /**
+   * GetPlacementPageSize returns the size of the pages owned by a single worker
+   * @param  {PlacementOptions} placement : placement options
+   * @return {size_t}                     : huge page size with hugePages, base page size otherwise
+   */
+  size_t GetPlacementPageSize(const PlacementOptions& placement);
+
+  /**
+   * GetPlacementNumWorkers resolves the number of workers splitting a given number of positions
+   * @param  {Eigen::Index} count         : number of positions
+   * @param  {PlacementOptions} placement : placement options
+   * @return {int}                        : number of workers, at least 1
+   */
+  int GetPlacementNumWorkers(Eigen::Index count, const PlacementOptions& placement);
+
+  /**
+   * GetPlacementWorkers returns the process wide worker pool of a placement. Pools are started on
+   * first use and kept alive, one per thread count and pinning, so worker i of a placement always
+   * runs on the same (pinned) thread.
+   * @param  {PlacementOptions} placement : placement options
+   * @return {shared_ptr<WorkerPool>}     : workers of the placement
+   */
+  shared_ptr<WorkerPool> GetPlacementWorkers(const PlacementOptions& placement);
+
+  /**
+   * GetPlacedRanges returns the positions of a column owned by a worker. The owner of a page is
+   * the worker whose ParallelFor block holds the position of the first element of the page, so
+   * the ranges of all workers tile the column and no page is shared between two workers. The
+   * first range is the head of the column lying in a page that starts in an earlier column.
+   *
+   * @param  {FieldLayout} layout  : layout of the field
+   * @param  {Eigen::Index} column : column
+   * @param  {int} worker          : worker in [0, workers)
+   * @param  {int} workers         : number of workers splitting the positions
+   * @param  {size_t} pageSize     : size of the pages, a multiple of the element size
+   * @return {PlacedRanges}        : positions of the column owned by the worker
+   */
+  PlacedRanges GetPlacedRanges(const FieldLayout& layout, Eigen::Index column, int worker,
+                               int workers, size_t pageSize);
+
+  /**
+   * ForEachPlacedBlock calls body(begin, end) for every range of a column owned by a worker, each
+   * on its own worker of the placement's pool. The first exception thrown by the body is rethrown
+   * on the calling thread.
+   *
+   * @param  {FieldLayout} layout         : layout of the field
+   * @param  {Eigen::Index} column        : column
+   * @param  {PlacementOptions} placement : placement options
+   * @param  {function} body              : called with [begin, end) positions of the column
+   */
+  void ForEachPlacedBlock(const FieldLayout& layout, Eigen::Index column,
+                          const PlacementOptions& placement,
+                          const function<void(Eigen::Index begin, Eigen::Index end)>& body);
+
+  /**
+   * ForEachPlacedColumn calls body(column, begin, end) for every range owned by a worker in every
+   * column, in a single run of the placement's pool
+   *
+   * @param  {FieldLayout} layout         : layout of the field
+   * @param  {Eigen::Index} cols          : number of columns
+   * @param  {PlacementOptions} placement : placement options
+   * @param  {function} body              : called with a column and [begin, end) positions of it
+   */
+  void ForEachPlacedColumn(
+      const FieldLayout& layout, Eigen::Index cols, const PlacementOptions& placement,
+      const function<void(Eigen::Index column, Eigen::Index begin, Eigen::Index end)>& body);
+
+  /**
+   * PlaceField first touches every page of a field on the worker owning it, writing zeros, or a
+   * copy of a source field when one is given. The whole pages of the field are released first,
+   * so pages an earlier owner of the memory faulted in are placed again.
+   *
+   * @param  {Matrix} field               : field to place
+   * @param  {PlacementOptions} placement : placement options
+   * @param  {Matrix} source              : optional field of identical dimensions to copy
+   */
+  template <typename Matrix>
+  void PlaceField(Matrix& field, const PlacementOptions& placement,
+                  const Matrix* source = nullptr) {
+    const size_t bytes = static_cast<size_t>(field.size()) * sizeof(*field.data());
+    ReleasePages(field.data(), bytes);
+    if (placement.hugePages) AdviseHugePages(field.data(), bytes);
+    ForEachPlacedColumn(FieldLayout::Of(field), field.cols(), placement,
+                        [&](Eigen::Index column, Eigen::Index begin, Eigen::Index end) {
+                          if (source == nullptr) {
+                            field.col(column).segment(begin, end - begin).setZero();
+                          } else {
+                            field.col(column).segment(begin, end - begin)
+                                = source->col(column).segment(begin, end - begin);
+                          }
+                        });
+  }
+
+  /**
+   * @brief PlacedFieldDeleter frees a placed field and refunds the subsystem it was charged to
+   */
+  template <typename Matrix> struct PlacedFieldDeleter {
+    MemorySubsystem subsystem = MemorySubsystem::Other;
+    size_t bytes = 0;
+
+    void operator()(Matrix* matrix) const {
+      MemoryAccountant::Refund(subsystem, bytes);
+      delete matrix;
+    }
+  };
+
+  /**
+   * AllocatePlacedField allocates a field and places it, see PlaceField. Placed fields bypass the
+   * buffer pools: a pooled buffer was already touched, and placed, by its previous owner.
+   *
+   * @param  {Eigen::Index} rows          : number of rows
+   * @param  {Eigen::Index} cols          : number of columns
+   * @param  {PlacementOptions} placement : placement options
+   * @param  {MemorySubsystem} subsystem  : subsystem the field is charged to
+   * @param  {Matrix} source              : optional field of identical dimensions to copy
+   * @return {shared_ptr<Matrix>}         : placed field
+   */
+  template <typename Matrix>
+  shared_ptr<Matrix> AllocatePlacedField(Eigen::Index rows, Eigen::Index cols,
+                                         const PlacementOptions& placement,
+                                         MemorySubsystem subsystem,
+                                         const Matrix* source = nullptr) {
+    const size_t bytes = static_cast<size_t>(rows * cols) * sizeof(typename Matrix::Scalar);
+    shared_ptr<Matrix> field(new Matrix(rows, cols), PlacedFieldDeleter<Matrix>{subsystem, bytes});
+    MemoryAccountant::Charge(subsystem, bytes);
+    PlaceField(*field, placement, source);
+    return field;
+  }
+}  // namespace CGLE
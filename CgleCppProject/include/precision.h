@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <complex>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief PrecisionPolicy pairs the scalar type fields are stored in with the scalar type kernels
+   * accumulate in. Grids, kernels and the stability solver are templated on a policy so the same
+   * code path serves both the reduced-storage mode and the all-double reference mode.
+   *
+   * @tparam StorageScalar     : real scalar type used for field storage
+   * @tparam AccumulatorScalar : real scalar type used for intermediate arithmetic
+   */
+  template <typename StorageScalar, typename AccumulatorScalar> struct PrecisionPolicy {
+    static_assert(sizeof(AccumulatorScalar) >= sizeof(StorageScalar),
+                  "accumulation must be at least as precise as storage");
+
+    using StorageType = StorageScalar;
+    using AccumulatorType = AccumulatorScalar;
+    using StorageComplex = complex<StorageScalar>;
+    using AccumulatorComplex = complex<AccumulatorScalar>;
+
+    /** Field matrix laid out as (position, time) so a time row is contiguous in memory **/
+    using FieldMatrix = Eigen::Matrix<StorageComplex, Eigen::Dynamic, Eigen::Dynamic>;
+    using AccumulatorVector = Eigen::Matrix<AccumulatorComplex, Eigen::Dynamic, 1>;
+
+    /**
+     * Rounds an accumulated value down to storage precision
+     * @param  {AccumulatorComplex} value : value computed at accumulator precision
+     * @return {StorageComplex}           : value at storage precision
+     */
+    static StorageComplex ToStorage(const AccumulatorComplex& value) {
+      return StorageComplex(static_cast<StorageScalar>(value.real()),
+                            static_cast<StorageScalar>(value.imag()));
+    }
+
+    /**
+     * Widens a stored value to accumulator precision
+     * @param  {StorageComplex} value : value read from a field
+     * @return {AccumulatorComplex}   : value at accumulator precision
+     */
+    static AccumulatorComplex ToAccumulator(const StorageComplex& value) {
+      return AccumulatorComplex(static_cast<AccumulatorScalar>(value.real()),
+                                static_cast<AccumulatorScalar>(value.imag()));
+    }
+  };
+
+  /** float storage with double accumulation: half the bytes per cell of the reference mode **/
+  using MixedPrecision = PrecisionPolicy<float, double>;
+
+  /** all-double reference mode used to validate MixedPrecision runs **/
+  using DoublePrecision = PrecisionPolicy<double, double>;
+}  // namespace CGLE
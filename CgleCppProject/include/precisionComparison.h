@@ -0,0 +1,46 @@
+#pragma once
+
+#include <constraint.h>
+#include <grid.h>
+#include <gridDetails.h>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief PrecisionComparison reports how far a MixedPrecision run drifts from the all-double
+   * reference run started from the same perturbed initial condition
+   */
+  struct PrecisionComparison {
+    /** max |A_mixed - A_reference| across the solved field **/
+    double maxDeviationA = 0;
+    /** max |B_mixed - B_reference| across the solved field **/
+    double maxDeviationB = 0;
+    /** max |A_reference|, |B_reference| across the solved fields **/
+    double maxReferenceAmplitude = 0;
+    /** max(maxDeviationA, maxDeviationB) / maxReferenceAmplitude **/
+    double maxRelativeDeviation = 0;
+  };
+
+  /**
+   * ComparePrecisionModes perturbs a reference grid, copies the perturbed fields into a mixed
+   * precision grid, runs the stability solver on both and reports the max deviation between them
+   *
+   * @param  {Constraint} constraint         : constraints of the case being simulated
+   * @param  {GridDetails} details           : grid dimensions and axis points
+   * @param  {double} pertubationCoefficient : pertubation coefficient applied to the boundaries
+   * @return {PrecisionComparison}           : deviation between the two modes
+   */
+  PrecisionComparison ComparePrecisionModes(Constraint& constraint, const GridDetails& details,
+                                            double pertubationCoefficient);
+
+  /**
+   * ComparePrecisionModes reports the max deviation between an already solved mixed precision
+   * grid and an already solved reference grid
+   *
+   * @param  {Grid} mixed              : solved mixed precision grid
+   * @param  {ReferenceGrid} reference : solved reference grid
+   * @return {PrecisionComparison}     : deviation between the two modes
+   */
+  PrecisionComparison ComparePrecisionModes(const Grid& mixed, const ReferenceGrid& reference);
+}  // namespace CGLE
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <constants.h>
+#include <constraint.h>
+#include <errorMetrics.h>
+#include <grid.h>
+#include <gridDetails.h>
+#include <precision.h>
+#include <separableEvaluator.h>
+#include <snapshot.h>
+#include <stabilitySolver.h>
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief ResultSettings holds the run settings that, together with the constraint and the grid
+   * details, determine the outcome of a solve
+   */
+  struct ResultSettings {
+    double pertubationCoefficient = 0;
+    /** seed of the mt19937_64 engine the pertubation is drawn from **/
+    uint64_t seed = 0;
+    BoundaryCondition boundaryCondition = BoundaryCondition::Dirichlet;
+    FieldEvaluation evaluation = FieldEvaluation::Separable;
+  };
+
+  /**
+   * @brief ResultKey is the content address of a result. The canonical encoding is a little
+   * endian byte string of every input (constraint, axes, settings, precision and cache format
+   * version), independent of the platform and of how the inputs were built. Entries are named
+   * after the 64 bit FNV-1a hash of the encoding and store the encoding itself, so a hash
+   * collision reads as a miss instead of a wrong result.
+   */
+  struct ResultKey {
+    string canonical;
+    uint64_t hash = 0;
+
+    /**
+     * GetAddress returns the hash as 16 hex digits, the name of the entry in the cache
+     * @return {string}  : hex address
+     */
+    string GetAddress() const;
+  };
+
+  /**
+   * MakeResultKey computes the key of a run
+   *
+   * @param  {Constraint} constraint     : constraint of the run
+   * @param  {GridDetails} details       : axes of the grid
+   * @param  {ResultSettings} settings   : settings of the run
+   * @param  {SnapshotScalar} storage    : scalar type the fields are stored at
+   * @param  {size_t} accumulatorBytes   : size of the accumulator scalar of the precision policy
+   * @return {ResultKey}                 : key of the run
+   */
+  ResultKey MakeResultKey(const Constraint& constraint, const GridDetails& details,
+                          const ResultSettings& settings, SnapshotScalar storage,
+                          size_t accumulatorBytes);
+
+  /**
+   * MakeResultKey computes the key of a run solved with a given precision policy
+   * @tparam Policy : PrecisionPolicy of the run
+   */
+  template <typename Policy>
+  ResultKey MakeResultKey(const Constraint& constraint, const GridDetails& details,
+                          const ResultSettings& settings) {
+    return MakeResultKey(constraint, details, settings,
+                         SnapshotScalarOf<typename Policy::StorageComplex>::value,
+                         sizeof(typename Policy::AccumulatorType));
+  }
+
+  /**
+   * @brief CachedResult holds the final perturbed fields and the error metrics of a solve
+   */
+  template <typename Policy> struct CachedResult {
+    typename Policy::FieldMatrix fieldA;
+    typename Policy::FieldMatrix fieldB;
+    ErrorMetrics metrics;
+  };
+
+  /**
+   * @brief ResultCacheStatistics counts the operations of a cache object in this process
+   */
+  struct ResultCacheStatistics {
+    long long hits = 0;
+    long long misses = 0;
+    long long stores = 0;
+    long long evictions = 0;
+  };
+
+  /**
+   * @brief ResultCache is a content addressed on-disk store of solve results, so repeated sweeps
+   * and resumed runs skip the cases they already computed. Each result is one file in the cache
+   * directory named after its key's address, with the fields compressed losslessly by a
+   * FieldCodec.
+   *
+   * Several processes may share a directory without locks: entries are written to a uniquely
+   * named temporary file and renamed into place, so readers only ever see complete entries, and
+   * an entry removed or replaced while being read stays readable through the open handle. A
+   * truncated or otherwise unreadable entry is a miss.
+   *
+   * The cache is kept under a byte limit by evicting the least recently used entries after every
+   * store. Recency is the entry's modification time, refreshed on every hit, so it is shared
+   * between the processes using the directory.
+   */
+  class ResultCache {
+  public:
+    /**
+     * ResultCache opens (and creates if needed) a cache directory
+     *
+     * @param  {string} directory  : directory holding the entries
+     * @param  {uintmax_t} maxBytes : size limit of the entries, enforced after every store
+     */
+    explicit ResultCache(const string& directory,
+                         uintmax_t maxBytes = DEFAULT_RESULT_CACHE_BYTES);
+
+    /**
+     * Get reads the result stored under a key
+     *
+     * @param  {ResultKey} key            : key of the result
+     * @param  {CachedResult<Policy>} out : receives the result on a hit
+     * @return {bool}                     : whether the result was found
+     */
+    template <typename Policy> bool Get(const ResultKey& key, CachedResult<Policy>& out);
+
+    /**
+     * Put stores a result under a key, replacing a previous entry, then evicts down to the limit
+     *
+     * @param  {ResultKey} key               : key of the result
+     * @param  {CachedResult<Policy>} result : result to store
+     */
+    template <typename Policy> void Put(const ResultKey& key, const CachedResult<Policy>& result);
+
+    /**
+     * Evict removes least recently used entries until the cache fits its limit, along with
+     * temporary files abandoned by writers that died
+     */
+    void Evict();
+
+    /**
+     * GetSizeBytes returns the total size of the entries currently in the directory
+     * @return {uintmax_t}  : size in bytes
+     */
+    uintmax_t GetSizeBytes() const;
+
+    const string& GetDirectory() const { return m_directory; }
+    uintmax_t GetMaxBytes() const { return m_maxBytes; }
+    ResultCacheStatistics GetStatistics() const;
+
+  private:
+    string GetEntryPath(const ResultKey& key) const;
+    string GetTemporaryPath(const ResultKey& key) const;
+
+    string m_directory;
+    uintmax_t m_maxBytes;
+    ResultCacheStatistics m_statistics;
+    mutable mutex m_mutex;
+  };
+
+  extern template bool ResultCache::Get<MixedPrecision>(const ResultKey&,
+                                                        CachedResult<MixedPrecision>&);
+  extern template bool ResultCache::Get<DoublePrecision>(const ResultKey&,
+                                                         CachedResult<DoublePrecision>&);
+  extern template void ResultCache::Put<MixedPrecision>(const ResultKey&,
+                                                        const CachedResult<MixedPrecision>&);
+  extern template void ResultCache::Put<DoublePrecision>(const ResultKey&,
+                                                         const CachedResult<DoublePrecision>&);
+
+  /**
+   * SolveWithCache returns the result of a run, reading it from the cache when present and
+   * otherwise building the grid, perturbing it with an engine seeded from the settings, solving
+   * it and storing the fields and error metrics
+   *
+   * @param  {ResultCache} cache         : cache to read from and store into
+   * @param  {Constraint} constraint     : constraint of the run
+   * @param  {GridDetails} details       : axes of the grid
+   * @param  {ResultSettings} settings   : settings of the run
+   * @param  {int} numThreads            : threads of the error metrics, 0 means one per thread
+   * @return {CachedResult<Policy>}      : fields and metrics of the run
+   */
+  template <typename Policy>
+  CachedResult<Policy> SolveWithCache(ResultCache& cache, const Constraint& constraint,
+                                      const GridDetails& details, const ResultSettings& settings,
+                                      int numThreads = 0);
+
+  extern template CachedResult<MixedPrecision> SolveWithCache<MixedPrecision>(
+      ResultCache&, const Constraint&, const GridDetails&, const ResultSettings&, int);
+  extern template CachedResult<DoublePrecision> SolveWithCache<DoublePrecision>(
+      ResultCache&, const Constraint&, const GridDetails&, const ResultSettings&, int);
+}  // namespace CGLE
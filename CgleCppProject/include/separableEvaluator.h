@@ -0,0 +1,74 @@
+#pragma once
+
+#include <constants.h>
+#include <constraint.h>
+#include <functionHandler.h>
+
+#include <Eigen/Dense>
+#include <complex>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief FieldEvaluation selects how a grid evaluates its ground truth
+   */
+  enum class FieldEvaluation {
+    /** one full exponential per cell through the FunctionHandler functors **/
+    Pointwise,
+    /** outer product of precomputed spatial and temporal exponential factors **/
+    Separable
+  };
+
+  /**
+   * @brief SeparableEvaluator evaluates the A and B wave forms of a FunctionHandler on a whole
+   * grid. Every wave form only depends on exp(k*x + w*t) = exp(k*x) * exp(w*t), so the Nx spatial
+   * factors are computed once and each time column computes a single temporal factor. Every cell
+   * then costs a few multiplies and a divide instead of an exponential.
+   *
+   * A factor whose exponent exceeds SEPARABLE_EXPONENT_LIMIT in magnitude could make the product
+   * leave double range (inf * 0) where the full exponential would not. Cells on such a position
+   * or time fall back to the pointwise functors.
+   */
+  class SeparableEvaluator {
+  public:
+    using Column = Eigen::VectorXcd;
+
+    /**
+     * SeparableEvaluator precomputes the spatial factors of a set of positions
+     *
+     * @param  {shared_ptr<FunctionHandler>} handler : wave forms, used for the fallback cells
+     * @param  {vector<double>} positions            : positional points of the grid
+     */
+    SeparableEvaluator(shared_ptr<FunctionHandler> handler, const vector<double>& positions);
+
+    /**
+     * EvaluateColumn evaluates A and B at every position for one time point
+     *
+     * @param  {double} time       : time point of the column
+     * @param  {Eigen::Ref<Column>} columnA : A(x, time) for every position on output
+     * @param  {Eigen::Ref<Column>} columnB : B(x, time) for every position on output
+     */
+    void EvaluateColumn(double time, Eigen::Ref<Column> columnA, Eigen::Ref<Column> columnB) const;
+
+    /**
+     * GetNumFallbackPositions returns the number of positions evaluated pointwise
+     * @return {int}  : number of positions outside the separable range
+     */
+    int GetNumFallbackPositions() const;
+
+  private:
+    enum class WaveForm { BrightBright, DarkDark, FrontFront };
+
+    shared_ptr<FunctionHandler> m_handler;
+    WaveForm m_waveForm;
+    double m_eta, m_mu;
+    double m_spatialRate, m_temporalRate;
+    vector<double> m_positions;
+    /** exp(Re(k1) * x) for every position **/
+    vector<double> m_spatialFactors;
+    vector<bool> m_separable;
+  };
+}  // namespace CGLE
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <binaryStream.h>
+#include <fieldCodec.h>
+#include <grid.h>
+#include <precision.h>
+
+#include <Eigen/Dense>
+#include <complex>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief SnapshotScalar identifies the scalar type of a snapshot field on disk
+   */
+  enum class SnapshotScalar : uint8_t {
+    Float32 = 0,
+    Float64 = 1,
+    ComplexFloat = 2,
+    ComplexDouble = 3
+  };
+
+  template <typename Scalar> struct SnapshotScalarOf;
+  template <> struct SnapshotScalarOf<float> {
+    static constexpr SnapshotScalar value = SnapshotScalar::Float32;
+  };
+  template <> struct SnapshotScalarOf<double> {
+    static constexpr SnapshotScalar value = SnapshotScalar::Float64;
+  };
+  template <> struct SnapshotScalarOf<complex<float>> {
+    static constexpr SnapshotScalar value = SnapshotScalar::ComplexFloat;
+  };
+  template <> struct SnapshotScalarOf<complex<double>> {
+    static constexpr SnapshotScalar value = SnapshotScalar::ComplexDouble;
+  };
+
+  /**
+   * GetSnapshotScalarSize returns the size in bytes of a snapshot scalar
+   * @param  {SnapshotScalar} scalar : scalar type
+   * @return {size_t}                : size in bytes
+   */
+  size_t GetSnapshotScalarSize(SnapshotScalar scalar);
+
+  /**
+   * @brief SnapshotWriter streams named column-major fields to a snapshot file. The file starts
+   * with the "CGLESNP1" magic and a field count, followed by one record per field (name, scalar
+   * type, rows, cols, raw data). Records of compressed fields set the high bit of the scalar type
+   * and store the size and the FieldCodec stream of the data instead of the raw data.
+   */
+  class SnapshotWriter {
+  public:
+    /**
+     * SnapshotWriter creates (or truncates) a snapshot file
+     * @param  {string} path                : path of the snapshot
+     * @param  {FieldCodecOptions} codec    : compression of the fields, vectors are never
+     * quantized so the axes stay exact with ErrorBounded
+     */
+    explicit SnapshotWriter(const string& path, const FieldCodecOptions& codec = {});
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    /**
+     * WriteField appends a field to the snapshot
+     * @param  {string} name   : name of the field
+     * @param  {Matrix} field  : field to write
+     */
+    template <typename Scalar>
+    void WriteField(const string& name,
+                    const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>& field) {
+      WriteRecord(name, SnapshotScalarOf<Scalar>::value, field.rows(), field.cols(), field.data());
+    }
+
+    /**
+     * WriteVector appends a column vector field to the snapshot
+     * @param  {string} name           : name of the field
+     * @param  {vector<double>} values : values to write
+     */
+    void WriteVector(const string& name, const vector<double>& values);
+
+    /**
+     * Close finalizes the field count and closes the file, also called by the destructor
+     */
+    void Close();
+
+  private:
+    void WriteRecord(const string& name, SnapshotScalar scalar, int64_t rows, int64_t cols,
+                     const void* data, bool exact = false);
+
+    string m_path;
+    FieldCodecOptions m_codec;
+    ofstream m_stream;
+    uint32_t m_numFields = 0;
+  };
+
+  /**
+   * @brief SnapshotReader reads the index of a snapshot and loads fields on demand
+   */
+  class SnapshotReader {
+  public:
+    struct FieldInfo {
+      string name;
+      SnapshotScalar scalar;
+      int64_t rows;
+      int64_t cols;
+      /** offset of the field's raw or compressed data in the file **/
+      int64_t offset;
+      bool compressed = false;
+      /** size of the field's data in the file **/
+      int64_t storedBytes;
+    };
+
+    /**
+     * SnapshotReader opens a snapshot and scans its field index
+     * @param  {string} path : path of the snapshot
+     */
+    explicit SnapshotReader(const string& path);
+
+    const vector<FieldInfo>& GetFields() const { return m_fields; }
+
+    /**
+     * GetField returns the index entry of a field, throwing if it does not exist
+     * @param  {string} name   : name of the field
+     * @return {FieldInfo}     : index entry of the field
+     */
+    const FieldInfo& GetField(const string& name) const;
+
+    bool HasField(const string& name) const;
+
+    /**
+     * ReadField loads a field stored with the given scalar type
+     * @param  {string} name : name of the field
+     * @return {Matrix}      : field
+     */
+    template <typename Scalar>
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> ReadField(const string& name) {
+      const FieldInfo& info = GetField(name);
+      if (info.scalar != SnapshotScalarOf<Scalar>::value) {
+        throw invalid_argument("field " + name + " is stored with another scalar type");
+      }
+      Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> field(info.rows, info.cols);
+      ReadRaw(info, field.data());
+      return field;
+    }
+
+  private:
+    void ReadRaw(const FieldInfo& info, void* data);
+
+    string m_path;
+    ifstream m_stream;
+    vector<FieldInfo> m_fields;
+  };
+
+  /**
+   * WriteSnapshot writes the axes and the fields of a grid under the names the MATLAB scripts use:
+   * X, T, GroundTruthA, GroundTruthB, PerturbedGridAA and PerturbedGridBB
+   *
+   * @param  {BasicGrid<Policy>} grid   : grid to write
+   * @param  {string} path              : path of the snapshot
+   * @param  {FieldCodecOptions} codec  : compression of the fields
+   */
+  template <typename Policy>
+  void WriteSnapshot(const BasicGrid<Policy>& grid, const string& path,
+                     const FieldCodecOptions& codec = {});
+
+  extern template void WriteSnapshot<MixedPrecision>(const Grid&, const string&,
+                                                     const FieldCodecOptions&);
+  extern template void WriteSnapshot<DoublePrecision>(const ReferenceGrid&, const string&,
+                                                      const FieldCodecOptions&);
+}  // namespace CGLE
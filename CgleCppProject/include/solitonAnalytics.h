@@ -0,0 +1,107 @@
+#pragma once
+
+#include <axis.h>
+#include <gridDetails.h>
+#include <precision.h>
+#include <stabilitySolver.h>
+
+#include <Eigen/Dense>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief FieldAnalytics holds the derived quantities of one field at one time row
+   */
+  struct FieldAnalytics {
+    /** coordinate of the peak, refined between positions by a parabola through |u|^2 **/
+    double peakPosition = 0;
+    /** change of peakPosition since the previous recorded row over the elapsed time **/
+    double peakVelocity = 0;
+    /** max |u| over the positions **/
+    double peakAmplitude = 0;
+    /** trapezoidal integral of |u|^2 over the positions **/
+    double power = 0;
+    /** peakAmplitude / max |d|u| / dx|, w for a tanh(x / w) front, 0 for a flat row **/
+    double frontWidth = 0;
+  };
+
+  /**
+   * @brief AnalyticsSample holds the analytics of both fields at one time row
+   */
+  struct AnalyticsSample {
+    int timeIndex = 0;
+    double time = 0;
+    FieldAnalytics a;
+    FieldAnalytics b;
+  };
+
+  /**
+   * @brief SolitonAnalytics computes the peak position, velocity and amplitude, the power and
+   * the front width of both fields in situ, while the solver marches, so runs that only need
+   * these do not have to keep or write the full fields. Each row is reduced in a single fused
+   * pass over the positions of A and B and appended to a compact time series. The observer
+   * chains to another one, so a run can still stream full fields through an AsyncFieldWriter.
+   *
+   * @tparam Policy : PrecisionPolicy selecting the storage type of the fields
+   */
+  template <typename Policy> class SolitonAnalytics {
+  public:
+    using FieldMatrix = typename Policy::FieldMatrix;
+    using StorageVector = Eigen::Matrix<typename Policy::StorageComplex, Eigen::Dynamic, 1>;
+    using RowObserver = typename StabilitySolver<Policy>::RowObserver;
+
+    /**
+     * SolitonAnalytics instantiates the analytics of a grid
+     * @param  {GridDetails} details : grid providing the position and time axes
+     */
+    explicit SolitonAnalytics(const GridDetails& details);
+
+    /**
+     * Record appends the analytics of one time row. Velocities are taken against the previously
+     * recorded row and are zero for the first one or when either row has no power.
+     *
+     * @param  {int} timeIndex       : time index of the row
+     * @param  {StorageVector} rowA  : A at every position
+     * @param  {StorageVector} rowB  : B at every position
+     */
+    void Record(int timeIndex, const Eigen::Ref<const StorageVector>& rowA,
+                const Eigen::Ref<const StorageVector>& rowB);
+
+    /**
+     * Observer returns a row observer recording every row the solver completes, forwarding the
+     * row to another observer afterwards. The analytics must outlive the solve.
+     *
+     * @param  {RowObserver} next : observer called after recording, may be empty
+     * @return {RowObserver}      : observer for StabilitySolver::SetRowObserver
+     */
+    RowObserver Observer(RowObserver next = nullptr);
+
+    /** Clear drops the recorded rows so the analytics can observe another solve **/
+    void Clear() { m_samples.clear(); }
+
+    const vector<AnalyticsSample>& GetSamples() const { return m_samples; }
+
+    /**
+     * WriteMatFile writes the time series as a struct of 1 x n row vectors (time, peakPositionA,
+     * peakVelocityA, ..., frontWidthB) named analytics
+     *
+     * @param  {string} path          : path of the .mat file
+     * @param  {int} compressionLevel : zlib level, 0 to store uncompressed
+     */
+    void WriteMatFile(const string& path, int compressionLevel = 0) const;
+
+  private:
+    Axis m_positions;
+    Axis m_times;
+    vector<AnalyticsSample> m_samples;
+    /** |u|^2 of the last row, kept for the parabolic peak refinement **/
+    Eigen::VectorXd m_normsA;
+    Eigen::VectorXd m_normsB;
+  };
+
+  extern template class SolitonAnalytics<MixedPrecision>;
+  extern template class SolitonAnalytics<DoublePrecision>;
+}  // namespace CGLE
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <axis.h>
+#include <memoryAccounting.h>
+#include <stabilitySolver.h>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <Eigen/SparseLU>
+#include <complex>
+#include <vector>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief StencilAxis is one axis of the structured mesh a SparseOperator is discretized on.
+   * Dirichlet axes pin their first and last positions so only the interior ones are unknowns;
+   * periodic axes solve for every position and wrap the last one around to the first one across
+   * a gap of the axis step.
+   */
+  struct StencilAxis {
+    Axis coordinates;
+    BoundaryCondition boundary = BoundaryCondition::Dirichlet;
+
+    /** number of unknowns along the axis **/
+    int GetNumUnknowns() const {
+      const int size = coordinates.size();
+      return boundary == BoundaryCondition::Periodic ? size : size - 2;
+    }
+  };
+
+  /**
+   * @brief StencilCoefficients holds the three point stencil of an operator along one axis: the
+   * entries applied to the previous position (sub), the position (diag) and the next position
+   * (super), given as on a uniform mesh of the axis step. On a non-uniform mesh each entry is
+   * rescaled to the local spacings the way the second difference is, so a stencil of
+   * (1, -2, 1) / step^2 is the second derivative on any mesh.
+   *
+   * @tparam Scalar : scalar type of the operator
+   */
+  template <typename Scalar> struct StencilCoefficients {
+    Scalar sub = 0;
+    Scalar diag = 0;
+    Scalar super = 0;
+  };
+
+  /**
+   * @brief SparseOperator assembles operators of the form diag(d) + sum over axes of a three point
+   * stencil on a 1D or 2D (or higher) structured mesh as an Eigen::SparseMatrix and solves
+   * against them with a sparse LU. Unknowns are ordered with the first axis fastest, like the
+   * position rows of a field. The sparsity pattern and the per nonzero stencil weights only
+   * depend on the mesh and are computed once at construction, so reassembling after a
+   * coefficient change rewrites the nonzero values in place, and the symbolic analysis of the LU
+   * is kept while only the numeric factorization is redone. On a single uniform axis the operator
+   * is the diag(b) + diag(c, 1) + diag(a, -1) of ComputeCoefficientMatrix.
+   *
+   * @tparam Scalar : scalar type of the operator (complex<double> or double)
+   */
+  template <typename Scalar> class SparseOperator {
+  public:
+    using Matrix = Eigen::SparseMatrix<Scalar>;
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+    using Stencil = StencilCoefficients<Scalar>;
+
+    /**
+     * SparseOperator builds the sparsity pattern of an operator on a mesh
+     * @param  {vector<StencilAxis>} axes : axes of the mesh, every one with at least 3 positions
+     */
+    explicit SparseOperator(vector<StencilAxis> axes);
+
+    /**
+     * Assemble sets the coefficients of the operator, invalidating its numeric factorization
+     *
+     * @param  {vector<Stencil>} stencils : stencil of every axis
+     * @param  {Vector} diagonal          : term added to the diagonal of every unknown
+     * @return {Matrix}                   : assembled operator
+     */
+    const Matrix& Assemble(const vector<Stencil>& stencils, const Vector& diagonal);
+
+    /**
+     * Assemble sets the coefficients of the operator with the same diagonal term everywhere
+     *
+     * @param  {vector<Stencil>} stencils : stencil of every axis
+     * @param  {Scalar} diagonal          : term added to the diagonal of every unknown
+     * @return {Matrix}                   : assembled operator
+     */
+    const Matrix& Assemble(const vector<Stencil>& stencils, Scalar diagonal = Scalar(0));
+
+    /**
+     * Factorize factorizes the assembled operator, running the symbolic analysis on the first call
+     * only. Throws runtime_error when the operator is singular.
+     */
+    void Factorize();
+
+    /**
+     * Solve solves the operator in place, factorizing it first if its coefficients changed
+     * @param  {Eigen::Ref<Vector>} rhs : right hand side, overwritten by the solution
+     */
+    void Solve(Eigen::Ref<Vector> rhs);
+
+    /**
+     * Index returns the unknown of a position of the mesh
+     * @param  {vector<int>} positions : position along every axis
+     * @return {int}                   : index of the unknown, -1 for pinned positions
+     */
+    int Index(const vector<int>& positions) const;
+
+    int GetNumUnknowns() const { return m_numUnknowns; }
+    const vector<StencilAxis>& GetAxes() const { return m_axes; }
+    const Matrix& GetMatrix() const { return m_matrix; }
+    int GetNumSymbolicFactorizations() const { return m_numSymbolic; }
+    int GetNumNumericFactorizations() const { return m_numNumeric; }
+
+  private:
+    vector<StencilAxis> m_axes;
+    int m_numUnknowns = 1;
+    Matrix m_matrix;
+    /** weight of every (sub, diag, super) coefficient of every axis in every nonzero value **/
+    Eigen::SparseMatrix<Scalar, Eigen::RowMajor> m_weights;
+    /** value index of the diagonal nonzero of every unknown **/
+    vector<int> m_diagonalIndex;
+    Eigen::SparseLU<Matrix> m_lu;
+    bool m_analyzed = false;
+    bool m_factorized = false;
+    int m_numSymbolic = 0;
+    int m_numNumeric = 0;
+    MemoryCharge m_charge{MemorySubsystem::Solver};
+  };
+
+  extern template class SparseOperator<complex<double>>;
+  extern template class SparseOperator<double>;
+}  // namespace CGLE
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <constraint.h>
+#include <gridDetails.h>
+#include <stabilitySolver.h>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <complex>
+#include <limits>
+#include <vector>
+
+using namespace std;
+
+namespace CGLE {
+  using LinearizedOperator = Eigen::SparseMatrix<complex<double>>;
+
+  /**
+   * @brief ScreeningVerdict classifies a case by the growth rate of its leading mode
+   */
+  enum class ScreeningVerdict { Stable, Borderline, Unstable };
+
+  /**
+   * @brief SpectralScreeningOptions configures ScreenStability and ComputeLeadingEigenvalues
+   */
+  struct SpectralScreeningOptions {
+    /** time row of the ground truth the operator is linearized around **/
+    int timeIndex = 0;
+    BoundaryCondition boundaryCondition = BoundaryCondition::Dirichlet;
+    /** number of eigenvalues closest to the shift that must converge **/
+    int numEigenvalues = 6;
+    /** size of the Krylov basis built between restarts **/
+    int krylovDimension = 40;
+    int maxRestarts = 100;
+    /** relative residual a Ritz pair must reach **/
+    double tolerance = 1e-10;
+    /** shift of the inverse, NaN places it just right of a bound on the growth rates **/
+    double shift = numeric_limits<double>::quiet_NaN();
+    /** growth rates within [-margin, margin] are borderline and left to a full march **/
+    double margin = 1e-3;
+  };
+
+  /**
+   * @brief SpectralScreeningResult holds the leading eigenvalues of a linearized operator
+   */
+  struct SpectralScreeningResult {
+    /** converged eigenvalues, by decreasing real part (growth rate) **/
+    vector<complex<double>> eigenvalues;
+    double maxGrowthRate = -numeric_limits<double>::infinity();
+    double shift = 0;
+    bool converged = false;
+    int numRestarts = 0;
+    /** Borderline whenever the eigenvalues did not converge **/
+    ScreeningVerdict verdict = ScreeningVerdict::Borderline;
+  };
+
+  /**
+   * BuildLinearizedOperator linearizes the coupled fields around a frozen (A0, B0) profile. The
+   * fields follow
+   *
+   *   A_t = i P1 A_xx + Gamma1 A + i (Q1 |A|^2 + Q2 |B|^2) A
+   *   B_t = i P1' B_xx + Gamma1' B + i (Q1' |A|^2 + Q2' |B|^2) B
+   *
+   * with the nonlinear terms grouped as in CoefficientMatrix::D2j. |A|^2 is not analytic, so a
+   * perturbation couples to its conjugate and the operator acts on (u, v, conj(u), conj(v)) for
+   * perturbations u of A and v of B at the unknown positions, with central differences of the
+   * grid spacing.
+   *
+   * @param  {Constraint} constraint      : constraint providing P1, Gamma1, Q1, Q2 and primes
+   * @param  {double} dx                  : spacing between positional points
+   * @param  {Eigen::VectorXcd} profileA  : A0 at every position
+   * @param  {Eigen::VectorXcd} profileB  : B0 at every position
+   * @param  {BoundaryCondition} boundary : Dirichlet pins the first and last positions
+   * @return {LinearizedOperator}         : 4 n x 4 n operator, n unknowns per field
+   */
+  LinearizedOperator BuildLinearizedOperator(const Constraint& constraint, double dx,
+                                             const Eigen::VectorXcd& profileA,
+                                             const Eigen::VectorXcd& profileB,
+                                             BoundaryCondition boundary);
+
+  /**
+   * ComputeLeadingEigenvalues computes the eigenvalues of an operator closest to a shift with
+   * Arnoldi iterations on the shift-inverted operator, factorized once by a sparse LU, with
+   * Krylov-Schur restarts keeping the leading Schur vectors. With the shift right of every
+   * eigenvalue the closest ones are the fastest growing.
+   *
+   * @param  {LinearizedOperator} linear       : square operator
+   * @param  {SpectralScreeningOptions} options : eigenvalue count, basis size and shift
+   * @return {SpectralScreeningResult}          : eigenvalues and verdict
+   */
+  SpectralScreeningResult ComputeLeadingEigenvalues(const LinearizedOperator& linear,
+                                                    const SpectralScreeningOptions& options);
+
+  /**
+   * ScreenStability linearizes a case around its FunctionHandler ground truth at one time row
+   * and classifies it by the growth rate of its leading modes, in a fraction of the time of a
+   * full march
+   *
+   * @param  {Constraint} constraint            : constraints of the case
+   * @param  {GridDetails} details              : grid dimensions and axis points
+   * @param  {SpectralScreeningOptions} options : screening configuration
+   * @return {SpectralScreeningResult}          : leading eigenvalues and verdict
+   */
+  SpectralScreeningResult ScreenStability(const Constraint& constraint,
+                                          const GridDetails& details,
+                                          const SpectralScreeningOptions& options = {});
+}  // namespace CGLE
@@ -0,0 +1,366 @@
+#pragma once
+
+#include <bufferPool.h>
+#include <constants.h>
+#include <constraint.h>
+#include <grid.h>
+#include <gridDetails.h>
+#include <newtonKrylov.h>
+#include <numaPlacement.h>
+#include <precision.h>
+#include <tridiagonal.h>
+
+#include <Eigen/Dense>
+#include <complex>
+#include <functional>
+#include <stdexcept>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief CoefficientMatrix holds the discretization coefficients ComputeCoefficientMatrix derives
+   * for one of the coupled fields. AA = diag(b) + diag(c, 1) + diag(a, -1) while d1j and d2j are
+   * the nonlinear terms evaluated from the current time row.
+   *
+   * @tparam Scalar : real scalar type the coefficients are computed in
+   */
+  template <typename Scalar> struct CoefficientMatrix {
+    using Complex = complex<Scalar>;
+
+    /**
+     * Create computes the coefficients of a field
+     *
+     * @param  {complex<double>} p     : dispersion coefficient (P1 or P1')
+     * @param  {complex<double>} gamma : linear gain coefficient (Gamma1 or Gamma1')
+     * @param  {complex<double>} q1    : self coupling coefficient (Q1 or Q1')
+     * @param  {complex<double>} q2    : cross coupling coefficient (Q2 or Q2')
+     * @param  {double} dx             : spacing between positional points
+     * @param  {double} dt             : spacing between time points
+     * @return {CoefficientMatrix}     : coefficients of the field
+     */
+    static CoefficientMatrix Create(complex<double> p, complex<double> gamma, complex<double> q1,
+                                    complex<double> q2, double dx, double dt) {
+      const complex<double> imaginary(0, 1);
+      CoefficientMatrix coeff;
+      coeff.a = Complex(p / (2 * dx * dx));
+      coeff.b
+          = Complex((imaginary / (2 * dt * dt)) - (p / (dx * dx)) - ((imaginary * gamma) / 2.0));
+      coeff.c = Complex(imaginary / (2 * dt * dt));
+      coeff.linear = Complex((p / (dx * dx)) + ((imaginary * gamma) / 2.0));
+      coeff.q1 = Complex(q1);
+      coeff.q2 = Complex(q2);
+      return coeff;
+    }
+
+    /**
+     * D1j evaluates the coefficient applied to the amplitude at the current position
+     * @param  {Complex} ampA : amplitude of A at the current position
+     * @param  {Complex} ampB : amplitude of B at the current position
+     * @return {Complex}      : coefficient value
+     */
+    Complex D1j(const Complex& ampA, const Complex& ampB) const { return linear + D2j(ampA, ampB); }
+
+    /**
+     * D2j evaluates the coefficient applied to the amplitude at the next position
+     * @param  {Complex} ampA : amplitude of A at the next position
+     * @param  {Complex} ampB : amplitude of B at the next position
+     * @return {Complex}      : coefficient value
+     */
+    Complex D2j(const Complex& ampA, const Complex& ampB) const {
+      return Scalar(-0.5) * (q1 * std::norm(ampA) + q2 * std::norm(ampB));
+    }
+
+    /**
+     * RightHandSide evaluates the right hand side entry of a position from the stencil of the
+     * field being computed (self) and of both fields
+     *
+     * @param  {Complex} previous : self at the previous position
+     * @param  {Complex} current  : self at the position
+     * @param  {Complex} next     : self at the next position
+     * @param  {Complex} ampA     : A at the position
+     * @param  {Complex} ampB     : B at the position
+     * @param  {Complex} nextA    : A at the next position
+     * @param  {Complex} nextB    : B at the next position
+     * @param  {Complex} earlier  : self at the position one time row earlier
+     * @param  {Complex} later    : self at the position one time row later
+     * @param  {bool} hasLater    : whether the later time row contributes
+     * @return {Complex}          : right hand side entry
+     */
+    Complex RightHandSide(const Complex& previous, const Complex& current, const Complex& next,
+                          const Complex& ampA, const Complex& ampB, const Complex& nextA,
+                          const Complex& nextB, const Complex& earlier, const Complex& later,
+                          bool hasLater) const {
+      Complex value = c * previous + D1j(ampA, ampB) * current + D2j(nextA, nextB) * next
+                      - a * earlier;
+      if (hasLater) value -= a * later;
+      return value;
+    }
+
+    Complex a, b, c;
+    Complex linear;
+    Complex q1, q2;
+  };
+
+  /**
+   * @brief BoundaryCondition selects how the solver treats the first and last positions.
+   * Dirichlet follows PerformNovelStabilityAnalysis.m and pins both to zero every step. Periodic
+   * treats the positions as one period of an unbounded domain: the last position neighbours the
+   * first one and every position is an unknown, solved with a cyclic tridiagonal system.
+   */
+  enum class BoundaryCondition { Dirichlet, Periodic };
+
+  /**
+   * @brief StepScheme selects how the solver treats the current row of the stencil.
+   * SemiImplicit follows PerformNovelStabilityAnalysis.m: every current row value of the right
+   * hand side, linear and nonlinear, is taken from the row before it is solved, a single AA / BB
+   * solve per step. It is unstable for stiff gains, with AA near singular for dt around
+   * 1 / sqrt(Gamma1). NewtonKrylov takes all of them from the solved row itself, coupling A and
+   * B through the nonlinear terms, so every step solves (AA - c * shift - linear) u = rhs(u)
+   * and stays bounded where the semi-implicit march blows up.
+   */
+  enum class StepScheme { SemiImplicit, NewtonKrylov };
+
+  /**
+   * @brief StabilitySolver marches a perturbed grid forward in time following the scheme of
+   * PerformNovelStabilityAnalysis.m. Each time row is obtained by solving the AA and BB
+   * tridiagonal systems against a right hand side assembled from the current row. Fields are read
+   * and written at storage precision while every intermediate is kept at accumulator precision.
+   * The per-step right hand sides are leased from the calling thread's BufferPool. Systems with
+   * at least PARALLEL_TRIDIAGONAL_THRESHOLD interior points are solved with the partitioned
+   * solver so a single high resolution run uses every core within each time step.
+   *
+   * @tparam Policy : PrecisionPolicy selecting the storage and accumulator scalar types
+   */
+  template <typename Policy> class StabilitySolver {
+  public:
+    using AccumulatorType = typename Policy::AccumulatorType;
+    using AccumulatorComplex = typename Policy::AccumulatorComplex;
+    using AccumulatorVector = typename Policy::AccumulatorVector;
+    using FieldMatrix = typename Policy::FieldMatrix;
+    using Coefficients = CoefficientMatrix<AccumulatorType>;
+    using ScratchPool = BufferPool<AccumulatorComplex>;
+    /** receives a time row of both fields once it is final, the row is fieldA.col(timeIndex) **/
+    using RowObserver = function<void(int timeIndex, const Eigen::Ref<FieldMatrix>& fieldA,
+                                      const Eigen::Ref<FieldMatrix>& fieldB)>;
+    /** decides after every final time row whether the march can stop there **/
+    using StopCondition = function<bool(int timeIndex, const Eigen::Ref<FieldMatrix>& fieldA,
+                                        const Eigen::Ref<FieldMatrix>& fieldB)>;
+
+    /**
+     * StabilitySolver instantiates a solver for a given set of constraints
+     *
+     * @param  {Constraint} constraint : constraints providing P1, Gamma1, Q1, Q2 and primed terms
+     * @param  {double} dx             : spacing between positional points
+     * @param  {double} dt             : spacing between time points
+     */
+    StabilitySolver(const Constraint& constraint, double dx, double dt);
+
+    /**
+     * StabilitySolver instantiates a solver using the spacing of a grid
+     *
+     * @param  {Constraint} constraint : constraints providing P1, Gamma1, Q1, Q2 and primed terms
+     * @param  {GridDetails} details   : grid details providing Dx and Dt
+     */
+    StabilitySolver(const Constraint& constraint, const GridDetails& details);
+
+    /**
+     * Solve runs the stability analysis on the perturbed fields of a grid. On return the perturbed
+     * fields hold PerturbedGridAA and PerturbedGridBB.
+     *
+     * @param  {BasicGrid<Policy>} grid : perturbed grid
+     */
+    void Solve(BasicGrid<Policy>& grid);
+
+    /**
+     * Solve runs the stability analysis in place on a pair of (position, time) fields
+     *
+     * @param  {Eigen::Ref<FieldMatrix>} fieldA : perturbed A field, overwritten by the solution
+     * @param  {Eigen::Ref<FieldMatrix>} fieldB : perturbed B field, overwritten by the solution
+     */
+    void Solve(Eigen::Ref<FieldMatrix> fieldA, Eigen::Ref<FieldMatrix> fieldB);
+
+    /**
+     * SetNumThreads sets the number of threads each AA / BB solve may use. Callers that already
+     * run several solvers concurrently should pass 1.
+     *
+     * @param  {int} numThreads : number of threads, 0 means one per hardware thread
+     * @param  {int} threshold  : minimum number of interior points solved in parallel
+     */
+    void SetNumThreads(int numThreads, int threshold = PARALLEL_TRIDIAGONAL_THRESHOLD);
+
+    /**
+     * SetPlacement assembles the right hand sides and stores the solution of every time row on
+     * the workers owning the pages of that row of a placed grid (see PlacementOptions), and
+     * solves AA / BB on the same persistent workers. The assembly follows the pages of A.
+     *
+     * @param  {PlacementOptions} placement : placement the fields were allocated with
+     * @param  {int} threshold              : minimum number of unknowns solved in parallel
+     */
+    void SetPlacement(const PlacementOptions& placement,
+                      int threshold = PARALLEL_TRIDIAGONAL_THRESHOLD);
+
+    /**
+     * SetBoundaryCondition selects the boundary condition of subsequent solves
+     * @param  {BoundaryCondition} boundary : Dirichlet (default) or Periodic
+     */
+    void SetBoundaryCondition(BoundaryCondition boundary);
+
+    BoundaryCondition GetBoundaryCondition() const { return m_boundary; }
+
+    /**
+     * SetStepScheme selects the step scheme of subsequent solves. Implicit steps start from the
+     * current row the fields hold and solve the coupled nonlinear system of both fields with a
+     * Jacobian-free Newton-Krylov method, preconditioned by the factorizations of the linear
+     * operators of the step, AA and BB with the linear current row terms moved to the left.
+     *
+     * @param  {StepScheme} scheme           : SemiImplicit (default) or NewtonKrylov
+     * @param  {NewtonKrylovOptions} options : Newton and GMRES settings of implicit steps
+     */
+    void SetStepScheme(StepScheme scheme, const NewtonKrylovOptions& options = {});
+
+    StepScheme GetStepScheme() const { return m_scheme; }
+
+    /**
+     * SetInitialIterate starts the Newton iterations of every implicit row from a guess of the
+     * solution instead of the current row of the fields. The guess only changes how many
+     * iterations a row takes, not the solution it converges to, and is ignored by semi-implicit
+     * solves. The fields are referenced, not copied, and must outlive the solves.
+     *
+     * @param  {FieldMatrix} guessA : guess of the solved A field, nullptr to remove the guess
+     * @param  {FieldMatrix} guessB : guess of the solved B field, sized like guessA
+     */
+    void SetInitialIterate(const FieldMatrix* guessA, const FieldMatrix* guessB) {
+      if ((guessA == nullptr) != (guessB == nullptr)) {
+        throw invalid_argument("guesses of A and B must be given together");
+      }
+      m_guessA = guessA;
+      m_guessB = guessB;
+    }
+
+    /**
+     * GetNewtonKrylovReport summarizes the implicit steps of the previous solve: iteration counts
+     * are totals over the rows, residuals the worst row's, converged whether every row converged
+     *
+     * @return {NewtonKrylovReport} : report of the previous solve, empty for semi-implicit ones
+     */
+    const NewtonKrylovReport& GetNewtonKrylovReport() const { return m_newtonKrylovReport; }
+
+    /**
+     * SetRowObserver registers a callback invoked on the solving thread for the initial row and
+     * every computed time row, in order, as soon as the row is final. The last time row is never
+     * computed by the march, it is left zero and not reported. Observers that do I/O should hand
+     * the row to an AsyncFieldWriter rather than write it themselves.
+     *
+     * @param  {RowObserver} observer : callback, empty to remove it
+     */
+    void SetRowObserver(RowObserver observer) { m_observer = std::move(observer); }
+
+    /**
+     * SetStopCondition registers a predicate evaluated after every computed time row, following
+     * the row observer. Once it returns true the march ends: later rows keep their perturbed
+     * values and GetLastSolvedRow() reports the row it stopped at.
+     *
+     * @param  {StopCondition} condition : predicate, empty to always march to the end
+     */
+    void SetStopCondition(StopCondition condition) { m_stopCondition = std::move(condition); }
+
+    /** last time row computed by the previous solve **/
+    int GetLastSolvedRow() const { return m_lastSolvedRow; }
+
+    const Coefficients& GetCoefficientsA() const { return m_coeffA; }
+    const Coefficients& GetCoefficientsB() const { return m_coeffB; }
+
+  private:
+    /**
+     * PrepareFields zeroes NaN cells and, with Dirichlet boundaries, enforces the boundary
+     * conditions at the first and last positions
+     */
+    void PrepareFields(Eigen::Ref<FieldMatrix> fieldA, Eigen::Ref<FieldMatrix> fieldB) const;
+
+    /**
+     * Factorize factorizes AA and BB for a given number of unknowns if not already done
+     *
+     * @param  {int} numUnknowns : number of unknown positions per time row
+     */
+    void Factorize(int numUnknowns);
+
+    /**
+     * ComputeAtCurrentTimeAndPosition computes the right hand side entry of a field at a given
+     * time row and position. Neighbours of the first and last positions wrap around, which only
+     * happens with periodic boundaries.
+     *
+     * @param  {Coefficients} coeff : coefficients of the field being computed
+     * @param  {FieldMatrix} self   : field being computed
+     * @param  {FieldMatrix} fieldA : A field, used by the nonlinear terms
+     * @param  {FieldMatrix} fieldB : B field, used by the nonlinear terms
+     * @param  {int} timeIndex      : time row being computed
+     * @param  {int} position       : position being computed
+     * @return {AccumulatorComplex} : right hand side entry
+     */
+    AccumulatorComplex ComputeAtCurrentTimeAndPosition(const Coefficients& coeff,
+                                                       const Eigen::Ref<FieldMatrix>& self,
+                                                       const Eigen::Ref<FieldMatrix>& fieldA,
+                                                       const Eigen::Ref<FieldMatrix>& fieldB,
+                                                       int timeIndex, int position) const;
+
+    /**
+     * SolveImplicitRow solves a time row fully implicitly, starting from the initial iterate
+     * when one is set and from the current row of the fields otherwise
+     *
+     * @param  {FieldMatrix} fieldA     : A field, the current row still holds its prior values
+     * @param  {FieldMatrix} fieldB     : B field, the current row still holds its prior values
+     * @param  {int} timeIndex          : time row being computed
+     * @param  {AccumulatorVector} da   : receives the unknowns of A
+     * @param  {AccumulatorVector} db   : receives the unknowns of B
+     */
+    void SolveImplicitRow(const Eigen::Ref<FieldMatrix>& fieldA,
+                          const Eigen::Ref<FieldMatrix>& fieldB, int timeIndex,
+                          Eigen::Ref<AccumulatorVector> da, Eigen::Ref<AccumulatorVector> db);
+
+    /**
+     * ImplicitResidual evaluates AA u - rhs(u) for both fields, with every current row value of
+     * the right hand side taken from the unknowns and the boundary values
+     *
+     * @param  {AccumulatorVector} unknowns : unknowns of A followed by those of B
+     * @param  {AccumulatorVector} residual : receives the residual, laid out like the unknowns
+     * @param  {FieldMatrix} fieldA         : A field providing the boundary values of the row
+     * @param  {FieldMatrix} fieldB         : B field providing the boundary values of the row
+     * @param  {int} timeIndex              : time row being computed
+     */
+    void ImplicitResidual(const AccumulatorVector& unknowns, AccumulatorVector& residual,
+                          const Eigen::Ref<FieldMatrix>& fieldA,
+                          const Eigen::Ref<FieldMatrix>& fieldB, int timeIndex) const;
+
+    Coefficients m_coeffA;
+    Coefficients m_coeffB;
+    PartitionedTridiagonalSolver<AccumulatorComplex> m_systemA;
+    PartitionedTridiagonalSolver<AccumulatorComplex> m_systemB;
+    CyclicTridiagonalSolver<AccumulatorComplex> m_cyclicA;
+    CyclicTridiagonalSolver<AccumulatorComplex> m_cyclicB;
+    /** linear operators of implicit steps, the preconditioners of the Newton-Krylov solves **/
+    PartitionedTridiagonalSolver<AccumulatorComplex> m_implicitA;
+    PartitionedTridiagonalSolver<AccumulatorComplex> m_implicitB;
+    CyclicTridiagonalSolver<AccumulatorComplex> m_implicitCyclicA;
+    CyclicTridiagonalSolver<AccumulatorComplex> m_implicitCyclicB;
+    BoundaryCondition m_boundary = BoundaryCondition::Dirichlet;
+    int m_numUnknowns = 0;
+    RowObserver m_observer;
+    StopCondition m_stopCondition;
+    const FieldMatrix* m_guessA = nullptr;
+    const FieldMatrix* m_guessB = nullptr;
+    int m_lastSolvedRow = 0;
+    typename ScratchPool::Lease m_da;
+    typename ScratchPool::Lease m_db;
+    MemoryCharge m_factorizationCharge{MemorySubsystem::Solver};
+    shared_ptr<const PlacementOptions> m_placement;
+    int m_placementThreshold = PARALLEL_TRIDIAGONAL_THRESHOLD;
+    StepScheme m_scheme = StepScheme::SemiImplicit;
+    NewtonKrylovSolver<AccumulatorComplex> m_newtonKrylov;
+    NewtonKrylovReport m_newtonKrylovReport;
+    AccumulatorVector m_unknowns;
+  };
+
+  extern template class StabilitySolver<MixedPrecision>;
+  extern template class StabilitySolver<DoublePrecision>;
+}  // namespace CGLE
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <constants.h>
+#include <constraint.h>
+#include <grid.h>
+#include <gridDetails.h>
+#include <precision.h>
+#include <stabilitySolver.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief ThresholdParameter selects the quantity a ThresholdSearch varies. Only quantities the
+   * grid or the solver read can change a verdict; m_Beta and m_Alpha of the constraint feed
+   * neither, so they are not offered.
+   */
+  enum class ThresholdParameter {
+    /** pertubation coefficient passed to PerturbGrid **/
+    PertubationCoefficient
+  };
+
+  /**
+   * @brief ThresholdSearchOptions configures a ThresholdSearch
+   */
+  struct ThresholdSearchOptions {
+    ThresholdParameter parameter = ThresholdParameter::PertubationCoefficient;
+    /** initial bracket, moved outwards by the bracket width times expansion until it straddles **/
+    double lower = 0.0;
+    double upper = 1.0;
+    double expansion = 2.0;
+    /** the search stops once the bracket is at most this wide **/
+    double tolerance = 1e-3;
+    /** upper bound on the number of solves, bracketing included **/
+    int maxProbes = 24;
+    /** whether values above the threshold are the unstable ones **/
+    bool unstableAbove = true;
+    /** seed of the noise, every probe draws the same noise so verdicts only depend on the value **/
+    uint64_t seed = 0;
+    /** a probe is unstable once its amplitude exceeds this factor times the ground truth max **/
+    double divergenceFactor = DEFAULT_DIVERGENCE_FACTOR;
+    BoundaryCondition boundaryCondition = BoundaryCondition::Dirichlet;
+    /** number of threads of every solve, 0 means one per hardware thread **/
+    int numThreads = 0;
+  };
+
+  /**
+   * @brief ThresholdProbe records one solve of a search
+   */
+  struct ThresholdProbe {
+    double value = 0;
+    bool unstable = false;
+    /** time row the verdict was reached at, earlier than the last row for unstable probes **/
+    int verdictRow = 0;
+  };
+
+  /**
+   * @brief ThresholdResult holds the bracket a search ended with. The threshold lies between the
+   * closest stable and unstable values probed, so half the bracket width bounds its error.
+   */
+  struct ThresholdResult {
+    /** whether a stable and an unstable value were found **/
+    bool bracketed = false;
+    /** closest stable and unstable values probed **/
+    double stableBound = 0;
+    double unstableBound = 0;
+    vector<ThresholdProbe> probes;
+
+    double GetThreshold() const { return 0.5 * (stableBound + unstableBound); }
+    double GetUncertainty() const { return 0.5 * std::abs(unstableBound - stableBound); }
+    double GetLowerBound() const { return std::min(stableBound, unstableBound); }
+    double GetUpperBound() const { return std::max(stableBound, unstableBound); }
+  };
+
+  /**
+   * @brief ThresholdSearch finds the value of a parameter at which a case turns unstable by
+   * bracketing and bisecting, instead of sweeping a dense range of full solves. The verdict of a
+   * probe is monotone in the parameter by assumption, which holds for the fixed noise every probe
+   * draws. Probes fork one ground truth and share one solver, so the ground truth and the AA / BB
+   * factorizations are computed once per search. An unstable probe stops marching at the first
+   * row exceeding the divergence limit.
+   *
+   * @tparam Policy : PrecisionPolicy selecting the storage and accumulator scalar types
+   */
+  template <typename Policy> class ThresholdSearch {
+  public:
+    /**
+     * ThresholdSearch instantiates a search for a case
+     *
+     * @param  {Constraint} constraint : constraints of the case
+     * @param  {GridDetails} details   : grid dimensions and axis points
+     */
+    ThresholdSearch(const Constraint& constraint, const GridDetails& details);
+
+    /**
+     * Run runs a search
+     * @param  {ThresholdSearchOptions} options : search configuration
+     * @return {ThresholdResult}                : final bracket and every probe
+     */
+    ThresholdResult Run(const ThresholdSearchOptions& options);
+
+    /**
+     * Probe solves the case once at a value of the searched parameter
+     * @param  {ThresholdSearchOptions} options : search configuration
+     * @param  {double} value                   : value of the parameter
+     * @return {ThresholdProbe}                 : verdict of the solve
+     */
+    ThresholdProbe Probe(const ThresholdSearchOptions& options, double value);
+
+  private:
+    /**
+     * Prepare computes the shared ground truth and solver on the first probe and rebuilds the
+     * solver only when the thread count of the options changes
+     */
+    void Prepare(const ThresholdSearchOptions& options);
+
+    Constraint m_constraint;
+    GridDetails m_details;
+    unique_ptr<BasicGrid<Policy>> m_base;
+    unique_ptr<StabilitySolver<Policy>> m_solver;
+    int m_numThreads = 0;
+    double m_maxGroundTruthAmplitude = 0;
+  };
+
+  extern template class ThresholdSearch<MixedPrecision>;
+  extern template class ThresholdSearch<DoublePrecision>;
+}  // namespace CGLE
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <bufferPool.h>
+#include <constants.h>
+#include <numaPlacement.h>
+
+#include <Eigen/Dense>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief TiledField is a copy-on-write view of a field. It reads through to a shared, immutable
+   * base matrix and keeps private copies of only the square tiles that were written to. Copying a
+   * TiledField shares the base and every tile; a tile (or the dense matrix once materialized) is
+   * only duplicated when a copy writes to it while another copy still references it.
+   *
+   * Reads through View() on a field with modified tiles materialize it lazily, so concurrent const
+   * access to the same TiledField is not thread safe. Distinct copies may be used from different
+   * threads.
+   *
+   * @tparam Scalar : scalar type of the field
+   */
+  template <typename Scalar> class TiledField {
+  public:
+    using Matrix = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+    using Pool = BufferPool<Scalar>;
+
+    TiledField() = default;
+
+    /**
+     * TiledField instantiates a field reading through to a base matrix
+     *
+     * @param  {shared_ptr<const Matrix>} base : immutable base the field reads through to
+     * @param  {int} tileSize                  : edge length of the copy-on-write tiles
+     */
+    explicit TiledField(shared_ptr<const Matrix> base, int tileSize = DEFAULT_FIELD_TILE_SIZE)
+        : m_tileSize(tileSize) {
+      if (tileSize <= 0) throw invalid_argument("tile size must be positive");
+      Reset(std::move(base));
+    }
+
+    /**
+     * Reset discards every modification and reads through to a new base
+     * @param  {shared_ptr<const Matrix>} base : immutable base the field reads through to
+     */
+    void Reset(shared_ptr<const Matrix> base) {
+      if (!base) throw invalid_argument("tiled field requires a base matrix");
+
+      m_base = std::move(base);
+      m_dense.reset();
+      m_tileRows = static_cast<int>((m_base->rows() + m_tileSize - 1) / m_tileSize);
+      m_tileCols = static_cast<int>((m_base->cols() + m_tileSize - 1) / m_tileSize);
+      m_tiles.assign(static_cast<size_t>(m_tileRows) * m_tileCols, nullptr);
+      m_numTiles = 0;
+    }
+
+    /**
+     * SetPlacement places the dense matrix of later materializations, which are then allocated
+     * outside the buffer pool, see AllocatePlacedField
+     * @param  {shared_ptr<const PlacementOptions>} placement : placement, null for none
+     */
+    void SetPlacement(shared_ptr<const PlacementOptions> placement) {
+      m_placement = std::move(placement);
+    }
+
+    Eigen::Index rows() const { return m_base ? m_base->rows() : 0; }
+    Eigen::Index cols() const { return m_base ? m_base->cols() : 0; }
+
+    /**
+     * Reads a cell without materializing the field
+     * @param  {Eigen::Index} row : row of the cell
+     * @param  {Eigen::Index} col : column of the cell
+     * @return {Scalar}           : value of the cell
+     */
+    Scalar operator()(Eigen::Index row, Eigen::Index col) const {
+      if (m_dense) return (*m_dense)(row, col);
+
+      const shared_ptr<Matrix>& tile = m_tiles[TileIndex(row, col)];
+      if (tile) return (*tile)(row % m_tileSize, col % m_tileSize);
+      return (*m_base)(row, col);
+    }
+
+    /**
+     * Set writes a cell, copying its tile first if it is still shared
+     * @param  {Eigen::Index} row : row of the cell
+     * @param  {Eigen::Index} col : column of the cell
+     * @param  {Scalar} value     : value to write
+     */
+    void Set(Eigen::Index row, Eigen::Index col, const Scalar& value) {
+      if (m_dense) {
+        Materialize()(row, col) = value;
+        return;
+      }
+
+      (*MutableTile(row, col))(row % m_tileSize, col % m_tileSize) = value;
+    }
+
+    /**
+     * Materialize returns a dense matrix this field owns exclusively, merging the base and the
+     * modified tiles the first time it is called
+     * @return {Matrix}  : dense, writable field
+     */
+    Matrix& Materialize() {
+      if (m_dense && m_dense.use_count() == 1) return *m_dense;
+
+      const Matrix& source = m_dense ? *m_dense : *m_base;
+      shared_ptr<Matrix> dense;
+      if (m_placement) {
+        dense = AllocatePlacedField<Matrix>(rows(), cols(), *m_placement,
+                                            MemorySubsystem::GridFields, &source);
+      } else {
+        dense = Pool::Local().AcquireShared(rows(), cols(), MemorySubsystem::GridFields);
+        *dense = source;
+      }
+      if (!m_dense) {
+        for (int tileCol = 0; tileCol < m_tileCols; tileCol++) {
+          for (int tileRow = 0; tileRow < m_tileRows; tileRow++) {
+            const shared_ptr<Matrix>& tile = m_tiles[tileRow + tileCol * m_tileRows];
+            if (!tile) continue;
+            dense->block(tileRow * m_tileSize, tileCol * m_tileSize, tile->rows(), tile->cols())
+                = *tile;
+          }
+        }
+        m_tiles.assign(m_tiles.size(), nullptr);
+        m_numTiles = 0;
+      }
+
+      m_dense = std::move(dense);
+      return *m_dense;
+    }
+
+    /**
+     * View returns the field as a dense matrix. Unmodified fields return the shared base directly.
+     * @return {Matrix}  : dense, read only field
+     */
+    const Matrix& View() const {
+      if (m_dense) return *m_dense;
+      if (m_numTiles == 0) return *m_base;
+      return const_cast<TiledField*>(this)->Materialize();
+    }
+
+    const shared_ptr<const Matrix>& GetBase() const { return m_base; }
+    bool IsMaterialized() const { return static_cast<bool>(m_dense); }
+    int GetNumModifiedTiles() const { return m_numTiles; }
+    int GetTileSize() const { return m_tileSize; }
+
+    /**
+     * GetExclusiveBytes returns the number of bytes held by this field that no other copy shares
+     * @return {size_t}  : bytes owned exclusively
+     */
+    size_t GetExclusiveBytes() const {
+      if (m_dense) {
+        return m_dense.use_count() == 1 ? BytesOf(*m_dense) : 0;
+      }
+
+      size_t bytes = 0;
+      for (const shared_ptr<Matrix>& tile : m_tiles) {
+        if (tile && tile.use_count() == 1) bytes += BytesOf(*tile);
+      }
+      return bytes;
+    }
+
+  private:
+    static size_t BytesOf(const Matrix& matrix) {
+      return static_cast<size_t>(matrix.size()) * sizeof(Scalar);
+    }
+
+    size_t TileIndex(Eigen::Index row, Eigen::Index col) const {
+      return static_cast<size_t>(row / m_tileSize)
+             + static_cast<size_t>(col / m_tileSize) * static_cast<size_t>(m_tileRows);
+    }
+
+    /**
+     * MutableTile returns the tile holding a cell, creating or un-sharing it as needed
+     */
+    Matrix* MutableTile(Eigen::Index row, Eigen::Index col) {
+      shared_ptr<Matrix>& tile = m_tiles[TileIndex(row, col)];
+      if (tile && tile.use_count() == 1) return tile.get();
+
+      const Eigen::Index rowStart = (row / m_tileSize) * m_tileSize;
+      const Eigen::Index colStart = (col / m_tileSize) * m_tileSize;
+      const Eigen::Index numRows = min<Eigen::Index>(m_tileSize, rows() - rowStart);
+      const Eigen::Index numCols = min<Eigen::Index>(m_tileSize, cols() - colStart);
+
+      shared_ptr<Matrix> copy
+          = Pool::Local().AcquireShared(numRows, numCols, MemorySubsystem::GridFields);
+      if (tile) {
+        *copy = *tile;
+      } else {
+        *copy = m_base->block(rowStart, colStart, numRows, numCols);
+        m_numTiles++;
+      }
+
+      tile = std::move(copy);
+      return tile.get();
+    }
+
+    int m_tileSize = DEFAULT_FIELD_TILE_SIZE;
+    int m_tileRows = 0;
+    int m_tileCols = 0;
+    int m_numTiles = 0;
+    shared_ptr<const Matrix> m_base;
+    shared_ptr<Matrix> m_dense;
+    vector<shared_ptr<Matrix>> m_tiles;
+    shared_ptr<const PlacementOptions> m_placement;
+  };
+}  // namespace CGLE
@@ -0,0 +1,519 @@
+#pragma once
+
+#include <constants.h>
+#include <workerPool.h>
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "helper.h"
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief TridiagonalSolver solves the constant coefficient systems produced by
+   * ComputeCoefficientMatrix (diag(b) + diag(c, 1) + diag(a, -1)) with the Thomas algorithm.
+   * The forward elimination factors only depend on the coefficients so they are computed once and
+   * every subsequent solve is a single forward and backward sweep.
+   *
+   * @tparam Scalar : scalar type of the system (typically complex<double>)
+   */
+  template <typename Scalar> class TridiagonalSolver {
+  public:
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+
+    TridiagonalSolver() = default;
+
+    /**
+     * TridiagonalSolver instantiates and factorizes a tridiagonal system
+     *
+     * @param  {int} size       : number of unknowns
+     * @param  {Scalar} sub     : coefficient on the sub diagonal (a)
+     * @param  {Scalar} diag    : coefficient on the main diagonal (b)
+     * @param  {Scalar} super   : coefficient on the super diagonal (c)
+     */
+    TridiagonalSolver(int size, Scalar sub, Scalar diag, Scalar super) {
+      Factorize(size, sub, diag, super);
+    }
+
+    /**
+     * Factorize precomputes the elimination factors of the system
+     *
+     * @param  {int} size       : number of unknowns
+     * @param  {Scalar} sub     : coefficient on the sub diagonal (a)
+     * @param  {Scalar} diag    : coefficient on the main diagonal (b)
+     * @param  {Scalar} super   : coefficient on the super diagonal (c)
+     */
+    void Factorize(int size, Scalar sub, Scalar diag, Scalar super) {
+      if (size <= 0) throw invalid_argument("tridiagonal system must have at least one unknown");
+
+      m_size = size;
+      m_sub = sub;
+      m_diag = diag;
+      m_super = super;
+      m_superPrime.resize(size);
+      m_inverseDenominator.resize(size);
+
+      Scalar denominator = diag;
+      for (int i = 0; i < size; i++) {
+        if (i > 0) denominator = diag - sub * m_superPrime[i - 1];
+        if (denominator == Scalar(0)) throw runtime_error("tridiagonal system is singular");
+        m_inverseDenominator[i] = Scalar(1) / denominator;
+        m_superPrime[i] = super * m_inverseDenominator[i];
+      }
+    }
+
+    /**
+     * Solve solves the factorized system in place
+     *
+     * @param  {Eigen::Ref<Vector>} rhs : right hand side on input, solution on output
+     */
+    void Solve(Eigen::Ref<Vector> rhs) const {
+      if (rhs.size() != m_size) {
+        throw invalid_argument("right hand side does not match system size");
+      }
+
+      rhs[0] *= m_inverseDenominator[0];
+      for (int i = 1; i < m_size; i++) {
+        rhs[i] = (rhs[i] - m_sub * rhs[i - 1]) * m_inverseDenominator[i];
+      }
+      for (int i = m_size - 2; i >= 0; i--) {
+        rhs[i] -= m_superPrime[i] * rhs[i + 1];
+      }
+    }
+
+    /**
+     * Multiply computes y = T * x, useful to validate solutions and to build residuals
+     *
+     * @param  {Vector} x : vector to multiply
+     * @return {Vector}   : product of the tridiagonal operator and x
+     */
+    Vector Multiply(const Vector& x) const {
+      Vector y(x.size());
+      for (int i = 0; i < m_size; i++) {
+        Scalar value = m_diag * x[i];
+        if (i > 0) value += m_sub * x[i - 1];
+        if (i + 1 < m_size) value += m_super * x[i + 1];
+        y[i] = value;
+      }
+      return y;
+    }
+
+    int GetSize() const { return m_size; }
+    Scalar GetSub() const { return m_sub; }
+    Scalar GetDiag() const { return m_diag; }
+    Scalar GetSuper() const { return m_super; }
+    /** bytes held by the factorization **/
+    size_t GetBytes() const {
+      return (m_superPrime.capacity() + m_inverseDenominator.capacity()) * sizeof(Scalar);
+    }
+
+  private:
+    int m_size = 0;
+    Scalar m_sub, m_diag, m_super;
+    vector<Scalar> m_superPrime;
+    vector<Scalar> m_inverseDenominator;
+  };
+
+  /**
+   * @brief SpikePartition splits the unknowns of a constant coefficient tridiagonal system into
+   * contiguous blocks for the SPIKE partition method. It holds what only depends on the
+   * coefficients: the factorizations of the two block sizes, their spikes and the factorized 2x2
+   * block tridiagonal system coupling the first and last unknowns of every block. Blocks differ by
+   * at most one unknown, the first (size % partitions) blocks are the larger ones.
+   *
+   * @tparam Scalar : scalar type of the system (typically complex<double>)
+   */
+  template <typename Scalar> class SpikePartition {
+  public:
+    using Vector = typename TridiagonalSolver<Scalar>::Vector;
+    using Block = Eigen::Matrix<Scalar, 2, 2>;
+    using Pair = Eigen::Matrix<Scalar, 2, 1>;
+
+    /**
+     * Factorize splits the system and precomputes the block factors, the spikes and the reduced
+     * system
+     *
+     * @param  {int} size          : number of unknowns
+     * @param  {int} numPartitions : number of blocks, each needs at least two unknowns
+     * @param  {Scalar} sub        : coefficient on the sub diagonal (a)
+     * @param  {Scalar} diag       : coefficient on the main diagonal (b)
+     * @param  {Scalar} super      : coefficient on the super diagonal (c)
+     */
+    void Factorize(int size, int numPartitions, Scalar sub, Scalar diag, Scalar super) {
+      if (numPartitions < 1 || size < 2 * numPartitions) {
+        throw invalid_argument("every partition needs at least two unknowns");
+      }
+
+      m_numPartitions = numPartitions;
+      m_blockSize = size / numPartitions;
+      m_numLarge = size % numPartitions;
+      m_small.Factorize(m_blockSize, sub, diag, super);
+      m_large.Factorize(m_blockSize + 1, sub, diag, super);
+      ComputeSpikes(m_small, m_smallLeft, m_smallRight);
+      ComputeSpikes(m_large, m_largeLeft, m_largeRight);
+      FactorizeReducedSystem();
+    }
+
+    /**
+     * SolveReduced solves the reduced system in place
+     *
+     * @param  {vector<Pair>} ends : first and last unknown of every locally solved block on
+     *                               input, of the solution on output
+     */
+    void SolveReduced(vector<Pair>& ends) const {
+      // block Thomas sweep
+      for (int block = 0; block < m_numPartitions; block++) {
+        Pair local = ends[block];
+        if (block > 0) local -= m_coupleLeft[block] * ends[block - 1];
+        ends[block] = m_inverseReduced[block] * local;
+      }
+      for (int block = m_numPartitions - 2; block >= 0; block--) {
+        ends[block] -= m_reducedSuper[block] * ends[block + 1];
+      }
+    }
+
+    /**
+     * Correct applies x_k = y_k - v_k * x_(k-1),last - w_k * x_(k+1),first to a locally solved
+     * block once the reduced system is solved
+     *
+     * @param  {int} block               : block index
+     * @param  {Eigen::Ref<Vector>} local : local solution of the block, corrected in place
+     * @param  {vector<Pair>} ends        : solution of the reduced system
+     */
+    void Correct(int block, Eigen::Ref<Vector> local, const vector<Pair>& ends) const {
+      if (block > 0) local -= ends[block - 1][1] * GetLeftSpike(block);
+      if (block + 1 < m_numPartitions) local -= ends[block + 1][0] * GetRightSpike(block);
+    }
+
+    int GetNumPartitions() const { return m_numPartitions; }
+    int BlockLength(int block) const { return m_blockSize + (IsLarge(block) ? 1 : 0); }
+    int BlockStart(int block) const { return block * m_blockSize + min(block, m_numLarge); }
+    const TridiagonalSolver<Scalar>& GetBlockSolver(int block) const {
+      return IsLarge(block) ? m_large : m_small;
+    }
+    const Vector& GetLeftSpike(int block) const {
+      return IsLarge(block) ? m_largeLeft : m_smallLeft;
+    }
+    const Vector& GetRightSpike(int block) const {
+      return IsLarge(block) ? m_largeRight : m_smallRight;
+    }
+    /** bytes held by the block factorizations, the spikes and the reduced system **/
+    size_t GetBytes() const {
+      const Eigen::Index spikes
+          = m_smallLeft.size() + m_smallRight.size() + m_largeLeft.size() + m_largeRight.size();
+      const size_t blocks
+          = m_coupleLeft.capacity() + m_inverseReduced.capacity() + m_reducedSuper.capacity();
+      return m_small.GetBytes() + m_large.GetBytes() + static_cast<size_t>(spikes) * sizeof(Scalar)
+             + blocks * sizeof(Block);
+    }
+
+  private:
+    bool IsLarge(int block) const { return block < m_numLarge; }
+
+    /**
+     * ComputeSpikes computes v = T^-1 (a e_1) and w = T^-1 (c e_m) for a block
+     */
+    void ComputeSpikes(const TridiagonalSolver<Scalar>& local, Vector& left, Vector& right) const {
+      left = Vector::Zero(local.GetSize());
+      right = Vector::Zero(local.GetSize());
+      left[0] = local.GetSub();
+      right[local.GetSize() - 1] = local.GetSuper();
+      local.Solve(left);
+      local.Solve(right);
+    }
+
+    /**
+     * FactorizeReducedSystem factorizes the 2x2 block tridiagonal system coupling the ends of the
+     * blocks: z_k + A_k z_(k-1) + C_k z_(k+1) = (y_k,first, y_k,last)
+     */
+    void FactorizeReducedSystem() {
+      m_coupleLeft.assign(m_numPartitions, Block::Zero());
+      m_inverseReduced.assign(m_numPartitions, Block::Zero());
+      m_reducedSuper.assign(m_numPartitions, Block::Zero());
+
+      Block previousSuper = Block::Zero();
+      for (int block = 0; block < m_numPartitions; block++) {
+        const Vector& left = GetLeftSpike(block);
+        const Vector& right = GetRightSpike(block);
+        const int last = BlockLength(block) - 1;
+
+        // A_k only couples to the last unknown of the previous block, C_k to the first of the next
+        Block coupleRight = Block::Zero();
+        if (block > 0) m_coupleLeft[block] << Scalar(0), left[0], Scalar(0), left[last];
+        if (block + 1 < m_numPartitions) coupleRight << right[0], Scalar(0), right[last], Scalar(0);
+
+        Block pivot = Block::Identity();
+        if (block > 0) pivot -= m_coupleLeft[block] * previousSuper;
+        if (pivot.determinant() == Scalar(0)) throw runtime_error("tridiagonal system is singular");
+
+        m_inverseReduced[block] = pivot.inverse();
+        m_reducedSuper[block] = m_inverseReduced[block] * coupleRight;
+        previousSuper = m_reducedSuper[block];
+      }
+    }
+
+    int m_numPartitions = 1;
+    int m_blockSize = 0;
+    int m_numLarge = 0;
+    TridiagonalSolver<Scalar> m_small, m_large;
+    Vector m_smallLeft, m_smallRight, m_largeLeft, m_largeRight;
+    vector<Block> m_coupleLeft, m_inverseReduced, m_reducedSuper;
+  };
+
+  /**
+   * @brief PartitionedTridiagonalSolver solves the same constant coefficient systems as
+   * TridiagonalSolver with the SPIKE partition method so a single solve uses several cores. The
+   * unknowns are split into one contiguous block per thread and each block is solved
+   * independently. A 2x2 block tridiagonal system then resolves the first and last unknown of
+   * every block, and each block is corrected with its precomputed spikes (see SpikePartition).
+   *
+   * Below the size threshold, or with a single thread, it falls back to the serial Thomas sweep.
+   * Everything that only depends on the coefficients (local factors, spikes and the reduced
+   * system) is computed once by Factorize, which also starts the workers the blocks are solved on
+   * and sizes the reduced system buffer, so a solve neither creates threads nor allocates. Copies
+   * share the workers but a single solver must not be solved from several threads at once.
+   *
+   * @tparam Scalar : scalar type of the system (typically complex<double>)
+   */
+  template <typename Scalar> class PartitionedTridiagonalSolver {
+  public:
+    using Vector = typename TridiagonalSolver<Scalar>::Vector;
+    using Block = typename SpikePartition<Scalar>::Block;
+    using Pair = typename SpikePartition<Scalar>::Pair;
+
+    PartitionedTridiagonalSolver() = default;
+
+    /**
+     * SetParallelism sets the number of threads used per solve and the system size from which the
+     * partitioned path is taken, refactorizing an already factorized system
+     *
+     * @param  {int} numThreads : number of threads, 0 means one per hardware thread
+     * @param  {int} threshold  : minimum number of unknowns solved in parallel
+     */
+    void SetParallelism(int numThreads, int threshold = PARALLEL_TRIDIAGONAL_THRESHOLD) {
+      m_numThreads = numThreads;
+      m_threshold = threshold;
+      if (m_serial.GetSize() > 0) {
+        Factorize(m_serial.GetSize(), m_serial.GetSub(), m_serial.GetDiag(), m_serial.GetSuper());
+      }
+    }
+
+    /**
+     * SetWorkers solves the blocks on a shared pool, e.g. the workers of a placement, instead of
+     * a pool of the solver's own, refactorizing an already factorized system. The number of
+     * partitions is capped at the pool's thread count.
+     *
+     * @param  {shared_ptr<WorkerPool>} workers : pool to solve on, null for an own pool
+     */
+    void SetWorkers(shared_ptr<WorkerPool> workers) {
+      m_sharedWorkers = std::move(workers);
+      m_workers.reset();
+      if (m_serial.GetSize() > 0) {
+        Factorize(m_serial.GetSize(), m_serial.GetSub(), m_serial.GetDiag(), m_serial.GetSuper());
+      }
+    }
+
+    /**
+     * Factorize precomputes the local factors, the spikes and the reduced system
+     *
+     * @param  {int} size       : number of unknowns
+     * @param  {Scalar} sub     : coefficient on the sub diagonal (a)
+     * @param  {Scalar} diag    : coefficient on the main diagonal (b)
+     * @param  {Scalar} super   : coefficient on the super diagonal (c)
+     */
+    void Factorize(int size, Scalar sub, Scalar diag, Scalar super) {
+      m_serial.Factorize(size, sub, diag, super);
+
+      int threads = Helper::GetNumThreads(m_numThreads);
+      if (m_sharedWorkers) threads = min(threads, m_sharedWorkers->GetNumThreads());
+      // every block needs at least two unknowns so its first and last unknowns are distinct
+      m_numPartitions = size >= m_threshold ? max(1, min(threads, size / 2)) : 1;
+      if (m_numPartitions == 1) return;
+
+      m_partition.Factorize(size, m_numPartitions, sub, diag, super);
+      m_ends.resize(m_numPartitions);
+      if (m_sharedWorkers) {
+        m_workers = m_sharedWorkers;
+      } else if (!m_workers || m_workers->GetNumThreads() != m_numPartitions) {
+        m_workers = make_shared<WorkerPool>(m_numPartitions);
+      }
+    }
+
+    /**
+     * Solve solves the factorized system in place
+     *
+     * @param  {Eigen::Ref<Vector>} rhs : right hand side on input, solution on output
+     */
+    void Solve(Eigen::Ref<Vector> rhs) const {
+      if (m_numPartitions == 1) {
+        m_serial.Solve(rhs);
+        return;
+      }
+      if (rhs.size() != m_serial.GetSize()) {
+        throw invalid_argument("right hand side does not match system size");
+      }
+
+      // local solves: y_k = T_k^-1 d_k
+      // shared pools may have more workers than blocks
+      m_workers->Run([&](int block) {
+        if (block < m_numPartitions) m_partition.GetBlockSolver(block).Solve(Segment(rhs, block));
+      });
+
+      // reduced system on the first and last unknown of every block
+      for (int block = 0; block < m_numPartitions; block++) {
+        const int start = m_partition.BlockStart(block);
+        m_ends[block] = Pair(rhs[start], rhs[start + m_partition.BlockLength(block) - 1]);
+      }
+      m_partition.SolveReduced(m_ends);
+
+      m_workers->Run([&](int block) {
+        if (block < m_numPartitions) m_partition.Correct(block, Segment(rhs, block), m_ends);
+      });
+    }
+
+    /**
+     * Multiply computes y = T * x
+     * @param  {Vector} x : vector to multiply
+     * @return {Vector}   : product of the tridiagonal operator and x
+     */
+    Vector Multiply(const Vector& x) const { return m_serial.Multiply(x); }
+
+    int GetSize() const { return m_serial.GetSize(); }
+    int GetNumPartitions() const { return m_numPartitions; }
+    Scalar GetSub() const { return m_serial.GetSub(); }
+    Scalar GetDiag() const { return m_serial.GetDiag(); }
+    Scalar GetSuper() const { return m_serial.GetSuper(); }
+    /** bytes held by the serial and block factorizations, the spikes and the reduced system **/
+    size_t GetBytes() const {
+      return m_serial.GetBytes() + m_partition.GetBytes() + m_ends.capacity() * sizeof(Pair);
+    }
+
+  private:
+    Eigen::Ref<Vector> Segment(Eigen::Ref<Vector>& rhs, int block) const {
+      return rhs.segment(m_partition.BlockStart(block), m_partition.BlockLength(block));
+    }
+
+    int m_numThreads = 0;
+    int m_threshold = PARALLEL_TRIDIAGONAL_THRESHOLD;
+    int m_numPartitions = 1;
+    TridiagonalSolver<Scalar> m_serial;
+    SpikePartition<Scalar> m_partition;
+    mutable vector<Pair> m_ends;
+    shared_ptr<WorkerPool> m_workers, m_sharedWorkers;
+  };
+
+  /**
+   * @brief CyclicTridiagonalSolver solves the periodic variant of the constant coefficient
+   * systems, where the first unknown also couples to the last one through the sub diagonal and
+   * the last unknown to the first one through the super diagonal. The two corner entries are a
+   * rank two update of the plain tridiagonal operator T, so the system is solved with the
+   * Sherman-Morrison-Woodbury formula
+   *
+   *   x = y - Z (I + V^T Z)^-1 V^T y,  y = T^-1 d,  Z = T^-1 [e_1, e_n]
+   *
+   * Z and the 2x2 capacitance matrix only depend on the coefficients and are computed once by
+   * Factorize, so every solve costs one (possibly partitioned) tridiagonal solve and two axpys.
+   *
+   * @tparam Scalar : scalar type of the system (typically complex<double>)
+   */
+  template <typename Scalar> class CyclicTridiagonalSolver {
+  public:
+    using Vector = typename TridiagonalSolver<Scalar>::Vector;
+    using Block = Eigen::Matrix<Scalar, 2, 2>;
+    using Pair = Eigen::Matrix<Scalar, 2, 1>;
+
+    CyclicTridiagonalSolver() = default;
+
+    /**
+     * SetParallelism sets the number of threads used by the underlying tridiagonal solves
+     *
+     * @param  {int} numThreads : number of threads, 0 means one per hardware thread
+     * @param  {int} threshold  : minimum number of unknowns solved in parallel
+     */
+    void SetParallelism(int numThreads, int threshold = PARALLEL_TRIDIAGONAL_THRESHOLD) {
+      m_system.SetParallelism(numThreads, threshold);
+    }
+
+    /**
+     * SetWorkers solves the underlying tridiagonal systems on a shared pool
+     * @param  {shared_ptr<WorkerPool>} workers : pool to solve on, null for an own pool
+     */
+    void SetWorkers(shared_ptr<WorkerPool> workers) { m_system.SetWorkers(std::move(workers)); }
+
+    /**
+     * Factorize factorizes the tridiagonal part and precomputes the rank two correction
+     *
+     * @param  {int} size       : number of unknowns, at least 3
+     * @param  {Scalar} sub     : coefficient on the sub diagonal and the top right corner (a)
+     * @param  {Scalar} diag    : coefficient on the main diagonal (b)
+     * @param  {Scalar} super   : coefficient on the super diagonal and the bottom left corner (c)
+     */
+    void Factorize(int size, Scalar sub, Scalar diag, Scalar super) {
+      if (size < 3) throw invalid_argument("cyclic tridiagonal system needs at least 3 unknowns");
+
+      m_system.Factorize(size, sub, diag, super);
+      m_first = Vector::Zero(size);
+      m_last = Vector::Zero(size);
+      m_first[0] = Scalar(1);
+      m_last[size - 1] = Scalar(1);
+      m_system.Solve(m_first);
+      m_system.Solve(m_last);
+
+      // V^T = [sub e_n^T; super e_1^T]
+      Block capacitance;
+      capacitance << Scalar(1) + sub * m_first[size - 1], sub * m_last[size - 1],
+          super * m_first[0], Scalar(1) + super * m_last[0];
+      if (capacitance.determinant() == Scalar(0)) {
+        throw runtime_error("cyclic tridiagonal system is singular");
+      }
+      m_inverseCapacitance = capacitance.inverse();
+    }
+
+    /**
+     * Solve solves the factorized system in place
+     *
+     * @param  {Eigen::Ref<Vector>} rhs : right hand side on input, solution on output
+     */
+    void Solve(Eigen::Ref<Vector> rhs) const {
+      m_system.Solve(rhs);
+
+      const int last = GetSize() - 1;
+      const Pair coupling(GetSub() * rhs[last], GetSuper() * rhs[0]);
+      const Pair weights = m_inverseCapacitance * coupling;
+      rhs -= weights[0] * m_first + weights[1] * m_last;
+    }
+
+    /**
+     * Multiply computes y = T * x including the periodic corner entries
+     * @param  {Vector} x : vector to multiply
+     * @return {Vector}   : product of the cyclic operator and x
+     */
+    Vector Multiply(const Vector& x) const {
+      Vector y = m_system.Multiply(x);
+      y[0] += GetSub() * x[GetSize() - 1];
+      y[GetSize() - 1] += GetSuper() * x[0];
+      return y;
+    }
+
+    int GetSize() const { return m_system.GetSize(); }
+    int GetNumPartitions() const { return m_system.GetNumPartitions(); }
+    Scalar GetSub() const { return m_system.GetSub(); }
+    Scalar GetDiag() const { return m_system.GetDiag(); }
+    Scalar GetSuper() const { return m_system.GetSuper(); }
+    /** bytes held by the tridiagonal factorization and the rank two correction **/
+    size_t GetBytes() const {
+      const Eigen::Index corrections = m_first.size() + m_last.size();
+      return m_system.GetBytes() + static_cast<size_t>(corrections) * sizeof(Scalar);
+    }
+
+  private:
+    PartitionedTridiagonalSolver<Scalar> m_system;
+    Vector m_first, m_last;
+    Block m_inverseCapacitance;
+  };
+}  // namespace CGLE
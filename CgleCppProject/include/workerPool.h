@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace CGLE {
+  /**
+   * @brief WorkerPool keeps a fixed set of worker threads alive between parallel sections, so
+   * code running a parallel section per time row (the partitioned tridiagonal solves, placed
+   * row blocks) does not create and join threads every time. Run() hands a task to every worker
+   * and blocks until all of them are done; the first exception thrown by a worker is rethrown on
+   * the calling thread.
+   *
+   * Runs are serialized, so copies of an object sharing a pool may use it from different threads.
+   * A Run() issued from inside a task of the same pool runs every worker's task inline on the
+   * calling thread instead of deadlocking. Pinned pools pin worker i to the CPU of placement
+   * worker i once, when it starts (see PinCurrentThread).
+   */
+  class WorkerPool {
+  public:
+    /**
+     * WorkerPool starts the worker threads
+     * @param  {int} numThreads  : number of workers, 0 means one per hardware thread
+     * @param  {bool} pinThreads : pin every worker to its own CPU, ordered by NUMA node
+     */
+    explicit WorkerPool(int numThreads = 0, bool pinThreads = false);
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    ~WorkerPool();
+
+    /**
+     * Run calls task(worker) once for every worker index, each on its own worker thread
+     * @param  {Task} task : callable taking the worker index
+     */
+    template <typename Task> void Run(const Task& task) {
+      auto invoke = [](const void* context, int worker) {
+        (*static_cast<const Task*>(context))(worker);
+      };
+      Dispatch(invoke, &task);
+    }
+
+    /**
+     * ParallelFor calls body(index) for every index in [0, count), split into contiguous blocks
+     * exactly like Helper::ParallelFor with GetNumThreads() threads
+     * @param  {int} count     : number of indices
+     * @param  {Function} body : callable taking the index
+     */
+    template <typename Function> void ParallelFor(int count, const Function& body) {
+      const int threads = min(GetNumThreads(), max(count, 1));
+      Run([&](int worker) {
+        if (worker >= threads) return;
+        const int begin = static_cast<int>(static_cast<long long>(count) * worker / threads);
+        const int end = static_cast<int>(static_cast<long long>(count) * (worker + 1) / threads);
+        for (int index = begin; index < end; index++) body(index);
+      });
+    }
+
+    int GetNumThreads() const { return static_cast<int>(m_threads.size()); }
+    bool IsPinned() const { return m_pinThreads; }
+
+  private:
+    using Invoker = void (*)(const void* context, int worker);
+
+    void Dispatch(Invoker invoke, const void* context);
+    void WorkerLoop(int worker);
+
+    mutex m_runMutex;
+    mutex m_mutex;
+    condition_variable m_wake, m_done;
+    Invoker m_invoke = nullptr;
+    const void* m_context = nullptr;
+    uint64_t m_generation = 0;
+    int m_pending = 0;
+    bool m_stop = false;
+    bool m_pinThreads = false;
+    vector<exception_ptr> m_errors;
+    vector<thread> m_threads;
+  };
+}  // namespace CGLE
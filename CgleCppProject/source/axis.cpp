@@ -0,0 +1,82 @@
+#include <axis.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+using namespace CGLE;
+
+Axis Axis::Linspace(double first, double last, int count) {
+  if (count < 0) throw invalid_argument("axis cannot have a negative number of points");
+
+  Axis axis;
+  axis.m_first = first;
+  axis.m_last = count == 1 ? first : last;
+  axis.m_intervals = count - 1;
+  return axis;
+}
+
+Axis Axis::Explicit(vector<double> points) {
+  Axis axis;
+  axis.m_uniform = false;
+  axis.m_points.assign(points.begin(), points.end());
+  return axis;
+}
+
+double Axis::At(int index) const {
+  if (index < 0 || index >= size()) throw out_of_range("axis index out of range");
+  return (*this)[index];
+}
+
+double Axis::GetStep() const {
+  if (size() < 2) return 0;
+  if (m_uniform) return (m_last - m_first) / m_intervals;
+  return m_points[1] - m_points[0];
+}
+
+vector<int> Axis::Find(double value) const {
+  vector<int> indices;
+  if (!m_uniform) {
+    for (size_t index = 0; index < m_points.size(); index++) {
+      if (m_points[index] == value) indices.push_back(static_cast<int>(index));
+    }
+    return indices;
+  }
+
+  if (size() == 0) return indices;
+  if (size() == 1 || m_first == m_last) {
+    if (m_first == value) {
+      for (int index = 0; index < size(); index++) indices.push_back(index);
+    }
+    return indices;
+  }
+
+  // the rounded candidate is exact up to one index either way
+  const double position = (value - m_first) / GetStep();
+  if (!(position > -2 && position < m_intervals + 2)) return indices;
+  const long long candidate = std::llround(position);
+  const long long last = min<long long>(m_intervals, candidate + 1);
+  for (long long index = max(0LL, candidate - 1); index <= last; index++) {
+    if ((*this)[static_cast<int>(index)] == value) indices.push_back(static_cast<int>(index));
+  }
+  return indices;
+}
+
+AxisRange Axis::Range(int begin, int end) const {
+  if (begin < 0 || end > size() || begin > end) throw out_of_range("axis range out of range");
+  return AxisRange{this, begin, end};
+}
+
+vector<AxisRange> Axis::Tiles(int tileSize) const {
+  if (tileSize <= 0) throw invalid_argument("tile size must be positive");
+
+  vector<AxisRange> tiles;
+  for (int begin = 0; begin < size(); begin += tileSize) {
+    tiles.push_back(AxisRange{this, begin, min(size(), begin + tileSize)});
+  }
+  return tiles;
+}
+
+vector<double> Axis::ToVector() const {
+  if (!m_uniform) return vector<double>(m_points.begin(), m_points.end());
+  return vector<double>(begin(), end());
+}
@@ -1,7 +1,9 @@
 #include <constraint.h>
 
-using namespace CGLE;
+#include <ostream>
 
-std::ostream& operator<<(std::ostream& o, Constraint const& constraint) {
-  return o << constraint.m_Alpha;
-}
\ No newline at end of file
+namespace CGLE {
+  std::ostream& operator<<(std::ostream& o, Constraint const& constraint) {
+    return o << constraint.m_Alpha;
+  }
+}  // namespace CGLE
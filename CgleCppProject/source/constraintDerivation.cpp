@@ -0,0 +1,285 @@
+#include <constraintDerivation.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+using namespace CGLE;
+
+namespace {
+  using cd = complex<double>;
+
+  // L used by the cases whose Gamma terms are scaled by 1 / L^2 at a finite L
+  const double SCALED_L = 1e-2 * 0.2;
+  // L used by the cases that are effectively unscaled
+  const double UNSCALED_L = 1e-150;
+
+  ConstraintInputs Metadata(const string& waveType, int caseType, int version) {
+    ConstraintInputs inputs;
+    inputs.waveType = waveType;
+    inputs.caseType = caseType;
+    inputs.version = version;
+    return inputs;
+  }
+
+  ConstraintInputs BrightBright(int caseType, int version) {
+    ConstraintInputs inputs = Metadata(BRIGHT_BRIGHT, caseType, version);
+    if (caseType == 1) {
+      inputs.startTime = 0;
+      inputs.endTime = 3;
+      inputs.startPosition = -8;
+      inputs.endPosition = 2;
+
+      inputs.L = SCALED_L;
+      inputs.k1 = cd(1.0417810279445396, 0.5295590088750854);
+      inputs.W1 = cd(3.5000000000000036, 2.2563808753624817);
+      inputs.eta = 17.364923362962905;
+      inputs.mu = 52.094770088888716;
+      inputs.beta = 1.0458028182282497;
+      inputs.alpha = 1.31454380654842;
+      inputs.q2r = -0.7291666666666667;
+      inputs.gamma1Scaled = cd(6.511613080797135, 1.75);
+      inputs.gamma1PrimeScaled = cd(4.797919755978034, -2.9166666666666667);
+
+      inputs.p1 = cd(2, 1);
+      inputs.p1Prime = cd(3, -2.5);
+      inputs.q1 = cd(1, -2.4);
+      inputs.q2 = cd(-0.7291666666666667, 1.75);
+      inputs.q1Prime = cd(0.6, -3);
+      inputs.q2Prime = cd(-0.5, 2.25);
+    } else {
+      inputs.startTime = 0;
+      inputs.endTime = 40;
+      inputs.startPosition = -50;
+      inputs.endPosition = 50;
+
+      inputs.L = UNSCALED_L;
+      inputs.k1 = cd(0.01283462537560516, 0.9911184493673615);
+      inputs.W1 = cd(0, -3.4698625394455194);
+      inputs.eta = 178.03586557962788;
+      inputs.mu = 247.320185920484;
+      inputs.beta = 8.748507371478683;
+      inputs.alpha = -8.657221966458971;
+      inputs.q2r = 0;
+      // the MATLAB expression -1.75 + (1i * 0) / L^2 only scales the (zero) imaginary part
+      inputs.gamma1 = cd(-1.75, 0);
+      inputs.gamma1Prime = cd(-6.1599157711868955, 0);
+
+      inputs.p1 = cd(3, 2.5);
+      inputs.p1Prime = cd(2, 6.817101079155266);
+      inputs.q1 = cd(-1, 2.4);
+      inputs.q2 = cd(0, -1.75);
+      inputs.q1Prime = cd(0.6, -3);
+      inputs.q2Prime = cd(-0.5, 2.065);
+    }
+    return inputs;
+  }
+
+  ConstraintInputs DarkDark(int caseType, int version) {
+    ConstraintInputs inputs = Metadata(DARK_DARK, caseType, version);
+    inputs.L = UNSCALED_L;
+    inputs.p1 = cd(2, 0);
+    inputs.p1Prime = cd(3, 0);
+    inputs.q1 = cd(1, 2.4);
+    inputs.q1Prime = cd(0.6, -3);
+    inputs.q2r = -1.25;
+    inputs.q2 = cd(-1.25, 1.75);
+    inputs.gamma1Scaled = cd(1.5, 1.75);
+
+    if (caseType == 1) {
+      inputs.startTime = 0;
+      inputs.endTime = 3;
+      inputs.startPosition = -10;
+      inputs.endPosition = 35;
+
+      inputs.beta = 1.7451982704913325;
+      inputs.alpha = -2.144007467651334;
+      inputs.eta = 0.6178480071311616;
+      inputs.mu = 0.009808447362978197;
+      inputs.omega1 = 10.144412552072561;
+      inputs.omega2 = 21.083022658796274;
+      inputs.gamma1PrimeScaled = cd(-1.8314750148267838, 1.25);
+      inputs.q2Prime = cd(-0.5, 2.25);
+
+      inputs.k1 = sqrt(0.11660407147455695);
+      inputs.K1 = 2.5;
+      inputs.K2 = 2.750686413691043;
+      inputs.W1 = -4.414733832593061;
+    } else {
+      // the MATLAB table starts at x = -0.05, positions are stored as integers
+      inputs.startTime = 0;
+      inputs.endTime = 1;
+      inputs.startPosition = 0;
+      inputs.endPosition = 0;
+
+      inputs.k1 = sqrt(153.26683828438394);
+      inputs.K1 = 5;
+      inputs.K2 = 21.6248760069397;
+      inputs.eta = 0.6191867854483949;
+      inputs.mu = 0.00797240852791569;
+      inputs.beta = 1.7456832294800957;
+      inputs.alpha = -2.1490753463338934;
+      inputs.W1 = -7.821410399458799;
+      inputs.omega1 = 47.640778725211504;
+      inputs.omega2 = 56.92452128936377;
+      inputs.gamma1PrimeScaled = cd(-4.598004125481732e-7, 1.25);
+      inputs.q2Prime = cd(-0.75, 3.75);
+    }
+    return inputs;
+  }
+
+  ConstraintInputs FrontFront(int caseType, int version) {
+    ConstraintInputs inputs = Metadata(FRONT_FRONT, caseType, version);
+    inputs.gamma1Scaled = cd(1.5, 1.75);
+
+    if (caseType == 1) {
+      inputs.startTime = 0;
+      inputs.endTime = 3;
+      inputs.startPosition = -70;
+      inputs.endPosition = 70;
+
+      inputs.L = SCALED_L;
+      inputs.alpha = 0.1781479115112448;
+      inputs.beta = -1.414213562373095;
+      inputs.q2r = -3.5751561628522968;
+      inputs.q2 = cd(-3.5751561628522968, 8.580374790845513);
+      inputs.q1Prime = cd(-0.209781046152021, 1.048905230760105);
+      inputs.k1 = sqrt(0.10049293010631864);
+      inputs.K1 = 0.04890336489571538;
+      inputs.K2 = 0.5683582642314903;
+      inputs.eta = 0.60971484582254;
+      inputs.mu = 0.17054215761476085;
+      inputs.omega1 = -1.135502075981213;
+      inputs.omega2 = -0.23827111103561216;
+      inputs.W1 = -1.567689709658571;
+      inputs.p1 = cd(2, -15.339230729988305);
+      inputs.p1Prime = cd(3, 0.6);
+      inputs.q1 = cd(-1, 2.4);
+      inputs.gamma1PrimeScaled = cd(0.019359027106311898, 1.25);
+      inputs.q2Prime = cd(-0.75, 3.75);
+    } else {
+      inputs.startTime = 0;
+      inputs.endTime = 2;
+      inputs.startPosition = -2;
+      inputs.endPosition = 2;
+
+      inputs.L = UNSCALED_L;
+      inputs.alpha = 0.08187621570341645;
+      inputs.beta = -2.091133922898288;
+      inputs.q2r = -0.12438483609473883;
+      inputs.q2 = cd(-0.12438483609473883, 0.21323114759098083);
+      inputs.q1Prime = cd(-2.813847820914596, 3.376617385097515);
+      inputs.k1 = sqrt(579980.8016216066);
+      inputs.K1 = 194.6279677165143;
+      inputs.K2 = -581.0420874804896;
+      inputs.eta = 1.1691069333364856;
+      inputs.omega1 = -0.8899570962652534;
+      inputs.omega2 = -0.3108984400357673;
+      inputs.W1 = -1.7601156501386148;
+      inputs.mu = 6.579377993570032;
+      inputs.p1 = cd(0.0000011, -2.56260724878725e-6);
+      inputs.p1Prime = cd(0.0000013, 0.0000023);
+      inputs.q1 = cd(-0.7, 1.2);
+      inputs.gamma1PrimeScaled = cd(1.5944612214966543, 1.25);
+      inputs.q2Prime = cd(-0.5, 0.6);
+    }
+    return inputs;
+  }
+}  // namespace
+
+ConstraintInputs CGLE::GetConstraintInputs(const string& waveType, int caseType, int version) {
+  if (version != 2) throw invalid_argument("only version 2 constraints are defined");
+  if (caseType != 1 && caseType != 2) throw invalid_argument("case type must be 1 or 2");
+
+  if (waveType == BRIGHT_BRIGHT) return BrightBright(caseType, version);
+  if (waveType == DARK_DARK) return DarkDark(caseType, version);
+  if (waveType == FRONT_FRONT) return FrontFront(caseType, version);
+  throw invalid_argument("unknown wave type " + waveType);
+}
+
+Constraint CGLE::DeriveConstraint(const ConstraintInputs& inputs) {
+  ConstraintBatch batch(inputs, 1);
+  batch.Derive();
+  return batch.At(0);
+}
+
+Constraint CGLE::ComputeConstraints(const string& waveType, int caseType, int version) {
+  return DeriveConstraint(GetConstraintInputs(waveType, caseType, version));
+}
+
+ConstraintBatch::ConstraintBatch(const ConstraintInputs& base, Eigen::Index size) {
+  Broadcast(base, size);
+}
+
+void ConstraintBatch::Broadcast(const ConstraintInputs& base, Eigen::Index size) {
+  if (size < 0) throw invalid_argument("batch size cannot be negative");
+
+  m_CaseType = base.caseType;
+  m_CaseLetter = base.caseLetter;
+  m_WaveType = base.waveType;
+  m_Version = base.version;
+  m_StartTime = base.startTime;
+  m_EndTime = base.endTime;
+  m_StartPosition = base.startPosition;
+  m_EndPosition = base.endPosition;
+
+  m_L.setConstant(size, base.L);
+  m_k1.setConstant(size, base.k1);
+  m_K1.setConstant(size, base.K1);
+  m_K2.setConstant(size, base.K2);
+  m_W1.setConstant(size, base.W1);
+  m_Eta.setConstant(size, base.eta);
+  m_Mu.setConstant(size, base.mu);
+  m_Omega1.setConstant(size, base.omega1);
+  m_Omega2.setConstant(size, base.omega2);
+  m_Beta.setConstant(size, base.beta);
+  m_Alpha.setConstant(size, base.alpha);
+  m_Q2r.setConstant(size, base.q2r);
+  m_Gamma1Unscaled.setConstant(size, base.gamma1);
+  m_Gamma1Scaled.setConstant(size, base.gamma1Scaled);
+  m_Gamma1PrimeUnscaled.setConstant(size, base.gamma1Prime);
+  m_Gamma1PrimeScaled.setConstant(size, base.gamma1PrimeScaled);
+  m_P1.setConstant(size, base.p1);
+  m_P1Prime.setConstant(size, base.p1Prime);
+  m_Q1.setConstant(size, base.q1);
+  m_Q2.setConstant(size, base.q2);
+  m_Q1Prime.setConstant(size, base.q1Prime);
+  m_Q2Prime.setConstant(size, base.q2Prime);
+
+  m_Gamma1.resize(0);
+  m_Gamma1Prime.resize(0);
+  m_Valid.resize(0);
+}
+
+void ConstraintBatch::Derive() {
+  // the scaled parts are multiplied by the real 1 / L^2, never divided by a complex L^2
+  const RealArray inverseL2 = m_L.square().inverse();
+  m_Gamma1 = m_Gamma1Unscaled + m_Gamma1Scaled * inverseL2;
+  m_Gamma1Prime = m_Gamma1PrimeUnscaled + m_Gamma1PrimeScaled * inverseL2;
+  m_Valid = (m_L > 0) && m_Gamma1.isFinite() && m_Gamma1Prime.isFinite();
+}
+
+Constraint ConstraintBatch::At(Eigen::Index index) const {
+  if (index < 0 || index >= GetSize()) throw out_of_range("parameter set index out of range");
+  if (m_Gamma1.size() != GetSize()) throw runtime_error("batch must be derived before use");
+
+  return Constraint(m_CaseType, m_CaseLetter, m_WaveType, m_Version, m_StartTime, m_EndTime,
+                    m_StartPosition, m_EndPosition, m_L[index], m_k1[index], m_K1[index],
+                    m_K2[index], m_W1[index], m_Eta[index], m_Mu[index], m_Omega1[index],
+                    m_Omega2[index], m_Beta[index], m_Alpha[index], m_Q2r[index], m_Gamma1[index],
+                    m_Gamma1Prime[index], m_P1[index], m_P1Prime[index], m_Q1[index], m_Q2[index],
+                    m_Q1Prime[index], m_Q2Prime[index]);
+}
+
+void ConstraintBatch::Generate(const ConstraintInputs& base, long long count,
+                               Eigen::Index batchSize, const Fill& fill, const Consume& consume) {
+  if (count < 0) throw invalid_argument("number of parameter sets cannot be negative");
+  if (batchSize <= 0) throw invalid_argument("batch size must be positive");
+
+  ConstraintBatch batch;
+  for (long long offset = 0; offset < count; offset += batchSize) {
+    batch.Broadcast(base, static_cast<Eigen::Index>(min<long long>(batchSize, count - offset)));
+    if (fill) fill(batch, offset);
+    batch.Derive();
+    consume(batch, offset);
+  }
+}
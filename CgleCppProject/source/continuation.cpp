@@ -0,0 +1,161 @@
+#include <continuation.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+using namespace CGLE;
+
+namespace {
+  /** CoarsenAxis keeps the extent of an axis with (n - 1) / factor + 1 of its points **/
+  Axis CoarsenAxis(const Axis& axis, int factor) {
+    const int size = axis.size();
+    const int count = (size - 1) / factor + 1;
+    if (count < 3) throw invalid_argument("grid is too small to coarsen");
+    if (axis.IsUniform()) return Axis::Linspace(axis[0], axis[size - 1], count);
+
+    vector<double> points;
+    points.reserve(static_cast<size_t>(count));
+    for (int point = 0; point < count; point++) points.push_back(axis[point * factor]);
+    points.back() = axis[size - 1];
+    return Axis::Explicit(std::move(points));
+  }
+
+  /** WithoutLastTime drops the last time point of a grid, the row the march never computes **/
+  GridDetails WithoutLastTime(const GridDetails& details) {
+    vector<double> times = details.GetTimeAxis().ToVector();
+    times.pop_back();
+    return GridDetails(details.GetXAxis(), Axis::Explicit(std::move(times)));
+  }
+
+  /**
+   * InteriorDifference measures a solved field against an interpolated one over the interior
+   *
+   * @param  {FieldMatrix} solved       : solved field
+   * @param  {FieldMatrix} interpolated : previous level interpolated onto the same grid
+   * @param  {double} relativeL2        : receives ||solved - interpolated|| / ||solved||
+   * @param  {double} linf              : receives max |solved - interpolated|
+   */
+  template <typename FieldMatrix>
+  void InteriorDifference(const FieldMatrix& solved, const FieldMatrix& interpolated,
+                          double& relativeL2, double& linf) {
+    double difference = 0;
+    double reference = 0;
+    linf = 0;
+    for (Eigen::Index col = 1; col + 1 < solved.cols(); col++) {
+      for (Eigen::Index row = 1; row + 1 < solved.rows(); row++) {
+        const complex<double> value(solved(row, col));
+        const double error = std::abs(value - complex<double>(interpolated(row, col)));
+        difference += error * error;
+        reference += std::norm(value);
+        linf = max(linf, error);
+      }
+    }
+    relativeL2 = reference > 0 ? std::sqrt(difference / reference) : 0;
+  }
+}  // namespace
+
+GridResampler::GridResampler(const GridDetails& source, const GridDetails& target)
+    : m_positions(BuildBrackets(source.GetXAxis(), target.GetXAxis())),
+      m_times(BuildBrackets(source.GetTimeAxis(), target.GetTimeAxis())),
+      m_numSourcePositions(source.GetXAxis().size()),
+      m_numSourceTimes(source.GetTimeAxis().size()) {}
+
+vector<GridResampler::Bracket> GridResampler::BuildBrackets(const Axis& source,
+                                                            const Axis& target) {
+  if (source.empty()) throw invalid_argument("source axis is empty");
+
+  const vector<double> points = source.ToVector();
+  vector<Bracket> brackets(static_cast<size_t>(target.size()));
+  for (int point = 0; point < target.size(); point++) {
+    const double value = target[point];
+    Bracket& bracket = brackets[static_cast<size_t>(point)];
+    if (value <= points.front()) continue;
+    if (value >= points.back()) {
+      bracket.index = static_cast<int>(points.size()) - 1;
+      continue;
+    }
+    // points[index] <= value < points[index + 1], so repeated points are never bracketed
+    const auto after = upper_bound(points.begin(), points.end(), value);
+    bracket.index = static_cast<int>(after - points.begin()) - 1;
+    bracket.weight = (value - *(after - 1)) / (*after - *(after - 1));
+  }
+  return brackets;
+}
+
+GridDetails CGLE::CoarsenGridDetails(const GridDetails& details, int factor) {
+  if (factor < 2) throw invalid_argument("coarsening factor must be at least 2");
+  return GridDetails(CoarsenAxis(details.GetXAxis(), factor),
+                     CoarsenAxis(details.GetTimeAxis(), factor));
+}
+
+template <typename Policy>
+Continuation<Policy>::Continuation(const Constraint& constraint, const GridDetails& target)
+    : m_constraint(constraint), m_target(target) {}
+
+template <typename Policy>
+ContinuationResult Continuation<Policy>::Run(const ContinuationOptions& options) {
+  if (options.numLevels < 1) throw invalid_argument("a continuation needs at least one level");
+  if (options.refinement < 2) throw invalid_argument("refinement must be at least 2");
+  if (options.warmStart && options.scheme != StepScheme::NewtonKrylov) {
+    throw invalid_argument("warm starts need the NewtonKrylov scheme");
+  }
+
+  vector<GridDetails> grids{m_target};
+  for (int level = 1; level < options.numLevels; level++) {
+    grids.insert(grids.begin(), CoarsenGridDetails(grids.front(), options.refinement));
+  }
+
+  ContinuationResult result;
+  unique_ptr<BasicGrid<Policy>> previous;
+  FieldMatrix interpolatedA, interpolatedB;
+  for (size_t level = 0; level < grids.size(); level++) {
+    const GridDetails& details = grids[level];
+    const auto start = chrono::steady_clock::now();
+    auto grid = make_unique<BasicGrid<Policy>>(m_constraint, details);
+    mt19937_64 engine(options.seed);
+    grid->PerturbGrid(options.pertubationCoefficient, engine);
+
+    FieldMatrix& fieldA = grid->GetPerturbedA();
+    FieldMatrix& fieldB = grid->GetPerturbedB();
+    if (previous) {
+      // the previous level's last row is zero, it is left out rather than interpolated towards
+      const GridResampler resampler(WithoutLastTime(grids[level - 1]), details);
+      const Eigen::Index computedRows = previous->GetPerturbedA().cols() - 1;
+      resampler.Resample(previous->GetPerturbedA().leftCols(computedRows), interpolatedA,
+                         options.numThreads);
+      resampler.Resample(previous->GetPerturbedB().leftCols(computedRows), interpolatedB,
+                         options.numThreads);
+    }
+
+    StabilitySolver<Policy> solver(m_constraint, details);
+    solver.SetBoundaryCondition(options.boundaryCondition);
+    solver.SetNumThreads(options.numThreads);
+    solver.SetStepScheme(options.scheme);
+    if (previous && options.warmStart) solver.SetInitialIterate(&interpolatedA, &interpolatedB);
+    solver.Solve(*grid);
+
+    ContinuationLevel record;
+    record.numPositions = static_cast<int>(fieldA.rows());
+    record.numTimes = static_cast<int>(fieldA.cols());
+    record.newtonIterations = solver.GetNewtonKrylovReport().newtonIterations;
+    if (previous) {
+      InteriorDifference(fieldA, interpolatedA, record.relativeL2A, record.linfA);
+      InteriorDifference(fieldB, interpolatedB, record.relativeL2B, record.linfB);
+    }
+    record.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    result.levels.push_back(record);
+    previous = std::move(grid);
+  }
+  m_grid = std::move(previous);
+  return result;
+}
+
+template <typename Policy> const BasicGrid<Policy>& Continuation<Policy>::GetGrid() const {
+  if (!m_grid) throw runtime_error("the continuation has not run yet");
+  return *m_grid;
+}
+
+template class CGLE::Continuation<MixedPrecision>;
+template class CGLE::Continuation<DoublePrecision>;
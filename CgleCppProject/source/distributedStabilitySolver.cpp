@@ -0,0 +1,277 @@
+#include <distributedStabilitySolver.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+using namespace CGLE;
+
+DomainDecomposition DomainDecomposition::Split(int numPositions, BoundaryCondition boundary,
+                                               int rank, int size) {
+  if (size < 1 || rank < 0 || rank >= size) throw invalid_argument("rank out of range");
+
+  const bool periodic = boundary == BoundaryCondition::Periodic;
+  const int numUnknowns = periodic ? numPositions : numPositions - 2;
+  if (numPositions < 3 || numUnknowns < 2 * size) {
+    throw invalid_argument("every rank needs at least two unknown positions");
+  }
+
+  // same split as SpikePartition: the first (numUnknowns % size) ranks hold one more unknown
+  const int blockSize = numUnknowns / size;
+  const int numLarge = numUnknowns % size;
+  DomainDecomposition decomposition;
+  decomposition.numPositions = numPositions;
+  decomposition.rank = rank;
+  decomposition.size = size;
+  decomposition.boundary = boundary;
+  decomposition.numLocalUnknowns = blockSize + (rank < numLarge ? 1 : 0);
+  decomposition.firstPosition = (periodic ? 0 : 1) + rank * blockSize + min(rank, numLarge);
+  decomposition.numLocalPositions = decomposition.numLocalUnknowns;
+
+  // the Dirichlet boundary positions go to the ranks at both ends
+  if (!periodic && rank == 0) {
+    decomposition.firstPosition--;
+    decomposition.numLocalPositions++;
+    decomposition.firstLocalUnknown = 1;
+  }
+  if (!periodic && rank == size - 1) decomposition.numLocalPositions++;
+  return decomposition;
+}
+
+int DomainDecomposition::GetLeftNeighbour() const {
+  if (rank > 0) return rank - 1;
+  return boundary == BoundaryCondition::Periodic ? size - 1 : NO_RANK;
+}
+
+int DomainDecomposition::GetRightNeighbour() const {
+  if (rank + 1 < size) return rank + 1;
+  return boundary == BoundaryCondition::Periodic ? 0 : NO_RANK;
+}
+
+template <typename Policy>
+DistributedStabilitySolver<Policy>::DistributedStabilitySolver(const Constraint& constraint,
+                                                               const GridDetails& details,
+                                                               DomainCommunicator& communicator)
+    : m_communicator(&communicator),
+      m_systemA(communicator),
+      m_systemB(communicator),
+      m_cyclicA(communicator),
+      m_cyclicB(communicator) {
+  const double dx = details.GetDx();
+  const double dt = details.GetDt();
+  if (dx <= 0 || dt <= 0) throw invalid_argument("grid spacing must be positive");
+
+  m_coeffA = Coefficients::Create(constraint.m_P1, constraint.m_Gamma1, constraint.m_Q1,
+                                  constraint.m_Q2, dx, dt);
+  m_coeffB = Coefficients::Create(constraint.m_P1Prime, constraint.m_Gamma1Prime,
+                                  constraint.m_Q1Prime, constraint.m_Q2Prime, dx, dt);
+}
+
+template <typename Policy>
+void DistributedStabilitySolver<Policy>::SetBoundaryCondition(BoundaryCondition boundary) {
+  if (boundary == m_boundary) return;
+
+  m_boundary = boundary;
+  m_numUnknowns = 0;
+}
+
+template <typename Policy>
+DomainDecomposition DistributedStabilitySolver<Policy>::GetDecomposition(int numPositions) const {
+  return DomainDecomposition::Split(numPositions, m_boundary, m_communicator->GetRank(),
+                                    m_communicator->GetSize());
+}
+
+template <typename Policy> void DistributedStabilitySolver<Policy>::Solve(BasicGrid<Policy>& grid) {
+  FieldMatrix& fieldA = grid.GetPerturbedA();
+  FieldMatrix& fieldB = grid.GetPerturbedB();
+  const int numPositions = static_cast<int>(fieldA.rows());
+  const int numTimes = static_cast<int>(fieldA.cols());
+  const DomainDecomposition local = GetDecomposition(numPositions);
+
+  FieldMatrix localA = fieldA.middleRows(local.firstPosition, local.numLocalPositions);
+  FieldMatrix localB = fieldB.middleRows(local.firstPosition, local.numLocalPositions);
+  Solve(localA, localB, numPositions);
+
+  // ranks hold different numbers of rows, every block is padded to the largest one
+  const int size = m_communicator->GetSize();
+  int maxRows = 0;
+  for (int rank = 0; rank < size; rank++) {
+    const DomainDecomposition other = DomainDecomposition::Split(numPositions, m_boundary, rank,
+                                                                 size);
+    maxRows = max(maxRows, other.numLocalPositions);
+  }
+  const size_t blockElements = static_cast<size_t>(maxRows) * static_cast<size_t>(numTimes);
+  FieldMatrix padded = FieldMatrix::Zero(maxRows, numTimes);
+  vector<StorageComplex> gathered(blockElements * static_cast<size_t>(size));
+  for (auto field : {make_pair(&localA, &fieldA), make_pair(&localB, &fieldB)}) {
+    padded.topRows(local.numLocalPositions) = *field.first;
+    m_communicator->AllGather(padded.data(), blockElements * sizeof(StorageComplex),
+                              gathered.data());
+    for (int rank = 0; rank < size; rank++) {
+      const DomainDecomposition other = DomainDecomposition::Split(numPositions, m_boundary, rank,
+                                                                   size);
+      Eigen::Map<const FieldMatrix> block(gathered.data() + rank * blockElements, maxRows,
+                                          numTimes);
+      field.second->middleRows(other.firstPosition, other.numLocalPositions)
+          = block.topRows(other.numLocalPositions);
+    }
+  }
+}
+
+template <typename Policy>
+void DistributedStabilitySolver<Policy>::GatherRows(const Eigen::Ref<const FieldMatrix>& local,
+                                                    int numPositions, FieldMatrix& field,
+                                                    int root) const {
+  const int size = m_communicator->GetSize();
+  if (root < 0 || root >= size) throw invalid_argument("rank out of range");
+  const DomainDecomposition decomposition = GetDecomposition(numPositions);
+  if (local.rows() != decomposition.numLocalPositions) {
+    throw invalid_argument("local field does not match the positions of the rank");
+  }
+
+  // blocks travel point to point, so no rank but the root ever holds more than its own rows
+  const FieldMatrix block = local;
+  auto bytesOf = [](const FieldMatrix& matrix) {
+    return static_cast<size_t>(matrix.size()) * sizeof(StorageComplex);
+  };
+  if (decomposition.rank != root) {
+    m_communicator->SendReceive(block.data(), bytesOf(block), root, nullptr, NO_RANK);
+    return;
+  }
+
+  field.resize(numPositions, block.cols());
+  for (int rank = 0; rank < size; rank++) {
+    const DomainDecomposition other = DomainDecomposition::Split(numPositions, m_boundary, rank,
+                                                                 size);
+    auto rows = field.middleRows(other.firstPosition, other.numLocalPositions);
+    if (rank == root) {
+      rows = block;
+      continue;
+    }
+    FieldMatrix received(other.numLocalPositions, block.cols());
+    m_communicator->SendReceive(nullptr, bytesOf(received), NO_RANK, received.data(), rank);
+    rows = received;
+  }
+}
+
+template <typename Policy>
+void DistributedStabilitySolver<Policy>::Solve(Eigen::Ref<FieldMatrix> localA,
+                                               Eigen::Ref<FieldMatrix> localB, int numPositions) {
+  if (localA.rows() != localB.rows() || localA.cols() != localB.cols()) {
+    throw invalid_argument("A and B fields must have identical dimensions");
+  }
+  const int numTimes = static_cast<int>(localA.cols());
+  if (numTimes < 2) throw invalid_argument("grid must have at least 2 time points");
+
+  const DomainDecomposition local = GetDecomposition(numPositions);
+  if (localA.rows() != local.numLocalPositions) {
+    throw invalid_argument("local fields do not match the positions of the rank");
+  }
+
+  auto zeroNaN = [](StorageComplex& value) {
+    if (std::isnan(value.real()) || std::isnan(value.imag())) value = StorageComplex(0, 0);
+  };
+  for (int timeIndex = 0; timeIndex < numTimes; timeIndex++) {
+    for (int row = 0; row < local.numLocalPositions; row++) {
+      zeroNaN(localA(row, timeIndex));
+      zeroNaN(localB(row, timeIndex));
+    }
+  }
+
+  const bool periodic = m_boundary == BoundaryCondition::Periodic;
+  if (!periodic && local.GetLeftNeighbour() == NO_RANK) {
+    localA.row(0).setZero();
+    localB.row(0).setZero();
+  }
+  if (!periodic && local.GetRightNeighbour() == NO_RANK) {
+    localA.row(local.numLocalPositions - 1).setZero();
+    localB.row(local.numLocalPositions - 1).setZero();
+  }
+
+  Factorize(periodic ? numPositions : numPositions - 2);
+
+  // the first time point is the initial condition and the last one the boundary condition
+  for (int timeIndex = 1; timeIndex < numTimes - 1; timeIndex++) {
+    StorageComplex left[2] = {}, right[2] = {};
+    ExchangeHalo(local, localA, localB, timeIndex, left, right);
+
+    auto at = [&](const Eigen::Ref<FieldMatrix>& field, int which, int row, int time) {
+      if (row < 0) return Policy::ToAccumulator(left[which]);
+      if (row >= local.numLocalPositions) return Policy::ToAccumulator(right[which]);
+      return Policy::ToAccumulator(field(row, time));
+    };
+    const bool hasLater = timeIndex + 1 < numTimes - 2;
+    auto compute = [&](const Coefficients& coeff, const Eigen::Ref<FieldMatrix>& self, int which,
+                       int row) {
+      return coeff.RightHandSide(
+          at(self, which, row - 1, timeIndex), at(self, which, row, timeIndex),
+          at(self, which, row + 1, timeIndex), at(localA, 0, row, timeIndex),
+          at(localB, 1, row, timeIndex), at(localA, 0, row + 1, timeIndex),
+          at(localB, 1, row + 1, timeIndex), at(self, which, row, timeIndex - 1),
+          hasLater ? at(self, which, row, timeIndex + 1) : AccumulatorComplex(), hasLater);
+    };
+
+    for (int unknown = 0; unknown < local.numLocalUnknowns; unknown++) {
+      const int row = local.firstLocalUnknown + unknown;
+      m_da[unknown] = compute(m_coeffA, localA, 0, row);
+      m_db[unknown] = compute(m_coeffB, localB, 1, row);
+    }
+
+    if (periodic) {
+      m_cyclicA.Solve(m_da);
+      m_cyclicB.Solve(m_db);
+    } else {
+      m_systemA.Solve(m_da);
+      m_systemB.Solve(m_db);
+    }
+
+    for (int unknown = 0; unknown < local.numLocalUnknowns; unknown++) {
+      localA(local.firstLocalUnknown + unknown, timeIndex) = Policy::ToStorage(m_da[unknown]);
+      localB(local.firstLocalUnknown + unknown, timeIndex) = Policy::ToStorage(m_db[unknown]);
+    }
+  }
+
+  // the last time row is never computed by the march and is reported as zero
+  localA.col(numTimes - 1).setZero();
+  localB.col(numTimes - 1).setZero();
+}
+
+template <typename Policy>
+void DistributedStabilitySolver<Policy>::ExchangeHalo(const DomainDecomposition& decomposition,
+                                                      const Eigen::Ref<FieldMatrix>& localA,
+                                                      const Eigen::Ref<FieldMatrix>& localB,
+                                                      int timeIndex, StorageComplex (&left)[2],
+                                                      StorageComplex (&right)[2]) {
+  const int last = decomposition.numLocalPositions - 1;
+  const StorageComplex firstRow[2] = {localA(0, timeIndex), localB(0, timeIndex)};
+  const StorageComplex lastRow[2] = {localA(last, timeIndex), localB(last, timeIndex)};
+  const int leftRank = decomposition.GetLeftNeighbour();
+  const int rightRank = decomposition.GetRightNeighbour();
+
+  // first rows travel left while the right halo arrives, then last rows travel right
+  m_communicator->SendReceive(firstRow, sizeof(firstRow), leftRank, right, rightRank);
+  m_communicator->SendReceive(lastRow, sizeof(lastRow), rightRank, left, leftRank);
+}
+
+template <typename Policy> void DistributedStabilitySolver<Policy>::Factorize(int numUnknowns) {
+  if (m_numUnknowns == numUnknowns) return;
+
+  int numLocalUnknowns = 0;
+  if (m_boundary == BoundaryCondition::Periodic) {
+    m_cyclicA.Factorize(numUnknowns, m_coeffA.a, m_coeffA.b, m_coeffA.c);
+    m_cyclicB.Factorize(numUnknowns, m_coeffB.a, m_coeffB.b, m_coeffB.c);
+    numLocalUnknowns = m_cyclicA.GetLocalSize();
+  } else {
+    m_systemA.Factorize(numUnknowns, m_coeffA.a, m_coeffA.b, m_coeffA.c);
+    m_systemB.Factorize(numUnknowns, m_coeffB.a, m_coeffB.b, m_coeffB.c);
+    numLocalUnknowns = m_systemA.GetLocalSize();
+  }
+  m_da.resize(numLocalUnknowns);
+  m_db.resize(numLocalUnknowns);
+  m_numUnknowns = numUnknowns;
+  m_charge.Update(m_systemA.GetBytes() + m_systemB.GetBytes() + m_cyclicA.GetBytes()
+                  + m_cyclicB.GetBytes()
+                  + 2 * static_cast<size_t>(numLocalUnknowns) * sizeof(AccumulatorComplex));
+}
+
+template class CGLE::DistributedStabilitySolver<MixedPrecision>;
+template class CGLE::DistributedStabilitySolver<DoublePrecision>;
@@ -0,0 +1,166 @@
+#include <domainDecomposition.h>
+
+#include <climits>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <utility>
+using namespace CGLE;
+
+/**
+ * State is shared by the ranks of a LocalCommunicatorGroup. Point to point messages are queued
+ * per (source, destination) pair. Gathers run in generations: the last rank to arrive builds the
+ * result, and the next gather only starts once every rank has copied it out.
+ */
+struct LocalCommunicatorGroup::State {
+  explicit State(int size) : size(size), slots(size) {}
+
+  const int size;
+  mutex lock;
+  condition_variable changed;
+  map<pair<int, int>, deque<vector<char>>> mailboxes;
+
+  vector<vector<char>> slots;
+  vector<char> gathered;
+  int arrived = 0;
+  int departed = 0;
+  bool draining = false;
+  size_t generation = 0;
+};
+
+class LocalCommunicatorGroup::Communicator : public DomainCommunicator {
+public:
+  Communicator(shared_ptr<State> state, int rank) : m_state(std::move(state)), m_rank(rank) {}
+
+  int GetRank() const override { return m_rank; }
+  int GetSize() const override { return m_state->size; }
+
+  void SendReceive(const void* send, size_t bytes, int destination, void* receive,
+                   int source) override {
+    CheckRank(destination);
+    CheckRank(source);
+    State& state = *m_state;
+    unique_lock<mutex> guard(state.lock);
+    if (destination != NO_RANK) {
+      const char* begin = static_cast<const char*>(send);
+      state.mailboxes[{m_rank, destination}].emplace_back(begin, begin + bytes);
+      state.changed.notify_all();
+    }
+    if (source == NO_RANK) return;
+
+    deque<vector<char>>& mailbox = state.mailboxes[{source, m_rank}];
+    state.changed.wait(guard, [&mailbox]() { return !mailbox.empty(); });
+    if (mailbox.front().size() != bytes) throw runtime_error("message size mismatch");
+    memcpy(receive, mailbox.front().data(), bytes);
+    mailbox.pop_front();
+  }
+
+  void AllGather(const void* send, size_t bytes, void* receive) override {
+    State& state = *m_state;
+    unique_lock<mutex> guard(state.lock);
+    state.changed.wait(guard, [&state]() { return !state.draining; });
+
+    const char* begin = static_cast<const char*>(send);
+    state.slots[m_rank].assign(begin, begin + bytes);
+    const size_t generation = state.generation;
+    if (++state.arrived == state.size) {
+      state.gathered.clear();
+      for (const vector<char>& slot : state.slots) {
+        if (slot.size() != bytes) throw runtime_error("gathered buffers differ in size");
+        state.gathered.insert(state.gathered.end(), slot.begin(), slot.end());
+      }
+      state.draining = true;
+      state.generation++;
+      state.changed.notify_all();
+    } else {
+      state.changed.wait(guard, [&state, generation]() { return state.generation != generation; });
+    }
+
+    memcpy(receive, state.gathered.data(), state.gathered.size());
+    if (++state.departed == state.size) {
+      state.arrived = 0;
+      state.departed = 0;
+      state.draining = false;
+      state.changed.notify_all();
+    }
+  }
+
+private:
+  void CheckRank(int rank) const {
+    if (rank != NO_RANK && (rank < 0 || rank >= m_state->size)) {
+      throw invalid_argument("rank out of range");
+    }
+  }
+
+  shared_ptr<State> m_state;
+  int m_rank;
+};
+
+LocalCommunicatorGroup::LocalCommunicatorGroup(int size) {
+  if (size < 1) throw invalid_argument("a communicator group needs at least one rank");
+
+  m_state = make_shared<State>(size);
+  for (int rank = 0; rank < size; rank++) {
+    m_communicators.push_back(make_unique<Communicator>(m_state, rank));
+  }
+}
+
+LocalCommunicatorGroup::~LocalCommunicatorGroup() = default;
+
+DomainCommunicator& LocalCommunicatorGroup::GetCommunicator(int rank) {
+  if (rank < 0 || rank >= GetSize()) throw invalid_argument("rank out of range");
+  return *m_communicators[rank];
+}
+
+#ifdef CGLE_WITH_MPI
+namespace {
+  int ToMpiRank(int rank) { return rank == NO_RANK ? MPI_PROC_NULL : rank; }
+
+  int ToMpiCount(size_t bytes) {
+    if (bytes > static_cast<size_t>(INT_MAX)) throw invalid_argument("message too large for MPI");
+    return static_cast<int>(bytes);
+  }
+
+  void Check(int status, const char* operation) {
+    if (status != MPI_SUCCESS) throw runtime_error(string(operation) + " failed");
+  }
+}  // namespace
+
+MpiSession::MpiSession(int* argc, char*** argv) {
+  int initialized = 0;
+  Check(MPI_Initialized(&initialized), "MPI_Initialized");
+  if (initialized) return;
+
+  Check(MPI_Init(argc, argv), "MPI_Init");
+  m_owned = true;
+}
+
+MpiSession::~MpiSession() {
+  int finalized = 0;
+  MPI_Finalized(&finalized);
+  if (m_owned && !finalized) MPI_Finalize();
+}
+
+MpiCommunicator::MpiCommunicator(MPI_Comm communicator) : m_communicator(communicator) {
+  Check(MPI_Comm_rank(m_communicator, &m_rank), "MPI_Comm_rank");
+  Check(MPI_Comm_size(m_communicator, &m_size), "MPI_Comm_size");
+}
+
+void MpiCommunicator::SendReceive(const void* send, size_t bytes, int destination, void* receive,
+                                  int source) {
+  // the side without a peer may pass no buffer, which MPI only accepts for an empty message
+  const int sendCount = destination == NO_RANK ? 0 : ToMpiCount(bytes);
+  const int receiveCount = source == NO_RANK ? 0 : ToMpiCount(bytes);
+  Check(MPI_Sendrecv(send, sendCount, MPI_BYTE, ToMpiRank(destination), 0, receive, receiveCount,
+                     MPI_BYTE, ToMpiRank(source), 0, m_communicator, MPI_STATUS_IGNORE),
+        "MPI_Sendrecv");
+}
+
+void MpiCommunicator::AllGather(const void* send, size_t bytes, void* receive) {
+  const int count = ToMpiCount(bytes);
+  Check(MPI_Allgather(send, count, MPI_BYTE, receive, count, MPI_BYTE, m_communicator),
+        "MPI_Allgather");
+}
+#endif
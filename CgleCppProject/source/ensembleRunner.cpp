@@ -0,0 +1,130 @@
+#include <ensembleRunner.h>
+#include <helper.h>
+#include <stabilitySolver.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+using namespace CGLE;
+
+RunningFieldStatistics::RunningFieldStatistics(Eigen::Index rows, Eigen::Index cols)
+    : m_mean(Eigen::ArrayXXd::Zero(rows, cols)),
+      m_m2(Eigen::ArrayXXd::Zero(rows, cols)),
+      m_max(Eigen::ArrayXXd::Zero(rows, cols)) {}
+
+void RunningFieldStatistics::Merge(const RunningFieldStatistics& other) {
+  if (other.m_count == 0) return;
+  if (m_count == 0) {
+    *this = other;
+    return;
+  }
+  if (other.m_mean.rows() != m_mean.rows() || other.m_mean.cols() != m_mean.cols()) {
+    throw invalid_argument("cannot merge statistics of different shapes");
+  }
+
+  const double countA = static_cast<double>(m_count);
+  const double countB = static_cast<double>(other.m_count);
+  const double count = countA + countB;
+
+  Eigen::ArrayXXd delta = other.m_mean - m_mean;
+  m_mean += delta * (countB / count);
+  m_m2 += other.m_m2 + delta.square() * (countA * countB / count);
+  m_max = m_max.max(other.m_max);
+  m_count += other.m_count;
+}
+
+Eigen::ArrayXXd RunningFieldStatistics::GetVariance() const {
+  if (m_count < 2) return Eigen::ArrayXXd::Zero(m_mean.rows(), m_mean.cols());
+  return m_m2 / static_cast<double>(m_count - 1);
+}
+
+template <typename Policy>
+EnsembleRunner<Policy>::EnsembleRunner(const Constraint& constraint, const GridDetails& details)
+    : m_constraint(constraint), m_base(m_constraint, details) {
+  m_base.ComputeGroundTruth();
+  m_maxGroundTruthAmplitude
+      = static_cast<double>(max(m_base.GetGroundTruthA().cwiseAbs().maxCoeff(),
+                                m_base.GetGroundTruthB().cwiseAbs().maxCoeff()));
+}
+
+template <typename Policy>
+EnsembleResult EnsembleRunner<Policy>::Run(const EnsembleOptions& options) const {
+  if (options.numMembers < 0) throw invalid_argument("number of members cannot be negative");
+  if (options.numLanes <= 0) throw invalid_argument("number of lanes must be positive");
+
+  const GridDetails& details = m_base.GetDetails();
+  const int numLanes = static_cast<int>(min<long long>(options.numLanes, options.numMembers));
+  const double divergenceLimit = options.divergenceFactor * m_maxGroundTruthAmplitude;
+
+  auto emptyResult = [&details]() {
+    EnsembleResult result;
+    result.amplitudeA = RunningFieldStatistics(details.GetNumXPts(), details.GetNumYPts());
+    result.amplitudeB = RunningFieldStatistics(details.GetNumXPts(), details.GetNumYPts());
+    result.stepMaxAmplitude = RunningFieldStatistics(details.GetNumYPts(), 1);
+    return result;
+  };
+
+  vector<EnsembleResult> lanes(numLanes);
+  Helper::ParallelFor(numLanes, options.numThreads, [&](int lane) {
+    lanes[lane] = emptyResult();
+    StabilitySolver<Policy> solver(m_constraint, details);
+    // lanes already run concurrently, each member's solves stay serial
+    solver.SetNumThreads(1);
+    solver.SetBoundaryCondition(options.boundaryCondition);
+    Eigen::VectorXd stepMax(details.GetNumYPts());
+
+    for (long long member = lane; member < options.numMembers; member += numLanes) {
+      BasicGrid<Policy> grid = m_base.Fork();
+      mt19937_64 engine = MemberEngine(options.seed, member);
+      grid.PerturbGrid(options.pertubationCoefficient, engine);
+      solver.Solve(grid);
+      Reduce(grid, divergenceLimit, stepMax, lanes[lane]);
+    }
+  });
+
+  // lanes are merged in a fixed order so the floating point result is independent of scheduling
+  EnsembleResult result = emptyResult();
+  for (const EnsembleResult& lane : lanes) {
+    result.numMembers += lane.numMembers;
+    result.numUnstable += lane.numUnstable;
+    result.amplitudeA.Merge(lane.amplitudeA);
+    result.amplitudeB.Merge(lane.amplitudeB);
+    result.stepMaxAmplitude.Merge(lane.stepMaxAmplitude);
+  }
+  return result;
+}
+
+template <typename Policy>
+mt19937_64 EnsembleRunner<Policy>::MemberEngine(uint64_t seed, long long member) {
+  const uint64_t index = static_cast<uint64_t>(member);
+  seed_seq sequence{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32),
+                    static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32)};
+  return mt19937_64(sequence);
+}
+
+template <typename Policy>
+void EnsembleRunner<Policy>::Reduce(const BasicGrid<Policy>& grid, double divergenceLimit,
+                                    Eigen::VectorXd& stepMax, EnsembleResult& lane) const {
+  const auto& fieldA = grid.GetPerturbedA();
+  const auto& fieldB = grid.GetPerturbedB();
+  lane.numMembers++;
+
+  // non finite members are counted as unstable but kept out of the statistics
+  if (!fieldA.allFinite() || !fieldB.allFinite()) {
+    lane.numUnstable++;
+    return;
+  }
+
+  for (int timeIndex = 0; timeIndex < fieldA.cols(); timeIndex++) {
+    stepMax[timeIndex] = static_cast<double>(max(fieldA.col(timeIndex).cwiseAbs().maxCoeff(),
+                                                 fieldB.col(timeIndex).cwiseAbs().maxCoeff()));
+  }
+  if (stepMax.maxCoeff() > divergenceLimit) lane.numUnstable++;
+
+  lane.amplitudeA.Add(fieldA);
+  lane.amplitudeB.Add(fieldB);
+  lane.stepMaxAmplitude.Add(stepMax);
+}
+
+template class CGLE::EnsembleRunner<MixedPrecision>;
+template class CGLE::EnsembleRunner<DoublePrecision>;
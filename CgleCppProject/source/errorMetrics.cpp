@@ -0,0 +1,101 @@
+#include <errorMetrics.h>
+#include <helper.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+using namespace CGLE;
+
+namespace {
+  /**
+   * PartialSums holds the running sums of one field over one chunk
+   */
+  struct PartialSums {
+    double l1 = 0;
+    double squaredError = 0;
+    double squaredReference = 0;
+    double linf = 0;
+    double maxAmplitude = 0;
+    double maxReference = 0;
+
+    void Add(complex<double> perturbed, complex<double> reference) {
+      const double error = std::abs(perturbed - reference);
+      const double referenceAmplitude = std::abs(reference);
+      l1 += error;
+      squaredError += error * error;
+      squaredReference += referenceAmplitude * referenceAmplitude;
+      linf = max(linf, error);
+      maxAmplitude = max(maxAmplitude, std::abs(perturbed));
+      maxReference = max(maxReference, referenceAmplitude);
+    }
+
+    void Merge(const PartialSums& other) {
+      l1 += other.l1;
+      squaredError += other.squaredError;
+      squaredReference += other.squaredReference;
+      linf = max(linf, other.linf);
+      maxAmplitude = max(maxAmplitude, other.maxAmplitude);
+      maxReference = max(maxReference, other.maxReference);
+    }
+
+    FieldErrorMetrics ToMetrics() const {
+      FieldErrorMetrics metrics;
+      metrics.l1 = l1;
+      metrics.l2 = sqrt(squaredError);
+      metrics.linf = linf;
+      metrics.relativeL2 = squaredReference > 0 ? sqrt(squaredError / squaredReference) : 0;
+      metrics.relativeLinf = maxReference > 0 ? linf / maxReference : 0;
+      metrics.maxAmplitude = maxAmplitude;
+      metrics.maxReferenceAmplitude = maxReference;
+      return metrics;
+    }
+  };
+}  // namespace
+
+template <typename Policy>
+ErrorMetrics CGLE::ComputeErrorMetrics(const BasicGrid<Policy>& grid, int numThreads) {
+  const auto& groundTruthA = grid.GetGroundTruthA();
+  const auto& groundTruthB = grid.GetGroundTruthB();
+  const auto& perturbedA = grid.GetPerturbedFieldA();
+  const auto& perturbedB = grid.GetPerturbedFieldB();
+
+  ErrorMetrics metrics;
+  const int numRows = static_cast<int>(groundTruthA.rows()) - 2;
+  const int numCols = static_cast<int>(groundTruthA.cols()) - 2;
+  if (numRows <= 0 || numCols <= 0) return metrics;
+
+  // chunk boundaries only depend on the grid shape, never on the number of threads
+  const int chunkCols = max(1, ERROR_METRIC_CHUNK_CELLS / numRows);
+  const int numChunks = (numCols + chunkCols - 1) / chunkCols;
+  vector<PartialSums> partialA(numChunks), partialB(numChunks);
+
+  Helper::ParallelFor(numChunks, numThreads, [&](int chunk) {
+    const int firstCol = 1 + chunk * chunkCols;
+    const int lastCol = min(firstCol + chunkCols, numCols + 1);
+    PartialSums sumsA, sumsB;
+    for (int col = firstCol; col < lastCol; col++) {
+      for (int row = 1; row <= numRows; row++) {
+        sumsA.Add(Policy::ToAccumulator(perturbedA(row, col)),
+                  Policy::ToAccumulator(groundTruthA(row, col)));
+        sumsB.Add(Policy::ToAccumulator(perturbedB(row, col)),
+                  Policy::ToAccumulator(groundTruthB(row, col)));
+      }
+    }
+    partialA[chunk] = sumsA;
+    partialB[chunk] = sumsB;
+  });
+
+  PartialSums totalA, totalB;
+  for (int chunk = 0; chunk < numChunks; chunk++) {
+    totalA.Merge(partialA[chunk]);
+    totalB.Merge(partialB[chunk]);
+  }
+
+  metrics.a = totalA.ToMetrics();
+  metrics.b = totalB.ToMetrics();
+  metrics.numCells = static_cast<long long>(numRows) * numCols;
+  return metrics;
+}
+
+template ErrorMetrics CGLE::ComputeErrorMetrics<MixedPrecision>(const Grid&, int);
+template ErrorMetrics CGLE::ComputeErrorMetrics<DoublePrecision>(const ReferenceGrid&, int);
@@ -0,0 +1,431 @@
+#include <fieldCodec.h>
+#include <helper.h>
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+using namespace CGLE;
+
+namespace {
+  const char CODEC_MAGIC[4] = {'C', 'F', 'C', '1'};
+  const int RANS_SCALE_BITS = 12;
+  const uint32_t RANS_SCALE = 1u << RANS_SCALE_BITS;
+  /** lower bound of the normalized rANS state, which stays in [RANS_LOWER_BOUND, 2^31) **/
+  const uint32_t RANS_LOWER_BOUND = 1u << 23;
+
+  enum class PlaneCoding : uint8_t { Delta = 0, Quantized = 1 };
+  enum class StreamCoding : uint8_t { Constant = 0, Raw = 1, Rans = 2 };
+
+  template <typename Real> struct RealBits;
+  template <> struct RealBits<float> {
+    using Unsigned = uint32_t;
+    using Signed = int32_t;
+    /** quantized values stay below this so that their differences fit Signed **/
+    static constexpr double maxQuantized = 1073741824.0;
+  };
+  template <> struct RealBits<double> {
+    using Unsigned = uint64_t;
+    using Signed = int64_t;
+    /** quantized values stay below this so that they are exact doubles **/
+    static constexpr double maxQuantized = 4503599627370496.0;
+  };
+
+  template <typename Scalar> struct ScalarParts {
+    using Real = Scalar;
+    static constexpr int components = 1;
+  };
+  template <typename T> struct ScalarParts<complex<T>> {
+    using Real = T;
+    static constexpr int components = 2;
+  };
+
+  template <typename T> void Append(vector<uint8_t>& out, T value) {
+    const size_t position = out.size();
+    out.resize(position + sizeof(T));
+    memcpy(out.data() + position, &value, sizeof(T));
+  }
+
+  /**
+   * @brief ByteReader walks a compressed stream, throwing when it runs past its end
+   */
+  class ByteReader {
+  public:
+    ByteReader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+    const uint8_t* Take(size_t count) {
+      if (count > m_size - m_position) throw runtime_error("compressed field is truncated");
+      const uint8_t* bytes = m_data + m_position;
+      m_position += count;
+      return bytes;
+    }
+
+    template <typename T> T Read() {
+      T value;
+      memcpy(&value, Take(sizeof(T)), sizeof(T));
+      return value;
+    }
+
+  private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_position = 0;
+  };
+
+  /**
+   * NormalizeFrequencies scales symbol counts to frequencies summing to RANS_SCALE, keeping
+   * every symbol that occurs at a frequency of at least 1
+   */
+  array<uint32_t, 256> NormalizeFrequencies(const array<uint32_t, 256>& counts, size_t total) {
+    array<uint32_t, 256> frequencies{};
+    uint32_t sum = 0;
+    for (int symbol = 0; symbol < 256; symbol++) {
+      if (counts[symbol] == 0) continue;
+      const uint64_t scaled = uint64_t{counts[symbol]} * RANS_SCALE / total;
+      frequencies[symbol] = max<uint32_t>(1, static_cast<uint32_t>(scaled));
+      sum += frequencies[symbol];
+    }
+    // the largest frequency absorbs the rounding, which distorts the code the least
+    while (sum != RANS_SCALE) {
+      const auto largest = max_element(frequencies.begin(), frequencies.end());
+      if (sum < RANS_SCALE) {
+        *largest += RANS_SCALE - sum;
+        sum = RANS_SCALE;
+      } else {
+        const uint32_t excess = min(sum - RANS_SCALE, *largest - 1);
+        *largest -= excess;
+        sum -= excess;
+      }
+    }
+    return frequencies;
+  }
+
+  /**
+   * EncodeStream appends one byte stream, picking the cheapest of constant, raw and rANS coding
+   *
+   * @param  {uint8_t} bytes           : bytes to code
+   * @param  {size_t} count            : number of bytes, at least 1
+   * @param  {vector<uint8_t>} out     : receives the coded stream
+   * @param  {vector<uint8_t>} scratch : scratch buffer
+   */
+  void EncodeStream(const uint8_t* bytes, size_t count, vector<uint8_t>& out,
+                    vector<uint8_t>& scratch) {
+    array<uint32_t, 256> counts{};
+    for (size_t index = 0; index < count; index++) counts[bytes[index]]++;
+    const int numSymbols
+        = static_cast<int>(count_if(counts.begin(), counts.end(), [](uint32_t c) { return c; }));
+    if (numSymbols == 1) {
+      out.push_back(static_cast<uint8_t>(StreamCoding::Constant));
+      out.push_back(bytes[0]);
+      return;
+    }
+
+    const array<uint32_t, 256> frequencies = NormalizeFrequencies(counts, count);
+    array<uint32_t, 256> cumulative{};
+    for (int symbol = 1; symbol < 256; symbol++) {
+      cumulative[symbol] = cumulative[symbol - 1] + frequencies[symbol - 1];
+    }
+
+    // rANS codes in reverse so that the decoder reads forward, the output is reversed at the end
+    scratch.clear();
+    uint32_t state = RANS_LOWER_BOUND;
+    for (size_t index = count; index-- > 0;) {
+      const uint32_t frequency = frequencies[bytes[index]];
+      const uint32_t limit = ((RANS_LOWER_BOUND >> RANS_SCALE_BITS) << 8) * frequency;
+      while (state >= limit) {
+        scratch.push_back(static_cast<uint8_t>(state));
+        state >>= 8;
+      }
+      state = ((state / frequency) << RANS_SCALE_BITS) + state % frequency
+              + cumulative[bytes[index]];
+    }
+    for (int byte = 0; byte < 4; byte++) {
+      scratch.push_back(static_cast<uint8_t>(state));
+      state >>= 8;
+    }
+
+    const size_t tableBytes = sizeof(uint16_t) + 3 * static_cast<size_t>(numSymbols);
+    if (tableBytes + sizeof(uint32_t) + scratch.size() >= count) {
+      out.push_back(static_cast<uint8_t>(StreamCoding::Raw));
+      out.insert(out.end(), bytes, bytes + count);
+      return;
+    }
+    out.push_back(static_cast<uint8_t>(StreamCoding::Rans));
+    Append<uint16_t>(out, static_cast<uint16_t>(numSymbols));
+    for (int symbol = 0; symbol < 256; symbol++) {
+      if (frequencies[symbol] == 0) continue;
+      out.push_back(static_cast<uint8_t>(symbol));
+      Append<uint16_t>(out, static_cast<uint16_t>(frequencies[symbol]));
+    }
+    Append<uint32_t>(out, static_cast<uint32_t>(scratch.size()));
+    out.insert(out.end(), scratch.rbegin(), scratch.rend());
+  }
+
+  /**
+   * DecodeStream reads one byte stream written by EncodeStream
+   *
+   * @param  {ByteReader} reader : compressed stream
+   * @param  {uint8_t} bytes     : receives the bytes
+   * @param  {size_t} count      : number of bytes
+   */
+  void DecodeStream(ByteReader& reader, uint8_t* bytes, size_t count) {
+    const auto coding = static_cast<StreamCoding>(reader.Read<uint8_t>());
+    if (coding == StreamCoding::Constant) {
+      memset(bytes, reader.Read<uint8_t>(), count);
+      return;
+    }
+    if (coding == StreamCoding::Raw) {
+      memcpy(bytes, reader.Take(count), count);
+      return;
+    }
+    if (coding != StreamCoding::Rans) throw runtime_error("unknown compressed stream coding");
+
+    array<uint32_t, 256> frequencies{}, cumulative{};
+    array<uint8_t, RANS_SCALE> slots;
+    const int numSymbols = reader.Read<uint16_t>();
+    uint32_t total = 0;
+    for (int entry = 0; entry < numSymbols; entry++) {
+      const uint8_t symbol = reader.Read<uint8_t>();
+      const uint32_t frequency = reader.Read<uint16_t>();
+      if (frequency == 0 || total + frequency > RANS_SCALE) {
+        throw runtime_error("corrupt compressed stream frequencies");
+      }
+      frequencies[symbol] = frequency;
+      cumulative[symbol] = total;
+      fill_n(slots.begin() + total, frequency, symbol);
+      total += frequency;
+    }
+    if (total != RANS_SCALE) throw runtime_error("corrupt compressed stream frequencies");
+
+    const size_t size = reader.Read<uint32_t>();
+    const uint8_t* input = reader.Take(size);
+    if (size < 4) throw runtime_error("compressed field is truncated");
+    uint32_t state = uint32_t{input[0]} << 24 | uint32_t{input[1]} << 16
+                     | uint32_t{input[2]} << 8 | uint32_t{input[3]};
+    size_t position = 4;
+    for (size_t index = 0; index < count; index++) {
+      const uint32_t slot = state & (RANS_SCALE - 1);
+      const uint8_t symbol = slots[slot];
+      bytes[index] = symbol;
+      state = frequencies[symbol] * (state >> RANS_SCALE_BITS) + slot - cumulative[symbol];
+      while (state < RANS_LOWER_BOUND) {
+        if (position == size) throw runtime_error("compressed field is truncated");
+        state = state << 8 | input[position++];
+      }
+    }
+  }
+
+  /**
+   * EncodePlane appends one real plane of a tile: its prediction residuals, byte shuffled
+   *
+   * @param  {Real} values         : first value of the plane
+   * @param  {size_t} count        : number of values
+   * @param  {int} stride          : distance between consecutive values
+   * @param  {double} step         : quantization step, 0 for lossless coding
+   */
+  template <typename Real>
+  void EncodePlane(const Real* values, size_t count, int stride, double step, vector<uint8_t>& out,
+                   vector<typename RealBits<Real>::Unsigned>& residuals, vector<uint8_t>& bytes,
+                   vector<uint8_t>& scratch) {
+    using Unsigned = typename RealBits<Real>::Unsigned;
+    using Signed = typename RealBits<Real>::Signed;
+    const int width = 8 * static_cast<int>(sizeof(Unsigned));
+    // zigzag coding maps differences of small magnitude to small unsigned integers
+    const auto zigzag = [width](Signed value) {
+      return static_cast<Unsigned>(static_cast<Unsigned>(value) << 1
+                                   ^ static_cast<Unsigned>(value >> (width - 1)));
+    };
+
+    bool quantized = step > 0;
+    for (size_t index = 0; quantized && index < count; index++) {
+      const double scaled = static_cast<double>(values[index * stride]) / step;
+      quantized = std::abs(scaled) < RealBits<Real>::maxQuantized;
+    }
+
+    residuals.resize(count);
+    if (quantized) {
+      int64_t previous = 0;
+      for (size_t index = 0; index < count; index++) {
+        const int64_t value = llround(static_cast<double>(values[index * stride]) / step);
+        residuals[index] = zigzag(static_cast<Signed>(value - previous));
+        previous = value;
+      }
+    } else {
+      Unsigned previous = 0;
+      for (size_t index = 0; index < count; index++) {
+        Unsigned value;
+        memcpy(&value, &values[index * stride], sizeof(Unsigned));
+        residuals[index] = zigzag(static_cast<Signed>(static_cast<Unsigned>(value - previous)));
+        previous = value;
+      }
+    }
+
+    out.push_back(static_cast<uint8_t>(quantized ? PlaneCoding::Quantized : PlaneCoding::Delta));
+    bytes.resize(count);
+    for (int shift = 0; shift < width; shift += 8) {
+      for (size_t index = 0; index < count; index++) {
+        bytes[index] = static_cast<uint8_t>(residuals[index] >> shift);
+      }
+      EncodeStream(bytes.data(), count, out, scratch);
+    }
+  }
+
+  /**
+   * DecodePlane reads one real plane of a tile written by EncodePlane
+   */
+  template <typename Real>
+  void DecodePlane(ByteReader& reader, Real* values, size_t count, int stride, double step,
+                   vector<typename RealBits<Real>::Unsigned>& residuals, vector<uint8_t>& bytes) {
+    using Unsigned = typename RealBits<Real>::Unsigned;
+    using Signed = typename RealBits<Real>::Signed;
+    const int width = 8 * static_cast<int>(sizeof(Unsigned));
+    const auto coding = static_cast<PlaneCoding>(reader.Read<uint8_t>());
+    if (coding != PlaneCoding::Delta && coding != PlaneCoding::Quantized) {
+      throw runtime_error("unknown compressed plane coding");
+    }
+
+    residuals.assign(count, 0);
+    bytes.resize(count);
+    for (int shift = 0; shift < width; shift += 8) {
+      DecodeStream(reader, bytes.data(), count);
+      for (size_t index = 0; index < count; index++) {
+        residuals[index] |= static_cast<Unsigned>(static_cast<Unsigned>(bytes[index]) << shift);
+      }
+    }
+
+    const auto unzigzag = [](Unsigned value) {
+      return static_cast<Signed>(static_cast<Signed>(value >> 1) ^ -static_cast<Signed>(value & 1));
+    };
+    if (coding == PlaneCoding::Quantized) {
+      int64_t previous = 0;
+      for (size_t index = 0; index < count; index++) {
+        previous += unzigzag(residuals[index]);
+        values[index * stride] = static_cast<Real>(static_cast<double>(previous) * step);
+      }
+    } else {
+      Unsigned previous = 0;
+      for (size_t index = 0; index < count; index++) {
+        const Signed difference = unzigzag(residuals[index]);
+        previous = static_cast<Unsigned>(previous + static_cast<Unsigned>(difference));
+        memcpy(&values[index * stride], &previous, sizeof(Unsigned));
+      }
+    }
+  }
+}  // namespace
+
+FieldCodec::FieldCodec(const FieldCodecOptions& options) : m_options(options) {
+  if (options.compression != FieldCompression::Lossless
+      && options.compression != FieldCompression::ErrorBounded) {
+    throw invalid_argument("uncompressed fields have no codec");
+  }
+  if (options.compression == FieldCompression::ErrorBounded
+      && !(options.errorBound > 0 && std::isfinite(options.errorBound))) {
+    throw invalid_argument("error bounded compression needs a positive error bound");
+  }
+  if (options.tileElements < 1) throw invalid_argument("tiles need at least one element");
+}
+
+template <typename Scalar>
+vector<uint8_t> FieldCodec::Encode(const Scalar* values, size_t numElements) const {
+  using Real = typename ScalarParts<Scalar>::Real;
+  const int components = ScalarParts<Scalar>::components;
+  const Real* parts = reinterpret_cast<const Real*>(values);
+  const size_t tileElements = static_cast<size_t>(m_options.tileElements);
+  const size_t numTiles = (numElements + tileElements - 1) / tileElements;
+  if (numTiles > static_cast<size_t>(INT_MAX)) throw invalid_argument("field has too many tiles");
+  const bool lossy = m_options.compression == FieldCompression::ErrorBounded;
+  const double step = lossy ? 2 * m_options.errorBound : 0;
+
+  vector<vector<uint8_t>> tiles(numTiles);
+  Helper::ParallelFor(static_cast<int>(numTiles), m_options.numThreads, [&](int tile) {
+    const size_t begin = static_cast<size_t>(tile) * tileElements;
+    const size_t count = min(tileElements, numElements - begin);
+    vector<typename RealBits<Real>::Unsigned> residuals;
+    vector<uint8_t> bytes, scratch;
+    for (int component = 0; component < components; component++) {
+      EncodePlane(parts + begin * components + component, count, components, step,
+                  tiles[static_cast<size_t>(tile)], residuals, bytes, scratch);
+    }
+  });
+
+  vector<uint8_t> out(CODEC_MAGIC, CODEC_MAGIC + sizeof(CODEC_MAGIC));
+  out.push_back(static_cast<uint8_t>(m_options.compression));
+  out.push_back(static_cast<uint8_t>(sizeof(Real)));
+  out.push_back(static_cast<uint8_t>(components));
+  out.push_back(0);
+  Append<double>(out, lossy ? m_options.errorBound : 0);
+  Append<uint64_t>(out, numElements);
+  Append<uint64_t>(out, tileElements);
+  Append<uint64_t>(out, numTiles);
+  size_t total = out.size() + numTiles * sizeof(uint64_t);
+  for (const vector<uint8_t>& tile : tiles) {
+    Append<uint64_t>(out, tile.size());
+    total += tile.size();
+  }
+  out.reserve(total);
+  for (const vector<uint8_t>& tile : tiles) out.insert(out.end(), tile.begin(), tile.end());
+  return out;
+}
+
+template <typename Scalar>
+void FieldCodec::Decode(const uint8_t* data, size_t size, Scalar* values,
+                        size_t numElements) const {
+  using Real = typename ScalarParts<Scalar>::Real;
+  const int components = ScalarParts<Scalar>::components;
+  ByteReader reader(data, size);
+  if (memcmp(reader.Take(sizeof(CODEC_MAGIC)), CODEC_MAGIC, sizeof(CODEC_MAGIC)) != 0) {
+    throw runtime_error("not a compressed field");
+  }
+  const auto compression = static_cast<FieldCompression>(reader.Read<uint8_t>());
+  const int realBytes = reader.Read<uint8_t>();
+  const int storedComponents = reader.Read<uint8_t>();
+  reader.Read<uint8_t>();
+  const double errorBound = reader.Read<double>();
+  if (realBytes != static_cast<int>(sizeof(Real)) || storedComponents != components) {
+    throw runtime_error("compressed field holds another scalar type");
+  }
+  if (reader.Read<uint64_t>() != numElements) {
+    throw runtime_error("compressed field holds another number of elements");
+  }
+  const uint64_t tileElements = reader.Read<uint64_t>();
+  const uint64_t numTiles = reader.Read<uint64_t>();
+  if (tileElements == 0 || numTiles != (numElements + tileElements - 1) / tileElements) {
+    throw runtime_error("corrupt compressed field tiling");
+  }
+  const double step = compression == FieldCompression::ErrorBounded ? 2 * errorBound : 0;
+
+  vector<ByteReader> tiles;
+  tiles.reserve(numTiles);
+  vector<uint64_t> sizes(numTiles);
+  for (uint64_t& tileSize : sizes) tileSize = reader.Read<uint64_t>();
+  for (uint64_t tileSize : sizes) {
+    if (tileSize > size) throw runtime_error("compressed field is truncated");
+    tiles.emplace_back(reader.Take(tileSize), tileSize);
+  }
+
+  Real* parts = reinterpret_cast<Real*>(values);
+  Helper::ParallelFor(static_cast<int>(numTiles), m_options.numThreads, [&](int tile) {
+    const size_t begin = static_cast<size_t>(tile) * tileElements;
+    const size_t count = min<size_t>(tileElements, numElements - begin);
+    vector<typename RealBits<Real>::Unsigned> residuals;
+    vector<uint8_t> bytes;
+    for (int component = 0; component < components; component++) {
+      DecodePlane(tiles[static_cast<size_t>(tile)], parts + begin * components + component, count,
+                  components, step, residuals, bytes);
+    }
+  });
+}
+
+template vector<uint8_t> FieldCodec::Encode<float>(const float*, size_t) const;
+template vector<uint8_t> FieldCodec::Encode<double>(const double*, size_t) const;
+template vector<uint8_t> FieldCodec::Encode<complex<float>>(const complex<float>*, size_t) const;
+template vector<uint8_t> FieldCodec::Encode<complex<double>>(const complex<double>*,
+                                                             size_t) const;
+template void FieldCodec::Decode<float>(const uint8_t*, size_t, float*, size_t) const;
+template void FieldCodec::Decode<double>(const uint8_t*, size_t, double*, size_t) const;
+template void FieldCodec::Decode<complex<float>>(const uint8_t*, size_t, complex<float>*,
+                                                 size_t) const;
+template void FieldCodec::Decode<complex<double>>(const uint8_t*, size_t, complex<double>*,
+                                                  size_t) const;
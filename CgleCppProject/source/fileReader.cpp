@@ -6,7 +6,9 @@
 #include <iostream>
 using namespace CGLE;
 
-ConstraintReader::ConstraintReader(string& filePath) : m_filePath(std::move(filePath)) {}
+ConstraintReader::ConstraintReader(string& filePath) : m_filePath(std::move(filePath)) {
+  m_charge.Update(sizeof(ConstraintReader) + m_filePath.capacity());
+}
 
 void ConstraintReader::ProcessConstraint(int numProcessedConstraints, const string& value,
                                          complex<double>* cmplxValue) {
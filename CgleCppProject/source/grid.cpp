@@ -1,69 +1,297 @@
 #include <grid.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <iterator>
+#include <random>
 #include <vector>
 using namespace CGLE;
 using namespace std;
 
-Grid::Grid(Constraint& constraint) {
-  m_details = make_unique<GridDetails>();
-  m_grid = Eigen::MatrixXcd(double(m_details->GetNumXPts()), double(m_details->GetNumYPts()));
-  m_functHdl = make_unique<FunctionHandler>(constraint);
-  m_perturbed_gridA = m_grid;
-  m_perturbed_gridB = m_grid;
-  m_grid_groundtruthA = m_grid;
-  m_grid_groundtruthB = m_grid;
+template <typename Policy> BasicGrid<Policy>::BasicGrid(Constraint& constraint) {
+  m_details = make_shared<GridDetails>();
+  m_functHdl = make_shared<FunctionHandler>(constraint);
+  AllocateFields();
 };
 
-Grid::Grid(int num_x_pts, int num_y_pts, int num_z_pts, int num_pts, Constraint& constraint) {
-  m_details = make_unique<GridDetails>(num_x_pts, num_y_pts, num_z_pts, num_pts);
-  m_grid = Eigen::MatrixXcd(double(m_details->GetNumXPts()), double(m_details->GetNumYPts()));
-  m_functHdl = make_unique<FunctionHandler>(constraint);
-  m_perturbed_gridA = m_grid;
-  m_perturbed_gridB = m_grid;
-  m_grid_groundtruthA = m_grid;
-  m_grid_groundtruthB = m_grid;
+template <typename Policy>
+BasicGrid<Policy>::BasicGrid(Constraint& constraint, const GridDetails& details) {
+  m_details = make_shared<GridDetails>(details);
+  m_functHdl = make_shared<FunctionHandler>(constraint);
+  AllocateFields();
 };
 
-Grid::Grid(int num_x_pts, int num_y_pts, int num_z_pts, double dx, double dy, double dz,
-           Constraint& constraint) {
-  m_details = make_unique<GridDetails>(num_x_pts, num_y_pts, num_z_pts, dx, dy, dz);
-  m_grid = Eigen::MatrixXcd(double(m_details->GetNumXPts()), double(m_details->GetNumYPts()));
-  m_functHdl = make_unique<FunctionHandler>(constraint);
-  m_perturbed_gridA = m_grid;
-  m_perturbed_gridB = m_grid;
-  m_grid_groundtruthA = m_grid;
-  m_grid_groundtruthB = m_grid;
+template <typename Policy>
+BasicGrid<Policy>::BasicGrid(Constraint& constraint, const GridDetails& details,
+                             const PlacementOptions& placement) {
+  m_details = make_shared<GridDetails>(details);
+  m_functHdl = make_shared<FunctionHandler>(constraint);
+  m_placement = make_shared<PlacementOptions>(placement);
+  AllocateFields();
 }
 
-void Grid::PerturbGrid(const double pertubationCoefficient) {
-  for (int xPoint = 0; xPoint < this->m_details->GetNumXPts(); xPoint++) {
+template <typename Policy> BasicGrid<Policy>::BasicGrid(int num_x_pts, int num_y_pts,
+                                                        int num_z_pts, int num_pts,
+                                                        Constraint& constraint) {
+  // grids are two dimensional (position, time) so the z axis is not materialized
+  (void)num_z_pts;
+  m_details = make_shared<GridDetails>(num_x_pts, num_y_pts, num_pts);
+  m_functHdl = make_shared<FunctionHandler>(constraint);
+  AllocateFields();
+};
+
+template <typename Policy>
+BasicGrid<Policy>::BasicGrid(int num_x_pts, int num_y_pts, int num_z_pts, double dx, double dy,
+                             double dz, Constraint& constraint) {
+  (void)num_z_pts;
+  (void)dz;
+  m_details = make_shared<GridDetails>(num_x_pts, num_y_pts, dx, dy);
+  m_functHdl = make_shared<FunctionHandler>(constraint);
+  AllocateFields();
+}
+
+template <typename Policy> void BasicGrid<Policy>::AllocateFields() {
+  m_grid_groundtruthA = LeaseField();
+  m_grid_groundtruthB = LeaseField();
+  if (!m_placement) {
+    m_grid_groundtruthA->setZero();
+    m_grid_groundtruthB->setZero();
+  }
+  m_perturbed_gridA = PerturbedField(m_grid_groundtruthA);
+  m_perturbed_gridB = PerturbedField(m_grid_groundtruthB);
+  m_perturbed_gridA.SetPlacement(m_placement);
+  m_perturbed_gridB.SetPlacement(m_placement);
+}
+
+template <typename Policy>
+shared_ptr<typename BasicGrid<Policy>::FieldMatrix> BasicGrid<Policy>::LeaseField() const {
+  // placed fields are allocated fresh and zeroed by the workers owning their pages
+  if (m_placement) {
+    return AllocatePlacedField<FieldMatrix>(m_details->GetNumXPts(), m_details->GetNumYPts(),
+                                            *m_placement, MemorySubsystem::GridFields);
+  }
+  return FieldPool::Local().AcquireShared(m_details->GetNumXPts(), m_details->GetNumYPts(),
+                                          MemorySubsystem::GridFields);
+}
+
+template <typename Policy> BasicGrid<Policy> BasicGrid<Policy>::Fork() const {
+  BasicGrid fork;
+  fork.m_functHdl = m_functHdl;
+  fork.m_details = m_details;
+  fork.m_grid_groundtruthA = m_grid_groundtruthA;
+  fork.m_grid_groundtruthB = m_grid_groundtruthB;
+  fork.m_perturbed_gridA = m_perturbed_gridA;
+  fork.m_perturbed_gridB = m_perturbed_gridB;
+  fork.m_groundtruth_computed = m_groundtruth_computed;
+  fork.m_evaluation = m_evaluation;
+  fork.m_placement = m_placement;
+  return fork;
+}
+
+template <typename Policy> size_t BasicGrid<Policy>::GetExclusiveBytes() const {
+  size_t bytes = m_perturbed_gridA.GetExclusiveBytes() + m_perturbed_gridB.GetExclusiveBytes();
+  auto addGroundTruth = [&bytes](const shared_ptr<FieldMatrix>& groundTruth,
+                                 const PerturbedField& perturbed) {
+    // the perturbed field reading through to the ground truth holds the only other reference
+    long ownReferences = perturbed.GetBase() == groundTruth ? 2 : 1;
+    if (groundTruth.use_count() == ownReferences) {
+      bytes += static_cast<size_t>(groundTruth->size()) * sizeof(typename Policy::StorageComplex);
+    }
+  };
+  addGroundTruth(m_grid_groundtruthA, m_perturbed_gridA);
+  addGroundTruth(m_grid_groundtruthB, m_perturbed_gridB);
+  return bytes;
+}
+
+template <typename Policy> void BasicGrid<Policy>::ComputeGroundTruth() {
+  // never overwrite a ground truth a fork may still be reading, the perturbed field reading
+  // through to it is the only other reference this grid holds
+  auto leaseIfShared = [this](shared_ptr<FieldMatrix>& groundTruth,
+                              const PerturbedField& perturbed) {
+    long ownReferences = perturbed.GetBase() == groundTruth ? 2 : 1;
+    if (groundTruth.use_count() > ownReferences) groundTruth = LeaseField();
+  };
+  leaseIfShared(m_grid_groundtruthA, m_perturbed_gridA);
+  leaseIfShared(m_grid_groundtruthB, m_perturbed_gridB);
+
+  const Axis& xPts = this->m_details->GetXAxis();
+  const Axis& timePts = this->m_details->GetTimeAxis();
+  if (any_of(timePts.begin(), timePts.end(), [](double time) { return time < 0; })) {
+    throw invalid_argument("time cannot be negative");
+  }
+
+  if (m_evaluation == FieldEvaluation::Separable) {
+    // O(Nx + Nt) exponentials, columns are evaluated at double precision and rounded once
+    using ColumnPool = BufferPool<complex<double>>;
+    SeparableEvaluator evaluator(m_functHdl, xPts.ToVector());
+    typename ColumnPool::Lease columnA
+        = ColumnPool::Local().Acquire(m_details->GetNumXPts(), 1, MemorySubsystem::GridFields);
+    typename ColumnPool::Lease columnB
+        = ColumnPool::Local().Acquire(m_details->GetNumXPts(), 1, MemorySubsystem::GridFields);
+
+    for (int timePoint = 0; timePoint < this->m_details->GetNumYPts(); timePoint++) {
+      evaluator.EvaluateColumn(timePts[timePoint], columnA->col(0), columnB->col(0));
+      m_grid_groundtruthA->col(timePoint)
+          = columnA->col(0).template cast<typename Policy::StorageComplex>();
+      m_grid_groundtruthB->col(timePoint)
+          = columnB->col(0).template cast<typename Policy::StorageComplex>();
+    }
+  } else {
+    const Eigen::Index numTimes = this->m_details->GetNumYPts();
+    auto evaluateField = [&](FieldMatrix& field, const FnHandlerRetType& wave) {
+      auto evaluateRows = [&](Eigen::Index timePoint, Eigen::Index firstRow, Eigen::Index endRow) {
+        auto timeValue = timePts[static_cast<int>(timePoint)];
+        for (int xPoint = static_cast<int>(firstRow); xPoint < endRow; xPoint++) {
+          // amplitudes are evaluated at accumulator precision and rounded once when stored
+          typename Policy::AccumulatorComplex amplitude = wave(xPts[xPoint], timeValue);
+          field(xPoint, timePoint) = Policy::ToStorage(amplitude);
+        }
+      };
+      // placed grids evaluate every page on the worker that placed it
+      if (m_placement) {
+        ForEachPlacedColumn(FieldLayout::Of(field), numTimes, *m_placement, evaluateRows);
+      } else {
+        for (Eigen::Index timePoint = 0; timePoint < numTimes; timePoint++) {
+          evaluateRows(timePoint, 0, field.rows());
+        }
+      }
+    };
+    evaluateField(*m_grid_groundtruthA, this->m_functHdl->A());
+    evaluateField(*m_grid_groundtruthB, this->m_functHdl->B());
+  }
+
+  m_groundtruth_computed = true;
+}
+
+template <typename Policy> void BasicGrid<Policy>::SetFieldEvaluation(FieldEvaluation evaluation) {
+  if (evaluation == m_evaluation) return;
+  m_evaluation = evaluation;
+  m_groundtruth_computed = false;
+}
+
+template <typename Policy>
+void BasicGrid<Policy>::PerturbGrid(const double pertubationCoefficient) {
+  std::random_device seed;
+  mt19937_64 engine(seed());
+  PerturbGrid(pertubationCoefficient, engine);
+}
+
+template <typename Policy>
+void BasicGrid<Policy>::PerturbGrid(const double pertubationCoefficient, mt19937_64& engine) {
+  PerturbLines(pertubationCoefficient, [&engine](const Cell&) {
+    return Helper::GenerateRandomNumber<double>(0, 1, engine);
+  });
+}
+
+template <typename Policy>
+void BasicGrid<Policy>::PerturbGrid(const double pertubationCoefficient, uint64_t seed) {
+  PerturbLines(pertubationCoefficient,
+               [seed](const Cell& cell) { return Helper::CellNoise(seed, cell.x, cell.y); });
+}
+
+template <typename Policy>
+void BasicGrid<Policy>::PerturbLines(double pertubationCoefficient,
+                                     const function<double(const Cell&)>& noise) {
+  if (!m_groundtruth_computed) ComputeGroundTruth();
+
+  // every cell off the x = 0 and t = 0 lines is identical to the ground truth
+  m_perturbed_gridA.Reset(m_grid_groundtruthA);
+  m_perturbed_gridB.Reset(m_grid_groundtruthB);
+
+  const Axis& xPts = this->m_details->GetXAxis();
+  const Axis& timePts = this->m_details->GetTimeAxis();
+  // the x = 0 and t = 0 lines are located directly instead of scanning every point
+  const vector<int> zeroPositions = xPts.Find(0);
+  const vector<int> zeroTimes = timePts.Find(0);
+
+  for (int xPoint : zeroPositions) {
     for (int timePoint = 0; timePoint < this->m_details->GetNumYPts(); timePoint++) {
       Cell cell(xPoint, timePoint);
-      auto posValue = this->m_details->m_x_pts.at(xPoint);
-      auto timeValue = this->m_details->m_time_pts.at(timePoint);
-      this->PerturbGridHelper(posValue, timeValue, cell, pertubationCoefficient);
+      this->PerturbGridHelper(xPts[xPoint], timePts[timePoint], cell,
+                              1 + (pertubationCoefficient * noise(cell)));
+    }
+  }
+
+  for (int timePoint : zeroTimes) {
+    for (int xPoint = 0; xPoint < this->m_details->GetNumXPts(); xPoint++) {
+      // cells on both lines were already perturbed by the loop above
+      if (xPts[xPoint] == 0) continue;
+      Cell cell(xPoint, timePoint);
+      this->PerturbGridHelper(xPts[xPoint], timePts[timePoint], cell,
+                              1 + (pertubationCoefficient * noise(cell)));
     }
   }
 }
 
-void Grid::PerturbGridHelper(const double& position, const double& time, const Cell& cell,
-                             double pertubationCoefficient) {
+template <typename Policy>
+void BasicGrid<Policy>::PerturbGridHelper(const double& position, const double& time,
+                                          const Cell& cell, double noiseValue) {
   if (time < 0) throw invalid_argument("time cannot be negative");
 
-  complex<double> amplitudeA = this->m_functHdl->A()(position, time);
-  complex<double> amplitudeB = this->m_functHdl->B()(position, time);
+  typename Policy::AccumulatorComplex amplitudeA = this->m_functHdl->A()(position, time);
+  typename Policy::AccumulatorComplex amplitudeB = this->m_functHdl->B()(position, time);
+  this->m_perturbed_gridA.Set(cell.x, cell.y, Policy::ToStorage(amplitudeA * (noiseValue)));
+  this->m_perturbed_gridB.Set(cell.x, cell.y, Policy::ToStorage(amplitudeB * (noiseValue)));
+}
 
-  if (position == 0 || time == 0) {
-    double noiseValue = 1 + (pertubationCoefficient * Helper::GenerateRandomNumber<double>(0, 1));
-    this->m_perturbed_gridA(cell.x, cell.y) = amplitudeA * (noiseValue);
-    this->m_perturbed_gridB(cell.x, cell.y) = amplitudeB * (noiseValue);
-  } else {
-    this->m_perturbed_gridA(cell.x, cell.y) = amplitudeA;
-    this->m_perturbed_gridB(cell.x, cell.y) = amplitudeB;
+template <typename Policy>
+void CGLE::ComputePerturbedRows(const Constraint& constraint, const GridDetails& details,
+                                int firstPosition, int numRows, double pertubationCoefficient,
+                                uint64_t seed, typename Policy::FieldMatrix& fieldA,
+                                typename Policy::FieldMatrix& fieldB) {
+  const Axis& xPts = details.GetXAxis();
+  const Axis& timePts = details.GetTimeAxis();
+  if (firstPosition < 0 || numRows < 1 || firstPosition + numRows > xPts.size()) {
+    throw invalid_argument("rows outside the grid");
+  }
+  if (any_of(timePts.begin(), timePts.end(), [](double time) { return time < 0; })) {
+    throw invalid_argument("time cannot be negative");
   }
 
-  // populate the ground truth waves
-  this->m_grid_groundtruthA(cell.x, cell.y) = amplitudeA;
-  this->m_grid_groundtruthB(cell.x, cell.y) = amplitudeB;
-}
\ No newline at end of file
+  // the ground truth of BasicGrid, evaluated by a separable evaluator over the block only
+  auto handler = make_shared<FunctionHandler>(constraint);
+  vector<double> positions(static_cast<size_t>(numRows));
+  for (int row = 0; row < numRows; row++) positions[row] = xPts[firstPosition + row];
+  SeparableEvaluator evaluator(handler, positions);
+  const int numTimes = timePts.size();
+  fieldA.resize(numRows, numTimes);
+  fieldB.resize(numRows, numTimes);
+  SeparableEvaluator::Column columnA(numRows), columnB(numRows);
+  for (int timePoint = 0; timePoint < numTimes; timePoint++) {
+    evaluator.EvaluateColumn(timePts[timePoint], columnA, columnB);
+    fieldA.col(timePoint) = columnA.template cast<typename Policy::StorageComplex>();
+    fieldB.col(timePoint) = columnB.template cast<typename Policy::StorageComplex>();
+  }
+
+  // the x = 0 and t = 0 lines of PerturbGrid(pertubationCoefficient, seed)
+  auto perturb = [&](int row, int timePoint) {
+    const double position = positions[row];
+    const double time = timePts[timePoint];
+    const double noiseValue
+        = 1 + (pertubationCoefficient * Helper::CellNoise(seed, firstPosition + row, timePoint));
+    typename Policy::AccumulatorComplex amplitudeA = handler->A()(position, time);
+    typename Policy::AccumulatorComplex amplitudeB = handler->B()(position, time);
+    fieldA(row, timePoint) = Policy::ToStorage(amplitudeA * (noiseValue));
+    fieldB(row, timePoint) = Policy::ToStorage(amplitudeB * (noiseValue));
+  };
+  const vector<int> zeroTimes = timePts.Find(0);
+  for (int row = 0; row < numRows; row++) {
+    if (positions[row] == 0) {
+      for (int timePoint = 0; timePoint < numTimes; timePoint++) perturb(row, timePoint);
+      continue;
+    }
+    for (int timePoint : zeroTimes) perturb(row, timePoint);
+  }
+}
+
+template class CGLE::BasicGrid<MixedPrecision>;
+template class CGLE::BasicGrid<DoublePrecision>;
+template void CGLE::ComputePerturbedRows<MixedPrecision>(const Constraint&, const GridDetails&,
+                                                         int, int, double, uint64_t,
+                                                         MixedPrecision::FieldMatrix&,
+                                                         MixedPrecision::FieldMatrix&);
+template void CGLE::ComputePerturbedRows<DoublePrecision>(const Constraint&, const GridDetails&,
+                                                          int, int, double, uint64_t,
+                                                          DoublePrecision::FieldMatrix&,
+                                                          DoublePrecision::FieldMatrix&);
@@ -1,13 +1,16 @@
-#pragma once
-#include <grid/grid.h>
-using namespace Grid;
+#include <constants.h>
+#include <gridDetails.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+using namespace CGLE;
 
 GridDetails::GridDetails()
     : m_num_x_points(DEFAULT_MAX_POSITION),
       m_num_y_points(DEFAULT_MAX_TIME),
       m_dx(DEFAULT_GRID_DX),
-      m_dy(DEFAULT_GRID_DY),
-{
+      m_dy(DEFAULT_GRID_DY) {
   this->PopulateTimeAndPositionalVectors(0, m_num_y_points, 0, m_num_x_points, DEFAULT_NUM_PTS);
   this->SetGridDimension();
 };
@@ -21,8 +24,8 @@ GridDetails::GridDetails(int grid_size_x, int grid_size_y, int totalNumberOfPts)
 
   // if no dimensional spacing is provided, we automatically compute it based on the total number of
   // points
-  m_dx = totalNumberOfPts / m_num_x_points;
-  m_dy = totalNumberOfPts / m_num_y_points;
+  m_dx = static_cast<double>(totalNumberOfPts) / m_num_x_points;
+  m_dy = static_cast<double>(totalNumberOfPts) / m_num_y_points;
 
   this->PopulateTimeAndPositionalVectors(0, m_num_y_points, 0, m_num_x_points, totalNumberOfPts);
   this->SetGridDimension();
@@ -33,13 +36,10 @@ GridDetails::GridDetails(int grid_size_x, int grid_size_y, double dx, double dy)
       m_num_y_points(std::move(grid_size_y)),
       m_dx(std::move(dx)),
       m_dy(std::move(dy)) {
-  double numPts, spacing;
-  // populate the number of values in the x axis and time axis
-  if (m_num_x_points != m_num_y_points) {
-    // obtain the maximal points which will dictate the size of the x and y axis of our grid
-    numPts = max(m_num_x_points, m_num_y_points);
-    m_num_y_points = m_num_x_points = numPts;
-  }
+  double spacing;
+  // obtain the maximal points which will dictate the size of the x and y axis of our grid
+  int numPts = max(m_num_x_points, m_num_y_points);
+  m_num_y_points = m_num_x_points = numPts;
 
   // obtain the spacing between points (we only care about the minimal spacing) as we want a more
   // fine grid if available
@@ -69,24 +69,52 @@ GridDetails::GridDetails(int startTime, int endTime, int startPosition, int endP
   this->SetGridDimension();
 }
 
+GridDetails::GridDetails(Axis xAxis, Axis timeAxis)
+    : m_time_axis(std::move(timeAxis)), m_x_axis(std::move(xAxis)) {
+  if (m_x_axis.size() < 2 || m_time_axis.size() < 2) {
+    throw std::invalid_argument("axes must have at least 2 points");
+  }
+
+  m_num_x_points = m_x_axis.size();
+  m_num_y_points = m_time_axis.size();
+  m_dx = std::abs(m_x_axis.GetStep());
+  m_dy = std::abs(m_time_axis.GetStep());
+  m_interval_start_time = static_cast<int>(m_time_axis[0]);
+  m_interval_end_time = static_cast<int>(m_time_axis[m_num_y_points - 1]);
+  m_start_pos = static_cast<int>(m_x_axis[0]);
+  m_end_pos = static_cast<int>(m_x_axis[m_num_x_points - 1]);
+  this->SetGridDimension();
+}
+
 int GridDetails::GetNumXPts() const { return m_num_x_points; }
 
 int GridDetails::GetNumYPts() const { return m_num_y_points; }
 
+double GridDetails::GetDx() const {
+  return m_x_axis.size() < 2 ? m_dx : std::abs(m_x_axis.GetStep());
+}
+
+double GridDetails::GetDt() const {
+  return m_time_axis.size() < 2 ? m_dy : std::abs(m_time_axis.GetStep());
+}
+
 void GridDetails::SetGridDimension() { m_dimensions = GridDimensions::TwoDimensions; }
 
 void GridDetails::PopulateTimeAndPositionalVectors(int startTime, int endTime, int startPosition,
                                                    int endPosition, int totalNumberOfPoints) {
   if ((endTime - startTime) % 2 == 0) {
-    auto leftHalf = Helper::linspace(startPosition, 0, (totalNumberOfPoints / 2) - 1);
-    auto rightHalf = Helper::linspace(0, endPosition, (totalNumberOfPoints / 2) - 1);
-    leftHalf.insert(leftHalf.end(), std::make_move_iterator(rightHalf.begin()),
-                    std::make_move_iterator(rightHalf.end()));
-    m_x_pts = leftHalf;
-    m_time_pts = Helper::linspace(startTime, endTime, totalNumberOfPoints);
-    return;
+    // two uniform halves meeting at 0, the joined mesh is kept as explicit points
+    const int halfPoints = (totalNumberOfPoints / 2) - 1;
+    vector<double> points = Axis::Linspace(startPosition, 0, halfPoints).ToVector();
+    vector<double> rightHalf = Axis::Linspace(0, endPosition, halfPoints).ToVector();
+    points.insert(points.end(), rightHalf.begin(), rightHalf.end());
+    m_x_axis = Axis::Explicit(std::move(points));
+  } else {
+    m_x_axis = Axis::Linspace(startPosition, endPosition, totalNumberOfPoints);
   }
+  m_time_axis = Axis::Linspace(startTime, endTime, totalNumberOfPoints);
 
-  m_x_pts = Helper::linspace(startPosition, endPosition, totalNumberOfPoints);
-  m_time_pts = Helper::linspace(startTime, endTime, totalNumberOfPoints);
+  // the field matrices are sized from these counts so they must match the materialized axes
+  m_num_x_points = m_x_axis.size();
+  m_num_y_points = m_time_axis.size();
 }
\ No newline at end of file
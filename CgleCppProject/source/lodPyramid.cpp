@@ -0,0 +1,164 @@
+#include <binaryStream.h>
+#include <lodPyramid.h>
+
+#include <cstring>
+#include <stdexcept>
+using namespace CGLE;
+
+namespace {
+  const char LOD_MAGIC[8] = {'C', 'G', 'L', 'E', 'L', 'O', 'D', '1'};
+
+  void WriteArray(ostream& stream, const Eigen::ArrayXXf& values) {
+    stream.write(reinterpret_cast<const char*>(values.data()),
+                 static_cast<streamsize>(values.size() * sizeof(float)));
+  }
+
+  void ReadArray(istream& stream, Eigen::ArrayXXf& values) {
+    if (!stream.read(reinterpret_cast<char*>(values.data()),
+                     static_cast<streamsize>(values.size() * sizeof(float)))) {
+      throw runtime_error("pyramid file is truncated");
+    }
+  }
+}  // namespace
+
+string CGLE::GetLodPath(const string& snapshotPath) { return snapshotPath + ".lod"; }
+
+LodWriter::LodWriter(const string& path) : m_path(path), m_stream(path, ios::binary | ios::trunc) {
+  if (!m_stream.is_open()) throw runtime_error("Error opening pyramid file " + path);
+
+  m_stream.write(LOD_MAGIC, sizeof(LOD_MAGIC));
+  WriteBinary<uint32_t>(m_stream, 0);
+}
+
+LodWriter::~LodWriter() {
+  try {
+    Close();
+  } catch (...) {
+    // destructors never throw, call Close() explicitly to observe write failures
+  }
+}
+
+void LodWriter::WritePyramid(const string& name, const LodPyramid& pyramid) {
+  if (!m_stream.is_open()) throw runtime_error("pyramid file " + m_path + " is already closed");
+
+  WriteBinaryString(m_stream, name);
+  WriteBinary<int64_t>(m_stream, pyramid.GetBaseRows());
+  WriteBinary<int64_t>(m_stream, pyramid.GetBaseCols());
+  WriteBinary<uint32_t>(m_stream, static_cast<uint32_t>(pyramid.GetNumLevels()));
+  for (int level = 1; level <= pyramid.GetNumLevels(); level++) {
+    const LodLevel& reduced = pyramid.GetLevel(level);
+    WriteBinary<int64_t>(m_stream, reduced.rows());
+    WriteBinary<int64_t>(m_stream, reduced.cols());
+    WriteArray(m_stream, reduced.min);
+    WriteArray(m_stream, reduced.max);
+    WriteArray(m_stream, reduced.mean);
+  }
+  if (!m_stream) throw runtime_error("Error writing pyramid file " + m_path);
+  m_numFields++;
+}
+
+void LodWriter::Close() {
+  if (!m_stream.is_open()) return;
+
+  m_stream.seekp(sizeof(LOD_MAGIC));
+  WriteBinary<uint32_t>(m_stream, m_numFields);
+  m_stream.close();
+  if (m_stream.fail()) throw runtime_error("Error writing pyramid file " + m_path);
+}
+
+LodReader::LodReader(const string& path) : m_path(path), m_stream(path, ios::binary) {
+  if (!m_stream.is_open()) throw runtime_error("Error opening pyramid file " + path);
+
+  char magic[sizeof(LOD_MAGIC)];
+  if (!m_stream.read(magic, sizeof(magic)) || memcmp(magic, LOD_MAGIC, sizeof(magic)) != 0) {
+    throw runtime_error(path + " is not a pyramid file");
+  }
+
+  const uint32_t numFields = ReadBinary<uint32_t>(m_stream);
+  for (uint32_t field = 0; field < numFields; field++) {
+    FieldInfo info;
+    info.name = ReadBinaryString(m_stream);
+    info.baseRows = ReadBinary<int64_t>(m_stream);
+    info.baseCols = ReadBinary<int64_t>(m_stream);
+    const uint32_t numLevels = ReadBinary<uint32_t>(m_stream);
+    for (uint32_t level = 0; level < numLevels; level++) {
+      LevelInfo levelInfo;
+      levelInfo.rows = ReadBinary<int64_t>(m_stream);
+      levelInfo.cols = ReadBinary<int64_t>(m_stream);
+      levelInfo.offset = static_cast<int64_t>(m_stream.tellg());
+      // skip the min, max and mean arrays, only the index is read up front
+      m_stream.seekg(3 * levelInfo.rows * levelInfo.cols * sizeof(float), ios::cur);
+      info.levels.push_back(levelInfo);
+    }
+    m_fields.push_back(info);
+  }
+}
+
+vector<string> LodReader::GetFieldNames() const {
+  vector<string> names;
+  for (const FieldInfo& field : m_fields) names.push_back(field.name);
+  return names;
+}
+
+int LodReader::GetNumLevels(const string& name) const {
+  return static_cast<int>(GetField(name).levels.size());
+}
+
+int LodReader::SelectLevel(const string& name, Eigen::Index maxRows, Eigen::Index maxCols) const {
+  const FieldInfo& field = GetField(name);
+  if (field.baseRows <= maxRows && field.baseCols <= maxCols) return 0;
+  for (size_t level = 0; level < field.levels.size(); level++) {
+    if (field.levels[level].rows <= maxRows && field.levels[level].cols <= maxCols) {
+      return static_cast<int>(level) + 1;
+    }
+  }
+  return static_cast<int>(field.levels.size());
+}
+
+LodLevel LodReader::ReadLevel(const string& name, int level) {
+  const FieldInfo& field = GetField(name);
+  if (level < 1 || level > static_cast<int>(field.levels.size())) {
+    throw out_of_range("pyramid level out of range");
+  }
+
+  const LevelInfo& info = field.levels[level - 1];
+  LodLevel reduced;
+  reduced.level = level;
+  reduced.min.resize(info.rows, info.cols);
+  reduced.max.resize(info.rows, info.cols);
+  reduced.mean.resize(info.rows, info.cols);
+
+  m_stream.clear();
+  m_stream.seekg(info.offset);
+  ReadArray(m_stream, reduced.min);
+  ReadArray(m_stream, reduced.max);
+  ReadArray(m_stream, reduced.mean);
+  return reduced;
+}
+
+const LodReader::FieldInfo& LodReader::GetField(const string& name) const {
+  for (const FieldInfo& field : m_fields) {
+    if (field.name == name) return field;
+  }
+  throw invalid_argument("pyramid file has no field " + name);
+}
+
+template <typename Policy>
+void CGLE::WriteLodPyramids(const BasicGrid<Policy>& grid, const string& snapshotPath,
+                            int minSize, int numThreads) {
+  // pyramids are built and written one field at a time to bound the extra memory
+  LodWriter writer(GetLodPath(snapshotPath));
+  writer.WritePyramid("GroundTruthA",
+                      LodPyramid::Build(grid.GetGroundTruthA(), minSize, numThreads));
+  writer.WritePyramid("GroundTruthB",
+                      LodPyramid::Build(grid.GetGroundTruthB(), minSize, numThreads));
+  writer.WritePyramid("PerturbedGridAA",
+                      LodPyramid::Build(grid.GetPerturbedA(), minSize, numThreads));
+  writer.WritePyramid("PerturbedGridBB",
+                      LodPyramid::Build(grid.GetPerturbedB(), minSize, numThreads));
+  writer.Close();
+}
+
+template void CGLE::WriteLodPyramids<MixedPrecision>(const Grid&, const string&, int, int);
+template void CGLE::WriteLodPyramids<DoublePrecision>(const ReferenceGrid&, const string&, int,
+                                                      int);
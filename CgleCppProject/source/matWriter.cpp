@@ -0,0 +1,357 @@
+#include <binaryStream.h>
+#include <matWriter.h>
+
+#include <climits>
+#include <ctime>
+#include <stdexcept>
+#ifdef CGLE_WITH_ZLIB
+#  include <zlib.h>
+#endif
+using namespace CGLE;
+
+namespace {
+  /** data types of the Level 5 format **/
+  const uint32_t MI_INT8 = 1;
+  const uint32_t MI_UINT16 = 4;
+  const uint32_t MI_INT32 = 5;
+  const uint32_t MI_UINT32 = 6;
+  const uint32_t MI_SINGLE = 7;
+  const uint32_t MI_DOUBLE = 9;
+  const uint32_t MI_MATRIX = 14;
+  const uint32_t MI_COMPRESSED = 15;
+
+  const uint32_t COMPLEX_FLAG = 0x0800;
+  /** struct field names are stored in fixed width, null terminated slots **/
+  const uint64_t FIELD_NAME_LENGTH = 32;
+  const size_t HEADER_TEXT_LENGTH = 116;
+
+  uint64_t Padded(uint64_t size) { return (size + 7) & ~uint64_t(7); }
+
+  /** size of a data element with its tag **/
+  uint64_t ElementSize(uint64_t dataSize) { return 8 + Padded(dataSize); }
+
+  uint64_t ScalarSize(MatClass matClass) {
+    switch (matClass) {
+      case MatClass::Char:
+        return sizeof(uint16_t);
+      case MatClass::Single:
+        return sizeof(float);
+      case MatClass::Double:
+        return sizeof(double);
+      case MatClass::Struct:
+        break;
+    }
+    throw invalid_argument("struct arrays have no scalar data");
+  }
+
+  uint32_t DataType(MatClass matClass) {
+    switch (matClass) {
+      case MatClass::Char:
+        return MI_UINT16;
+      case MatClass::Single:
+        return MI_SINGLE;
+      case MatClass::Double:
+        return MI_DOUBLE;
+      case MatClass::Struct:
+        break;
+    }
+    throw invalid_argument("struct arrays have no scalar data");
+  }
+
+  uint64_t DataSize(const MatArray& array) {
+    return static_cast<uint64_t>(array.rows) * static_cast<uint64_t>(array.cols)
+           * ScalarSize(array.matClass);
+  }
+
+  /** size of the miMATRIX payload of a numeric or char array **/
+  uint64_t ArraySize(const MatArray& array, size_t nameLength) {
+    const uint64_t parts = array.isComplex ? 2 : 1;
+    return ElementSize(8) + ElementSize(8) + ElementSize(nameLength)
+           + parts * ElementSize(DataSize(array));
+  }
+
+  void CheckVariableSize(uint64_t size) {
+    if (size > UINT32_MAX) {
+      throw runtime_error(".mat v5 variables are limited to 4 GiB, use a smaller grid or snapshot");
+    }
+  }
+}  // namespace
+
+MatArray MatArray::FromVector(const string& name, const vector<double>& values) {
+  auto data = make_shared<vector<double>>(values);
+  MatArray array;
+  array.name = name;
+  array.rows = 1;
+  array.cols = static_cast<int64_t>(values.size());
+  array.produce = [data](const Sink& sink, bool) {
+    sink(reinterpret_cast<const char*>(data->data()), data->size() * sizeof(double));
+  };
+  return array;
+}
+
+MatArray MatArray::FromScalar(const string& name, double value) {
+  return FromVector(name, vector<double>{value});
+}
+
+MatArray MatArray::FromString(const string& name, const string& value) {
+  auto data = make_shared<vector<uint16_t>>(value.begin(), value.end());
+  MatArray array;
+  array.name = name;
+  array.matClass = MatClass::Char;
+  array.rows = 1;
+  array.cols = static_cast<int64_t>(value.size());
+  array.produce = [data](const Sink& sink, bool) {
+    sink(reinterpret_cast<const char*>(data->data()), data->size() * sizeof(uint16_t));
+  };
+  return array;
+}
+
+struct MatWriter::Deflater {
+#ifdef CGLE_WITH_ZLIB
+  ~Deflater() { deflateEnd(&stream); }
+
+  z_stream stream{};
+#endif
+  /** position of the size field of the open miCOMPRESSED tag **/
+  streampos sizePosition;
+  uint64_t compressedSize = 0;
+  vector<char> buffer = vector<char>(MAT_WRITE_CHUNK_BYTES);
+};
+
+MatWriter::MatWriter(const string& path, int compressionLevel)
+    : m_path(path), m_compressionLevel(compressionLevel) {
+  if (compressionLevel < 0 || compressionLevel > 9) {
+    throw invalid_argument("compression level must be between 0 and 9");
+  }
+  if (compressionLevel > 0 && !IsCompressionAvailable()) {
+    throw invalid_argument("this build has no zlib, .mat files can only be written uncompressed");
+  }
+
+  m_stream.open(path, ios::binary | ios::trunc);
+  if (!m_stream.is_open()) throw runtime_error("Error opening .mat file " + path);
+
+  const time_t now = time(nullptr);
+  char date[64] = "";
+  strftime(date, sizeof(date), "%a %b %d %H:%M:%S %Y", localtime(&now));
+  string text = string("MATLAB 5.0 MAT-file, Platform: CGLE, Created on: ") + date;
+  text.resize(HEADER_TEXT_LENGTH, ' ');
+  m_stream.write(text.data(), static_cast<streamsize>(text.size()));
+  WriteBinary<uint64_t>(m_stream, 0);
+  WriteBinary<uint16_t>(m_stream, 0x0100);
+  // written in native byte order, readers swap when they see "MI" instead of "IM"
+  WriteBinary<uint16_t>(m_stream, static_cast<uint16_t>(('M' << 8) | 'I'));
+}
+
+MatWriter::~MatWriter() {
+  try {
+    Close();
+  } catch (...) {
+    // destructors never throw, call Close() explicitly to observe write failures
+  }
+}
+
+bool MatWriter::IsCompressionAvailable() {
+#ifdef CGLE_WITH_ZLIB
+  return true;
+#else
+  return false;
+#endif
+}
+
+void MatWriter::WriteArray(const MatArray& array) {
+  const uint64_t size = ArraySize(array, array.name.size());
+  CheckVariableSize(size);
+
+  BeginVariable();
+  WriteTag(MI_MATRIX, size);
+  WriteArrayBody(array, array.name);
+  EndVariable();
+}
+
+void MatWriter::WriteStruct(const string& name, const vector<MatArray>& fields) {
+  uint64_t size = ElementSize(8) + ElementSize(8) + ElementSize(name.size())
+                  + ElementSize(sizeof(int32_t)) + ElementSize(FIELD_NAME_LENGTH * fields.size());
+  for (const MatArray& field : fields) {
+    if (field.name.empty() || field.name.size() >= FIELD_NAME_LENGTH) {
+      throw invalid_argument("struct field names must have between 1 and 31 characters");
+    }
+    size += 8 + ArraySize(field, 0);
+  }
+  CheckVariableSize(size);
+
+  BeginVariable();
+  WriteTag(MI_MATRIX, size);
+  WriteArrayHeader(MatClass::Struct, false, 1, 1, name);
+
+  WriteTag(MI_INT32, sizeof(int32_t));
+  const auto nameLength = static_cast<int32_t>(FIELD_NAME_LENGTH);
+  Write(reinterpret_cast<const char*>(&nameLength), sizeof(nameLength));
+  WritePadding(sizeof(int32_t));
+
+  string names(FIELD_NAME_LENGTH * fields.size(), '\0');
+  for (size_t field = 0; field < fields.size(); field++) {
+    names.replace(field * FIELD_NAME_LENGTH, fields[field].name.size(), fields[field].name);
+  }
+  WriteTag(MI_INT8, names.size());
+  Write(names.data(), names.size());
+  WritePadding(names.size());
+
+  // struct fields are unnamed arrays, their names come from the list above
+  for (const MatArray& field : fields) {
+    WriteTag(MI_MATRIX, ArraySize(field, 0));
+    WriteArrayBody(field, "");
+  }
+  EndVariable();
+}
+
+void MatWriter::Close() {
+  if (!m_stream.is_open()) return;
+
+  m_stream.close();
+  if (m_stream.fail()) throw runtime_error("Error writing .mat file " + m_path);
+}
+
+void MatWriter::WriteArrayHeader(MatClass matClass, bool isComplex, int64_t rows, int64_t cols,
+                                 const string& name) {
+  if (rows > INT32_MAX || cols > INT32_MAX) {
+    throw runtime_error(".mat v5 array dimensions are limited to 2^31 - 1");
+  }
+
+  WriteTag(MI_UINT32, 8);
+  const uint32_t flags[2] = {static_cast<uint32_t>(matClass) | (isComplex ? COMPLEX_FLAG : 0), 0};
+  Write(reinterpret_cast<const char*>(flags), sizeof(flags));
+
+  WriteTag(MI_INT32, 8);
+  const int32_t dimensions[2] = {static_cast<int32_t>(rows), static_cast<int32_t>(cols)};
+  Write(reinterpret_cast<const char*>(dimensions), sizeof(dimensions));
+
+  WriteTag(MI_INT8, name.size());
+  Write(name.data(), name.size());
+  WritePadding(name.size());
+}
+
+void MatWriter::WriteArrayBody(const MatArray& array, const string& name) {
+  WriteArrayHeader(array.matClass, array.isComplex, array.rows, array.cols, name);
+
+  const uint64_t dataSize = DataSize(array);
+  const MatArray::Sink sink = [this](const char* data, size_t size) { Write(data, size); };
+  for (bool imaginary : {false, true}) {
+    if (imaginary && !array.isComplex) break;
+
+    WriteTag(DataType(array.matClass), dataSize);
+    if (dataSize > 0) array.produce(sink, imaginary);
+    WritePadding(dataSize);
+  }
+}
+
+void MatWriter::WriteTag(uint32_t type, uint64_t size) {
+  const uint32_t tag[2] = {type, static_cast<uint32_t>(size)};
+  Write(reinterpret_cast<const char*>(tag), sizeof(tag));
+}
+
+void MatWriter::WritePadding(uint64_t size) {
+  const char zeros[8] = {};
+  Write(zeros, Padded(size) - size);
+}
+
+void MatWriter::BeginVariable() {
+  if (!m_stream.is_open()) throw runtime_error(".mat file " + m_path + " is already closed");
+  if (m_compressionLevel == 0) return;
+
+#ifdef CGLE_WITH_ZLIB
+  m_deflater = make_unique<Deflater>();
+  WriteBinary<uint32_t>(m_stream, MI_COMPRESSED);
+  m_deflater->sizePosition = m_stream.tellp();
+  WriteBinary<uint32_t>(m_stream, 0);
+  if (deflateInit(&m_deflater->stream, m_compressionLevel) != Z_OK) {
+    m_deflater.reset();
+    throw runtime_error("Error initializing zlib");
+  }
+#endif
+}
+
+void MatWriter::EndVariable() {
+#ifdef CGLE_WITH_ZLIB
+  if (m_deflater) {
+    z_stream& stream = m_deflater->stream;
+    int status = Z_OK;
+    while (status != Z_STREAM_END) {
+      stream.next_out = reinterpret_cast<Bytef*>(m_deflater->buffer.data());
+      stream.avail_out = static_cast<uInt>(m_deflater->buffer.size());
+      status = deflate(&stream, Z_FINISH);
+      if (status == Z_STREAM_ERROR) break;
+      const size_t produced = m_deflater->buffer.size() - stream.avail_out;
+      m_stream.write(m_deflater->buffer.data(), static_cast<streamsize>(produced));
+      m_deflater->compressedSize += produced;
+    }
+    const uint64_t compressedSize = m_deflater->compressedSize;
+    const streampos sizePosition = m_deflater->sizePosition;
+    m_deflater.reset();
+    if (status != Z_STREAM_END) throw runtime_error("Error compressing .mat variable");
+    CheckVariableSize(compressedSize);
+
+    // compressed elements are not padded, only the size in their tag is patched
+    const streampos end = m_stream.tellp();
+    m_stream.seekp(sizePosition);
+    WriteBinary<uint32_t>(m_stream, static_cast<uint32_t>(compressedSize));
+    m_stream.seekp(end);
+  }
+#endif
+  if (!m_stream) throw runtime_error("Error writing .mat file " + m_path);
+}
+
+void MatWriter::Write(const char* data, size_t size) {
+  if (size == 0) return;
+  if (!m_deflater) {
+    m_stream.write(data, static_cast<streamsize>(size));
+    return;
+  }
+
+#ifdef CGLE_WITH_ZLIB
+  z_stream& stream = m_deflater->stream;
+  while (size > 0) {
+    // zlib counts input in uInt, feed very large chunks in slices
+    const size_t slice = min<size_t>(size, UINT_MAX);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream.avail_in = static_cast<uInt>(slice);
+    do {
+      stream.next_out = reinterpret_cast<Bytef*>(m_deflater->buffer.data());
+      stream.avail_out = static_cast<uInt>(m_deflater->buffer.size());
+      if (deflate(&stream, Z_NO_FLUSH) == Z_STREAM_ERROR) {
+        throw runtime_error("Error compressing .mat variable");
+      }
+      const size_t produced = m_deflater->buffer.size() - stream.avail_out;
+      m_stream.write(m_deflater->buffer.data(), static_cast<streamsize>(produced));
+      m_deflater->compressedSize += produced;
+    } while (stream.avail_out == 0);
+    data += slice;
+    size -= slice;
+  }
+#endif
+}
+
+template <typename Policy>
+void CGLE::WriteMatFile(const BasicGrid<Policy>& grid, const string& path,
+                        int compressionLevel) {
+  const GridDetails& details = grid.GetDetails();
+  vector<MatArray> fields = {
+      MatArray::FromVector("X", details.GetXAxis().ToVector()),
+      MatArray::FromVector("T", details.GetTimeAxis().ToVector()),
+      MatArray::FromScalar("Dx", details.GetDx()),
+      MatArray::FromScalar("Dt", details.GetDt()),
+      MatArray::FromScalar("Nx", details.GetNumXPts()),
+      MatArray::FromScalar("Nt", details.GetNumYPts()),
+      MatArray::FromString("WaveType", grid.GetConstraint().m_WaveType),
+      MatArray::FromTransposedField("GroundTruthA", grid.GetGroundTruthA()),
+      MatArray::FromTransposedField("GroundTruthB", grid.GetGroundTruthB()),
+      MatArray::FromTransposedField("PerturbedGridAA", grid.GetPerturbedA()),
+      MatArray::FromTransposedField("PerturbedGridBB", grid.GetPerturbedB()),
+  };
+
+  MatWriter writer(path, compressionLevel);
+  writer.WriteStruct("grid", fields);
+  writer.Close();
+}
+
+template void CGLE::WriteMatFile<MixedPrecision>(const Grid&, const string&, int);
+template void CGLE::WriteMatFile<DoublePrecision>(const ReferenceGrid&, const string&, int);
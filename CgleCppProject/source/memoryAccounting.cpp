@@ -0,0 +1,100 @@
+#include <memoryAccounting.h>
+
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+using namespace CGLE;
+
+namespace {
+  struct Counters {
+    atomic<size_t> live{0};
+    atomic<size_t> peak{0};
+  };
+
+  Counters& GetCounters(MemorySubsystem subsystem) {
+    static Counters counters[NUM_MEMORY_SUBSYSTEMS];
+    const int index = static_cast<int>(subsystem);
+    if (index < 0 || index >= NUM_MEMORY_SUBSYSTEMS) {
+      throw invalid_argument("unknown memory subsystem");
+    }
+    return counters[index];
+  }
+
+  Counters& GetTotalCounters() {
+    static Counters total;
+    return total;
+  }
+
+  void RaisePeak(atomic<size_t>& peak, size_t live) {
+    size_t current = peak.load(memory_order_relaxed);
+    while (live > current && !peak.compare_exchange_weak(current, live, memory_order_relaxed)) {
+    }
+  }
+
+  void Add(Counters& counters, size_t bytes) {
+    RaisePeak(counters.peak, counters.live.fetch_add(bytes, memory_order_relaxed) + bytes);
+  }
+}  // namespace
+
+string CGLE::GetMemorySubsystemName(MemorySubsystem subsystem) {
+  switch (subsystem) {
+    case MemorySubsystem::GridFields:
+      return "GridFields";
+    case MemorySubsystem::GridDetails:
+      return "GridDetails";
+    case MemorySubsystem::FunctionHandler:
+      return "FunctionHandler";
+    case MemorySubsystem::ConstraintReader:
+      return "ConstraintReader";
+    case MemorySubsystem::Solver:
+      return "Solver";
+    case MemorySubsystem::BufferPool:
+      return "BufferPool";
+    case MemorySubsystem::Other:
+      return "Other";
+  }
+  throw invalid_argument("unknown memory subsystem");
+}
+
+void MemoryAccountant::Charge(MemorySubsystem subsystem, size_t bytes) {
+  if (bytes == 0) return;
+  Add(GetCounters(subsystem), bytes);
+  Add(GetTotalCounters(), bytes);
+}
+
+void MemoryAccountant::Refund(MemorySubsystem subsystem, size_t bytes) {
+  if (bytes == 0) return;
+  GetCounters(subsystem).live.fetch_sub(bytes, memory_order_relaxed);
+  GetTotalCounters().live.fetch_sub(bytes, memory_order_relaxed);
+}
+
+MemoryUsage MemoryAccountant::GetUsage(MemorySubsystem subsystem) {
+  const Counters& counters = GetCounters(subsystem);
+  return MemoryUsage{counters.live.load(), counters.peak.load()};
+}
+
+MemoryUsage MemoryAccountant::GetTotalUsage() {
+  const Counters& total = GetTotalCounters();
+  return MemoryUsage{total.live.load(), total.peak.load()};
+}
+
+void MemoryAccountant::ResetPeaks() {
+  for (int index = 0; index < NUM_MEMORY_SUBSYSTEMS; index++) {
+    Counters& counters = GetCounters(static_cast<MemorySubsystem>(index));
+    counters.peak = counters.live.load();
+  }
+  GetTotalCounters().peak = GetTotalCounters().live.load();
+}
+
+string MemoryAccountant::GetReport() {
+  ostringstream report;
+  for (int index = 0; index < NUM_MEMORY_SUBSYSTEMS; index++) {
+    const MemorySubsystem subsystem = static_cast<MemorySubsystem>(index);
+    const MemoryUsage usage = GetUsage(subsystem);
+    report << GetMemorySubsystemName(subsystem) << ": live " << usage.liveBytes << " bytes, peak "
+           << usage.peakBytes << " bytes\n";
+  }
+  const MemoryUsage total = GetTotalUsage();
+  report << "Total: live " << total.liveBytes << " bytes, peak " << total.peakBytes << " bytes\n";
+  return report.str();
+}
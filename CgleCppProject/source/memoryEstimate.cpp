@@ -0,0 +1,85 @@
+#include <functionHandler.h>
+#include <memoryEstimate.h>
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include "helper.h"
+using namespace CGLE;
+
+namespace {
+  /** bytes of a partitioned tridiagonal factorization, see PartitionedTridiagonalSolver **/
+  template <typename Scalar> size_t TridiagonalBytes(int size, int numThreads) {
+    size_t elements = 2 * static_cast<size_t>(size);
+    const int threads = Helper::GetNumThreads(numThreads);
+    const int partitions
+        = size >= PARALLEL_TRIDIAGONAL_THRESHOLD ? max(1, min(threads, size / 2)) : 1;
+    if (partitions > 1) {
+      const size_t blockSize = static_cast<size_t>(size / partitions);
+      // small and large block factorizations, then their left and right spikes
+      elements += 2 * blockSize + 2 * (blockSize + 1);
+      elements += 2 * blockSize + 2 * (blockSize + 1);
+      elements += 3 * static_cast<size_t>(partitions) * 4;
+      // reduced system right hand side
+      elements += 2 * static_cast<size_t>(partitions);
+    }
+    return elements * sizeof(Scalar);
+  }
+}  // namespace
+
+size_t MemoryEstimate::GetTotalBytes() const {
+  return accumulate(bytes.begin(), bytes.end(), size_t(0));
+}
+
+template <typename Policy>
+MemoryEstimate CGLE::EstimateMemory(int numXPts, int numTimePts, BoundaryCondition boundary,
+                                    int numThreads) {
+  if (numXPts < 3 || numTimePts < 1) throw invalid_argument("invalid grid dimensions");
+
+  using StorageComplex = typename Policy::StorageComplex;
+  using AccumulatorComplex = typename Policy::AccumulatorComplex;
+  MemoryEstimate estimate;
+  auto at = [&estimate](MemorySubsystem subsystem) -> size_t& {
+    return estimate.bytes[static_cast<size_t>(subsystem)];
+  };
+
+  // ground truth and materialized perturbed fields, plus the copy-on-write tiles of the field
+  // being materialized
+  const size_t cells = static_cast<size_t>(numXPts) * static_cast<size_t>(numTimePts);
+  const size_t tileSize = DEFAULT_FIELD_TILE_SIZE;
+  const size_t tiles = (numXPts + tileSize - 1) / tileSize + (numTimePts + tileSize - 1) / tileSize;
+  const size_t tileCells = min(cells, tiles * tileSize * tileSize);
+  at(MemorySubsystem::GridFields) = (4 * cells + tileCells) * sizeof(StorageComplex)
+                                    + 2 * static_cast<size_t>(numXPts) * sizeof(complex<double>);
+
+  at(MemorySubsystem::FunctionHandler) = sizeof(FunctionHandler) + sizeof(Constraint);
+
+  const bool periodic = boundary == BoundaryCondition::Periodic;
+  const int numUnknowns = periodic ? numXPts : numXPts - 2;
+  size_t systemBytes = TridiagonalBytes<AccumulatorComplex>(numUnknowns, numThreads);
+  if (periodic) systemBytes += 2 * static_cast<size_t>(numUnknowns) * sizeof(AccumulatorComplex);
+  at(MemorySubsystem::Solver)
+      = 2 * systemBytes + 2 * static_cast<size_t>(numUnknowns) * sizeof(AccumulatorComplex);
+  return estimate;
+}
+
+template <typename Policy>
+MemoryEstimate CGLE::EstimateMemory(const GridDetails& details, BoundaryCondition boundary,
+                                    int numThreads) {
+  MemoryEstimate estimate = EstimateMemory<Policy>(details.GetNumXPts(), details.GetNumYPts(),
+                                                   boundary, numThreads);
+  size_t axisPoints = 0;
+  for (const Axis* axis : {&details.GetXAxis(), &details.GetTimeAxis()}) {
+    if (!axis->IsUniform()) axisPoints += static_cast<size_t>(axis->size());
+  }
+  estimate.bytes[static_cast<size_t>(MemorySubsystem::GridDetails)] = axisPoints * sizeof(double);
+  return estimate;
+}
+
+template MemoryEstimate CGLE::EstimateMemory<MixedPrecision>(int, int, BoundaryCondition, int);
+template MemoryEstimate CGLE::EstimateMemory<DoublePrecision>(int, int, BoundaryCondition, int);
+template MemoryEstimate CGLE::EstimateMemory<MixedPrecision>(const GridDetails&,
+                                                             BoundaryCondition, int);
+template MemoryEstimate CGLE::EstimateMemory<DoublePrecision>(const GridDetails&,
+                                                              BoundaryCondition, int);
@@ -0,0 +1,187 @@
+#include <newtonKrylov.h>
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+using namespace CGLE;
+
+namespace {
+  /** real inner product of vectors seen as the concatenation of their real and imaginary parts **/
+  template <typename X, typename Y>
+  double RealDot(const Eigen::MatrixBase<X>& x, const Eigen::MatrixBase<Y>& y) {
+    return std::real(x.dot(y));
+  }
+}  // namespace
+
+template <typename Scalar>
+NewtonKrylovSolver<Scalar>::NewtonKrylovSolver(const NewtonKrylovOptions& options)
+    : m_options(options) {
+  if (options.maxNewtonIterations < 1 || options.krylovDimension < 1
+      || options.maxKrylovRestarts < 1 || options.maxBacktracks < 0) {
+    throw invalid_argument("Newton-Krylov iteration limits must be positive");
+  }
+  if (!(options.forcingTerm > 0 && options.forcingTerm < 1)) {
+    throw invalid_argument("forcing term must lie in (0, 1)");
+  }
+}
+
+template <typename Scalar> void NewtonKrylovSolver<Scalar>::Reserve(Eigen::Index size) {
+  const int dimension = m_options.krylovDimension;
+  if (m_basis.rows() == size) return;
+
+  m_basis.resize(size, dimension + 1);
+  m_hessenberg.resize(dimension + 1, dimension);
+  m_cosines.resize(dimension);
+  m_sines.resize(dimension);
+  m_projection.resize(dimension + 1);
+  m_work.resize(size);
+  m_direction.resize(size);
+  m_perturbed.resize(size);
+  m_perturbedResidual.resize(size);
+  m_charge.Update(sizeof(Scalar) * static_cast<size_t>(size * (dimension + 5)));
+}
+
+template <typename Scalar>
+void NewtonKrylovSolver<Scalar>::ApplyJacobian(const Residual& residual, const Vector& x,
+                                               const Vector& residualAtX, const Vector& v,
+                                               Vector& product) {
+  const double norm = v.norm();
+  if (norm == 0) {
+    product.setZero(x.size());
+    return;
+  }
+  // balances truncation against cancellation relative to the size of x
+  const double step = std::sqrt(numeric_limits<double>::epsilon()) * (1 + x.norm()) / norm;
+  m_perturbed = x + Real(step) * v;
+  residual(m_perturbed, m_perturbedResidual);
+  m_residualEvaluations++;
+  product = (m_perturbedResidual - residualAtX) / Real(step);
+}
+
+template <typename Scalar>
+int NewtonKrylovSolver<Scalar>::Gmres(const Residual& residual,
+                                      const Preconditioner& precondition, const Vector& x,
+                                      const Vector& residualAtX, const Vector& rhs,
+                                      Vector& correction) {
+  const int dimension = m_options.krylovDimension;
+  const double target = m_options.forcingTerm * rhs.norm();
+  correction.setZero(x.size());
+  m_work = rhs;
+  double beta = m_work.norm();
+  int iterations = 0;
+
+  for (int restart = 0; restart < m_options.maxKrylovRestarts && beta > target; restart++) {
+    m_basis.col(0) = m_work / Real(beta);
+    m_projection.setZero();
+    m_projection[0] = beta;
+
+    int size = 0;
+    while (size < dimension) {
+      const int column = size;
+      m_direction = m_basis.col(column);
+      precondition(m_direction);
+      ApplyJacobian(residual, x, residualAtX, m_direction, m_work);
+      iterations++;
+
+      // modified Gram-Schmidt against the basis with the real inner product
+      for (int row = 0; row <= column; row++) {
+        const double coefficient = RealDot(m_basis.col(row), m_work);
+        m_hessenberg(row, column) = Real(coefficient);
+        m_work -= Real(coefficient) * m_basis.col(row);
+      }
+      const double next = m_work.norm();
+      m_hessenberg(column + 1, column) = Real(next);
+
+      for (int row = 0; row < column; row++) {
+        const Real upper = m_hessenberg(row, column);
+        const Real lower = m_hessenberg(row + 1, column);
+        m_hessenberg(row, column) = m_cosines[row] * upper + m_sines[row] * lower;
+        m_hessenberg(row + 1, column) = -m_sines[row] * upper + m_cosines[row] * lower;
+      }
+      const Real radius
+          = std::hypot(m_hessenberg(column, column), m_hessenberg(column + 1, column));
+      m_cosines[column] = radius > 0 ? m_hessenberg(column, column) / radius : Real(1);
+      m_sines[column] = radius > 0 ? m_hessenberg(column + 1, column) / radius : Real(0);
+      m_hessenberg(column, column) = radius;
+      m_hessenberg(column + 1, column) = 0;
+      m_projection[column + 1] = -m_sines[column] * m_projection[column];
+      m_projection[column] = m_cosines[column] * m_projection[column];
+
+      size = column + 1;
+      if (std::abs(m_projection[size]) <= target || next == 0) break;
+      m_basis.col(size) = m_work / Real(next);
+    }
+
+    // the least squares solution of the Hessenberg system gives the preconditioned update
+    const RealVector coefficients = m_hessenberg.topLeftCorner(size, size)
+                                        .template triangularView<Eigen::Upper>()
+                                        .solve(m_projection.head(size));
+    m_direction = m_basis.leftCols(size) * coefficients.template cast<Scalar>();
+    precondition(m_direction);
+    correction += m_direction;
+
+    beta = std::abs(m_projection[size]);
+    if (beta <= target || restart + 1 == m_options.maxKrylovRestarts) break;
+    // restart from the true linearized residual rather than the recurrence
+    ApplyJacobian(residual, x, residualAtX, correction, m_work);
+    m_work = rhs - m_work;
+    beta = m_work.norm();
+  }
+  return iterations;
+}
+
+template <typename Scalar>
+NewtonKrylovReport NewtonKrylovSolver<Scalar>::Solve(const Residual& residual,
+                                                     const Preconditioner& precondition,
+                                                     Vector& x, double absoluteTolerance) {
+  if (x.size() == 0) throw invalid_argument("Newton-Krylov needs at least one unknown");
+  Reserve(x.size());
+  m_residualEvaluations = 0;
+
+  Vector current(x.size());
+  residual(x, current);
+  m_residualEvaluations++;
+  NewtonKrylovReport report;
+  report.initialResidual = current.norm();
+  report.residual = report.initialResidual;
+  if (!std::isfinite(report.initialResidual)) {
+    report.converged = false;
+    report.residualEvaluations = m_residualEvaluations;
+    return report;
+  }
+  const double threshold
+      = max(m_options.relativeTolerance * report.initialResidual, absoluteTolerance);
+
+  Vector correction(x.size()), trial(x.size()), trialResidual(x.size());
+  while (report.residual > threshold && report.newtonIterations < m_options.maxNewtonIterations) {
+    report.newtonIterations++;
+    report.krylovIterations
+        += Gmres(residual, precondition, x, current, Vector(-current), correction);
+
+    // backtrack until the residual norm decreases sufficiently
+    Real damping = 1;
+    bool accepted = false;
+    for (int backtrack = 0; backtrack <= m_options.maxBacktracks; backtrack++) {
+      trial = x + damping * correction;
+      residual(trial, trialResidual);
+      m_residualEvaluations++;
+      const double norm = trialResidual.norm();
+      if (std::isfinite(norm) && norm <= (1 - 1e-4 * damping) * report.residual) {
+        accepted = true;
+        x.swap(trial);
+        current.swap(trialResidual);
+        report.residual = norm;
+        break;
+      }
+      damping /= 2;
+    }
+    if (!accepted) break;
+  }
+
+  report.converged = report.residual <= threshold;
+  report.residualEvaluations = m_residualEvaluations;
+  return report;
+}
+
+template class CGLE::NewtonKrylovSolver<double>;
+template class CGLE::NewtonKrylovSolver<complex<double>>;
@@ -0,0 +1,260 @@
+#include <numaPlacement.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "helper.h"
+
+#ifdef __linux__
+#  include <sched.h>
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+using namespace CGLE;
+
+namespace {
+  /** reads the NUMA node of a CPU from sysfs, 0 when the kernel does not expose it **/
+  int GetCpuNode(int cpu) {
+    error_code error;
+    const filesystem::path directory = "/sys/devices/system/cpu/cpu" + to_string(cpu);
+    for (const auto& entry : filesystem::directory_iterator(directory, error)) {
+      const string name = entry.path().filename().string();
+      if (name.size() > 4 && name.compare(0, 4, "node") == 0
+          && all_of(name.begin() + 4, name.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+        return stoi(name.substr(4));
+      }
+    }
+    return 0;
+  }
+
+  vector<int> ComputePlacementCpus() {
+    vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return cpus;
+
+    vector<pair<int, int>> nodeCpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &allowed)) nodeCpus.emplace_back(GetCpuNode(cpu), cpu);
+    }
+    sort(nodeCpus.begin(), nodeCpus.end());
+    for (const auto& nodeCpu : nodeCpus) cpus.push_back(nodeCpu.second);
+#endif
+    return cpus;
+  }
+
+  /** whole pages of a range, as [first, last) addresses **/
+  pair<uintptr_t, uintptr_t> GetWholePages(const void* data, size_t bytes, uintptr_t page) {
+    const uintptr_t first = (reinterpret_cast<uintptr_t>(data) + page - 1) / page * page;
+    const uintptr_t last = (reinterpret_cast<uintptr_t>(data) + bytes) / page * page;
+    return {first, max(first, last)};
+  }
+
+  /** worker whose ParallelFor block of positions holds a position **/
+  int GetPositionOwner(Eigen::Index position, Eigen::Index rows, int workers) {
+    int worker = static_cast<int>(position * workers / rows);
+    while (worker + 1 < workers && rows * (worker + 1) / workers <= position) worker++;
+    while (worker > 0 && rows * worker / workers > position) worker--;
+    return worker;
+  }
+
+  /** runs the owned ranges of the columns [firstColumn, endColumn) on their workers **/
+  void ForEachPlacedColumns(
+      const FieldLayout& layout, Eigen::Index firstColumn, Eigen::Index endColumn,
+      const PlacementOptions& placement,
+      const function<void(Eigen::Index column, Eigen::Index begin, Eigen::Index end)>& body) {
+    const int workers = GetPlacementNumWorkers(layout.rows, placement);
+    if (workers == 1 && !placement.pinThreads) {
+      for (Eigen::Index column = firstColumn; column < endColumn; column++) {
+        body(column, 0, layout.rows);
+      }
+      return;
+    }
+
+    // a page is always computed on the worker that placed it, so it stays on that worker's node
+    const size_t pageSize = GetPlacementPageSize(placement);
+    GetPlacementWorkers(placement)->Run([&](int worker) {
+      if (worker >= workers) return;
+      for (Eigen::Index column = firstColumn; column < endColumn; column++) {
+        for (const auto& range : GetPlacedRanges(layout, column, worker, workers, pageSize)) {
+          if (range.first < range.second) body(column, range.first, range.second);
+        }
+      }
+    });
+  }
+}  // namespace
+
+const vector<int>& CGLE::GetPlacementCpus() {
+  static const vector<int> cpus = ComputePlacementCpus();
+  return cpus;
+}
+
+bool CGLE::PinCurrentThread(int worker) {
+  const vector<int>& cpus = GetPlacementCpus();
+  if (cpus.empty() || worker < 0) return false;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpus[static_cast<size_t>(worker) % cpus.size()], &set);
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+bool CGLE::AdviseHugePages(void* data, size_t bytes) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  const long pageSize = sysconf(_SC_PAGESIZE);
+  if (pageSize <= 0 || data == nullptr) return false;
+
+  // madvise needs page aligned bounds, partial pages at both ends are left alone
+  const auto pages = GetWholePages(data, bytes, static_cast<uintptr_t>(pageSize));
+  if (pages.second == pages.first) return false;
+  return madvise(reinterpret_cast<void*>(pages.first), pages.second - pages.first, MADV_HUGEPAGE)
+         == 0;
+#else
+  (void)data;
+  (void)bytes;
+  return false;
+#endif
+}
+
+bool CGLE::ReleasePages(void* data, size_t bytes) {
+#if defined(__linux__) && defined(MADV_DONTNEED)
+  const long pageSize = sysconf(_SC_PAGESIZE);
+  if (pageSize <= 0 || data == nullptr) return false;
+
+  // partial pages at both ends hold memory of neighbouring allocations
+  const auto pages = GetWholePages(data, bytes, static_cast<uintptr_t>(pageSize));
+  if (pages.second == pages.first) return false;
+  return madvise(reinterpret_cast<void*>(pages.first), pages.second - pages.first, MADV_DONTNEED)
+         == 0;
+#else
+  (void)data;
+  (void)bytes;
+  return false;
+#endif
+}
+
+int CGLE::GetPlacementNode(int worker) {
+  const vector<int>& cpus = GetPlacementCpus();
+  if (cpus.empty() || worker < 0) return -1;
+  return GetCpuNode(cpus[static_cast<size_t>(worker) % cpus.size()]);
+}
+
+vector<int> CGLE::GetPageNodes(const void* data, size_t bytes) {
+  vector<int> nodes;
+#if defined(__linux__) && defined(SYS_move_pages)
+  const long pageSize = sysconf(_SC_PAGESIZE);
+  if (pageSize <= 0 || data == nullptr || bytes == 0) return nodes;
+
+  // move_pages without target nodes only reports where every page lives
+  const uintptr_t page = static_cast<uintptr_t>(pageSize);
+  const uintptr_t first = reinterpret_cast<uintptr_t>(data) / page * page;
+  const uintptr_t last = reinterpret_cast<uintptr_t>(data) + bytes;
+  vector<void*> pages;
+  for (uintptr_t address = first; address < last; address += page) {
+    pages.push_back(reinterpret_cast<void*>(address));
+  }
+  nodes.assign(pages.size(), 0);
+  if (syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, nodes.data(), 0) != 0) {
+    nodes.clear();
+  }
+#else
+  (void)data;
+  (void)bytes;
+#endif
+  return nodes;
+}
+
+size_t CGLE::GetPlacementPageSize(const PlacementOptions& placement) {
+  static const size_t basePageSize = []() {
+#ifdef __linux__
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    if (pageSize > 0) return static_cast<size_t>(pageSize);
+#endif
+    return static_cast<size_t>(4096);
+  }();
+  static const size_t hugePageSize = []() {
+    size_t size = 0;
+    ifstream file("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size");
+    if (!(file >> size) || size == 0) size = static_cast<size_t>(2) << 20;
+    return size;
+  }();
+  return placement.hugePages ? hugePageSize : basePageSize;
+}
+
+int CGLE::GetPlacementNumWorkers(Eigen::Index count, const PlacementOptions& placement) {
+  const Eigen::Index workers = min<Eigen::Index>(Helper::GetNumThreads(placement.numThreads),
+                                                 max<Eigen::Index>(count, 1));
+  return static_cast<int>(workers);
+}
+
+shared_ptr<WorkerPool> CGLE::GetPlacementWorkers(const PlacementOptions& placement) {
+  static mutex poolsMutex;
+  static map<pair<int, bool>, shared_ptr<WorkerPool>> pools;
+
+  const pair<int, bool> key(Helper::GetNumThreads(placement.numThreads), placement.pinThreads);
+  lock_guard<mutex> lock(poolsMutex);
+  shared_ptr<WorkerPool>& pool = pools[key];
+  if (!pool) pool = make_shared<WorkerPool>(key.first, key.second);
+  return pool;
+}
+
+PlacedRanges CGLE::GetPlacedRanges(const FieldLayout& layout, Eigen::Index column, int worker,
+                                   int workers, size_t pageSize) {
+  const Eigen::Index rows = layout.rows;
+  PlacedRanges ranges{};
+  if (rows <= 0 || worker < 0 || worker >= workers) return ranges;
+
+  // in elements: fields whose elements do not tile the pages fall back to the ParallelFor split
+  const size_t elementSize = max<size_t>(layout.elementSize, 1);
+  const bool aligned = pageSize % elementSize == 0 && layout.address % elementSize == 0;
+  const Eigen::Index pageElements
+      = aligned ? max<Eigen::Index>(static_cast<Eigen::Index>(pageSize / elementSize), 1) : 1;
+  const Eigen::Index columnStart = column * layout.outerStride;
+  const Eigen::Index offset = static_cast<Eigen::Index>(
+      (layout.address / elementSize + static_cast<uintptr_t>(columnStart)) % pageElements);
+
+  // first page boundary at or after a position of the column
+  auto boundary = [&](Eigen::Index position) {
+    const Eigen::Index next = position + (pageElements - (offset + position) % pageElements)
+                                             % pageElements;
+    return min(next, rows);
+  };
+
+  // the head of the column belongs to the owner of the first element of its page
+  const Eigen::Index head = boundary(0);
+  if (head > 0) {
+    const Eigen::Index pageStart = columnStart - offset;
+    const Eigen::Index position
+        = pageStart < 0 ? 0 : min(pageStart % max(layout.outerStride, rows), rows - 1);
+    if (GetPositionOwner(position, rows, workers) == worker) ranges[0] = {0, head};
+  }
+  ranges[1] = {boundary(rows * worker / workers), boundary(rows * (worker + 1) / workers)};
+  return ranges;
+}
+
+void CGLE::ForEachPlacedBlock(const FieldLayout& layout, Eigen::Index column,
+                              const PlacementOptions& placement,
+                              const function<void(Eigen::Index begin, Eigen::Index end)>& body) {
+  ForEachPlacedColumns(layout, column, column + 1, placement,
+                       [&](Eigen::Index, Eigen::Index begin, Eigen::Index end) {
+                         body(begin, end);
+                       });
+}
+
+void CGLE::ForEachPlacedColumn(
+    const FieldLayout& layout, Eigen::Index cols, const PlacementOptions& placement,
+    const function<void(Eigen::Index column, Eigen::Index begin, Eigen::Index end)>& body) {
+  ForEachPlacedColumns(layout, 0, cols, placement, body);
+}
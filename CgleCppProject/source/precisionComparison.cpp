@@ -0,0 +1,50 @@
+#include <precisionComparison.h>
+#include <stabilitySolver.h>
+
+#include <algorithm>
+#include <cmath>
+using namespace CGLE;
+
+namespace {
+  /**
+   * MaxDeviation computes max |mixed - reference| with the mixed values widened to double
+   */
+  double MaxDeviation(const Grid::FieldMatrix& mixed, const ReferenceGrid::FieldMatrix& reference) {
+    double maxDeviation = 0;
+    for (int timeIndex = 0; timeIndex < reference.cols(); timeIndex++) {
+      for (int position = 0; position < reference.rows(); position++) {
+        complex<double> widened = MixedPrecision::ToAccumulator(mixed(position, timeIndex));
+        maxDeviation = max(maxDeviation, std::abs(widened - reference(position, timeIndex)));
+      }
+    }
+    return maxDeviation;
+  }
+}  // namespace
+
+PrecisionComparison CGLE::ComparePrecisionModes(Constraint& constraint, const GridDetails& details,
+                                                double pertubationCoefficient) {
+  ReferenceGrid reference(constraint, details);
+  reference.PerturbGrid(pertubationCoefficient);
+
+  Grid mixed(constraint, details);
+  mixed.CopyFieldsFrom(reference);
+
+  StabilitySolver<DoublePrecision>(constraint, details).Solve(reference);
+  StabilitySolver<MixedPrecision>(constraint, details).Solve(mixed);
+
+  return ComparePrecisionModes(mixed, reference);
+}
+
+PrecisionComparison CGLE::ComparePrecisionModes(const Grid& mixed, const ReferenceGrid& reference) {
+  PrecisionComparison comparison;
+  comparison.maxDeviationA = MaxDeviation(mixed.GetPerturbedA(), reference.GetPerturbedA());
+  comparison.maxDeviationB = MaxDeviation(mixed.GetPerturbedB(), reference.GetPerturbedB());
+  comparison.maxReferenceAmplitude
+      = max(reference.GetPerturbedA().cwiseAbs().maxCoeff(),
+            reference.GetPerturbedB().cwiseAbs().maxCoeff());
+
+  double maxDeviation = max(comparison.maxDeviationA, comparison.maxDeviationB);
+  comparison.maxRelativeDeviation
+      = comparison.maxReferenceAmplitude > 0 ? maxDeviation / comparison.maxReferenceAmplitude : 0;
+  return comparison;
+}
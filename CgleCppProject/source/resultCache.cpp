@@ -0,0 +1,366 @@
+#include <binaryStream.h>
+#include <fieldCodec.h>
+#include <resultCache.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+using namespace CGLE;
+
+namespace {
+  const char CACHE_MAGIC[8] = {'C', 'G', 'L', 'E', 'R', 'E', 'S', '2'};
+  const string ENTRY_EXTENSION = ".res";
+  const string TEMPORARY_EXTENSION = ".tmp";
+
+  /**
+   * @brief KeyEncoder appends values to a canonical key in little endian byte order
+   */
+  class KeyEncoder {
+  public:
+    void Add(uint64_t value) {
+      for (int byte = 0; byte < 8; byte++) {
+        m_bytes.push_back(static_cast<char>(value >> (8 * byte)));
+      }
+    }
+    void Add(int64_t value) { Add(static_cast<uint64_t>(value)); }
+    void Add(int value) { Add(static_cast<int64_t>(value)); }
+    void Add(double value) {
+      uint64_t bits;
+      memcpy(&bits, &value, sizeof(bits));
+      Add(bits);
+    }
+    void Add(const complex<double>& value) {
+      Add(value.real());
+      Add(value.imag());
+    }
+    void Add(const string& value) {
+      Add(static_cast<uint64_t>(value.size()));
+      m_bytes += value;
+    }
+    void Add(const Axis& axis) {
+      Add(static_cast<int>(axis.IsUniform()));
+      Add(axis.size());
+      if (axis.IsUniform()) {
+        if (!axis.empty()) {
+          Add(axis[0]);
+          Add(axis[axis.size() - 1]);
+        }
+        return;
+      }
+      for (double point : axis) Add(point);
+    }
+
+    const string& GetBytes() const { return m_bytes; }
+
+  private:
+    string m_bytes;
+  };
+
+  string ToHex(uint64_t value) {
+    static const char digits[] = "0123456789abcdef";
+    string hex(16, '0');
+    for (int digit = 0; digit < 16; digit++) hex[15 - digit] = digits[(value >> (4 * digit)) & 15];
+    return hex;
+  }
+
+  uint64_t Fnv1a(const string& bytes) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (char byte : bytes) {
+      hash ^= static_cast<unsigned char>(byte);
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+
+  void WriteMetrics(ostream& stream, const FieldErrorMetrics& metrics) {
+    for (double value : {metrics.l1, metrics.l2, metrics.linf, metrics.relativeL2,
+                         metrics.relativeLinf, metrics.maxAmplitude,
+                         metrics.maxReferenceAmplitude}) {
+      WriteBinary<double>(stream, value);
+    }
+  }
+
+  void ReadMetrics(istream& stream, FieldErrorMetrics& metrics) {
+    for (double* value : {&metrics.l1, &metrics.l2, &metrics.linf, &metrics.relativeL2,
+                          &metrics.relativeLinf, &metrics.maxAmplitude,
+                          &metrics.maxReferenceAmplitude}) {
+      *value = ReadBinary<double>(stream);
+    }
+  }
+
+  /** fields are compressed losslessly, the cached results must match a fresh solve bit for bit **/
+  FieldCodec MakeEntryCodec() {
+    FieldCodecOptions options;
+    options.compression = FieldCompression::Lossless;
+    return FieldCodec(options);
+  }
+
+  template <typename FieldMatrix> void WriteField(ostream& stream, const FieldMatrix& field) {
+    const vector<uint8_t> compressed
+        = MakeEntryCodec().Encode(field.data(), static_cast<size_t>(field.size()));
+    WriteBinary<int64_t>(stream, field.rows());
+    WriteBinary<int64_t>(stream, field.cols());
+    WriteBinary<uint64_t>(stream, compressed.size());
+    stream.write(reinterpret_cast<const char*>(compressed.data()),
+                 static_cast<streamsize>(compressed.size()));
+  }
+
+  template <typename FieldMatrix> void ReadField(istream& stream, FieldMatrix& field) {
+    const int64_t rows = ReadBinary<int64_t>(stream);
+    const int64_t cols = ReadBinary<int64_t>(stream);
+    if (rows < 0 || cols < 0) throw runtime_error("invalid field dimensions");
+    vector<uint8_t> compressed(ReadBinary<uint64_t>(stream));
+    if (!stream.read(reinterpret_cast<char*>(compressed.data()),
+                     static_cast<streamsize>(compressed.size()))) {
+      throw runtime_error("unexpected end of file");
+    }
+    field.resize(rows, cols);
+    MakeEntryCodec().Decode(compressed.data(), compressed.size(), field.data(),
+                            static_cast<size_t>(field.size()));
+  }
+}  // namespace
+
+string ResultKey::GetAddress() const { return ToHex(hash); }
+
+ResultKey CGLE::MakeResultKey(const Constraint& constraint, const GridDetails& details,
+                              const ResultSettings& settings, SnapshotScalar storage,
+                              size_t accumulatorBytes) {
+  KeyEncoder encoder;
+  encoder.Add(RESULT_CACHE_VERSION);
+  encoder.Add(static_cast<int>(storage));
+  encoder.Add(static_cast<int>(accumulatorBytes));
+
+  encoder.Add(constraint.m_CaseType);
+  encoder.Add(constraint.m_CaseLetter);
+  encoder.Add(constraint.m_WaveType);
+  encoder.Add(constraint.m_Version);
+  encoder.Add(constraint.m_StartTime);
+  encoder.Add(constraint.m_EndTime);
+  encoder.Add(constraint.m_StartPosition);
+  encoder.Add(constraint.m_EndPosition);
+  for (double value : {constraint.m_L, constraint.m_K1, constraint.m_K2, constraint.m_Eta,
+                       constraint.m_Mu, constraint.m_Omega1, constraint.m_Omega2,
+                       constraint.m_Beta, constraint.m_Alpha, constraint.m_Q2r}) {
+    encoder.Add(value);
+  }
+  for (const complex<double>& value :
+       {constraint.m_k1, constraint.m_W1, constraint.m_Gamma1, constraint.m_Gamma1Prime,
+        constraint.m_P1, constraint.m_P1Prime, constraint.m_Q1, constraint.m_Q2,
+        constraint.m_Q1Prime, constraint.m_Q2Prime}) {
+    encoder.Add(value);
+  }
+
+  encoder.Add(details.GetXAxis());
+  encoder.Add(details.GetTimeAxis());
+  encoder.Add(details.GetDx());
+  encoder.Add(details.GetDt());
+
+  encoder.Add(settings.pertubationCoefficient);
+  encoder.Add(settings.seed);
+  encoder.Add(static_cast<int>(settings.boundaryCondition));
+  encoder.Add(static_cast<int>(settings.evaluation));
+
+  ResultKey key;
+  key.canonical = encoder.GetBytes();
+  key.hash = Fnv1a(key.canonical);
+  return key;
+}
+
+ResultCache::ResultCache(const string& directory, uintmax_t maxBytes)
+    : m_directory(directory), m_maxBytes(maxBytes) {
+  error_code error;
+  filesystem::create_directories(m_directory, error);
+  if (!filesystem::is_directory(m_directory)) {
+    throw runtime_error("Error opening result cache " + m_directory);
+  }
+}
+
+template <typename Policy> bool ResultCache::Get(const ResultKey& key, CachedResult<Policy>& out) {
+  const string path = GetEntryPath(key);
+  bool found = false;
+  try {
+    ifstream stream(path, ios::binary);
+    char magic[sizeof(CACHE_MAGIC)];
+    if (stream.read(magic, sizeof(magic)) && memcmp(magic, CACHE_MAGIC, sizeof(magic)) == 0
+        && ReadBinaryString(stream) == key.canonical) {
+      CachedResult<Policy> result;
+      ReadField(stream, result.fieldA);
+      ReadField(stream, result.fieldB);
+      ReadMetrics(stream, result.metrics.a);
+      ReadMetrics(stream, result.metrics.b);
+      result.metrics.numCells = ReadBinary<int64_t>(stream);
+      out = std::move(result);
+      found = true;
+    }
+  } catch (const exception&) {
+    // a truncated or foreign entry is a miss, the next store replaces it
+  }
+
+  if (found) {
+    error_code error;
+    filesystem::last_write_time(path, filesystem::file_time_type::clock::now(), error);
+  }
+  lock_guard<mutex> lock(m_mutex);
+  (found ? m_statistics.hits : m_statistics.misses)++;
+  return found;
+}
+
+template <typename Policy>
+void ResultCache::Put(const ResultKey& key, const CachedResult<Policy>& result) {
+  const string temporary = GetTemporaryPath(key);
+  {
+    ofstream stream(temporary, ios::binary | ios::trunc);
+    if (!stream.is_open()) throw runtime_error("Error writing result cache entry " + temporary);
+    stream.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    WriteBinaryString(stream, key.canonical);
+    WriteField(stream, result.fieldA);
+    WriteField(stream, result.fieldB);
+    WriteMetrics(stream, result.metrics.a);
+    WriteMetrics(stream, result.metrics.b);
+    WriteBinary<int64_t>(stream, result.metrics.numCells);
+    stream.close();
+    if (!stream) {
+      error_code error;
+      filesystem::remove(temporary, error);
+      throw runtime_error("Error writing result cache entry " + temporary);
+    }
+  }
+
+  // rename replaces the entry atomically, concurrent readers see the old or the new entry
+  error_code error;
+  filesystem::rename(temporary, GetEntryPath(key), error);
+  if (error) {
+    filesystem::remove(temporary, error);
+    throw runtime_error("Error storing result cache entry " + GetEntryPath(key));
+  }
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_statistics.stores++;
+  }
+  Evict();
+}
+
+void ResultCache::Evict() {
+  struct Entry {
+    filesystem::path path;
+    filesystem::file_time_type lastUse;
+    uintmax_t size;
+  };
+
+  const auto now = filesystem::file_time_type::clock::now();
+  vector<Entry> entries;
+  uintmax_t totalBytes = 0;
+  error_code error;
+  for (const auto& file : filesystem::directory_iterator(m_directory, error)) {
+    error_code fileError;
+    const filesystem::path& path = file.path();
+    const auto lastUse = filesystem::last_write_time(path, fileError);
+    if (fileError) continue;
+
+    if (path.extension() == TEMPORARY_EXTENSION) {
+      if (now - lastUse > chrono::seconds(RESULT_CACHE_STALE_SECONDS)) {
+        filesystem::remove(path, fileError);
+      }
+      continue;
+    }
+    if (path.extension() != ENTRY_EXTENSION) continue;
+
+    const uintmax_t size = filesystem::file_size(path, fileError);
+    if (fileError) continue;
+    entries.push_back(Entry{path, lastUse, size});
+    totalBytes += size;
+  }
+  if (totalBytes <= m_maxBytes) return;
+
+  sort(entries.begin(), entries.end(),
+       [](const Entry& left, const Entry& right) { return left.lastUse < right.lastUse; });
+  long long evictions = 0;
+  for (const Entry& entry : entries) {
+    if (totalBytes <= m_maxBytes) break;
+    // another process may have evicted it already, the bytes are gone either way
+    filesystem::remove(entry.path, error);
+    totalBytes -= entry.size;
+    evictions++;
+  }
+  lock_guard<mutex> lock(m_mutex);
+  m_statistics.evictions += evictions;
+}
+
+uintmax_t ResultCache::GetSizeBytes() const {
+  uintmax_t totalBytes = 0;
+  error_code error;
+  for (const auto& file : filesystem::directory_iterator(m_directory, error)) {
+    if (file.path().extension() != ENTRY_EXTENSION) continue;
+    error_code fileError;
+    const uintmax_t size = filesystem::file_size(file.path(), fileError);
+    if (!fileError) totalBytes += size;
+  }
+  return totalBytes;
+}
+
+ResultCacheStatistics ResultCache::GetStatistics() const {
+  lock_guard<mutex> lock(m_mutex);
+  return m_statistics;
+}
+
+string ResultCache::GetEntryPath(const ResultKey& key) const {
+  return (filesystem::path(m_directory) / (key.GetAddress() + ENTRY_EXTENSION)).string();
+}
+
+string ResultCache::GetTemporaryPath(const ResultKey& key) const {
+  // unique across the threads and processes sharing the directory
+  static mutex engineMutex;
+  static mt19937_64 engine(random_device{}()
+                           ^ static_cast<uint64_t>(
+                               chrono::steady_clock::now().time_since_epoch().count()));
+  uint64_t suffix;
+  {
+    lock_guard<mutex> lock(engineMutex);
+    suffix = engine() ^ hash<thread::id>()(this_thread::get_id());
+  }
+  const string name = key.GetAddress() + "." + ToHex(suffix) + TEMPORARY_EXTENSION;
+  return (filesystem::path(m_directory) / name).string();
+}
+
+template <typename Policy>
+CachedResult<Policy> CGLE::SolveWithCache(ResultCache& cache, const Constraint& constraint,
+                                          const GridDetails& details,
+                                          const ResultSettings& settings, int numThreads) {
+  const ResultKey key = MakeResultKey<Policy>(constraint, details, settings);
+  CachedResult<Policy> result;
+  if (cache.Get(key, result)) return result;
+
+  Constraint gridConstraint = constraint;
+  BasicGrid<Policy> grid(gridConstraint, details);
+  grid.SetFieldEvaluation(settings.evaluation);
+  mt19937_64 engine(settings.seed);
+  grid.PerturbGrid(settings.pertubationCoefficient, engine);
+
+  StabilitySolver<Policy> solver(constraint, details);
+  solver.SetBoundaryCondition(settings.boundaryCondition);
+  solver.Solve(grid);
+
+  result.metrics = ComputeErrorMetrics(grid, numThreads);
+  result.fieldA = grid.GetPerturbedA();
+  result.fieldB = grid.GetPerturbedB();
+  cache.Put(key, result);
+  return result;
+}
+
+template bool ResultCache::Get<MixedPrecision>(const ResultKey&, CachedResult<MixedPrecision>&);
+template bool ResultCache::Get<DoublePrecision>(const ResultKey&, CachedResult<DoublePrecision>&);
+template void ResultCache::Put<MixedPrecision>(const ResultKey&,
+                                               const CachedResult<MixedPrecision>&);
+template void ResultCache::Put<DoublePrecision>(const ResultKey&,
+                                                const CachedResult<DoublePrecision>&);
+template CachedResult<MixedPrecision> CGLE::SolveWithCache<MixedPrecision>(
+    ResultCache&, const Constraint&, const GridDetails&, const ResultSettings&, int);
+template CachedResult<DoublePrecision> CGLE::SolveWithCache<DoublePrecision>(
+    ResultCache&, const Constraint&, const GridDetails&, const ResultSettings&, int);
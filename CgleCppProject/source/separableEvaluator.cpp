@@ -0,0 +1,88 @@
+#include <separableEvaluator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+using namespace CGLE;
+
+SeparableEvaluator::SeparableEvaluator(shared_ptr<FunctionHandler> handler,
+                                       const vector<double>& positions)
+    : m_handler(std::move(handler)), m_positions(positions) {
+  if (!m_handler) throw invalid_argument("separable evaluation requires a function handler");
+
+  const Constraint& constraint = m_handler->GetConstraint();
+  if (constraint.m_WaveType == BRIGHT_BRIGHT) {
+    m_waveForm = WaveForm::BrightBright;
+  } else if (constraint.m_WaveType == DARK_DARK) {
+    m_waveForm = WaveForm::DarkDark;
+  } else {
+    m_waveForm = WaveForm::FrontFront;
+  }
+
+  m_eta = constraint.m_Eta;
+  m_mu = constraint.m_Mu;
+  m_spatialRate = real(constraint.m_k1);
+  m_temporalRate = real(constraint.m_W1);
+
+  m_spatialFactors.resize(positions.size());
+  m_separable.resize(positions.size());
+  for (size_t position = 0; position < positions.size(); position++) {
+    const double exponent = m_spatialRate * positions[position];
+    m_separable[position] = std::abs(exponent) <= SEPARABLE_EXPONENT_LIMIT;
+    m_spatialFactors[position] = m_separable[position] ? exp(exponent) : 0;
+  }
+}
+
+void SeparableEvaluator::EvaluateColumn(double time, Eigen::Ref<Column> columnA,
+                                        Eigen::Ref<Column> columnB) const {
+  const Eigen::Index numPositions = static_cast<Eigen::Index>(m_positions.size());
+  if (columnA.size() != numPositions || columnB.size() != numPositions) {
+    throw invalid_argument("columns must have one entry per position");
+  }
+
+  const double temporalExponent = m_temporalRate * time;
+  const bool separableTime = std::abs(temporalExponent) <= SEPARABLE_EXPONENT_LIMIT;
+  const double temporalFactor = separableTime ? exp(temporalExponent) : 0;
+
+  for (Eigen::Index position = 0; position < numPositions; position++) {
+    if (!separableTime || !m_separable[position]) {
+      columnA[position] = m_handler->A()(m_positions[position], time);
+      columnB[position] = m_handler->B()(m_positions[position], time);
+      continue;
+    }
+
+    const double spatialFactor = m_spatialFactors[position];
+    // single = exp(k x + w t), twice = exp(2 k x + 2 w t)
+    const double single = spatialFactor * temporalFactor;
+    const double twice = single * single;
+
+    double amplitudeA = 0, amplitudeB = 0;
+    switch (m_waveForm) {
+      case WaveForm::BrightBright: {
+        const double shape = twice / ((1 + twice) * (1 + twice));
+        amplitudeA = m_eta * shape;
+        amplitudeB = m_mu * shape;
+        break;
+      }
+      case WaveForm::DarkDark: {
+        // B uses exp(2 k x + w t) as in ComputeFunctionsAndRelatedFields.m
+        const double mixed = spatialFactor * single;
+        amplitudeA = m_eta * (1 - twice) * (1 - twice) / ((1 + twice) * (1 + twice));
+        amplitudeB = m_mu * (1 - mixed) * (1 - mixed) / ((1 + mixed) * (1 + mixed));
+        break;
+      }
+      case WaveForm::FrontFront: {
+        const double denominator = (1 + single) * (1 + single);
+        amplitudeA = m_eta / denominator;
+        amplitudeB = m_mu * twice / denominator;
+        break;
+      }
+    }
+    columnA[position] = complex<double>(amplitudeA, 0);
+    columnB[position] = complex<double>(amplitudeB, 0);
+  }
+}
+
+int SeparableEvaluator::GetNumFallbackPositions() const {
+  return static_cast<int>(count(m_separable.begin(), m_separable.end(), false));
+}
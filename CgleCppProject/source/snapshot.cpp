@@ -0,0 +1,196 @@
+#include <snapshot.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+using namespace CGLE;
+
+namespace {
+  const char SNAPSHOT_MAGIC[8] = {'C', 'G', 'L', 'E', 'S', 'N', 'P', '1'};
+  /** set in the scalar type of records whose data is a FieldCodec stream **/
+  const uint8_t COMPRESSED_RECORD = 0x80;
+
+  vector<uint8_t> EncodeRecord(const FieldCodec& codec, SnapshotScalar scalar, const void* data,
+                               size_t numElements) {
+    switch (scalar) {
+      case SnapshotScalar::Float32:
+        return codec.Encode(static_cast<const float*>(data), numElements);
+      case SnapshotScalar::Float64:
+        return codec.Encode(static_cast<const double*>(data), numElements);
+      case SnapshotScalar::ComplexFloat:
+        return codec.Encode(static_cast<const complex<float>*>(data), numElements);
+      case SnapshotScalar::ComplexDouble:
+        return codec.Encode(static_cast<const complex<double>*>(data), numElements);
+    }
+    throw invalid_argument("unknown snapshot scalar type");
+  }
+
+  void DecodeRecord(const FieldCodec& codec, SnapshotScalar scalar, const vector<uint8_t>& stream,
+                    void* data, size_t numElements) {
+    switch (scalar) {
+      case SnapshotScalar::Float32:
+        return codec.Decode(stream.data(), stream.size(), static_cast<float*>(data), numElements);
+      case SnapshotScalar::Float64:
+        return codec.Decode(stream.data(), stream.size(), static_cast<double*>(data), numElements);
+      case SnapshotScalar::ComplexFloat:
+        return codec.Decode(stream.data(), stream.size(), static_cast<complex<float>*>(data),
+                            numElements);
+      case SnapshotScalar::ComplexDouble:
+        return codec.Decode(stream.data(), stream.size(), static_cast<complex<double>*>(data),
+                            numElements);
+    }
+    throw invalid_argument("unknown snapshot scalar type");
+  }
+}  // namespace
+
+size_t CGLE::GetSnapshotScalarSize(SnapshotScalar scalar) {
+  switch (scalar) {
+    case SnapshotScalar::Float32:
+      return sizeof(float);
+    case SnapshotScalar::Float64:
+      return sizeof(double);
+    case SnapshotScalar::ComplexFloat:
+      return sizeof(complex<float>);
+    case SnapshotScalar::ComplexDouble:
+      return sizeof(complex<double>);
+  }
+  throw invalid_argument("unknown snapshot scalar type");
+}
+
+SnapshotWriter::SnapshotWriter(const string& path, const FieldCodecOptions& codec)
+    : m_path(path), m_codec(codec) {
+  // validates the options before the file is touched
+  if (codec.compression != FieldCompression::None) FieldCodec{codec};
+  m_stream.open(path, ios::binary | ios::trunc);
+  if (!m_stream.is_open()) throw runtime_error("Error opening snapshot " + path);
+
+  m_stream.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+  WriteBinary<uint32_t>(m_stream, 0);
+}
+
+SnapshotWriter::~SnapshotWriter() {
+  try {
+    Close();
+  } catch (...) {
+    // destructors never throw, call Close() explicitly to observe write failures
+  }
+}
+
+void SnapshotWriter::WriteVector(const string& name, const vector<double>& values) {
+  WriteRecord(name, SnapshotScalar::Float64, static_cast<int64_t>(values.size()), 1,
+              values.data(), true);
+}
+
+void SnapshotWriter::WriteRecord(const string& name, SnapshotScalar scalar, int64_t rows,
+                                 int64_t cols, const void* data, bool exact) {
+  if (!m_stream.is_open()) throw runtime_error("snapshot " + m_path + " is already closed");
+
+  WriteBinaryString(m_stream, name);
+  if (m_codec.compression == FieldCompression::None) {
+    WriteBinary<uint8_t>(m_stream, static_cast<uint8_t>(scalar));
+    WriteBinary<int64_t>(m_stream, rows);
+    WriteBinary<int64_t>(m_stream, cols);
+    m_stream.write(static_cast<const char*>(data),
+                   static_cast<streamsize>(rows * cols * GetSnapshotScalarSize(scalar)));
+  } else {
+    FieldCodecOptions options = m_codec;
+    if (exact) options.compression = FieldCompression::Lossless;
+    const vector<uint8_t> stream
+        = EncodeRecord(FieldCodec(options), scalar, data, static_cast<size_t>(rows * cols));
+    WriteBinary<uint8_t>(m_stream, static_cast<uint8_t>(scalar) | COMPRESSED_RECORD);
+    WriteBinary<int64_t>(m_stream, rows);
+    WriteBinary<int64_t>(m_stream, cols);
+    WriteBinary<uint64_t>(m_stream, stream.size());
+    m_stream.write(reinterpret_cast<const char*>(stream.data()),
+                   static_cast<streamsize>(stream.size()));
+  }
+  if (!m_stream) throw runtime_error("Error writing snapshot " + m_path);
+  m_numFields++;
+}
+
+void SnapshotWriter::Close() {
+  if (!m_stream.is_open()) return;
+
+  m_stream.seekp(sizeof(SNAPSHOT_MAGIC));
+  WriteBinary<uint32_t>(m_stream, m_numFields);
+  m_stream.close();
+  if (m_stream.fail()) throw runtime_error("Error writing snapshot " + m_path);
+}
+
+SnapshotReader::SnapshotReader(const string& path) : m_path(path), m_stream(path, ios::binary) {
+  if (!m_stream.is_open()) throw runtime_error("Error opening snapshot " + path);
+
+  char magic[sizeof(SNAPSHOT_MAGIC)];
+  if (!m_stream.read(magic, sizeof(magic)) || memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0) {
+    throw runtime_error(path + " is not a snapshot");
+  }
+
+  const uint32_t numFields = ReadBinary<uint32_t>(m_stream);
+  for (uint32_t field = 0; field < numFields; field++) {
+    FieldInfo info;
+    info.name = ReadBinaryString(m_stream);
+    const uint8_t scalar = ReadBinary<uint8_t>(m_stream);
+    info.scalar = static_cast<SnapshotScalar>(scalar & ~COMPRESSED_RECORD);
+    info.compressed = (scalar & COMPRESSED_RECORD) != 0;
+    info.rows = ReadBinary<int64_t>(m_stream);
+    info.cols = ReadBinary<int64_t>(m_stream);
+    info.storedBytes
+        = info.compressed ? static_cast<int64_t>(ReadBinary<uint64_t>(m_stream))
+                          : static_cast<int64_t>(info.rows * info.cols
+                                                 * GetSnapshotScalarSize(info.scalar));
+    info.offset = static_cast<int64_t>(m_stream.tellg());
+    m_stream.seekg(info.storedBytes, ios::cur);
+    m_fields.push_back(info);
+  }
+}
+
+const SnapshotReader::FieldInfo& SnapshotReader::GetField(const string& name) const {
+  auto it = find_if(m_fields.begin(), m_fields.end(),
+                    [&name](const FieldInfo& info) { return info.name == name; });
+  if (it == m_fields.end()) throw invalid_argument("snapshot has no field " + name);
+  return *it;
+}
+
+bool SnapshotReader::HasField(const string& name) const {
+  return any_of(m_fields.begin(), m_fields.end(),
+                [&name](const FieldInfo& info) { return info.name == name; });
+}
+
+void SnapshotReader::ReadRaw(const FieldInfo& info, void* data) {
+  m_stream.clear();
+  m_stream.seekg(info.offset);
+  if (!info.compressed) {
+    if (!m_stream.read(static_cast<char*>(data), static_cast<streamsize>(info.storedBytes))) {
+      throw runtime_error("snapshot " + m_path + " is truncated");
+    }
+    return;
+  }
+
+  vector<uint8_t> stream(static_cast<size_t>(info.storedBytes));
+  if (!m_stream.read(reinterpret_cast<char*>(stream.data()),
+                     static_cast<streamsize>(stream.size()))) {
+    throw runtime_error("snapshot " + m_path + " is truncated");
+  }
+  FieldCodecOptions options;
+  options.compression = FieldCompression::Lossless;
+  DecodeRecord(FieldCodec(options), info.scalar, stream, data,
+               static_cast<size_t>(info.rows * info.cols));
+}
+
+template <typename Policy>
+void CGLE::WriteSnapshot(const BasicGrid<Policy>& grid, const string& path,
+                         const FieldCodecOptions& codec) {
+  SnapshotWriter writer(path, codec);
+  writer.WriteVector("X", grid.GetDetails().GetXAxis().ToVector());
+  writer.WriteVector("T", grid.GetDetails().GetTimeAxis().ToVector());
+  writer.WriteField("GroundTruthA", grid.GetGroundTruthA());
+  writer.WriteField("GroundTruthB", grid.GetGroundTruthB());
+  writer.WriteField("PerturbedGridAA", grid.GetPerturbedA());
+  writer.WriteField("PerturbedGridBB", grid.GetPerturbedB());
+  writer.Close();
+}
+
+template void CGLE::WriteSnapshot<MixedPrecision>(const Grid&, const string&,
+                                                  const FieldCodecOptions&);
+template void CGLE::WriteSnapshot<DoublePrecision>(const ReferenceGrid&, const string&,
+                                                   const FieldCodecOptions&);
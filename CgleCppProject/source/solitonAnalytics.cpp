@@ -0,0 +1,163 @@
+#include <matWriter.h>
+#include <solitonAnalytics.h>
+
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+using namespace CGLE;
+
+namespace {
+  /** running reduction of one field over the positions of a row **/
+  struct FieldReduction {
+    double power = 0;
+    double peakNorm = -1;
+    int peak = 0;
+    double previousAmplitude = 0;
+    double previousNorm = 0;
+    double steepestSlope = 0;
+
+    void Add(int position, double spacing, double norm) {
+      const double amplitude = std::sqrt(norm);
+      if (norm > peakNorm) {
+        peakNorm = norm;
+        peak = position;
+      }
+      // repeated coordinates add no power and have no slope
+      if (position > 0 && spacing > 0) {
+        power += 0.5 * (norm + previousNorm) * spacing;
+        steepestSlope = max(steepestSlope, std::abs(amplitude - previousAmplitude) / spacing);
+      }
+      previousAmplitude = amplitude;
+      previousNorm = norm;
+    }
+  };
+
+  /**
+   * RefinePeak places the vertex of the parabola through the |u|^2 of a peak and its neighbours,
+   * or keeps the peak coordinate at the ends of the axis and where |u|^2 is not concave
+   */
+  double RefinePeak(const Axis& positions, const Eigen::VectorXd& norms, int peak) {
+    const double center = positions[peak];
+    if (peak == 0 || peak + 1 >= positions.size()) return center;
+
+    // coordinates relative to the peak avoid cancellation far from the origin
+    const double left = positions[peak - 1] - center;
+    const double right = positions[peak + 1] - center;
+    if (!(left < 0) || !(right > 0)) return center;
+    const double slopeLeft = (norms[peak] - norms[peak - 1]) / -left;
+    const double slopeRight = (norms[peak + 1] - norms[peak]) / right;
+    const double curvature = (slopeRight - slopeLeft) / (right - left);
+    if (!(curvature < 0)) return center;
+
+    // p(x) = norms[peak - 1] + slopeLeft (x - left) + curvature (x - left) x
+    const double vertex = (curvature * left - slopeLeft) / (2 * curvature);
+    return center + std::clamp(vertex, left, right);
+  }
+
+  FieldAnalytics FinishField(const Axis& positions, const FieldReduction& reduction,
+                             const Eigen::VectorXd& norms) {
+    FieldAnalytics field;
+    field.peakAmplitude = std::sqrt(max(reduction.peakNorm, 0.0));
+    field.peakPosition = RefinePeak(positions, norms, reduction.peak);
+    field.power = reduction.power;
+    if (reduction.steepestSlope > 0) {
+      field.frontWidth = field.peakAmplitude / reduction.steepestSlope;
+    }
+    return field;
+  }
+}  // namespace
+
+template <typename Policy>
+SolitonAnalytics<Policy>::SolitonAnalytics(const GridDetails& details)
+    : m_positions(details.GetXAxis()), m_times(details.GetTimeAxis()) {
+  if (m_positions.size() < 2) throw invalid_argument("analytics need at least 2 positions");
+  m_normsA.resize(m_positions.size());
+  m_normsB.resize(m_positions.size());
+}
+
+template <typename Policy>
+void SolitonAnalytics<Policy>::Record(int timeIndex, const Eigen::Ref<const StorageVector>& rowA,
+                                      const Eigen::Ref<const StorageVector>& rowB) {
+  const int numPositions = m_positions.size();
+  if (rowA.size() != numPositions || rowB.size() != numPositions) {
+    throw invalid_argument("rows must have one value per position");
+  }
+  if (timeIndex < 0 || timeIndex >= m_times.size()) {
+    throw out_of_range("time index outside the grid");
+  }
+
+  // one fused pass over both fields
+  FieldReduction reductionA, reductionB;
+  double previousCoordinate = m_positions[0];
+  for (int position = 0; position < numPositions; position++) {
+    const double coordinate = m_positions[position];
+    const double spacing = coordinate - previousCoordinate;
+    m_normsA[position] = static_cast<double>(std::norm(rowA[position]));
+    m_normsB[position] = static_cast<double>(std::norm(rowB[position]));
+    reductionA.Add(position, spacing, m_normsA[position]);
+    reductionB.Add(position, spacing, m_normsB[position]);
+    previousCoordinate = coordinate;
+  }
+
+  AnalyticsSample sample;
+  sample.timeIndex = timeIndex;
+  sample.time = m_times[timeIndex];
+  sample.a = FinishField(m_positions, reductionA, m_normsA);
+  sample.b = FinishField(m_positions, reductionB, m_normsB);
+  if (!m_samples.empty()) {
+    const AnalyticsSample& previous = m_samples.back();
+    const double elapsed = sample.time - previous.time;
+    auto velocity = [elapsed](const FieldAnalytics& before, const FieldAnalytics& now) {
+      if (elapsed == 0 || before.power == 0 || now.power == 0) return 0.0;
+      return (now.peakPosition - before.peakPosition) / elapsed;
+    };
+    sample.a.peakVelocity = velocity(previous.a, sample.a);
+    sample.b.peakVelocity = velocity(previous.b, sample.b);
+  }
+  m_samples.push_back(sample);
+}
+
+template <typename Policy>
+typename SolitonAnalytics<Policy>::RowObserver SolitonAnalytics<Policy>::Observer(
+    RowObserver next) {
+  return [this, next](int timeIndex, const Eigen::Ref<FieldMatrix>& fieldA,
+                      const Eigen::Ref<FieldMatrix>& fieldB) {
+    Record(timeIndex, fieldA.col(timeIndex), fieldB.col(timeIndex));
+    if (next) next(timeIndex, fieldA, fieldB);
+  };
+}
+
+template <typename Policy>
+void SolitonAnalytics<Policy>::WriteMatFile(const string& path, int compressionLevel) const {
+  auto series = [this](const string& name, const function<double(const AnalyticsSample&)>& get) {
+    vector<double> values;
+    values.reserve(m_samples.size());
+    for (const AnalyticsSample& sample : m_samples) values.push_back(get(sample));
+    return MatArray::FromVector(name, values);
+  };
+
+  const pair<const char*, double FieldAnalytics::*> quantities[]
+      = {{"peakPosition", &FieldAnalytics::peakPosition},
+         {"peakVelocity", &FieldAnalytics::peakVelocity},
+         {"peakAmplitude", &FieldAnalytics::peakAmplitude},
+         {"power", &FieldAnalytics::power},
+         {"frontWidth", &FieldAnalytics::frontWidth}};
+  vector<MatArray> fields;
+  fields.push_back(series("time", [](const AnalyticsSample& sample) { return sample.time; }));
+  for (const auto& [name, member] : quantities) {
+    fields.push_back(series(string(name) + "A", [member = member](const AnalyticsSample& sample) {
+      return sample.a.*member;
+    }));
+    fields.push_back(series(string(name) + "B", [member = member](const AnalyticsSample& sample) {
+      return sample.b.*member;
+    }));
+  }
+
+  MatWriter writer(path, compressionLevel);
+  writer.WriteStruct("analytics", fields);
+  writer.Close();
+}
+
+template class CGLE::SolitonAnalytics<MixedPrecision>;
+template class CGLE::SolitonAnalytics<DoublePrecision>;
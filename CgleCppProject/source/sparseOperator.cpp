@@ -0,0 +1,174 @@
+#include <sparseOperator.h>
+
+#include <algorithm>
+#include <stdexcept>
+using namespace CGLE;
+
+namespace {
+  /** nonzero of the operator and the coefficient it receives a share of, -1 for the diagonal **/
+  struct Contribution {
+    int row;
+    int col;
+    int term;
+    double weight;
+  };
+}  // namespace
+
+template <typename Scalar> SparseOperator<Scalar>::SparseOperator(vector<StencilAxis> axes)
+    : m_axes(std::move(axes)) {
+  if (m_axes.empty()) throw invalid_argument("an operator needs at least one axis");
+  for (const StencilAxis& axis : m_axes) {
+    if (axis.coordinates.size() < 3) throw invalid_argument("every axis needs at least 3 points");
+    m_numUnknowns *= axis.GetNumUnknowns();
+  }
+
+  const int numAxes = static_cast<int>(m_axes.size());
+  vector<Contribution> contributions;
+  contributions.reserve(static_cast<size_t>(m_numUnknowns) * (1 + 3 * numAxes));
+  vector<int> unknown(numAxes, 0);
+  for (int row = 0; row < m_numUnknowns; row++) {
+    contributions.push_back({row, row, -1, 1.0});
+    int stride = 1;
+    for (int axisIndex = 0; axisIndex < numAxes; axisIndex++) {
+      const StencilAxis& axis = m_axes[axisIndex];
+      const Axis& coordinates = axis.coordinates;
+      const bool periodic = axis.boundary == BoundaryCondition::Periodic;
+      const int count = axis.GetNumUnknowns();
+      const int position = (periodic ? 0 : 1) + unknown[axisIndex];
+
+      // periodic axes wrap around across a gap of the axis step, uniform axes use their step
+      // everywhere so their weights are exactly one
+      const double step = coordinates.GetStep();
+      const bool uniform = coordinates.IsUniform();
+      const double before = position > 0 && !uniform
+                                ? coordinates[position] - coordinates[position - 1]
+                                : step;
+      const double after = position + 1 < coordinates.size() && !uniform
+                               ? coordinates[position + 1] - coordinates[position]
+                               : step;
+      if (!(before > 0) || !(after > 0)) throw invalid_argument("axis points must increase");
+
+      // three point second difference weights relative to a uniform mesh of the axis step
+      const double scale = step * step;
+      const int term = 3 * axisIndex;
+      contributions.push_back({row, row, term + 1, scale / (before * after)});
+      if (unknown[axisIndex] > 0 || periodic) {
+        const int previous = unknown[axisIndex] > 0 ? row - stride : row + (count - 1) * stride;
+        contributions.push_back({row, previous, term, 2 * scale / (before * (before + after))});
+      }
+      if (unknown[axisIndex] + 1 < count || periodic) {
+        const int next = unknown[axisIndex] + 1 < count ? row + stride : row - (count - 1) * stride;
+        contributions.push_back({row, next, term + 2, 2 * scale / (after * (before + after))});
+      }
+      stride *= count;
+    }
+
+    // first axis fastest
+    for (int axisIndex = 0; axisIndex < numAxes; axisIndex++) {
+      if (++unknown[axisIndex] < m_axes[axisIndex].GetNumUnknowns()) break;
+      unknown[axisIndex] = 0;
+    }
+  }
+
+  vector<Eigen::Triplet<Scalar>> pattern;
+  pattern.reserve(contributions.size());
+  for (const Contribution& entry : contributions) pattern.emplace_back(entry.row, entry.col, 1);
+  m_matrix.resize(m_numUnknowns, m_numUnknowns);
+  m_matrix.setFromTriplets(pattern.begin(), pattern.end());
+  m_matrix.makeCompressed();
+
+  // every contribution lands on the value of its nonzero in the compressed storage
+  const int* rows = m_matrix.innerIndexPtr();
+  const int* columns = m_matrix.outerIndexPtr();
+  vector<Eigen::Triplet<Scalar>> weights;
+  weights.reserve(contributions.size());
+  m_diagonalIndex.assign(static_cast<size_t>(m_numUnknowns), 0);
+  for (const Contribution& entry : contributions) {
+    const int index = static_cast<int>(
+        lower_bound(rows + columns[entry.col], rows + columns[entry.col + 1], entry.row) - rows);
+    if (entry.term < 0) {
+      m_diagonalIndex[static_cast<size_t>(entry.row)] = index;
+    } else {
+      weights.emplace_back(index, entry.term, Scalar(entry.weight));
+    }
+  }
+  m_weights.resize(m_matrix.nonZeros(), 3 * numAxes);
+  m_weights.setFromTriplets(weights.begin(), weights.end());
+
+  const size_t nonZeros = static_cast<size_t>(m_matrix.nonZeros());
+  m_charge.Update(nonZeros * (sizeof(Scalar) + sizeof(int))
+                  + static_cast<size_t>(m_numUnknowns + 1) * sizeof(int)
+                  + static_cast<size_t>(m_weights.nonZeros()) * (sizeof(Scalar) + sizeof(int))
+                  + nonZeros * sizeof(int) + m_diagonalIndex.size() * sizeof(int));
+}
+
+template <typename Scalar> const typename SparseOperator<Scalar>::Matrix&
+SparseOperator<Scalar>::Assemble(const vector<Stencil>& stencils, const Vector& diagonal) {
+  if (stencils.size() != m_axes.size()) throw invalid_argument("one stencil per axis is needed");
+  if (diagonal.size() != m_numUnknowns) {
+    throw invalid_argument("diagonal must have one entry per unknown");
+  }
+
+  Vector coefficients(3 * static_cast<Eigen::Index>(stencils.size()));
+  for (size_t axisIndex = 0; axisIndex < stencils.size(); axisIndex++) {
+    const Eigen::Index term = 3 * static_cast<Eigen::Index>(axisIndex);
+    coefficients[term] = stencils[axisIndex].sub;
+    coefficients[term + 1] = stencils[axisIndex].diag;
+    coefficients[term + 2] = stencils[axisIndex].super;
+  }
+  Eigen::Map<Vector> values(m_matrix.valuePtr(), m_matrix.nonZeros());
+  values = m_weights * coefficients;
+  for (int row = 0; row < m_numUnknowns; row++) {
+    values[m_diagonalIndex[static_cast<size_t>(row)]] += diagonal[row];
+  }
+  m_factorized = false;
+  return m_matrix;
+}
+
+template <typename Scalar> const typename SparseOperator<Scalar>::Matrix&
+SparseOperator<Scalar>::Assemble(const vector<Stencil>& stencils, Scalar diagonal) {
+  return Assemble(stencils, Vector::Constant(m_numUnknowns, diagonal));
+}
+
+template <typename Scalar> void SparseOperator<Scalar>::Factorize() {
+  // the pattern never changes, so neither does the fill reducing ordering
+  if (!m_analyzed) {
+    m_lu.analyzePattern(m_matrix);
+    m_analyzed = true;
+    m_numSymbolic++;
+  }
+  m_lu.factorize(m_matrix);
+  if (m_lu.info() != Eigen::Success) throw runtime_error("sparse operator is singular");
+  m_factorized = true;
+  m_numNumeric++;
+}
+
+template <typename Scalar> void SparseOperator<Scalar>::Solve(Eigen::Ref<Vector> rhs) {
+  if (rhs.size() != m_numUnknowns) throw invalid_argument("right hand side has the wrong size");
+  if (!m_factorized) Factorize();
+
+  const Vector solution = m_lu.solve(rhs);
+  rhs = solution;
+}
+
+template <typename Scalar> int SparseOperator<Scalar>::Index(const vector<int>& positions) const {
+  if (positions.size() != m_axes.size()) throw invalid_argument("one position per axis is needed");
+
+  int index = 0;
+  int stride = 1;
+  for (size_t axisIndex = 0; axisIndex < m_axes.size(); axisIndex++) {
+    const StencilAxis& axis = m_axes[axisIndex];
+    const int position = positions[axisIndex];
+    if (position < 0 || position >= axis.coordinates.size()) {
+      throw out_of_range("position outside the axis");
+    }
+    const int unknown = axis.boundary == BoundaryCondition::Periodic ? position : position - 1;
+    if (unknown < 0 || unknown >= axis.GetNumUnknowns()) return -1;
+    index += unknown * stride;
+    stride *= axis.GetNumUnknowns();
+  }
+  return index;
+}
+
+template class CGLE::SparseOperator<complex<double>>;
+template class CGLE::SparseOperator<double>;
@@ -0,0 +1,368 @@
+#include <functionHandler.h>
+#include <spectralScreening.h>
+
+#include <Eigen/Eigenvalues>
+#include <Eigen/SparseLU>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+using namespace CGLE;
+
+namespace {
+  using cd = complex<double>;
+  using Triplet = Eigen::Triplet<cd>;
+
+  /**
+   * FieldCoupling holds the entries of one field's linearized equation: the second difference
+   * coefficient, the diagonal and the couplings to the other perturbations
+   */
+  struct FieldCoupling {
+    cd diffusion;
+    Eigen::VectorXcd self, other, selfConjugate, otherConjugate;
+  };
+
+  /**
+   * NumericalAbscissaBound bounds the growth rate of every eigenvalue by Gershgorin discs of the
+   * hermitian part (L + L^H) / 2
+   */
+  double NumericalAbscissaBound(const LinearizedOperator& linear) {
+    Eigen::VectorXd diagonal = Eigen::VectorXd::Zero(linear.rows());
+    Eigen::VectorXd radius = Eigen::VectorXd::Zero(linear.rows());
+    for (int col = 0; col < linear.outerSize(); col++) {
+      for (LinearizedOperator::InnerIterator entry(linear, col); entry; ++entry) {
+        if (entry.row() == entry.col()) {
+          diagonal[entry.row()] = entry.value().real();
+        } else {
+          radius[entry.row()] += 0.5 * std::abs(entry.value());
+          radius[entry.col()] += 0.5 * std::abs(entry.value());
+        }
+      }
+    }
+    return (diagonal + radius).maxCoeff();
+  }
+
+  /**
+   * SchurForm computes the complex Schur form T = Q^H M Q of a small square matrix, reducing it to
+   * upper Hessenberg form by Householder reflections first
+   */
+  void SchurForm(const Eigen::MatrixXcd& matrix, Eigen::MatrixXcd& triangular,
+                 Eigen::MatrixXcd& vectors) {
+    const Eigen::Index size = matrix.rows();
+    Eigen::MatrixXcd hessenberg = matrix;
+    vectors = Eigen::MatrixXcd::Identity(size, size);
+    Eigen::VectorXcd workspace(size);
+    for (Eigen::Index col = 0; col + 2 < size; col++) {
+      const Eigen::Index length = size - col - 1;
+      Eigen::VectorXcd essential(length - 1);
+      cd tau;
+      double beta;
+      hessenberg.col(col).tail(length).makeHouseholder(essential, tau, beta);
+      hessenberg.bottomRightCorner(length, size - col)
+          .applyHouseholderOnTheLeft(essential, tau, workspace.data());
+      // the reflection is not hermitian, its adjoint acts on the right
+      hessenberg.rightCols(length).applyHouseholderOnTheRight(essential, std::conj(tau),
+                                                             workspace.data());
+      vectors.rightCols(length).applyHouseholderOnTheRight(essential, std::conj(tau),
+                                                          workspace.data());
+      hessenberg.col(col).tail(length - 1).setZero();
+    }
+
+    Eigen::ComplexSchur<Eigen::MatrixXcd> schur;
+    schur.computeFromHessenberg(hessenberg, vectors, true);
+    if (schur.info() != Eigen::Success) throw runtime_error("Ritz values did not converge");
+    triangular = schur.matrixT();
+    vectors = schur.matrixU();
+  }
+
+  /**
+   * SwapSchurDiagonal exchanges the adjacent eigenvalues k and k + 1 of a complex Schur form
+   * T = Q^H H Q with one Givens rotation, updating T and Q in place
+   */
+  void SwapSchurDiagonal(Eigen::MatrixXcd& triangular, Eigen::MatrixXcd& vectors, Eigen::Index k) {
+    const cd first = triangular(k, k);
+    const cd second = triangular(k + 1, k + 1);
+    const cd f = triangular(k, k + 1);
+    const cd g = second - first;
+    const double norm = std::hypot(std::abs(f), std::abs(g));
+    if (norm == 0) return;
+    const double c = std::abs(f) / norm;
+    const cd s = std::abs(f) == 0 ? std::conj(g) / std::abs(g)
+                                  : f / std::abs(f) * std::conj(g) / norm;
+
+    // rows k, k + 1 by the rotation and columns k, k + 1 by its adjoint
+    for (Eigen::Index col = k + 2; col < triangular.cols(); col++) {
+      const cd x = triangular(k, col), y = triangular(k + 1, col);
+      triangular(k, col) = c * x + s * y;
+      triangular(k + 1, col) = c * y - std::conj(s) * x;
+    }
+    auto rotateColumns = [c, s, k](Eigen::MatrixXcd& matrix, Eigen::Index rows) {
+      for (Eigen::Index row = 0; row < rows; row++) {
+        const cd x = matrix(row, k), y = matrix(row, k + 1);
+        matrix(row, k) = c * x + std::conj(s) * y;
+        matrix(row, k + 1) = c * y - s * x;
+      }
+    };
+    rotateColumns(triangular, k);
+    rotateColumns(vectors, vectors.rows());
+    triangular(k, k) = second;
+    triangular(k + 1, k + 1) = first;
+  }
+
+  /**
+   * TriangularEigenvector solves (T - T(k, k)) y = 0 for the unit eigenvector of an upper
+   * triangular matrix by back substitution
+   */
+  Eigen::VectorXcd TriangularEigenvector(const Eigen::MatrixXcd& triangular, Eigen::Index k) {
+    const double smallest = 1e-14 * max(triangular.norm(), 1e-300);
+    Eigen::VectorXcd solution = Eigen::VectorXcd::Zero(triangular.rows());
+    solution[k] = 1;
+    for (Eigen::Index row = k - 1; row >= 0; row--) {
+      cd sum = 0;
+      for (Eigen::Index col = row + 1; col <= k; col++) sum += triangular(row, col) * solution[col];
+      cd denominator = triangular(row, row) - triangular(k, k);
+      if (std::abs(denominator) < smallest) denominator = smallest;
+      solution[row] = -sum / denominator;
+    }
+    return solution.normalized();
+  }
+}  // namespace
+
+LinearizedOperator CGLE::BuildLinearizedOperator(const Constraint& constraint, double dx,
+                                                 const Eigen::VectorXcd& profileA,
+                                                 const Eigen::VectorXcd& profileB,
+                                                 BoundaryCondition boundary) {
+  if (profileA.size() != profileB.size()) {
+    throw invalid_argument("A and B profiles must have identical sizes");
+  }
+  if (dx <= 0) throw invalid_argument("grid spacing must be positive");
+
+  const bool periodic = boundary == BoundaryCondition::Periodic;
+  const int numPositions = static_cast<int>(profileA.size());
+  const int firstUnknown = periodic ? 0 : 1;
+  const int n = periodic ? numPositions : numPositions - 2;
+  if (n < 3) throw invalid_argument("profile must have at least 3 unknown positions");
+
+  const cd i(0, 1);
+  const Eigen::VectorXcd a = profileA.segment(firstUnknown, n);
+  const Eigen::VectorXcd b = profileB.segment(firstUnknown, n);
+  const Eigen::VectorXd normA = a.cwiseAbs2();
+  const Eigen::VectorXd normB = b.cwiseAbs2();
+
+  // d(N A) = N u + A (q1 d|A|^2 + q2 d|B|^2), d|A|^2 = conj(A) u + A conj(u)
+  auto couple = [&](cd p, cd gamma, cd q1, cd q2, const Eigen::VectorXcd& own,
+                    const Eigen::VectorXcd& cross, cd ownCoupling, cd crossCoupling) {
+    const Eigen::VectorXcd nonlinear = q1 * normA.cast<cd>() + q2 * normB.cast<cd>();
+    FieldCoupling field;
+    field.diffusion = i * p / (dx * dx);
+    field.self = (gamma + i * nonlinear.array() + i * ownCoupling * own.cwiseAbs2().array())
+                     .matrix();
+    field.selfConjugate = (i * ownCoupling * own.array().square()).matrix();
+    field.other = (i * crossCoupling * own.array() * cross.conjugate().array()).matrix();
+    field.otherConjugate = (i * crossCoupling * own.array() * cross.array()).matrix();
+    return field;
+  };
+  // both fields weigh |A|^2 with their Q1 and |B|^2 with their Q2
+  const FieldCoupling fieldA = couple(constraint.m_P1, constraint.m_Gamma1, constraint.m_Q1,
+                                      constraint.m_Q2, a, b, constraint.m_Q1, constraint.m_Q2);
+  const FieldCoupling fieldB
+      = couple(constraint.m_P1Prime, constraint.m_Gamma1Prime, constraint.m_Q1Prime,
+               constraint.m_Q2Prime, b, a, constraint.m_Q2Prime, constraint.m_Q1Prime);
+
+  // blocks are ordered u, v, conj(u), conj(v); conjugate rows swap every variable for its
+  // conjugate and conjugate every coefficient
+  vector<Triplet> triplets;
+  triplets.reserve(static_cast<size_t>(4 * n) * 7);
+  auto addField = [&](const FieldCoupling& field, int selfBlock, int otherBlock, bool conjugate) {
+    auto value = [conjugate](cd coefficient) {
+      return conjugate ? std::conj(coefficient) : coefficient;
+    };
+    const int conjugateOffset = conjugate ? -2 : 2;
+    const int rowBlock = conjugate ? selfBlock + 2 : selfBlock;
+    const int selfColumn = rowBlock;
+    const int otherColumn = conjugate ? otherBlock + 2 : otherBlock;
+    for (int k = 0; k < n; k++) {
+      const int row = rowBlock * n + k;
+      triplets.emplace_back(row, selfColumn * n + k, value(field.self[k] - 2.0 * field.diffusion));
+      if (k > 0 || periodic) {
+        triplets.emplace_back(row, selfColumn * n + (k + n - 1) % n, value(field.diffusion));
+      }
+      if (k + 1 < n || periodic) {
+        triplets.emplace_back(row, selfColumn * n + (k + 1) % n, value(field.diffusion));
+      }
+      triplets.emplace_back(row, (selfColumn + conjugateOffset) * n + k,
+                            value(field.selfConjugate[k]));
+      triplets.emplace_back(row, otherColumn * n + k, value(field.other[k]));
+      triplets.emplace_back(row, (otherColumn + conjugateOffset) * n + k,
+                            value(field.otherConjugate[k]));
+    }
+  };
+  for (bool conjugate : {false, true}) {
+    addField(fieldA, 0, 1, conjugate);
+    addField(fieldB, 1, 0, conjugate);
+  }
+
+  LinearizedOperator linear(4 * n, 4 * n);
+  linear.setFromTriplets(triplets.begin(), triplets.end());
+  return linear;
+}
+
+SpectralScreeningResult CGLE::ComputeLeadingEigenvalues(const LinearizedOperator& linear,
+                                                        const SpectralScreeningOptions& options) {
+  const int size = static_cast<int>(linear.rows());
+  if (size == 0 || linear.cols() != size) throw invalid_argument("operator must be square");
+  if (options.numEigenvalues < 1) throw invalid_argument("at least one eigenvalue is needed");
+
+  const int basisSize = min(max(options.krylovDimension, options.numEigenvalues + 2), size);
+  const int numWanted = min(options.numEigenvalues, basisSize - 1);
+
+  SpectralScreeningResult result;
+  result.shift = options.shift;
+  if (std::isnan(result.shift)) {
+    const double bound = NumericalAbscissaBound(linear);
+    result.shift = bound + max(1.0, 1e-3 * std::abs(bound));
+  }
+
+  // factorizing L / scale keeps the LU of near overflow coefficients finite, the eigenvalues of
+  // the inverse become scale / (lambda - shift)
+  double scale = 0;
+  for (int col = 0; col < linear.outerSize(); col++) {
+    for (LinearizedOperator::InnerIterator entry(linear, col); entry; ++entry) {
+      scale = max(scale, std::abs(entry.value()));
+    }
+  }
+  if (!std::isfinite(scale) || !std::isfinite(result.shift)) {
+    throw invalid_argument("operator coefficients must be finite");
+  }
+  if (scale == 0) scale = 1;
+  LinearizedOperator shifted = linear / scale;
+  for (int k = 0; k < size; k++) shifted.coeffRef(k, k) -= result.shift / scale;
+  shifted.makeCompressed();
+  Eigen::SparseLU<LinearizedOperator> inverse;
+  inverse.analyzePattern(shifted);
+  inverse.factorize(shifted);
+  if (inverse.info() != Eigen::Success) throw runtime_error("shifted operator is singular");
+
+  // a fixed start vector keeps the screening deterministic
+  Eigen::VectorXcd start(size);
+  for (int k = 0; k < size; k++) start[k] = cd(1.0 + 0.5 * std::sin(k + 1.0), std::cos(3.0 * k));
+
+  // Krylov-Schur: V_k+1 and the (k + 1) x k matrix R satisfy inv V_k = V_k+1 R, with R upper
+  // triangular above a full last row after a restart and upper Hessenberg after a reset
+  Eigen::MatrixXcd basis = Eigen::MatrixXcd::Zero(size, basisSize + 1);
+  Eigen::MatrixXcd rayleigh = Eigen::MatrixXcd::Zero(basisSize + 1, basisSize);
+  basis.col(0) = start.normalized();
+  int kept = 0;
+  vector<cd> eigenvalues;
+  for (result.numRestarts = 0; result.numRestarts <= options.maxRestarts; result.numRestarts++) {
+    // extend the basis with one pass of reorthogonalization
+    int steps = basisSize;
+    bool invariant = false;
+    for (int j = kept; j < basisSize; j++) {
+      Eigen::VectorXcd next = inverse.solve(basis.col(j));
+      for (int pass = 0; pass < 2; pass++) {
+        const Eigen::VectorXcd projection = basis.leftCols(j + 1).adjoint() * next;
+        next -= basis.leftCols(j + 1) * projection;
+        rayleigh.col(j).head(j + 1) += projection;
+      }
+      rayleigh(j + 1, j) = next.norm();
+      if (std::abs(rayleigh(j + 1, j)) <= 1e-14 * rayleigh.col(j).head(j + 1).norm()) {
+        steps = j + 1;
+        invariant = true;
+        break;
+      }
+      basis.col(j + 1) = next / rayleigh(j + 1, j);
+    }
+
+    Eigen::MatrixXcd triangular, vectors;
+    SchurForm(rayleigh.topLeftCorner(steps, steps), triangular, vectors);
+
+    // the largest eigenvalues of the inverse are the ones closest to the shift; bubble them to
+    // the front of the Schur form so the leading columns span them
+    const int keep = invariant ? steps : min(max(numWanted + 1, steps / 2), steps - 1);
+    for (int front = 0; front < keep; front++) {
+      int best = front;
+      for (int k = front + 1; k < steps; k++) {
+        if (std::abs(triangular(k, k)) > std::abs(triangular(best, best))) best = k;
+      }
+      for (int k = best - 1; k >= front; k--) SwapSchurDiagonal(triangular, vectors, k);
+    }
+
+    const int wanted = min(numWanted, steps);
+    const Eigen::RowVectorXcd coupling = rayleigh.row(steps).head(steps) * vectors;
+    bool converged = true;
+    eigenvalues.clear();
+    for (int k = 0; k < wanted; k++) {
+      const cd theta = triangular(k, k);
+      const Eigen::VectorXcd y = TriangularEigenvector(triangular, k);
+      const cd projection = (coupling.head(k + 1) * y.head(k + 1)).value();
+      const double residual = invariant ? 0 : std::abs(projection);
+      converged = converged && residual <= options.tolerance * std::abs(theta);
+      eigenvalues.push_back(result.shift + scale / theta);
+    }
+    if (converged) {
+      result.converged = true;
+      break;
+    }
+
+    // thick restart from the leading Schur vectors
+    basis.leftCols(keep) = basis.leftCols(steps) * vectors.leftCols(keep);
+    basis.col(keep) = basis.col(steps);
+    basis.rightCols(basisSize - keep).setZero();
+    const Eigen::MatrixXcd leading = triangular.topLeftCorner(keep, keep);
+    rayleigh.setZero();
+    rayleigh.topLeftCorner(keep, keep) = leading;
+    rayleigh.row(keep).head(keep) = coupling.head(keep);
+    kept = keep;
+  }
+  result.numRestarts = min(result.numRestarts, options.maxRestarts);
+
+  sort(eigenvalues.begin(), eigenvalues.end(),
+       [](cd first, cd second) { return first.real() > second.real(); });
+  result.eigenvalues = eigenvalues;
+  result.maxGrowthRate = eigenvalues.front().real();
+  // growth rates are recovered as shift + 1 / theta, far shifts cancel their digits
+  const double resolution = max(options.margin, 64 * numeric_limits<double>::epsilon()
+                                                    * std::abs(result.shift));
+  if (!result.converged) {
+    result.verdict = ScreeningVerdict::Borderline;
+  } else if (result.maxGrowthRate > resolution) {
+    result.verdict = ScreeningVerdict::Unstable;
+  } else if (result.maxGrowthRate < -resolution) {
+    result.verdict = ScreeningVerdict::Stable;
+  } else {
+    result.verdict = ScreeningVerdict::Borderline;
+  }
+  return result;
+}
+
+SpectralScreeningResult CGLE::ScreenStability(const Constraint& constraint,
+                                              const GridDetails& details,
+                                              const SpectralScreeningOptions& options) {
+  const Axis& times = details.GetTimeAxis();
+  if (options.timeIndex < 0 || options.timeIndex >= times.size()) {
+    throw invalid_argument("time index outside the grid");
+  }
+
+  FunctionHandler functions(constraint);
+  const FnHandlerRetType fieldA = functions.A();
+  const FnHandlerRetType fieldB = functions.B();
+  const Axis& positions = details.GetXAxis();
+  const double time = times[options.timeIndex];
+  Eigen::VectorXcd profileA(positions.size());
+  Eigen::VectorXcd profileB(positions.size());
+  for (int position = 0; position < positions.size(); position++) {
+    profileA[position] = fieldA(positions[position], time);
+    profileB[position] = fieldB(positions[position], time);
+  }
+
+  // non finite ground truth cells are zeroed like the solver's initial condition
+  for (Eigen::VectorXcd* profile : {&profileA, &profileB}) {
+    for (cd& value : *profile) {
+      if (!std::isfinite(value.real()) || !std::isfinite(value.imag())) value = cd(0, 0);
+    }
+  }
+  return ComputeLeadingEigenvalues(BuildLinearizedOperator(constraint, details.GetDx(), profileA,
+                                                           profileB, options.boundaryCondition),
+                                   options);
+}
@@ -0,0 +1,342 @@
+#include <stabilitySolver.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+using namespace CGLE;
+
+template <typename Policy>
+StabilitySolver<Policy>::StabilitySolver(const Constraint& constraint, double dx, double dt) {
+  if (dx <= 0 || dt <= 0) throw invalid_argument("grid spacing must be positive");
+
+  m_coeffA = Coefficients::Create(constraint.m_P1, constraint.m_Gamma1, constraint.m_Q1,
+                                  constraint.m_Q2, dx, dt);
+  m_coeffB = Coefficients::Create(constraint.m_P1Prime, constraint.m_Gamma1Prime,
+                                  constraint.m_Q1Prime, constraint.m_Q2Prime, dx, dt);
+}
+
+template <typename Policy>
+StabilitySolver<Policy>::StabilitySolver(const Constraint& constraint, const GridDetails& details)
+    : StabilitySolver(constraint, details.GetDx(), details.GetDt()) {}
+
+template <typename Policy>
+void StabilitySolver<Policy>::SetPlacement(const PlacementOptions& placement, int threshold) {
+  m_placement = make_shared<PlacementOptions>(placement);
+  m_placementThreshold = threshold;
+  SetNumThreads(placement.numThreads, threshold);
+  // the AA / BB blocks are solved on the same pinned workers the row blocks are placed on
+  const shared_ptr<WorkerPool> workers = GetPlacementWorkers(placement);
+  m_systemA.SetWorkers(workers);
+  m_systemB.SetWorkers(workers);
+  m_cyclicA.SetWorkers(workers);
+  m_cyclicB.SetWorkers(workers);
+  m_implicitA.SetWorkers(workers);
+  m_implicitB.SetWorkers(workers);
+  m_implicitCyclicA.SetWorkers(workers);
+  m_implicitCyclicB.SetWorkers(workers);
+}
+
+template <typename Policy>
+void StabilitySolver<Policy>::SetNumThreads(int numThreads, int threshold) {
+  m_systemA.SetParallelism(numThreads, threshold);
+  m_systemB.SetParallelism(numThreads, threshold);
+  m_cyclicA.SetParallelism(numThreads, threshold);
+  m_cyclicB.SetParallelism(numThreads, threshold);
+  m_implicitA.SetParallelism(numThreads, threshold);
+  m_implicitB.SetParallelism(numThreads, threshold);
+  m_implicitCyclicA.SetParallelism(numThreads, threshold);
+  m_implicitCyclicB.SetParallelism(numThreads, threshold);
+  m_numUnknowns = 0;
+}
+
+template <typename Policy>
+void StabilitySolver<Policy>::SetBoundaryCondition(BoundaryCondition boundary) {
+  if (boundary == m_boundary) return;
+
+  m_boundary = boundary;
+  m_numUnknowns = 0;
+}
+
+template <typename Policy>
+void StabilitySolver<Policy>::SetStepScheme(StepScheme scheme, const NewtonKrylovOptions& options) {
+  m_newtonKrylov = NewtonKrylovSolver<AccumulatorComplex>(options);
+  m_scheme = scheme;
+  m_numUnknowns = 0;
+}
+
+template <typename Policy> void StabilitySolver<Policy>::Solve(BasicGrid<Policy>& grid) {
+  Solve(grid.GetPerturbedA(), grid.GetPerturbedB());
+}
+
+template <typename Policy>
+void StabilitySolver<Policy>::Solve(Eigen::Ref<FieldMatrix> fieldA,
+                                    Eigen::Ref<FieldMatrix> fieldB) {
+  if (fieldA.rows() != fieldB.rows() || fieldA.cols() != fieldB.cols()) {
+    throw invalid_argument("A and B fields must have identical dimensions");
+  }
+
+  const int numPositions = static_cast<int>(fieldA.rows());
+  const int numTimes = static_cast<int>(fieldA.cols());
+  if (numPositions < 3 || numTimes < 2) {
+    throw invalid_argument("grid must have at least 3 positions and 2 time points");
+  }
+  if (m_guessA
+      && (m_guessA->rows() != numPositions || m_guessA->cols() != numTimes
+          || m_guessB->rows() != numPositions || m_guessB->cols() != numTimes)) {
+    throw invalid_argument("initial iterate must match the fields");
+  }
+
+  PrepareFields(fieldA, fieldB);
+
+  // periodic fields solve for every position, Dirichlet ones only for the interior
+  const bool periodic = m_boundary == BoundaryCondition::Periodic;
+  const int firstUnknown = periodic ? 0 : 1;
+  const int numUnknowns = periodic ? numPositions : numPositions - 2;
+  Factorize(numUnknowns);
+  m_lastSolvedRow = 0;
+  m_newtonKrylovReport = NewtonKrylovReport();
+  auto da = m_da->col(0);
+  auto db = m_db->col(0);
+  if (m_observer) m_observer(0, fieldA, fieldB);
+
+  // placed solves work through every row on the workers owning the pages of that row of a field
+  const bool placed = m_placement && numUnknowns >= m_placementThreshold;
+  auto forEachBlock = [&](const Eigen::Ref<FieldMatrix>& field, int row,
+                          const function<void(Eigen::Index, Eigen::Index)>& body) {
+    auto unknowns = [&](Eigen::Index begin, Eigen::Index end) {
+      const Eigen::Index first = max<Eigen::Index>(begin, firstUnknown) - firstUnknown;
+      const Eigen::Index last = min<Eigen::Index>(end - firstUnknown, numUnknowns);
+      if (first < last) body(first, last);
+    };
+    if (placed) {
+      ForEachPlacedBlock(FieldLayout::Of(field), row, *m_placement, unknowns);
+    } else {
+      body(0, numUnknowns);
+    }
+  };
+
+  // the first time point is the initial condition and the last one the boundary condition
+  for (int timeIndex = 1; timeIndex < numTimes - 1; timeIndex++) {
+    if (m_scheme == StepScheme::NewtonKrylov) {
+      SolveImplicitRow(fieldA, fieldB, timeIndex, da, db);
+    } else {
+      forEachBlock(fieldA, timeIndex, [&](Eigen::Index begin, Eigen::Index end) {
+        for (int unknown = static_cast<int>(begin); unknown < end; unknown++) {
+          const int position = firstUnknown + unknown;
+          da[unknown] = ComputeAtCurrentTimeAndPosition(m_coeffA, fieldA, fieldA, fieldB,
+                                                        timeIndex, position);
+          db[unknown] = ComputeAtCurrentTimeAndPosition(m_coeffB, fieldB, fieldA, fieldB,
+                                                        timeIndex, position);
+        }
+      });
+
+      if (periodic) {
+        m_cyclicA.Solve(da);
+        m_cyclicB.Solve(db);
+      } else {
+        m_systemA.Solve(da);
+        m_systemB.Solve(db);
+      }
+    }
+
+    // Dirichlet boundary positions stay at zero, only the unknowns of the current row are replaced
+    forEachBlock(fieldA, timeIndex, [&](Eigen::Index begin, Eigen::Index end) {
+      for (int unknown = static_cast<int>(begin); unknown < end; unknown++) {
+        fieldA(firstUnknown + unknown, timeIndex) = Policy::ToStorage(da[unknown]);
+      }
+    });
+    forEachBlock(fieldB, timeIndex, [&](Eigen::Index begin, Eigen::Index end) {
+      for (int unknown = static_cast<int>(begin); unknown < end; unknown++) {
+        fieldB(firstUnknown + unknown, timeIndex) = Policy::ToStorage(db[unknown]);
+      }
+    });
+    if (m_observer) m_observer(timeIndex, fieldA, fieldB);
+    m_lastSolvedRow = timeIndex;
+    if (m_stopCondition && m_stopCondition(timeIndex, fieldA, fieldB)) return;
+  }
+
+  // the last time row is never computed by the march, it is zeroed and not reported as a sample
+  fieldA.col(numTimes - 1).setZero();
+  fieldB.col(numTimes - 1).setZero();
+}
+
+template <typename Policy>
+void StabilitySolver<Policy>::PrepareFields(Eigen::Ref<FieldMatrix> fieldA,
+                                            Eigen::Ref<FieldMatrix> fieldB) const {
+  using StorageComplex = typename Policy::StorageComplex;
+  auto zeroNaN = [](StorageComplex& value) {
+    if (std::isnan(value.real()) || std::isnan(value.imag())) value = StorageComplex(0, 0);
+  };
+
+  for (int timeIndex = 0; timeIndex < fieldA.cols(); timeIndex++) {
+    for (int position = 0; position < fieldA.rows(); position++) {
+      zeroNaN(fieldA(position, timeIndex));
+      zeroNaN(fieldB(position, timeIndex));
+    }
+  }
+
+  if (m_boundary == BoundaryCondition::Periodic) return;
+
+  fieldA.row(0).setZero();
+  fieldA.row(fieldA.rows() - 1).setZero();
+  fieldB.row(0).setZero();
+  fieldB.row(fieldB.rows() - 1).setZero();
+}
+
+template <typename Policy> void StabilitySolver<Policy>::Factorize(int numUnknowns) {
+  if (m_numUnknowns == numUnknowns) return;
+
+  if (m_scheme == StepScheme::NewtonKrylov) {
+    // implicit steps move c * previous and linear * current of the stencil to the left
+    const Coefficients* coeffs[2] = {&m_coeffA, &m_coeffB};
+    for (int field = 0; field < 2; field++) {
+      const Coefficients& coeff = *coeffs[field];
+      const AccumulatorComplex sub = coeff.a - coeff.c;
+      const AccumulatorComplex diag = coeff.b - coeff.linear;
+      if (m_boundary == BoundaryCondition::Periodic) {
+        (field == 0 ? m_implicitCyclicA : m_implicitCyclicB)
+            .Factorize(numUnknowns, sub, diag, coeff.c);
+      } else {
+        (field == 0 ? m_implicitA : m_implicitB).Factorize(numUnknowns, sub, diag, coeff.c);
+      }
+    }
+  } else if (m_boundary == BoundaryCondition::Periodic) {
+    m_cyclicA.Factorize(numUnknowns, m_coeffA.a, m_coeffA.b, m_coeffA.c);
+    m_cyclicB.Factorize(numUnknowns, m_coeffB.a, m_coeffB.b, m_coeffB.c);
+  } else {
+    m_systemA.Factorize(numUnknowns, m_coeffA.a, m_coeffA.b, m_coeffA.c);
+    m_systemB.Factorize(numUnknowns, m_coeffB.a, m_coeffB.b, m_coeffB.c);
+  }
+  m_da = ScratchPool::Local().Acquire(numUnknowns, 1, MemorySubsystem::Solver);
+  m_db = ScratchPool::Local().Acquire(numUnknowns, 1, MemorySubsystem::Solver);
+  m_numUnknowns = numUnknowns;
+  m_factorizationCharge.Update(m_systemA.GetBytes() + m_systemB.GetBytes() + m_cyclicA.GetBytes()
+                               + m_cyclicB.GetBytes() + m_implicitA.GetBytes()
+                               + m_implicitB.GetBytes() + m_implicitCyclicA.GetBytes()
+                               + m_implicitCyclicB.GetBytes());
+}
+
+template <typename Policy>
+typename StabilitySolver<Policy>::AccumulatorComplex
+StabilitySolver<Policy>::ComputeAtCurrentTimeAndPosition(const Coefficients& coeff,
+                                                         const Eigen::Ref<FieldMatrix>& self,
+                                                         const Eigen::Ref<FieldMatrix>& fieldA,
+                                                         const Eigen::Ref<FieldMatrix>& fieldB,
+                                                         int timeIndex, int position) const {
+  auto at = [timeIndex](const Eigen::Ref<FieldMatrix>& field, int pos, int time = -1) {
+    return Policy::ToAccumulator(field(pos, time < 0 ? timeIndex : time));
+  };
+
+  const int numTimes = static_cast<int>(self.cols());
+  const int numPositions = static_cast<int>(self.rows());
+  const int previous = position == 0 ? numPositions - 1 : position - 1;
+  const int next = position + 1 == numPositions ? 0 : position + 1;
+
+  // the next time row only contributes while it is not one of the trailing boundary rows
+  const bool hasLater = timeIndex + 1 < numTimes - 2;
+  return coeff.RightHandSide(at(self, previous), at(self, position), at(self, next),
+                             at(fieldA, position), at(fieldB, position), at(fieldA, next),
+                             at(fieldB, next), at(self, position, timeIndex - 1),
+                             hasLater ? at(self, position, timeIndex + 1) : AccumulatorComplex(),
+                             hasLater);
+}
+
+template <typename Policy>
+void StabilitySolver<Policy>::SolveImplicitRow(const Eigen::Ref<FieldMatrix>& fieldA,
+                                               const Eigen::Ref<FieldMatrix>& fieldB,
+                                               int timeIndex, Eigen::Ref<AccumulatorVector> da,
+                                               Eigen::Ref<AccumulatorVector> db) {
+  const int numUnknowns = m_numUnknowns;
+  const bool periodic = m_boundary == BoundaryCondition::Periodic;
+  const int firstUnknown = periodic ? 0 : 1;
+
+  auto residual = [&](const AccumulatorVector& unknowns, AccumulatorVector& values) {
+    ImplicitResidual(unknowns, values, fieldA, fieldB, timeIndex);
+  };
+  auto precondition = [&](AccumulatorVector& values) {
+    if (periodic) {
+      m_implicitCyclicA.Solve(values.head(numUnknowns));
+      m_implicitCyclicB.Solve(values.tail(numUnknowns));
+    } else {
+      m_implicitA.Solve(values.head(numUnknowns));
+      m_implicitB.Solve(values.tail(numUnknowns));
+    }
+  };
+
+  // without a guess the fields hold the scheme's own estimate of the current row
+  auto seed = [&](auto& values, const auto& field) {
+    values = field.col(timeIndex)
+                 .segment(firstUnknown, numUnknowns)
+                 .template cast<AccumulatorComplex>();
+  };
+  m_unknowns.resize(2 * numUnknowns);
+  auto headValues = m_unknowns.head(numUnknowns);
+  auto tailValues = m_unknowns.tail(numUnknowns);
+  if (m_guessA) {
+    seed(headValues, *m_guessA);
+    seed(tailValues, *m_guessB);
+  } else {
+    seed(headValues, fieldA);
+    seed(tailValues, fieldB);
+  }
+  // AA u and the stencil cancel to round-off of their size, which cannot be reduced any further
+  const double scale = max(std::abs(m_coeffA.a) + std::abs(m_coeffA.b) + std::abs(m_coeffA.c),
+                           std::abs(m_coeffB.a) + std::abs(m_coeffB.b) + std::abs(m_coeffB.c));
+  const double roundOff
+      = 64 * numeric_limits<AccumulatorType>::epsilon() * scale * m_unknowns.norm();
+  m_newtonKrylovReport.Merge(m_newtonKrylov.Solve(residual, precondition, m_unknowns, roundOff));
+  da = m_unknowns.head(numUnknowns);
+  db = m_unknowns.tail(numUnknowns);
+}
+
+template <typename Policy>
+void StabilitySolver<Policy>::ImplicitResidual(const AccumulatorVector& unknowns,
+                                               AccumulatorVector& residual,
+                                               const Eigen::Ref<FieldMatrix>& fieldA,
+                                               const Eigen::Ref<FieldMatrix>& fieldB,
+                                               int timeIndex) const {
+  const int numUnknowns = m_numUnknowns;
+  const int numPositions = static_cast<int>(fieldA.rows());
+  const int numTimes = static_cast<int>(fieldA.cols());
+  const bool periodic = m_boundary == BoundaryCondition::Periodic;
+  const int firstUnknown = periodic ? 0 : 1;
+  const bool hasLater = timeIndex + 1 < numTimes - 2;
+
+  // current row values come from the unknowns, the Dirichlet boundaries from the fields
+  auto current = [&](int field, int position) -> AccumulatorComplex {
+    position = (position + numPositions) % numPositions;
+    const int unknown = position - firstUnknown;
+    if (unknown >= 0 && unknown < numUnknowns) return unknowns[field * numUnknowns + unknown];
+    return Policy::ToAccumulator((field == 0 ? fieldA : fieldB)(position, timeIndex));
+  };
+
+  for (int field = 0; field < 2; field++) {
+    const Coefficients& coeff = field == 0 ? m_coeffA : m_coeffB;
+    const Eigen::Ref<FieldMatrix>& self = field == 0 ? fieldA : fieldB;
+    const AccumulatorComplex* values = unknowns.data() + field * numUnknowns;
+    for (int unknown = 0; unknown < numUnknowns; unknown++) {
+      const int position = firstUnknown + unknown;
+      // AA u, including the corner entries of the cyclic system
+      AccumulatorComplex product = coeff.b * values[unknown];
+      if (unknown > 0 || periodic) {
+        product += coeff.a * values[(unknown + numUnknowns - 1) % numUnknowns];
+      }
+      if (unknown + 1 < numUnknowns || periodic) {
+        product += coeff.c * values[(unknown + 1) % numUnknowns];
+      }
+      // the stencil of ComputeAtCurrentTimeAndPosition with every current row value implicit
+      const AccumulatorComplex rhs = coeff.RightHandSide(
+          current(field, position - 1), values[unknown], current(field, position + 1),
+          current(0, position), current(1, position), current(0, position + 1),
+          current(1, position + 1), Policy::ToAccumulator(self(position, timeIndex - 1)),
+          hasLater ? Policy::ToAccumulator(self(position, timeIndex + 1)) : AccumulatorComplex(),
+          hasLater);
+      residual[field * numUnknowns + unknown] = product - rhs;
+    }
+  }
+}
+
+template class CGLE::StabilitySolver<MixedPrecision>;
+template class CGLE::StabilitySolver<DoublePrecision>;
@@ -0,0 +1,130 @@
+#include <thresholdSearch.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+using namespace CGLE;
+
+namespace {
+  /** largest amplitude of a time row of both fields, infinite when a value is not finite **/
+  template <typename Matrix> double RowMaxAmplitude(const Matrix& fieldA, const Matrix& fieldB,
+                                                   int timeIndex) {
+    if (!fieldA.col(timeIndex).allFinite() || !fieldB.col(timeIndex).allFinite()) {
+      return numeric_limits<double>::infinity();
+    }
+    return static_cast<double>(max(fieldA.col(timeIndex).cwiseAbs().maxCoeff(),
+                                   fieldB.col(timeIndex).cwiseAbs().maxCoeff()));
+  }
+}  // namespace
+
+template <typename Policy>
+ThresholdSearch<Policy>::ThresholdSearch(const Constraint& constraint, const GridDetails& details)
+    : m_constraint(constraint), m_details(details) {}
+
+template <typename Policy>
+ThresholdResult ThresholdSearch<Policy>::Run(const ThresholdSearchOptions& options) {
+  if (!(options.lower < options.upper)) throw invalid_argument("lower must be below upper");
+  if (!(options.tolerance > 0)) throw invalid_argument("tolerance must be positive");
+  if (!(options.expansion > 0)) throw invalid_argument("expansion must be positive");
+  if (options.maxProbes < 2) throw invalid_argument("a search needs at least two probes");
+
+  ThresholdResult result;
+  auto probe = [&](double value) {
+    result.probes.push_back(Probe(options, value));
+    return result.probes.back().unstable;
+  };
+
+  // stable and unstable ends of the bracket, moved outwards until their verdicts match them
+  const double direction = options.unstableAbove ? 1.0 : -1.0;
+  double stable = options.unstableAbove ? options.lower : options.upper;
+  double unstable = options.unstableAbove ? options.upper : options.lower;
+  bool stableVerdict = probe(stable);
+  bool unstableVerdict = probe(unstable);
+  while (stableVerdict || !unstableVerdict) {
+    if (stableVerdict && !unstableVerdict) {
+      throw runtime_error("stability is not monotone in the searched parameter");
+    }
+    if (static_cast<int>(result.probes.size()) >= options.maxProbes) break;
+
+    const double step = std::abs(unstable - stable) * options.expansion;
+    if (!unstableVerdict) {
+      stable = unstable;
+      unstable += direction * step;
+      unstableVerdict = probe(unstable);
+      continue;
+    }
+
+    // pertubation coefficients are amplitudes and cannot go below zero
+    double next = stable - direction * step;
+    if (options.parameter == ThresholdParameter::PertubationCoefficient) next = max(next, 0.0);
+    if (next == stable) break;
+    unstable = stable;
+    stable = next;
+    stableVerdict = probe(stable);
+  }
+
+  result.bracketed = !stableVerdict && unstableVerdict;
+  while (result.bracketed && std::abs(unstable - stable) > options.tolerance
+         && static_cast<int>(result.probes.size()) < options.maxProbes) {
+    const double middle = 0.5 * (stable + unstable);
+    (probe(middle) ? unstable : stable) = middle;
+  }
+  result.stableBound = stable;
+  result.unstableBound = unstable;
+  return result;
+}
+
+template <typename Policy>
+ThresholdProbe ThresholdSearch<Policy>::Probe(const ThresholdSearchOptions& options,
+                                              double value) {
+  if (options.parameter != ThresholdParameter::PertubationCoefficient) {
+    throw invalid_argument("unsupported threshold parameter");
+  }
+  Prepare(options);
+
+  ThresholdProbe probe;
+  probe.value = value;
+  BasicGrid<Policy> grid = m_base->Fork();
+  mt19937_64 engine(options.seed);
+  grid.PerturbGrid(value, engine);
+
+  // the verdict is clear as soon as one row diverges, the march stops there
+  const double limit = options.divergenceFactor * m_maxGroundTruthAmplitude;
+  if (RowMaxAmplitude(grid.GetPerturbedA(), grid.GetPerturbedB(), 0) > limit) {
+    probe.unstable = true;
+    return probe;
+  }
+  using FieldRef = Eigen::Ref<typename Policy::FieldMatrix>;
+  m_solver->SetStopCondition([&probe, limit](int timeIndex, const FieldRef& fieldA,
+                                             const FieldRef& fieldB) {
+    probe.unstable = RowMaxAmplitude(fieldA, fieldB, timeIndex) > limit;
+    return probe.unstable;
+  });
+  m_solver->Solve(grid);
+  m_solver->SetStopCondition(nullptr);
+  probe.verdictRow = m_solver->GetLastSolvedRow();
+  return probe;
+}
+
+template <typename Policy>
+void ThresholdSearch<Policy>::Prepare(const ThresholdSearchOptions& options) {
+  if (!m_base) {
+    m_base = make_unique<BasicGrid<Policy>>(m_constraint, m_details);
+    m_base->ComputeGroundTruth();
+    m_maxGroundTruthAmplitude
+        = static_cast<double>(max(m_base->GetGroundTruthA().cwiseAbs().maxCoeff(),
+                                  m_base->GetGroundTruthB().cwiseAbs().maxCoeff()));
+  }
+
+  if (!m_solver || options.numThreads != m_numThreads) {
+    m_numThreads = options.numThreads;
+    m_solver = make_unique<StabilitySolver<Policy>>(m_constraint, m_details);
+    m_solver->SetNumThreads(options.numThreads);
+  }
+  m_solver->SetBoundaryCondition(options.boundaryCondition);
+}
+
+template class CGLE::ThresholdSearch<MixedPrecision>;
+template class CGLE::ThresholdSearch<DoublePrecision>;
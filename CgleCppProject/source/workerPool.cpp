@@ -0,0 +1,83 @@
+#include <numaPlacement.h>
+#include <workerPool.h>
+
+#include "helper.h"
+using namespace CGLE;
+
+namespace {
+  /** pool whose task the calling thread is running, used to detect nested runs **/
+  thread_local const WorkerPool* t_currentPool = nullptr;
+}  // namespace
+
+WorkerPool::WorkerPool(int numThreads, bool pinThreads) : m_pinThreads(pinThreads) {
+  const int threads = Helper::GetNumThreads(numThreads);
+  m_errors.resize(threads);
+  m_threads.reserve(threads);
+  for (int worker = 0; worker < threads; worker++) {
+    m_threads.emplace_back(&WorkerPool::WorkerLoop, this, worker);
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_wake.notify_all();
+  for (thread& worker : m_threads) worker.join();
+}
+
+void WorkerPool::Dispatch(Invoker invoke, const void* context) {
+  if (t_currentPool == this) {
+    for (int worker = 0; worker < GetNumThreads(); worker++) invoke(context, worker);
+    return;
+  }
+
+  lock_guard<mutex> run(m_runMutex);
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_invoke = invoke;
+    m_context = context;
+    m_pending = GetNumThreads();
+    fill(m_errors.begin(), m_errors.end(), nullptr);
+    m_generation++;
+  }
+  m_wake.notify_all();
+
+  unique_lock<mutex> lock(m_mutex);
+  m_done.wait(lock, [this]() { return m_pending == 0; });
+  for (const exception_ptr& error : m_errors) {
+    if (error) rethrow_exception(error);
+  }
+}
+
+void WorkerPool::WorkerLoop(int worker) {
+  t_currentPool = this;
+  if (m_pinThreads) PinCurrentThread(worker);
+  uint64_t seen = 0;
+  while (true) {
+    Invoker invoke;
+    const void* context;
+    {
+      unique_lock<mutex> lock(m_mutex);
+      m_wake.wait(lock, [&]() { return m_stop || m_generation != seen; });
+      if (m_stop) return;
+      seen = m_generation;
+      invoke = m_invoke;
+      context = m_context;
+    }
+
+    exception_ptr error;
+    try {
+      invoke(context, worker);
+    } catch (...) {
+      error = current_exception();
+    }
+
+    {
+      lock_guard<mutex> lock(m_mutex);
+      m_errors[worker] = error;
+      if (--m_pending == 0) m_done.notify_one();
+    }
+  }
+}
@@ -0,0 +1,77 @@
+#include <constraintDerivation.h>
+#include <distributedStabilitySolver.h>
+#include <domainDecomposition.h>
+#include <grid.h>
+#include <stabilitySolver.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+/**
+ * Runs the distributed march over MPI_COMM_WORLD and compares it with StabilitySolver, for both
+ * boundary conditions: once on a grid every rank holds in full, and once with every rank building
+ * and solving only its own rows before they are gathered on the last rank. Registered with CTest
+ * under mpiexec for several process counts, the process exits non zero when any rank sees a
+ * mismatch.
+ */
+int main(int argc, char** argv) {
+  using namespace CGLE;
+  using Matrix = DoublePrecision::FieldMatrix;
+
+  MpiSession session(&argc, &argv);
+  MpiCommunicator communicator;
+  Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  const GridDetails details(Axis::Linspace(-8, 8, 41), Axis::Linspace(0, 3, 40));
+  const int numPositions = 41;
+  const uint64_t seed = 5;
+  const int root = communicator.GetSize() - 1;
+
+  int failures = 0;
+  auto compare = [&](const char* path, BoundaryCondition boundary, const Matrix& fieldA,
+                     const Matrix& fieldB, const ReferenceGrid& reference) {
+    const double scale = reference.GetPerturbedA().cwiseAbs().maxCoeff()
+                         + reference.GetPerturbedB().cwiseAbs().maxCoeff();
+    const double differenceA = (fieldA - reference.GetPerturbedA()).cwiseAbs().maxCoeff();
+    const double differenceB = (fieldB - reference.GetPerturbedB()).cwiseAbs().maxCoeff();
+    if (!(differenceA <= 1e-12 * scale && differenceB <= 1e-12 * scale)) {
+      std::fprintf(stderr,
+                   "rank %d of %d, %s path, %s boundary: differs from StabilitySolver by %g / %g\n",
+                   communicator.GetRank(), communicator.GetSize(), path,
+                   boundary == BoundaryCondition::Dirichlet ? "Dirichlet" : "Periodic",
+                   differenceA, differenceB);
+      failures++;
+    }
+  };
+
+  for (BoundaryCondition boundary : {BoundaryCondition::Dirichlet, BoundaryCondition::Periodic}) {
+    ReferenceGrid reference(constraint, details);
+    reference.PerturbGrid(0.2, seed);
+    ReferenceGrid grid = reference.Fork();
+    StabilitySolver<DoublePrecision> solver(constraint, details);
+    solver.SetBoundaryCondition(boundary);
+    solver.Solve(reference);
+
+    DistributedStabilitySolver<DoublePrecision> distributed(constraint, details, communicator);
+    distributed.SetBoundaryCondition(boundary);
+    distributed.Solve(grid);
+    compare("full grid", boundary, grid.GetPerturbedA(), grid.GetPerturbedB(), reference);
+
+    // rank-local rows: no rank but the root ever holds more than its own positions
+    const DomainDecomposition local = distributed.GetDecomposition(numPositions);
+    Matrix localA, localB;
+    ComputePerturbedRows<DoublePrecision>(constraint, details, local.firstPosition,
+                                          local.numLocalPositions, 0.2, seed, localA, localB);
+    distributed.Solve(localA, localB, numPositions);
+    Matrix gatheredA, gatheredB;
+    distributed.GatherRows(localA, numPositions, gatheredA, root);
+    distributed.GatherRows(localB, numPositions, gatheredB, root);
+    if (communicator.GetRank() == root) {
+      compare("local rows", boundary, gatheredA, gatheredB, reference);
+    } else if (gatheredA.size() != 0 || gatheredB.size() != 0) {
+      std::fprintf(stderr, "rank %d received a gathered field\n", communicator.GetRank());
+      failures++;
+    }
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+#include <doctest/doctest.h>
+#include <asyncWriter.h>
+#include <constraintDerivation.h>
+#include <stabilitySolver.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Async field writer streams every solved time row in order") {
+  using namespace CGLE;
+
+  Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  GridDetails details(8, 3, 24);
+  Grid grid(constraint, details);
+  grid.PerturbGrid(0.1);
+
+  Grid::FieldMatrix streamedA = Grid::FieldMatrix::Zero(details.GetNumXPts(),
+                                                         details.GetNumYPts());
+  Grid::FieldMatrix streamedB = streamedA;
+  std::vector<long long> firstTimes;
+  auto sink = [&](long long firstTime, const AsyncFieldWriter<std::complex<float>>::ConstBlock& a,
+                  const AsyncFieldWriter<std::complex<float>>::ConstBlock& b) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    streamedA.middleCols(firstTime, a.cols()) = a;
+    streamedB.middleCols(firstTime, b.cols()) = b;
+    firstTimes.push_back(firstTime);
+  };
+
+  AsyncFieldWriter<std::complex<float>> writer(details.GetNumXPts(), 5, sink, 2);
+  StabilitySolver<MixedPrecision> solver(constraint, details);
+  solver.SetRowObserver(writer.Observer());
+  solver.Solve(grid);
+  writer.Flush();
+
+  CHECK(streamedA == grid.GetPerturbedA());
+  CHECK(streamedB == grid.GetPerturbedB());
+  CHECK((firstTimes == std::vector<long long>{0, 5, 10, 15, 20}));
+  CHECK(writer.GetStatistics().written == 5);
+}
+
+TEST_CASE("Async writer applies backpressure once every buffer is in flight") {
+  using namespace CGLE;
+
+  std::vector<long long> tags;
+  auto sink = [&tags](const Eigen::MatrixXd& buffer, long long tag, Eigen::Index numCols) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CHECK(buffer(0, numCols - 1) == tag);
+    tags.push_back(tag);
+  };
+
+  AsyncWriter<double> writer(1, 4, sink, 2);
+  for (long long tag = 0; tag < 6; tag++) {
+    writer.Current()(0, 1) = static_cast<double>(tag);
+    writer.Submit(tag, 2);
+  }
+  writer.Flush();
+
+  const AsyncWriterStatistics statistics = writer.GetStatistics();
+  CHECK(statistics.submitted == 6);
+  CHECK(statistics.written == 6);
+  CHECK(statistics.stalls > 0);
+  CHECK((tags == std::vector<long long>{0, 1, 2, 3, 4, 5}));
+}
+
+TEST_CASE("Async writer rethrows sink failures") {
+  using namespace CGLE;
+
+  auto sink = [](const Eigen::MatrixXd&, long long, Eigen::Index) {
+    throw std::runtime_error("disk full");
+  };
+  AsyncWriter<double> writer(1, 1, sink);
+  writer.Submit(0, 1);
+  CHECK_THROWS_AS(writer.Flush(), std::runtime_error);
+  CHECK(writer.GetStatistics().written == 0);
+}
@@ -0,0 +1,58 @@
+#include <doctest/doctest.h>
+#include <axis.h>
+#include <gridDetails.h>
+
+#include <numeric>
+
+TEST_CASE("Uniform axes compute exact endpoints without accumulating error") {
+  using namespace CGLE;
+
+  Axis axis = Axis::Linspace(-50, 50, 1001);
+  REQUIRE(axis.IsUniform());
+  CHECK(axis.size() == 1001);
+  CHECK(axis[0] == -50);
+  CHECK(axis[500] == 0);
+  CHECK(axis[1000] == 50);
+  CHECK(axis.GetStep() == doctest::Approx(0.1));
+  CHECK_THROWS_AS(axis.At(1001), std::out_of_range);
+
+  const std::vector<int> zero = axis.Find(0);
+  REQUIRE(zero.size() == 1);
+  CHECK(zero[0] == 500);
+  CHECK(axis.Find(0.05).empty());
+  CHECK(axis.Find(axis[123]) == std::vector<int>{123});
+}
+
+TEST_CASE("Axis tiles cover every point once") {
+  using namespace CGLE;
+
+  Axis axis = Axis::Linspace(0, 3, 10);
+  std::vector<AxisRange> tiles = axis.Tiles(4);
+  REQUIRE(tiles.size() == 3);
+  CHECK(tiles[2].size() == 2);
+
+  std::vector<double> points;
+  for (const AxisRange& tile : tiles) points.insert(points.end(), tile.cbegin(), tile.cend());
+  CHECK(points == axis.ToVector());
+  CHECK(axis.Range(3, 7)[0] == axis[3]);
+}
+
+TEST_CASE("Non-uniform meshes keep their explicit points") {
+  using namespace CGLE;
+
+  Axis axis = Axis::Explicit({-2, -1, 0, 0, 3});
+  CHECK_FALSE(axis.IsUniform());
+  CHECK((axis.Find(0) == std::vector<int>{2, 3}));
+  CHECK(axis.GetStep() == 1);
+  CHECK(std::accumulate(axis.begin(), axis.end(), 0.0) == 0);
+}
+
+TEST_CASE("Grid details expose uniform axes") {
+  using namespace CGLE;
+
+  GridDetails details(8, 3, 24);
+  CHECK(details.GetXAxis().IsUniform());
+  CHECK(details.GetXAxis().size() == details.GetNumXPts());
+  CHECK(details.GetTimeAxis()[details.GetNumYPts() - 1] == 3);
+  CHECK(details.GetDx() == doctest::Approx(8.0 / 23));
+}
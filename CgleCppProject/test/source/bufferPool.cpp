@@ -0,0 +1,55 @@
+#include <bufferPool.h>
+#include <doctest/doctest.h>
+#include <grid.h>
+
+#include <complex>
+
+TEST_CASE("Buffer pool reuses released buffers of the same size") {
+  using namespace CGLE;
+  using Pool = BufferPool<double>;
+
+  Pool pool;
+  {
+    Pool::Lease lease = pool.Acquire(4, 6);
+    CHECK(lease->rows() == 4);
+    CHECK(lease->cols() == 6);
+    pool.Release(unique_ptr<Pool::Matrix>(lease.release()));
+  }
+  CHECK(pool.GetStatistics().allocations == 1);
+  CHECK(pool.GetStatistics().bytesPooled == 24 * sizeof(double));
+
+  // same element count in a different shape is served from the cache
+  Pool::Lease reshaped = pool.Acquire(6, 4);
+  CHECK(reshaped->rows() == 6);
+  CHECK(pool.GetStatistics().reuses == 1);
+  CHECK(pool.GetStatistics().allocations == 1);
+  CHECK(pool.GetStatistics().bytesPooled == 0);
+  pool.Release(unique_ptr<Pool::Matrix>(reshaped.release()));
+
+  pool.SetCapacity(1);
+  pool.Clear();
+  pool.Release(make_unique<Pool::Matrix>(2, 2));
+  CHECK(pool.GetStatistics().evictions == 1);
+}
+
+TEST_CASE("Consecutive grids of the same size do not allocate") {
+  using namespace CGLE;
+
+  Constraint constraint;
+  constraint.m_CaseType = 1;
+  constraint.m_WaveType = "Bright-Bright";
+  GridDetails details(8, 3, 24);
+
+  auto& pool = Grid::FieldPool::Local();
+  {
+    Grid warmUp(constraint, details);
+    warmUp.GetPerturbedA();
+  }
+  const size_t allocations = pool.GetStatistics().allocations;
+
+  for (int job = 0; job < 5; job++) {
+    Grid grid(constraint, details);
+    CHECK(grid.GetPerturbedA().rows() == details.GetNumXPts());
+  }
+  CHECK(pool.GetStatistics().allocations == allocations);
+}
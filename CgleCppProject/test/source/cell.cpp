@@ -20,7 +20,7 @@ TEST_CASE("Cell Equality Check") {
 
   int scenario1Xval, scenario1Yval, scenario2Xval, scenario2Yval;
   scenario1Xval = 0;
-  scenario1Xval = 0;
+  scenario1Yval = 0;
   scenario2Xval = 0;
   scenario2Yval = 0;
 
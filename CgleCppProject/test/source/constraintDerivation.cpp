@@ -0,0 +1,56 @@
+#include <doctest/doctest.h>
+#include <constraintDerivation.h>
+
+#include <complex>
+#include <stdexcept>
+
+TEST_CASE("Computed constraints match ComputeConstraints.m") {
+  using namespace CGLE;
+
+  Constraint brightBright = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  CHECK(brightBright.m_StartPosition == -8);
+  CHECK(brightBright.m_Eta == 17.364923362962905);
+  CHECK(brightBright.m_Gamma1.real() == doctest::Approx(6.511613080797135 / (0.002 * 0.002)));
+  CHECK(brightBright.m_Gamma1Prime.imag()
+        == doctest::Approx(-2.9166666666666667 / (0.002 * 0.002)));
+
+  Constraint unscaled = ComputeConstraints(BRIGHT_BRIGHT, 2);
+  CHECK(unscaled.m_Gamma1 == std::complex<double>(-1.75, 0));
+
+  Constraint darkDark = ComputeConstraints(DARK_DARK, 1);
+  CHECK(darkDark.m_k1.real() == doctest::Approx(0.3414734491));
+  CHECK(darkDark.m_Gamma1.real() == doctest::Approx(1.5e300));
+
+  CHECK_THROWS(ComputeConstraints("Unknown", 1));
+  CHECK_THROWS(ComputeConstraints(FRONT_FRONT, 3));
+}
+
+TEST_CASE("Constraint batches derive every set of a sweep") {
+  using namespace CGLE;
+
+  ConstraintInputs base = GetConstraintInputs(BRIGHT_BRIGHT, 1);
+  long long generated = 0;
+  long long invalid = 0;
+  ConstraintBatch::Generate(
+      base, 10, 4,
+      [](ConstraintBatch& batch, long long offset) {
+        for (Eigen::Index i = 0; i < batch.GetSize(); i++) batch.m_L[i] = 0.001 * (offset + i);
+      },
+      [&](const ConstraintBatch& batch, long long offset) {
+        CHECK(batch.GetSize() == (offset == 8 ? 2 : 4));
+        for (Eigen::Index i = 0; i < batch.GetSize(); i++) {
+          if (!batch.m_Valid[i]) {
+            invalid++;
+            continue;
+          }
+          Constraint constraint = batch.At(i);
+          const double L = 0.001 * (offset + i);
+          CHECK(constraint.m_Gamma1.real() == doctest::Approx(6.511613080797135 / (L * L)));
+        }
+        generated += batch.GetSize();
+      });
+
+  CHECK(generated == 10);
+  // L = 0 is the only set whose derived terms are not finite
+  CHECK(invalid == 1);
+}
@@ -0,0 +1,97 @@
+#include <doctest/doctest.h>
+#include <constraintDerivation.h>
+#include <continuation.h>
+
+#include <algorithm>
+#include <cmath>
+
+TEST_CASE("Grid resampler interpolates bilinear fields exactly") {
+  using namespace CGLE;
+
+  const GridDetails coarse(Axis::Linspace(-4, 4, 9), Axis::Linspace(0, 2, 5));
+  const GridDetails fine(Axis::Explicit({-5, -3.5, -1, 0.25, 2, 3.75, 4.5}),
+                         Axis::Linspace(0, 2, 13));
+  auto bilinear = [](double x, double t) { return std::complex<double>(1 + x * t, x - 2 * t); };
+
+  Eigen::MatrixXcd source(9, 5);
+  for (int row = 0; row < 9; row++) {
+    for (int col = 0; col < 5; col++) {
+      source(row, col) = bilinear(coarse.GetXAxis()[row], coarse.GetTimeAxis()[col]);
+    }
+  }
+
+  Eigen::MatrixXcd target;
+  GridResampler(coarse, fine).Resample(source, target, 2);
+  REQUIRE(target.rows() == 7);
+  REQUIRE(target.cols() == 13);
+  for (int row = 0; row < 7; row++) {
+    // positions outside the coarse axis take the value of its nearest end
+    const double x = std::clamp(fine.GetXAxis()[row], -4.0, 4.0);
+    for (int col = 0; col < 13; col++) {
+      const auto expected = bilinear(x, fine.GetTimeAxis()[col]);
+      CHECK(std::abs(target(row, col) - expected) < 1e-12);
+    }
+  }
+
+  Eigen::MatrixXcf identity;
+  GridResampler(coarse, coarse).Resample(source.cast<std::complex<float>>().eval(), identity);
+  CHECK(identity == source.cast<std::complex<float>>());
+  CHECK_THROWS_AS(GridResampler(fine, coarse).Resample(source, target), std::invalid_argument);
+}
+
+TEST_CASE("Continuation refines a case towards the target grid") {
+  using namespace CGLE;
+
+  const GridDetails target(Axis::Linspace(-8, 8, 65), Axis::Linspace(0, 3, 65));
+  const GridDetails coarse = CoarsenGridDetails(target, 2);
+  CHECK(coarse.GetXAxis().size() == 33);
+  CHECK(coarse.GetTimeAxis()[32] == 3);
+  CHECK_THROWS_AS(CoarsenGridDetails(target, 1), std::invalid_argument);
+  CHECK_THROWS_AS(CoarsenGridDetails(target, 64), std::invalid_argument);
+
+  Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  Continuation<DoublePrecision> continuation(constraint, target);
+  CHECK_THROWS_AS(continuation.GetGrid(), std::runtime_error);
+
+  ContinuationOptions options;
+  options.seed = 7;
+  options.numThreads = 2;
+  const ContinuationResult result = continuation.Run(options);
+  REQUIRE(result.levels.size() == 3);
+  CHECK(result.levels[0].numPositions == 17);
+  CHECK(result.levels[1].numTimes == 33);
+  CHECK(result.levels[2].numPositions == 65);
+  CHECK(result.levels[0].relativeL2A == 0);
+  for (const ContinuationLevel& level : result.levels) {
+    CHECK(std::isfinite(level.relativeL2A));
+    CHECK(std::isfinite(level.linfB));
+    CHECK(level.seconds >= 0);
+  }
+  CHECK(result.levels[2].relativeL2A > 0);
+  CHECK(continuation.GetGrid().GetPerturbedA().rows() == 65);
+
+  // the rows ahead of the march are never seeded, warm starts are Newton initial iterates only
+  options.warmStart = true;
+  CHECK_THROWS_AS(continuation.Run(options), std::invalid_argument);
+  options.scheme = StepScheme::NewtonKrylov;
+  const ContinuationResult warmResult = continuation.Run(options);
+  const Eigen::MatrixXcd warmA = continuation.GetGrid().GetPerturbedA();
+  const Eigen::MatrixXcd warmB = continuation.GetGrid().GetPerturbedB();
+  options.warmStart = false;
+  options.numLevels = 1;
+  const ContinuationResult coldResult = continuation.Run(options);
+  // the interpolated iterate saves about half the Newton iterations of the target level
+  const int warmIterations = warmResult.levels.back().newtonIterations;
+  const int coldIterations = coldResult.levels.back().newtonIterations;
+  CHECK(warmIterations > 0);
+  CHECK(4 * warmIterations < 3 * coldIterations);
+  const auto& coldA = continuation.GetGrid().GetPerturbedA();
+  const auto& coldB = continuation.GetGrid().GetPerturbedB();
+  REQUIRE(coldA.rows() == warmA.rows());
+  CHECK(coldA.allFinite());
+  CHECK((coldA - warmA).norm() <= 1e-8 * coldA.norm());
+  CHECK((coldB - warmB).norm() <= 1e-8 * coldB.norm());
+
+  options.numLevels = 0;
+  CHECK_THROWS_AS(continuation.Run(options), std::invalid_argument);
+}
@@ -0,0 +1,158 @@
+#include <doctest/doctest.h>
+#include <constraintDerivation.h>
+#include <distributedStabilitySolver.h>
+#include <grid.h>
+
+#include <exception>
+#include <functional>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+  /** runs one rank per thread over a local communicator group, rethrowing the first failure **/
+  void RunRanks(int size, const std::function<void(CGLE::DomainCommunicator&)>& body) {
+    CGLE::LocalCommunicatorGroup group(size);
+    std::vector<std::exception_ptr> errors(size);
+    std::vector<std::thread> ranks;
+    for (int rank = 0; rank < size; rank++) {
+      ranks.emplace_back([&, rank]() {
+        try {
+          body(group.GetCommunicator(rank));
+        } catch (...) {
+          errors[rank] = std::current_exception();
+        }
+      });
+    }
+    for (std::thread& rank : ranks) rank.join();
+    for (const std::exception_ptr& error : errors) {
+      if (error) std::rethrow_exception(error);
+    }
+  }
+}  // namespace
+
+TEST_CASE("Local communicators exchange and gather in order") {
+  using namespace CGLE;
+
+  std::vector<std::vector<int>> gathered(3);
+  std::vector<int> received(3, -1);
+  RunRanks(3, [&](DomainCommunicator& communicator) {
+    const int rank = communicator.GetRank();
+    const int right = (rank + 1) % 3;
+    const int left = (rank + 2) % 3;
+    communicator.SendReceive(&rank, sizeof(rank), right, &received[rank], left);
+    gathered[rank] = AllGather(communicator, 10 * rank);
+    gathered[rank] = AllGather(communicator, gathered[rank][2] + rank);
+  });
+  CHECK((received == std::vector<int>{2, 0, 1}));
+  for (const std::vector<int>& values : gathered) CHECK((values == std::vector<int>{20, 21, 22}));
+}
+
+TEST_CASE("Domain decomposition splits the unknowns like the SPIKE blocks") {
+  using namespace CGLE;
+
+  DomainDecomposition first = DomainDecomposition::Split(12, BoundaryCondition::Dirichlet, 0, 3);
+  DomainDecomposition last = DomainDecomposition::Split(12, BoundaryCondition::Dirichlet, 2, 3);
+  CHECK(first.firstPosition == 0);
+  CHECK(first.numLocalPositions == 5);
+  CHECK(first.firstLocalUnknown == 1);
+  CHECK(first.GetLeftNeighbour() == NO_RANK);
+  CHECK(last.firstPosition == 8);
+  CHECK(last.numLocalPositions == 4);
+  CHECK(last.GetRightNeighbour() == NO_RANK);
+
+  DomainDecomposition periodic = DomainDecomposition::Split(12, BoundaryCondition::Periodic, 0, 3);
+  CHECK(periodic.numLocalPositions == 4);
+  CHECK(periodic.GetLeftNeighbour() == 2);
+  CHECK_THROWS_AS(DomainDecomposition::Split(7, BoundaryCondition::Dirichlet, 0, 3),
+                  std::invalid_argument);
+}
+
+TEST_CASE("Distributed solves match the single process solver") {
+  using namespace CGLE;
+
+  Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  GridDetails details(8, 3, 24);
+
+  for (BoundaryCondition boundary : {BoundaryCondition::Dirichlet, BoundaryCondition::Periodic}) {
+    for (int size : {1, 2, 3}) {
+      using DoubleGrid = BasicGrid<DoublePrecision>;
+      auto perturbed = [&]() {
+        auto grid = std::make_unique<DoubleGrid>(constraint, details);
+        std::mt19937_64 engine(11);
+        grid->PerturbGrid(0.1, engine);
+        return grid;
+      };
+
+      // the same number of SPIKE partitions gives identical results, any other agrees closely
+      auto reference = perturbed();
+      StabilitySolver<DoublePrecision> solver(constraint, details);
+      solver.SetBoundaryCondition(boundary);
+      solver.SetNumThreads(size, 1);
+      solver.Solve(*reference);
+      auto serial = perturbed();
+      StabilitySolver<DoublePrecision> serialSolver(constraint, details);
+      serialSolver.SetBoundaryCondition(boundary);
+      serialSolver.Solve(*serial);
+
+      std::vector<std::unique_ptr<DoubleGrid>> grids;
+      for (int rank = 0; rank < size; rank++) grids.push_back(perturbed());
+      RunRanks(size, [&](DomainCommunicator& communicator) {
+        DistributedStabilitySolver<DoublePrecision> distributed(constraint, details, communicator);
+        distributed.SetBoundaryCondition(boundary);
+        distributed.Solve(*grids[communicator.GetRank()]);
+      });
+
+      for (const auto& grid : grids) {
+        CHECK(grid->GetPerturbedA() == reference->GetPerturbedA());
+        CHECK(grid->GetPerturbedB() == reference->GetPerturbedB());
+        CHECK(grid->GetPerturbedA().isApprox(serial->GetPerturbedA(), 1e-10));
+      }
+    }
+  }
+}
+
+TEST_CASE("Ranks build, solve and gather only their own rows") {
+  using namespace CGLE;
+  using Matrix = DoublePrecision::FieldMatrix;
+
+  Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  const GridDetails details(Axis::Linspace(-4, 4, 33), Axis::Linspace(0, 2, 21));
+  const int numPositions = 33;
+
+  for (BoundaryCondition boundary : {BoundaryCondition::Dirichlet, BoundaryCondition::Periodic}) {
+    const int size = 3;
+    BasicGrid<DoublePrecision> reference(constraint, details);
+    reference.PerturbGrid(0.1, uint64_t(9));
+    const Matrix perturbedA = reference.GetPerturbedA();
+    StabilitySolver<DoublePrecision> solver(constraint, details);
+    solver.SetBoundaryCondition(boundary);
+    solver.SetNumThreads(size, 1);
+    solver.Solve(reference);
+
+    std::vector<Matrix> initialA(size);
+    Matrix gatheredA, gatheredB;
+    RunRanks(size, [&](DomainCommunicator& communicator) {
+      DistributedStabilitySolver<DoublePrecision> distributed(constraint, details, communicator);
+      distributed.SetBoundaryCondition(boundary);
+      const DomainDecomposition local = distributed.GetDecomposition(numPositions);
+      Matrix localA, localB;
+      ComputePerturbedRows<DoublePrecision>(constraint, details, local.firstPosition,
+                                            local.numLocalPositions, 0.1, 9, localA, localB);
+      initialA[local.rank] = localA;
+      distributed.Solve(localA, localB, numPositions);
+      // the root is not rank 0, so both sides of the point to point gather are exercised
+      distributed.GatherRows(localA, numPositions, gatheredA, 1);
+      distributed.GatherRows(localB, numPositions, gatheredB, 1);
+    });
+
+    for (int rank = 0; rank < size; rank++) {
+      const DomainDecomposition local = DomainDecomposition::Split(numPositions, boundary, rank,
+                                                                   size);
+      CHECK(initialA[rank] == perturbedA.middleRows(local.firstPosition, local.numLocalPositions));
+    }
+    CHECK(gatheredA == reference.GetPerturbedA());
+    CHECK(gatheredB == reference.GetPerturbedB());
+  }
+}
@@ -0,0 +1,50 @@
+#include <doctest/doctest.h>
+#include <constraintDerivation.h>
+#include <ensembleRunner.h>
+
+TEST_CASE("Merged running statistics match a single pass") {
+  using namespace CGLE;
+
+  const double values[] = {1.5, -2.0, 4.25, 0.5, 3.0, -7.5, 2.0};
+  RunningFieldStatistics single(1, 1), first(1, 1), second(1, 1);
+  for (int i = 0; i < 7; i++) {
+    Eigen::Matrix<double, 1, 1> cell;
+    cell << values[i];
+    single.Add(cell);
+    (i < 3 ? first : second).Add(cell);
+  }
+  first.Merge(second);
+
+  CHECK(first.GetCount() == 7);
+  CHECK(first.GetMean()(0, 0) == doctest::Approx(single.GetMean()(0, 0)));
+  CHECK(first.GetVariance()(0, 0) == doctest::Approx(single.GetVariance()(0, 0)));
+  CHECK(first.GetMax()(0, 0) == 7.5);
+  CHECK(single.GetMean()(0, 0) == doctest::Approx(20.75 / 7));
+}
+
+TEST_CASE("Ensemble results only depend on the seed") {
+  using namespace CGLE;
+
+  EnsembleRunner<MixedPrecision> runner(ComputeConstraints(BRIGHT_BRIGHT, 1),
+                                        GridDetails(8, 3, 24));
+  EnsembleOptions options;
+  options.numMembers = 12;
+  options.seed = 42;
+  options.numLanes = 4;
+
+  options.numThreads = 1;
+  EnsembleResult serial = runner.Run(options);
+  options.numThreads = 3;
+  EnsembleResult parallel = runner.Run(options);
+
+  CHECK(serial.numMembers == 12);
+  CHECK(serial.numUnstable == parallel.numUnstable);
+  CHECK(serial.amplitudeA.GetCount() + serial.numUnstable >= 12);
+  CHECK((serial.amplitudeA.GetMean() == parallel.amplitudeA.GetMean()).all());
+  CHECK((serial.amplitudeB.GetVariance() == parallel.amplitudeB.GetVariance()).all());
+  CHECK((serial.stepMaxAmplitude.GetMax() == parallel.stepMaxAmplitude.GetMax()).all());
+
+  options.seed = 43;
+  EnsembleResult reseeded = runner.Run(options);
+  CHECK((serial.amplitudeA.GetMean() != reseeded.amplitudeA.GetMean()).any());
+}
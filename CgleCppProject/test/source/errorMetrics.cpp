@@ -0,0 +1,37 @@
+#include <doctest/doctest.h>
+#include <constraintDerivation.h>
+#include <errorMetrics.h>
+#include <stabilitySolver.h>
+
+#include <cmath>
+
+TEST_CASE("Error metrics match a direct computation over the interior") {
+  using namespace CGLE;
+
+  Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  GridDetails details(8, 3, 24);
+  ReferenceGrid grid(constraint, details);
+  std::mt19937_64 engine(7);
+  grid.PerturbGrid(0.2, engine);
+  StabilitySolver<DoublePrecision>(constraint, details).Solve(grid);
+
+  const auto& groundTruth = grid.GetGroundTruthA();
+  const auto& perturbed = grid.GetPerturbedA();
+  const Eigen::Index rows = groundTruth.rows() - 2, cols = groundTruth.cols() - 2;
+  Eigen::ArrayXXd error
+      = (perturbed.block(1, 1, rows, cols) - groundTruth.block(1, 1, rows, cols)).cwiseAbs();
+
+  ErrorMetrics metrics = ComputeErrorMetrics(grid, 1);
+  CHECK(metrics.numCells == rows * cols);
+  CHECK(metrics.a.l1 == doctest::Approx(error.sum()));
+  CHECK(metrics.a.l2 == doctest::Approx(std::sqrt(error.square().sum())));
+  CHECK(metrics.a.linf == error.maxCoeff());
+  CHECK(metrics.a.maxReferenceAmplitude
+        == groundTruth.block(1, 1, rows, cols).cwiseAbs().maxCoeff());
+
+  // chunking is independent of the thread count, so the sums are bit for bit identical
+  ErrorMetrics parallel = ComputeErrorMetrics(grid, 4);
+  CHECK(parallel.a.l2 == metrics.a.l2);
+  CHECK(parallel.b.l1 == metrics.b.l1);
+  CHECK(parallel.b.relativeL2 == metrics.b.relativeL2);
+}
@@ -0,0 +1,156 @@
+#include <doctest/doctest.h>
+#include <constraintDerivation.h>
+#include <fieldCodec.h>
+#include <snapshot.h>
+
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+  /** a smooth complex field with the separable shape of the amplitudes the solver produces **/
+  std::vector<std::complex<double>> SmoothField(int rows, int cols) {
+    std::vector<std::complex<double>> values;
+    for (int col = 0; col < cols; col++) {
+      for (int row = 0; row < rows; row++) {
+        const double x = -8 + 16.0 * row / (rows - 1);
+        values.push_back(std::polar(1 / std::cosh(x), 0.3 * x + 0.01 * col));
+      }
+    }
+    return values;
+  }
+}  // namespace
+
+TEST_CASE("Lossless field compression reproduces every bit") {
+  using namespace CGLE;
+
+  FieldCodecOptions options;
+  options.compression = FieldCompression::Lossless;
+  options.tileElements = 1000;
+  const FieldCodec codec(options);
+
+  std::vector<std::complex<double>> values = SmoothField(129, 40);
+  values[17] = {std::numeric_limits<double>::quiet_NaN(), -0.0};
+  values[2500] = {std::numeric_limits<double>::infinity(), -1e-310};
+  const std::vector<uint8_t> stream = codec.Encode(values.data(), values.size());
+  std::vector<std::complex<double>> decoded(values.size());
+  codec.Decode(stream.data(), stream.size(), decoded.data(), decoded.size());
+  CHECK(std::memcmp(decoded.data(), values.data(), values.size() * sizeof(values[0])) == 0);
+
+  // random bits do not compress, the raw fallback keeps the overhead small
+  std::mt19937 engine(3);
+  std::vector<float> noise(5000);
+  for (float& value : noise) {
+    const uint32_t bits = engine();
+    std::memcpy(&value, &bits, sizeof(bits));
+  }
+  const std::vector<uint8_t> noisy = codec.Encode(noise.data(), noise.size());
+  CHECK(noisy.size() < noise.size() * sizeof(float) + 200);
+  std::vector<float> decodedNoise(noise.size());
+  codec.Decode(noisy.data(), noisy.size(), decodedNoise.data(), decodedNoise.size());
+  CHECK(std::memcmp(decodedNoise.data(), noise.data(), noise.size() * sizeof(float)) == 0);
+
+  // real amplitudes stored as complex numbers have constant imaginary planes
+  std::vector<std::complex<float>> real(4096);
+  for (size_t i = 0; i < real.size(); i++) real[i] = static_cast<float>(i % 7);
+  CHECK(codec.Encode(real.data(), real.size()).size() < real.size() * sizeof(float) / 2);
+
+  const std::vector<uint8_t> empty = codec.Encode(values.data(), 0);
+  CHECK_NOTHROW(codec.Decode(empty.data(), empty.size(), decoded.data(), 0));
+}
+
+TEST_CASE("Error bounded field compression honours its bound") {
+  using namespace CGLE;
+
+  const std::vector<std::complex<double>> values = SmoothField(257, 64);
+  const size_t rawBytes = values.size() * sizeof(values[0]);
+  FieldCodecOptions options;
+  options.compression = FieldCompression::Lossless;
+  const size_t losslessBytes = FieldCodec(options).Encode(values.data(), values.size()).size();
+
+  options.compression = FieldCompression::ErrorBounded;
+  options.tileElements = 4096;
+  for (double bound : {1e-3, 1e-6, 1e-9}) {
+    options.errorBound = bound;
+    const FieldCodec codec(options);
+    const std::vector<uint8_t> stream = codec.Encode(values.data(), values.size());
+    CHECK(stream.size() < losslessBytes);
+    CHECK(stream.size() < rawBytes / 2);
+
+    std::vector<std::complex<double>> decoded(values.size());
+    codec.Decode(stream.data(), stream.size(), decoded.data(), decoded.size());
+    double error = 0;
+    for (size_t i = 0; i < values.size(); i++) {
+      error = std::max(error, std::abs(decoded[i].real() - values[i].real()));
+      error = std::max(error, std::abs(decoded[i].imag() - values[i].imag()));
+    }
+    CHECK(error <= bound * (1 + 1e-9));
+  }
+
+  options.errorBound = 0;
+  CHECK_THROWS_AS(FieldCodec{options}, std::invalid_argument);
+  options.compression = FieldCompression::None;
+  CHECK_THROWS_AS(FieldCodec{options}, std::invalid_argument);
+}
+
+TEST_CASE("Corrupt compressed fields are rejected") {
+  using namespace CGLE;
+
+  FieldCodecOptions options;
+  options.compression = FieldCompression::Lossless;
+  options.tileElements = 512;
+  const FieldCodec codec(options);
+  const std::vector<std::complex<double>> values = SmoothField(65, 33);
+  const std::vector<uint8_t> stream = codec.Encode(values.data(), values.size());
+
+  std::vector<std::complex<double>> decoded(values.size());
+  CHECK_THROWS_AS(codec.Decode(stream.data(), stream.size() / 2, decoded.data(), decoded.size()),
+                  std::runtime_error);
+  CHECK_THROWS_AS(codec.Decode(stream.data(), stream.size(), decoded.data(), decoded.size() - 1),
+                  std::runtime_error);
+  std::vector<std::complex<float>> narrow(values.size());
+  CHECK_THROWS_AS(codec.Decode(stream.data(), stream.size(), narrow.data(), narrow.size()),
+                  std::runtime_error);
+}
+
+TEST_CASE("Compressed snapshots read back like uncompressed ones") {
+  using namespace CGLE;
+
+  Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  Grid grid(constraint, GridDetails(100, 3, 150));
+  grid.PerturbGrid(0.2);
+
+  const std::string rawPath = "fieldCodecRawTest.snapshot";
+  const std::string losslessPath = "fieldCodecLosslessTest.snapshot";
+  const std::string boundedPath = "fieldCodecBoundedTest.snapshot";
+  WriteSnapshot(grid, rawPath);
+  FieldCodecOptions options;
+  options.compression = FieldCompression::Lossless;
+  WriteSnapshot(grid, losslessPath, options);
+  options.compression = FieldCompression::ErrorBounded;
+  options.errorBound = 1e-4;
+  WriteSnapshot(grid, boundedPath, options);
+
+  SnapshotReader raw(rawPath), lossless(losslessPath), bounded(boundedPath);
+  CHECK_FALSE(raw.GetField("GroundTruthA").compressed);
+  CHECK(lossless.GetField("GroundTruthA").compressed);
+  CHECK(lossless.GetField("GroundTruthA").storedBytes < raw.GetField("GroundTruthA").storedBytes);
+  CHECK(lossless.ReadField<std::complex<float>>("GroundTruthA") == grid.GetGroundTruthA());
+  CHECK(lossless.ReadField<std::complex<float>>("PerturbedGridBB") == grid.GetPerturbedB());
+
+  // the axes stay exact, the fields are within the bound plus the float rounding
+  CHECK(bounded.ReadField<double>("X") == raw.ReadField<double>("X"));
+  const auto field = bounded.ReadField<std::complex<float>>("PerturbedGridAA");
+  const auto& expected = grid.GetPerturbedA();
+  const float error = (field - expected).cwiseAbs().maxCoeff();
+  CHECK(error <= 1.5e-4f);
+  CHECK(bounded.GetField("PerturbedGridAA").storedBytes
+        < lossless.GetField("PerturbedGridAA").storedBytes);
+
+  for (const std::string& path : {rawPath, losslessPath, boundedPath}) std::remove(path.c_str());
+}
@@ -0,0 +1,63 @@
+#include <doctest/doctest.h>
+#include <constraintDerivation.h>
+#include <fixedGrid.h>
+#include <grid.h>
+#include <stabilitySolver.h>
+
+#include <memory>
+#include <random>
+
+TEST_CASE("Fixed size grids reproduce the dynamic grid") {
+  using namespace CGLE;
+
+  Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  GridDetails details(8, 3, 24);
+  ReferenceGrid grid(constraint, details);
+  grid.SetFieldEvaluation(FieldEvaluation::Pointwise);
+  std::mt19937_64 engine(42);
+  grid.PerturbGrid(0.2, engine);
+
+  FixedGrid<24, 24, DoublePrecision> fixed(constraint, FixedGridDetails<24, 24>(0, 8, 0, 3));
+  std::mt19937_64 fixedEngine(42);
+  fixed.PerturbGrid(0.2, fixedEngine);
+
+  CHECK(fixed.GetDetails().GetDx() == doctest::Approx(details.GetDx()));
+  CHECK(fixed.GetGroundTruthA() == grid.GetGroundTruthA());
+  CHECK(fixed.GetPerturbedA() == grid.GetPerturbedA());
+  CHECK(fixed.GetPerturbedB() == grid.GetPerturbedB());
+
+  // the solver works on the fixed fields in place through Eigen::Ref
+  StabilitySolver<DoublePrecision> solver(constraint, details);
+  solver.Solve(grid);
+  StabilitySolver<DoublePrecision> fixedSolver(constraint, fixed.GetDetails().GetDx(),
+                                               fixed.GetDetails().GetDt());
+  fixedSolver.Solve(fixed.GetPerturbedA(), fixed.GetPerturbedB());
+  CHECK(fixed.GetPerturbedA() == grid.GetPerturbedA());
+}
+
+TEST_CASE("Fixed size grids support the default screening size") {
+  using namespace CGLE;
+  using DefaultGrid = FixedGrid<DEFAULT_NUM_PTS, DEFAULT_NUM_PTS, DoublePrecision>;
+
+  Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  GridDetails details(Axis::Linspace(0, DEFAULT_MAX_POSITION, DEFAULT_NUM_PTS),
+                      Axis::Linspace(0, DEFAULT_MAX_TIME, DEFAULT_NUM_PTS));
+  ReferenceGrid grid(constraint, details);
+  grid.SetFieldEvaluation(FieldEvaluation::Pointwise);
+  std::mt19937_64 engine(7);
+  grid.PerturbGrid(0.2, engine);
+
+  // four 100 x 100 double fields are better kept off the stack
+  auto fixed = std::make_unique<DefaultGrid>(constraint);
+  std::mt19937_64 fixedEngine(7);
+  fixed->PerturbGrid(0.2, fixedEngine);
+  CHECK(fixed->GetGroundTruthB() == grid.GetGroundTruthB());
+  CHECK(fixed->GetPerturbedA() == grid.GetPerturbedA());
+
+  // copies evaluate through their own handler once the original is gone
+  auto copy = std::make_unique<DefaultGrid>(*fixed);
+  fixed.reset();
+  copy->ComputeGroundTruth();
+  CHECK(copy->GetGroundTruthA() == grid.GetGroundTruthA());
+  CHECK(copy->GetConstraint().m_WaveType == BRIGHT_BRIGHT);
+}
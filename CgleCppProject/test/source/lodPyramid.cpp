@@ -0,0 +1,69 @@
+#include <doctest/doctest.h>
+#include <constraintDerivation.h>
+#include <lodPyramid.h>
+#include <snapshot.h>
+
+#include <cstdio>
+#include <string>
+
+TEST_CASE("Pyramid levels preserve min, max and mean") {
+  using namespace CGLE;
+
+  Eigen::MatrixXd field(13, 7);
+  for (int col = 0; col < field.cols(); col++) {
+    for (int row = 0; row < field.rows(); row++) field(row, col) = (row * 7 + col * 3) % 11 - 5;
+  }
+
+  LodPyramid pyramid = LodPyramid::Build(field, 2, 2);
+  REQUIRE(pyramid.GetNumLevels() == 3);
+  CHECK(pyramid.GetLevel(1).rows() == 7);
+  CHECK(pyramid.GetLevel(1).cols() == 4);
+
+  const Eigen::ArrayXXd amplitude = field.cwiseAbs();
+  for (int level = 1; level <= pyramid.GetNumLevels(); level++) {
+    const LodLevel& reduced = pyramid.GetLevel(level);
+    CHECK(reduced.min.minCoeff() == amplitude.minCoeff());
+    CHECK(reduced.max.maxCoeff() == amplitude.maxCoeff());
+  }
+
+  // the coarsest level is a single block per 8x8 region, its weighted mean is the global mean
+  const LodLevel& coarsest = pyramid.GetLevel(3);
+  double weightedSum = 0;
+  for (int col = 0; col < coarsest.cols(); col++) {
+    for (int row = 0; row < coarsest.rows(); row++) {
+      const double rows = std::min<double>(8, 13 - 8 * row);
+      const double cols = std::min<double>(8, 7 - 8 * col);
+      weightedSum += coarsest.mean(row, col) * rows * cols;
+    }
+  }
+  CHECK(weightedSum / amplitude.size() == doctest::Approx(amplitude.mean()).epsilon(1e-6));
+  CHECK(pyramid.SelectLevel(4, 4) == 2);
+  CHECK(pyramid.SelectLevel(100, 100) == 0);
+}
+
+TEST_CASE("Pyramids are stored next to the snapshot and read one level at a time") {
+  using namespace CGLE;
+
+  Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  Grid grid(constraint, GridDetails(200, 3, 300));
+  grid.PerturbGrid(0.2);
+
+  const std::string snapshotPath = "lodPyramidTest.snapshot";
+  WriteSnapshot(grid, snapshotPath);
+  WriteLodPyramids(grid, snapshotPath, 16, 2);
+
+  SnapshotReader snapshot(snapshotPath);
+  CHECK(snapshot.HasField("GroundTruthA"));
+  CHECK(snapshot.ReadField<std::complex<float>>("GroundTruthA") == grid.GetGroundTruthA());
+
+  LodReader reader(GetLodPath(snapshotPath));
+  CHECK(reader.GetFieldNames().size() == 4);
+  const int level = reader.SelectLevel("GroundTruthA", 64, 64);
+  LodLevel loaded = reader.ReadLevel("GroundTruthA", level);
+  LodPyramid expected = LodPyramid::Build(grid.GetGroundTruthA(), 16, 1);
+  CHECK((loaded.max == expected.GetLevel(level).max).all());
+  CHECK((loaded.mean == expected.GetLevel(level).mean).all());
+
+  std::remove(snapshotPath.c_str());
+  std::remove(GetLodPath(snapshotPath).c_str());
+}
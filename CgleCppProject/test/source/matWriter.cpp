@@ -0,0 +1,189 @@
+#include <doctest/doctest.h>
+#include <constraintDerivation.h>
+#include <matWriter.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+#ifdef CGLE_WITH_ZLIB
+#  include <zlib.h>
+#endif
+
+namespace {
+  struct ParsedArray {
+    uint32_t flags = 0;
+    int32_t rows = 0, cols = 0;
+    std::vector<char> real, imag;
+  };
+
+  uint32_t ReadWord(const std::vector<char>& bytes, size_t& offset) {
+    uint32_t value;
+    std::memcpy(&value, bytes.data() + offset, sizeof(value));
+    offset += sizeof(value);
+    return value;
+  }
+
+  /** reads one data element starting at offset, returns its type and moves past its padding **/
+  uint32_t ReadElement(const std::vector<char>& bytes, size_t& offset, std::vector<char>& data) {
+    const uint32_t type = ReadWord(bytes, offset);
+    const uint32_t size = ReadWord(bytes, offset);
+    data.assign(bytes.begin() + offset, bytes.begin() + offset + size);
+    offset += (size + 7) & ~7u;
+    return type;
+  }
+
+  /** parses the unnamed numeric arrays of a top level struct written uncompressed **/
+  std::map<std::string, ParsedArray> ParseStruct(const std::vector<char>& bytes) {
+    size_t offset = 128 + 8;
+    std::vector<char> data;
+    ReadElement(bytes, offset, data);  // flags
+    ReadElement(bytes, offset, data);  // dimensions
+    ReadElement(bytes, offset, data);  // name
+    ReadElement(bytes, offset, data);  // field name length
+    ReadElement(bytes, offset, data);  // field names
+
+    std::vector<std::string> names;
+    for (size_t name = 0; name < data.size() / 32; name++) names.push_back(&data[name * 32]);
+
+    std::map<std::string, ParsedArray> fields;
+    for (const std::string& name : names) {
+      ReadWord(bytes, offset);
+      ReadWord(bytes, offset);
+      ParsedArray array;
+      ReadElement(bytes, offset, data);
+      std::memcpy(&array.flags, data.data(), sizeof(array.flags));
+      ReadElement(bytes, offset, data);
+      std::memcpy(&array.rows, data.data(), sizeof(array.rows));
+      std::memcpy(&array.cols, data.data() + 4, sizeof(array.cols));
+      ReadElement(bytes, offset, data);
+      ReadElement(bytes, offset, array.real);
+      if (array.flags & 0x0800) ReadElement(bytes, offset, array.imag);
+      fields[name] = array;
+    }
+    return fields;
+  }
+
+  std::vector<char> ReadFile(const std::string& path) {
+    std::ifstream stream(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(stream), {});
+  }
+
+  /** non square grid, so transposed fields cannot pass for untransposed ones **/
+  CGLE::GridDetails NonSquareDetails() {
+    return CGLE::GridDetails(CGLE::Axis::Linspace(-4, 4, 40), CGLE::Axis::Linspace(0, 3, 30));
+  }
+
+  /** checks that a parsed field holds the transpose of a grid field, indexed (time, position) **/
+  template <typename Field>
+  void CheckTransposedField(const ParsedArray& array, const Field& expected) {
+    REQUIRE(array.rows == expected.cols());
+    REQUIRE(array.cols == expected.rows());
+    CHECK((array.flags & 0xff) == static_cast<uint32_t>(CGLE::MatClass::Single));
+    Eigen::MatrixXf real(array.rows, array.cols);
+    Eigen::MatrixXf imag(array.rows, array.cols);
+    REQUIRE(array.real.size() == real.size() * sizeof(float));
+    REQUIRE(array.imag.size() == imag.size() * sizeof(float));
+    std::memcpy(real.data(), array.real.data(), array.real.size());
+    std::memcpy(imag.data(), array.imag.data(), array.imag.size());
+    CHECK(real == expected.real().transpose());
+    CHECK(imag == expected.imag().transpose());
+  }
+}  // namespace
+
+TEST_CASE("Grids are written as the MATLAB grid struct") {
+  using namespace CGLE;
+
+  Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  Grid grid(constraint, NonSquareDetails());
+  grid.PerturbGrid(0.2);
+
+  const std::string path = "matWriterTest.mat";
+  WriteMatFile(grid, path);
+  const std::vector<char> bytes = ReadFile(path);
+  std::remove(path.c_str());
+
+  REQUIRE(bytes.size() > 136);
+  CHECK(std::string(bytes.data(), 10) == "MATLAB 5.0");
+  uint16_t version;
+  std::memcpy(&version, bytes.data() + 124, sizeof(version));
+  CHECK(version == 0x0100);
+  size_t offset = 128;
+  CHECK(ReadWord(bytes, offset) == 14);
+  CHECK(ReadWord(bytes, offset) + 136 == bytes.size());
+
+  std::map<std::string, ParsedArray> fields = ParseStruct(bytes);
+  for (const char* name : {"X", "T", "Dx", "Dt", "Nx", "Nt", "WaveType", "GroundTruthA",
+                           "GroundTruthB", "PerturbedGridAA", "PerturbedGridBB"}) {
+    CHECK(fields.count(name) == 1);
+  }
+
+  // the MATLAB scripts index fields (time, position): Nt rows of Nx positions
+  const GridDetails& details = grid.GetDetails();
+  CHECK(fields["GroundTruthA"].rows == details.GetNumYPts());
+  CHECK(fields["GroundTruthA"].cols == details.GetNumXPts());
+  CheckTransposedField(fields["GroundTruthA"], grid.GetGroundTruthA());
+  CheckTransposedField(fields["PerturbedGridAA"], grid.GetPerturbedA());
+
+  const ParsedArray& x = fields["X"];
+  CHECK(x.rows == 1);
+  CHECK(x.cols == static_cast<int32_t>(grid.GetDetails().GetXAxis().size()));
+  const ParsedArray& waveType = fields["WaveType"];
+  CHECK((waveType.flags & 0xff) == static_cast<uint32_t>(MatClass::Char));
+  CHECK(waveType.real.size() == BRIGHT_BRIGHT.size() * sizeof(uint16_t));
+}
+
+TEST_CASE("Compressed .mat variables are wrapped in a single compressed element") {
+  using namespace CGLE;
+
+  if (!MatWriter::IsCompressionAvailable()) {
+    CHECK_THROWS_AS(MatWriter("matWriterTest.mat", 1), std::invalid_argument);
+    return;
+  }
+
+  Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  Grid grid(constraint, NonSquareDetails());
+  grid.PerturbGrid(0.2);
+  const std::string path = "matWriterCompressedTest.mat";
+  WriteMatFile(grid, path, 1);
+  const std::vector<char> bytes = ReadFile(path);
+  std::remove(path.c_str());
+
+  size_t offset = 128;
+  REQUIRE(bytes.size() > 136);
+  CHECK(ReadWord(bytes, offset) == 15);
+  const uint32_t compressedSize = ReadWord(bytes, offset);
+  CHECK(compressedSize + 136 == bytes.size());
+
+#ifdef CGLE_WITH_ZLIB
+  // the payload inflates to the element an uncompressed file holds after its header
+  std::vector<char> inflated(bytes.begin(), bytes.begin() + 128);
+  std::vector<char> buffer(1 << 16);
+  z_stream stream{};
+  REQUIRE(inflateInit(&stream) == Z_OK);
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(bytes.data() + 136));
+  stream.avail_in = compressedSize;
+  int status = Z_OK;
+  while (status == Z_OK) {
+    stream.next_out = reinterpret_cast<Bytef*>(buffer.data());
+    stream.avail_out = static_cast<uInt>(buffer.size());
+    status = inflate(&stream, Z_NO_FLUSH);
+    const size_t produced = buffer.size() - stream.avail_out;
+    inflated.insert(inflated.end(), buffer.data(), buffer.data() + produced);
+  }
+  inflateEnd(&stream);
+  REQUIRE(status == Z_STREAM_END);
+
+  offset = 128;
+  CHECK(ReadWord(inflated, offset) == 14);
+  std::map<std::string, ParsedArray> fields = ParseStruct(inflated);
+  CheckTransposedField(fields["GroundTruthA"], grid.GetGroundTruthA());
+  CheckTransposedField(fields["GroundTruthB"], grid.GetGroundTruthB());
+  CheckTransposedField(fields["PerturbedGridAA"], grid.GetPerturbedA());
+  CheckTransposedField(fields["PerturbedGridBB"], grid.GetPerturbedB());
+#endif
+}
@@ -0,0 +1,76 @@
+#include <doctest/doctest.h>
+#include <constraintDerivation.h>
+#include <memoryEstimate.h>
+
+#include <complex>
+#include <vector>
+
+TEST_CASE("Memory charges track live and peak bytes per subsystem") {
+  using namespace CGLE;
+
+  MemoryAccountant::ResetPeaks();
+  const MemoryUsage before = MemoryAccountant::GetUsage(MemorySubsystem::Other);
+  {
+    MemoryCharge charge(MemorySubsystem::Other, 100);
+    MemoryCharge copy = charge;
+    CHECK(MemoryAccountant::GetUsage(MemorySubsystem::Other).liveBytes == before.liveBytes + 200);
+    copy.Update(50);
+    MemoryCharge moved = std::move(charge);
+    CHECK(MemoryAccountant::GetUsage(MemorySubsystem::Other).liveBytes == before.liveBytes + 150);
+    CHECK(MemoryAccountant::GetUsage(MemorySubsystem::Other).peakBytes == before.liveBytes + 200);
+
+    std::vector<double, TrackingAllocator<double, MemorySubsystem::Other>> values(10);
+    CHECK(MemoryAccountant::GetUsage(MemorySubsystem::Other).liveBytes
+          == before.liveBytes + 150 + 10 * sizeof(double));
+  }
+  CHECK(MemoryAccountant::GetUsage(MemorySubsystem::Other).liveBytes == before.liveBytes);
+  CHECK(MemoryAccountant::GetReport().find("GridFields: live") != std::string::npos);
+}
+
+TEST_CASE("Memory estimates bound the tracked peaks of a solve") {
+  using namespace CGLE;
+
+  Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  GridDetails details(8, 3, 24);
+  const MemoryEstimate estimate = EstimateMemory<MixedPrecision>(details);
+  const int subsystems[] = {static_cast<int>(MemorySubsystem::GridFields),
+                            static_cast<int>(MemorySubsystem::FunctionHandler),
+                            static_cast<int>(MemorySubsystem::Solver)};
+
+  MemoryAccountant::ResetPeaks();
+  std::vector<MemoryUsage> before;
+  for (int subsystem = 0; subsystem < NUM_MEMORY_SUBSYSTEMS; subsystem++) {
+    before.push_back(MemoryAccountant::GetUsage(static_cast<MemorySubsystem>(subsystem)));
+  }
+  // a 24 x 24 field is a single copy-on-write tile
+  const size_t fieldBytes = 24 * 24 * sizeof(std::complex<float>);
+  const size_t tileBytes = fieldBytes;
+  {
+    Grid grid(constraint, details);
+    grid.PerturbGrid(0.1);
+    // the ground truth is leased once, the perturbed fields only copy the tiles they modified
+    const MemoryUsage perturbed = MemoryAccountant::GetUsage(MemorySubsystem::GridFields);
+    CHECK(perturbed.peakBytes - before[0].liveBytes == 2 * fieldBytes + 2 * tileBytes);
+
+    StabilitySolver<MixedPrecision> solver(constraint, details);
+    solver.Solve(grid);
+  }
+
+  const MemoryUsage fields = MemoryAccountant::GetUsage(MemorySubsystem::GridFields);
+  CHECK(fields.peakBytes - before[0].liveBytes >= 4 * fieldBytes);
+  for (int subsystem : subsystems) {
+    const MemoryUsage usage = MemoryAccountant::GetUsage(static_cast<MemorySubsystem>(subsystem));
+    CHECK(usage.peakBytes > before[subsystem].liveBytes);
+    CHECK(usage.peakBytes - before[subsystem].liveBytes
+          <= estimate.GetBytes(static_cast<MemorySubsystem>(subsystem)));
+    // every byte of the job is refunded once the grid and the solver are gone
+    CHECK(usage.liveBytes == before[subsystem].liveBytes);
+  }
+  const size_t axisBytes = details.GetXAxis().IsUniform() ? 0 : 24 * sizeof(double);
+  CHECK(estimate.GetBytes(MemorySubsystem::GridDetails) == axisBytes);
+  const MemoryEstimate fromDimensions = EstimateMemory<MixedPrecision>(24, 24);
+  CHECK(fromDimensions.GetBytes(MemorySubsystem::GridDetails) == 0);
+  CHECK(fromDimensions.GetBytes(MemorySubsystem::GridFields)
+        == estimate.GetBytes(MemorySubsystem::GridFields));
+  CHECK(estimate.GetTotalBytes() >= 4 * fieldBytes);
+}
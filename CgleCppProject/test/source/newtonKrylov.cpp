@@ -0,0 +1,74 @@
+#include <doctest/doctest.h>
+#include <newtonKrylov.h>
+#include <tridiagonal.h>
+
+#include <cmath>
+#include <complex>
+
+TEST_CASE("Newton-Krylov solves a cubic tridiagonal system") {
+  using namespace CGLE;
+  using cd = std::complex<double>;
+  using Solver = NewtonKrylovSolver<cd>;
+
+  // T x + s |x|^2 x = b is not complex differentiable, only real differentiable
+  const int size = 40;
+  const TridiagonalSolver<cd> linear(size, cd(1, 0.5), cd(4, 1), cd(-1, 0.2));
+  Eigen::VectorXcd rhs(size);
+  for (int i = 0; i < size; i++) rhs[i] = cd(std::sin(i), std::cos(0.3 * i));
+
+  for (double strength : {0.1, 10.0}) {
+    auto residual = [&](const Solver::Vector& x, Solver::Vector& values) {
+      values = linear.Multiply(x) - rhs;
+      for (int i = 0; i < size; i++) values[i] += strength * cd(0.5, 1) * std::norm(x[i]) * x[i];
+    };
+    auto precondition = [&linear](Solver::Vector& values) { linear.Solve(values); };
+
+    Solver solver;
+    Solver::Vector x = Solver::Vector::Zero(size);
+    const NewtonKrylovReport report = solver.Solve(residual, precondition, x);
+    CHECK(report.converged);
+    CHECK(report.newtonIterations <= 8);
+    CHECK(report.residual <= 1e-10 * report.initialResidual);
+
+    Solver::Vector values(size);
+    residual(x, values);
+    CHECK(values.norm() == doctest::Approx(report.residual));
+  }
+}
+
+TEST_CASE("Newton-Krylov reports unconverged solves") {
+  using namespace CGLE;
+  using Solver = NewtonKrylovSolver<double>;
+
+  auto residual = [](const Solver::Vector& x, Solver::Vector& values) {
+    values = x.array().cube() + x.array() - 10;
+  };
+  auto identity = [](Solver::Vector&) {};
+
+  NewtonKrylovOptions options;
+  options.maxNewtonIterations = 1;
+  Solver solver(options);
+  Solver::Vector x = Solver::Vector::Zero(3);
+  NewtonKrylovReport report = solver.Solve(residual, identity, x);
+  CHECK_FALSE(report.converged);
+  CHECK(report.newtonIterations == 1);
+  CHECK(report.residual < report.initialResidual);
+
+  // the absolute tolerance accepts the initial guess outright
+  x.setZero();
+  report = solver.Solve(residual, identity, x, 100);
+  CHECK(report.converged);
+  CHECK(report.newtonIterations == 0);
+  CHECK(x.isZero());
+
+  NewtonKrylovReport total;
+  total.Merge(NewtonKrylovReport{true, 1, 2, 3, 7, 1});
+  total.Merge(NewtonKrylovReport{false, 2, 3, 4, 5, 6});
+  CHECK_FALSE(total.converged);
+  CHECK(total.krylovIterations == 5);
+  CHECK(total.initialResidual == 7);
+  CHECK(total.residual == 6);
+
+  options.forcingTerm = 1;
+  CHECK_THROWS_AS(Solver{options}, std::invalid_argument);
+}
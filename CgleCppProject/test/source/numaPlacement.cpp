@@ -0,0 +1,171 @@
+#include <doctest/doctest.h>
+#include <constraintDerivation.h>
+#include <grid.h>
+#include <numaPlacement.h>
+#include <stabilitySolver.h>
+
+#include <algorithm>
+#include <complex>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+TEST_CASE("Placed ranges give every page a single worker") {
+  using namespace CGLE;
+
+  const size_t pageSize = 4096;
+  for (size_t elementSize : {size_t(8), size_t(16)}) {
+    for (Eigen::Index rows : {Eigen::Index(5), Eigen::Index(700), Eigen::Index(1500)}) {
+      for (uintptr_t address : {uintptr_t(0x100000), uintptr_t(0x100000 + 48)}) {
+        for (int workers : {1, 3, 4}) {
+          const FieldLayout layout{address, elementSize, rows, rows};
+          const Eigen::Index cols = 7;
+          std::vector<int> owners(static_cast<size_t>(rows * cols), -1);
+          std::map<uintptr_t, int> pageOwners;
+          bool disjoint = true, singleOwner = true;
+          for (int worker = 0; worker < workers; worker++) {
+            for (Eigen::Index column = 0; column < cols; column++) {
+              for (const auto& range : GetPlacedRanges(layout, column, worker, workers, pageSize)) {
+                for (Eigen::Index position = range.first; position < range.second; position++) {
+                  const Eigen::Index element = column * rows + position;
+                  disjoint &= owners[element] == -1;
+                  owners[element] = worker;
+                  const uintptr_t page = (address + element * elementSize) / pageSize;
+                  singleOwner &= pageOwners.emplace(page, worker).first->second == worker;
+                }
+              }
+            }
+          }
+          CHECK(disjoint);
+          CHECK(singleOwner);
+          CHECK(std::count(owners.begin(), owners.end(), -1) == 0);
+        }
+      }
+    }
+  }
+
+  // page aligned columns split on the first page boundary at or after the ParallelFor split
+  const FieldLayout aligned{0x100000, 8, 2048, 2048};
+  using Range = PlacedRanges::value_type;
+  CHECK(GetPlacedRanges(aligned, 1, 0, 3, pageSize)[1] == Range(0, 1024));
+  CHECK(GetPlacedRanges(aligned, 1, 1, 3, pageSize)[1] == Range(1024, 1536));
+  CHECK(GetPlacedRanges(aligned, 1, 2, 3, pageSize)[1] == Range(1536, 2048));
+  CHECK(GetPlacedRanges(aligned, 1, 1, 3, pageSize)[0] == Range(0, 0));
+}
+
+TEST_CASE("Placed blocks run on the same workers") {
+  using namespace CGLE;
+
+  PlacementOptions placement;
+  placement.numThreads = 3;
+  Eigen::MatrixXcf field(4096, 2);
+  const FieldLayout layout = FieldLayout::Of(field);
+  std::vector<int> visits(4096, 0);
+  std::mutex mutex;
+  ForEachPlacedBlock(layout, 1, placement, [&](Eigen::Index begin, Eigen::Index end) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (Eigen::Index position = begin; position < end; position++) visits[position]++;
+  });
+  CHECK((visits == std::vector<int>(4096, 1)));
+  CHECK(GetPlacementNumWorkers(2, placement) == 2);
+
+  // every range runs on the same persistent worker call after call
+  std::map<Eigen::Index, std::thread::id> first, second;
+  ForEachPlacedBlock(layout, 1, placement, [&](Eigen::Index begin, Eigen::Index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    first[begin] = std::this_thread::get_id();
+  });
+  ForEachPlacedBlock(layout, 1, placement, [&](Eigen::Index begin, Eigen::Index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    second[begin] = std::this_thread::get_id();
+  });
+  CHECK(first == second);
+  CHECK(GetPlacementWorkers(placement) == GetPlacementWorkers(placement));
+  CHECK(GetPlacementWorkers(placement)->IsPinned());
+
+  Eigen::MatrixXd matrix(10, 4);
+  Eigen::MatrixXd source = Eigen::MatrixXd::Random(10, 4);
+  PlaceField(matrix, placement, &source);
+  CHECK(matrix == source);
+  PlaceField(matrix, placement);
+  CHECK(matrix.isZero(0));
+
+  // huge pages are owned whole, so short columns are placed by a single worker each
+  placement.hugePages = true;
+  PlaceField(matrix, placement, &source);
+  CHECK(matrix == source);
+}
+
+TEST_CASE("Placed fields live on the nodes of their workers") {
+  using namespace CGLE;
+  using Matrix = Eigen::MatrixXcf;
+
+  PlacementOptions placement;
+  placement.numThreads = 2;
+  const MemoryUsage before = MemoryAccountant::GetUsage(MemorySubsystem::GridFields);
+  shared_ptr<Matrix> field = AllocatePlacedField<Matrix>(3000, 6, placement,
+                                                         MemorySubsystem::GridFields);
+  const size_t bytes = static_cast<size_t>(field->size()) * sizeof(std::complex<float>);
+  CHECK(field->isZero(0));
+  CHECK(MemoryAccountant::GetUsage(MemorySubsystem::GridFields).liveBytes
+        == before.liveBytes + bytes);
+
+  // only checked where the kernel reports page locations and workers can be pinned
+  const std::vector<int> nodes = GetPageNodes(field->data(), bytes);
+  if (!nodes.empty() && GetPlacementNode(0) >= 0) {
+    // the first and last page may be shared with neighbouring allocations
+    const size_t pageSize = GetPlacementPageSize(placement);
+    const uintptr_t firstPage = reinterpret_cast<uintptr_t>(field->data()) / pageSize;
+    const FieldLayout layout = FieldLayout::Of(*field);
+    bool local = true;
+    for (int worker = 0; worker < 2; worker++) {
+      for (Eigen::Index column = 0; column < field->cols(); column++) {
+        for (const auto& range : GetPlacedRanges(layout, column, worker, 2, pageSize)) {
+          for (Eigen::Index position = range.first; position < range.second; position++) {
+            const size_t page = reinterpret_cast<uintptr_t>(&(*field)(position, column)) / pageSize
+                                - firstPage;
+            if (page == 0 || page + 1 == nodes.size()) continue;
+            local &= nodes[page] == GetPlacementNode(worker);
+          }
+        }
+      }
+    }
+    CHECK(local);
+  }
+
+  field.reset();
+  CHECK(MemoryAccountant::GetUsage(MemorySubsystem::GridFields).liveBytes == before.liveBytes);
+}
+
+TEST_CASE("Placed grids and solves match the unplaced ones") {
+  using namespace CGLE;
+
+  Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  GridDetails details(8, 3, 24);
+  PlacementOptions placement;
+  placement.numThreads = 3;
+
+  for (FieldEvaluation evaluation : {FieldEvaluation::Pointwise, FieldEvaluation::Separable}) {
+    Grid grid(constraint, details);
+    Grid placed(constraint, details, placement);
+    grid.SetFieldEvaluation(evaluation);
+    placed.SetFieldEvaluation(evaluation);
+    std::mt19937_64 engine(3), placedEngine(3);
+    grid.PerturbGrid(0.1, engine);
+    placed.PerturbGrid(0.1, placedEngine);
+    CHECK(placed.GetGroundTruthA() == grid.GetGroundTruthA());
+    CHECK(placed.GetGroundTruthB() == grid.GetGroundTruthB());
+
+    StabilitySolver<MixedPrecision> solver(constraint, details);
+    StabilitySolver<MixedPrecision> placedSolver(constraint, details);
+    placedSolver.SetPlacement(placement, 1);
+    solver.Solve(grid);
+    placedSolver.Solve(placed);
+    CHECK(placed.GetPerturbedA() == grid.GetPerturbedA());
+    CHECK(placed.GetPerturbedB() == grid.GetPerturbedB());
+  }
+}
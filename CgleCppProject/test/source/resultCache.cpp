@@ -0,0 +1,130 @@
+#include <doctest/doctest.h>
+#include <constraintDerivation.h>
+#include <resultCache.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+TEST_CASE("Result keys change with every input of a run") {
+  using namespace CGLE;
+
+  Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  GridDetails details(8, 3, 24);
+  ResultSettings settings;
+  settings.pertubationCoefficient = 0.1;
+  settings.seed = 7;
+
+  const ResultKey key = MakeResultKey<MixedPrecision>(constraint, details, settings);
+  CHECK(key.GetAddress().size() == 16);
+  CHECK(MakeResultKey<MixedPrecision>(constraint, details, settings).hash == key.hash);
+  CHECK(MakeResultKey<DoublePrecision>(constraint, details, settings).hash != key.hash);
+  CHECK(MakeResultKey<MixedPrecision>(constraint, GridDetails(8, 3, 26), settings).hash
+        != key.hash);
+
+  ResultSettings otherSeed = settings;
+  otherSeed.seed = 8;
+  CHECK(MakeResultKey<MixedPrecision>(constraint, details, otherSeed).hash != key.hash);
+  ResultSettings periodic = settings;
+  periodic.boundaryCondition = BoundaryCondition::Periodic;
+  CHECK(MakeResultKey<MixedPrecision>(constraint, details, periodic).hash != key.hash);
+
+  Constraint other = constraint;
+  other.m_Mu += 1e-12;
+  CHECK(MakeResultKey<MixedPrecision>(other, details, settings).hash != key.hash);
+}
+
+TEST_CASE("Solves are read back from the result cache") {
+  using namespace CGLE;
+
+  const std::string directory = "resultCacheTest";
+  std::filesystem::remove_all(directory);
+  {
+    Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+    GridDetails details(8, 3, 24);
+    ResultSettings settings;
+    settings.pertubationCoefficient = 0.1;
+    settings.seed = 42;
+
+    ResultCache cache(directory);
+    const CachedResult<MixedPrecision> computed
+        = SolveWithCache<MixedPrecision>(cache, constraint, details, settings, 1);
+    CHECK(cache.GetStatistics().misses == 1);
+    CHECK(cache.GetStatistics().stores == 1);
+
+    Grid grid(constraint, details);
+    std::mt19937_64 engine(settings.seed);
+    grid.PerturbGrid(settings.pertubationCoefficient, engine);
+    StabilitySolver<MixedPrecision> solver(constraint, details);
+    solver.Solve(grid);
+    CHECK(computed.fieldA == grid.GetPerturbedA());
+    CHECK(computed.fieldB == grid.GetPerturbedB());
+
+    // a second process sharing the directory sees the entry
+    ResultCache reopened(directory);
+    const CachedResult<MixedPrecision> cached
+        = SolveWithCache<MixedPrecision>(reopened, constraint, details, settings, 1);
+    CHECK(reopened.GetStatistics().hits == 1);
+    CHECK(reopened.GetStatistics().stores == 0);
+    CHECK(cached.fieldA == computed.fieldA);
+    CHECK(cached.fieldB == computed.fieldB);
+    CHECK(cached.metrics.a.relativeL2 == computed.metrics.a.relativeL2);
+    CHECK(cached.metrics.b.linf == computed.metrics.b.linf);
+    CHECK(cached.metrics.numCells == computed.metrics.numCells);
+
+    // a truncated entry is a miss
+    const ResultKey key = MakeResultKey<MixedPrecision>(constraint, details, settings);
+    const std::string path = directory + "/" + key.GetAddress() + ".res";
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) / 2);
+    CachedResult<MixedPrecision> truncated;
+    CHECK_FALSE(reopened.Get(key, truncated));
+  }
+  std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("The result cache evicts its least recently used entries") {
+  using namespace CGLE;
+
+  const std::string directory = "resultCacheEvictionTest";
+  std::filesystem::remove_all(directory);
+  {
+    Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+    GridDetails details(8, 3, 24);
+    CachedResult<DoublePrecision> result;
+    result.fieldA = DoublePrecision::FieldMatrix::Constant(24, 24, 1.0);
+    result.fieldB = result.fieldA;
+
+    std::vector<ResultKey> keys;
+    for (uint64_t seed = 0; seed < 3; seed++) {
+      ResultSettings settings;
+      settings.seed = seed;
+      keys.push_back(MakeResultKey<DoublePrecision>(constraint, details, settings));
+    }
+
+    ResultCache unlimited(directory);
+    unlimited.Put(keys[0], result);
+    const uintmax_t entryBytes = unlimited.GetSizeBytes();
+    unlimited.Put(keys[1], result);
+    CHECK(unlimited.GetSizeBytes() == 2 * entryBytes);
+
+    // make the first entry the most recently used one
+    const auto now = std::filesystem::file_time_type::clock::now();
+    std::filesystem::last_write_time(directory + "/" + keys[1].GetAddress() + ".res",
+                                     now - std::chrono::hours(1));
+    std::filesystem::last_write_time(directory + "/" + keys[0].GetAddress() + ".res",
+                                     now - std::chrono::minutes(1));
+
+    ResultCache limited(directory, 2 * entryBytes);
+    limited.Put(keys[2], result);
+    CHECK(limited.GetStatistics().evictions == 1);
+    CHECK(limited.GetSizeBytes() == 2 * entryBytes);
+
+    CachedResult<DoublePrecision> read;
+    CHECK(limited.Get(keys[0], read));
+    CHECK(read.fieldA == result.fieldA);
+    CHECK_FALSE(limited.Get(keys[1], read));
+    CHECK(limited.Get(keys[2], read));
+  }
+  std::filesystem::remove_all(directory);
+}
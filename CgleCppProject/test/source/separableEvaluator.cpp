@@ -0,0 +1,88 @@
+#include <doctest/doctest.h>
+#include <constraintDerivation.h>
+#include <grid.h>
+#include <separableEvaluator.h>
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+TEST_CASE("Separable evaluation matches the pointwise wave forms") {
+  using namespace CGLE;
+
+  for (const std::string& waveType : {BRIGHT_BRIGHT, DARK_DARK, FRONT_FRONT}) {
+    Constraint constraint = ComputeConstraints(waveType, 1);
+    auto handler = std::make_shared<FunctionHandler>(constraint);
+
+    std::vector<double> positions;
+    for (int i = 0; i < 41; i++) positions.push_back(-10 + 0.5 * i);
+    SeparableEvaluator evaluator(handler, positions);
+
+    Eigen::VectorXcd columnA(positions.size()), columnB(positions.size());
+    for (double time : {0.0, 0.25, 1.5, 3.0}) {
+      evaluator.EvaluateColumn(time, columnA, columnB);
+      for (size_t i = 0; i < positions.size(); i++) {
+        std::complex<double> expectedA = handler->A()(positions[i], time);
+        std::complex<double> expectedB = handler->B()(positions[i], time);
+        CHECK(std::abs(columnA[i] - expectedA) <= 1e-12 * (1 + std::abs(expectedA)));
+        CHECK(std::abs(columnB[i] - expectedB) <= 1e-12 * (1 + std::abs(expectedB)));
+      }
+    }
+  }
+}
+
+TEST_CASE("Separable dark-dark B follows ComputeFunctionsAndRelatedFields.m") {
+  using namespace CGLE;
+
+  Constraint constraint = ComputeConstraints(DARK_DARK, 1);
+  auto handler = std::make_shared<FunctionHandler>(constraint);
+  const double position = 0.75, time = 0.5;
+  SeparableEvaluator evaluator(handler, {position});
+
+  Eigen::VectorXcd columnA(1), columnB(1);
+  evaluator.EvaluateColumn(time, columnA, columnB);
+
+  // mu (1 - exp(2 k x + w t))^2 / (1 + exp(2 k x + w t))^2
+  const double kx = real(constraint.m_k1) * position;
+  const double wt = real(constraint.m_W1) * time;
+  const double numerator = 1 - std::exp(2 * kx + wt);
+  const double denominator = 1 + std::exp(2 * kx + wt);
+  const double expected = constraint.m_Mu * numerator * numerator / (denominator * denominator);
+  CHECK(columnB[0].real() == doctest::Approx(expected).epsilon(1e-12));
+  CHECK(columnB[0].imag() == 0);
+}
+
+TEST_CASE("Separable evaluation falls back outside double range") {
+  using namespace CGLE;
+
+  Constraint constraint = ComputeConstraints(FRONT_FRONT, 1);
+  auto handler = std::make_shared<FunctionHandler>(constraint);
+
+  // k1 * x is far beyond the exponent limit while k1 * x + w1 * t stays moderate
+  const double time = 400;
+  const double position = -real(constraint.m_W1) * time / real(constraint.m_k1);
+  SeparableEvaluator evaluator(handler, {position});
+  CHECK(evaluator.GetNumFallbackPositions() == 1);
+
+  Eigen::VectorXcd columnA(1), columnB(1);
+  evaluator.EvaluateColumn(time, columnA, columnB);
+  CHECK(std::isfinite(columnA[0].real()));
+  CHECK(columnA[0].real() == doctest::Approx(handler->A()(position, time).real()));
+}
+
+TEST_CASE("Separable and pointwise ground truths agree") {
+  using namespace CGLE;
+
+  Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  GridDetails details(8, 3, 24);
+  ReferenceGrid separable(constraint, details);
+  ReferenceGrid pointwise(constraint, details);
+  pointwise.SetFieldEvaluation(FieldEvaluation::Pointwise);
+  separable.ComputeGroundTruth();
+  pointwise.ComputeGroundTruth();
+
+  const double scale = pointwise.GetGroundTruthA().cwiseAbs().maxCoeff();
+  CHECK((separable.GetGroundTruthA() - pointwise.GetGroundTruthA()).cwiseAbs().maxCoeff()
+        <= 1e-12 * scale);
+}
@@ -0,0 +1,100 @@
+#include <doctest/doctest.h>
+#include <constraintDerivation.h>
+#include <solitonAnalytics.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+TEST_CASE("Soliton analytics track a moving soliton and a front") {
+  using namespace CGLE;
+  using cd = std::complex<double>;
+
+  const GridDetails details(20, 1, 401);
+  const Axis& x = details.GetXAxis();
+  const Axis& t = details.GetTimeAxis();
+  const double width = 1.5;
+  const double velocity = 0.75;
+  SolitonAnalytics<DoublePrecision> analytics(details);
+
+  // A is a sech soliton moving at a constant velocity, B a tanh front of the same width
+  Eigen::VectorXcd rowA(x.size());
+  Eigen::VectorXcd rowB(x.size());
+  for (int timeIndex = 0; timeIndex < 5; timeIndex++) {
+    const double center = 10 + velocity * t[timeIndex];
+    for (int position = 0; position < x.size(); position++) {
+      rowA[position] = cd(0, 2) / std::cosh((x[position] - center) / width);
+      rowB[position] = std::tanh((x[position] - 10) / width);
+    }
+    analytics.Record(timeIndex, rowA, rowB);
+  }
+
+  const auto& samples = analytics.GetSamples();
+  REQUIRE(samples.size() == 5);
+  const double dx = x[1] - x[0];
+  const double first = x[0];
+  const double last = x[x.size() - 1];
+  for (int timeIndex = 0; timeIndex < 5; timeIndex++) {
+    const FieldAnalytics& a = samples[timeIndex].a;
+    const double center = 10 + velocity * t[timeIndex];
+    CHECK(samples[timeIndex].time == t[timeIndex]);
+    CHECK(std::abs(a.peakPosition - center) < 0.02 * dx);
+    CHECK(a.peakAmplitude == doctest::Approx(2).epsilon(1e-2));
+    // 4 sech^2((x - c) / w) integrates to 4 w tanh((x - c) / w)
+    const double power
+        = 4 * width * (std::tanh((last - center) / width) - std::tanh((first - center) / width));
+    CHECK(a.power == doctest::Approx(power).epsilon(1e-3));
+    CHECK(samples[timeIndex].b.frontWidth == doctest::Approx(width).epsilon(1e-2));
+    if (timeIndex > 0) CHECK(a.peakVelocity == doctest::Approx(velocity).epsilon(1e-2));
+  }
+  CHECK(samples[0].a.peakVelocity == 0);
+  CHECK(samples[2].b.peakVelocity == 0);
+
+  const std::string path = "solitonAnalyticsTest.mat";
+  analytics.WriteMatFile(path);
+  std::ifstream stream(path, std::ios::binary | std::ios::ate);
+  CHECK(stream.tellg() > 128);
+  stream.close();
+  std::remove(path.c_str());
+
+  CHECK_THROWS_AS(analytics.Record(0, rowA.head(10), rowB), std::invalid_argument);
+}
+
+TEST_CASE("Soliton analytics observe every computed row of a solve") {
+  using namespace CGLE;
+
+  Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  GridDetails details(8, 3, 24);
+  BasicGrid<MixedPrecision> grid(constraint, details);
+  std::mt19937_64 engine(3);
+  grid.PerturbGrid(0.1, engine);
+
+  StabilitySolver<MixedPrecision> solver(constraint, details);
+  SolitonAnalytics<MixedPrecision> analytics(details);
+  int forwarded = 0;
+  solver.SetRowObserver(analytics.Observer(
+      [&forwarded](int, const Eigen::Ref<MixedPrecision::FieldMatrix>&,
+                   const Eigen::Ref<MixedPrecision::FieldMatrix>&) { forwarded++; }));
+  solver.Solve(grid);
+
+  const auto& samples = analytics.GetSamples();
+  // the last row is never computed, so it is not recorded as a sample
+  REQUIRE(samples.size() == 23);
+  CHECK(forwarded == 23);
+  for (int timeIndex = 0; timeIndex < 23; timeIndex++) {
+    CHECK(samples[timeIndex].timeIndex == timeIndex);
+  }
+
+  // the analytics of a row match a reduction of the solved field
+  const auto& fieldA = grid.GetPerturbedA();
+  const Axis& x = details.GetXAxis();
+  double power = 0;
+  for (int position = 1; position < x.size(); position++) {
+    power += 0.5 * (std::norm(fieldA(position, 5)) + std::norm(fieldA(position - 1, 5)))
+             * (x[position] - x[position - 1]);
+  }
+  CHECK(samples[5].a.power == doctest::Approx(power));
+  CHECK(samples[5].a.peakAmplitude == doctest::Approx(fieldA.col(5).cwiseAbs().maxCoeff()));
+  CHECK(samples.back().a.power > 0);
+}
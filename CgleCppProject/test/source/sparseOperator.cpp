@@ -0,0 +1,87 @@
+#include <doctest/doctest.h>
+#include <sparseOperator.h>
+#include <tridiagonal.h>
+
+#include <cmath>
+#include <complex>
+
+TEST_CASE("Sparse operators on a uniform axis match the tridiagonal system") {
+  using namespace CGLE;
+  using cd = std::complex<double>;
+
+  const auto coeff = CoefficientMatrix<double>::Create(cd(2, 1), cd(3, -2.5), cd(1, -2.4),
+                                                       cd(-0.7, 1.75), 0.25, 0.1);
+  SparseOperator<cd> system({StencilAxis{Axis::Linspace(-3, 3, 25), BoundaryCondition::Dirichlet}});
+  REQUIRE(system.GetNumUnknowns() == 23);
+  const auto& matrix = system.Assemble({{coeff.a, coeff.b, coeff.c}});
+  CHECK(matrix.nonZeros() == 3 * 23 - 2);
+  CHECK(matrix.coeff(5, 4) == coeff.a);
+  CHECK(matrix.coeff(5, 5) == coeff.b);
+  CHECK(matrix.coeff(5, 6) == coeff.c);
+
+  Eigen::VectorXcd rhs(23);
+  for (int i = 0; i < 23; i++) rhs[i] = cd(std::sin(i), 1.0 / (i + 1));
+  TridiagonalSolver<cd> tridiagonal(23, coeff.a, coeff.b, coeff.c);
+  Eigen::VectorXcd expected = rhs;
+  tridiagonal.Solve(expected);
+  Eigen::VectorXcd solution = rhs;
+  system.Solve(solution);
+  CHECK((solution - expected).cwiseAbs().maxCoeff() < 1e-12);
+
+  // new coefficients keep the pattern and the symbolic analysis
+  const cd* values = matrix.valuePtr();
+  system.Assemble({{coeff.a, 2.0 * coeff.b, coeff.c}}, cd(0.5, 0));
+  CHECK(system.GetMatrix().valuePtr() == values);
+  CHECK(system.GetMatrix().coeff(5, 5) == 2.0 * coeff.b + 0.5);
+  solution = rhs;
+  system.Solve(solution);
+  CHECK((system.GetMatrix() * solution - rhs).cwiseAbs().maxCoeff() < 1e-12);
+  CHECK(system.GetNumSymbolicFactorizations() == 1);
+  CHECK(system.GetNumNumericFactorizations() == 2);
+
+  // periodic axes couple the first and last positions
+  SparseOperator<cd> periodic({StencilAxis{Axis::Linspace(0, 1, 8), BoundaryCondition::Periodic}});
+  periodic.Assemble({{coeff.a, coeff.b, coeff.c}});
+  CHECK(periodic.GetNumUnknowns() == 8);
+  CHECK(periodic.GetMatrix().coeff(0, 7) == coeff.a);
+  CHECK(periodic.GetMatrix().coeff(7, 0) == coeff.c);
+}
+
+TEST_CASE("Sparse operators discretize the Laplacian of a non-uniform 2D mesh") {
+  using namespace CGLE;
+
+  // u = (x - x0)(x - xN)(y - y0)(y - yN) vanishes on the boundary and the three point second
+  // difference of a quadratic is exact on any mesh
+  const Axis x = Axis::Explicit({0.0, 0.1, 0.25, 0.3, 0.5, 0.8, 0.9, 1.2, 1.3, 1.5});
+  const Axis y = Axis::Linspace(-1, 1, 13);
+  SparseOperator<double> laplacian({StencilAxis{x, BoundaryCondition::Dirichlet},
+                                    StencilAxis{y, BoundaryCondition::Dirichlet}});
+  REQUIRE(laplacian.GetNumUnknowns() == 8 * 11);
+  CHECK(laplacian.Index({0, 4}) == -1);
+  CHECK(laplacian.Index({2, 3}) == 1 + 2 * 8);
+
+  const double stepX = x.GetStep();
+  const double stepY = y.GetStep();
+  laplacian.Assemble({{1 / (stepX * stepX), -2 / (stepX * stepX), 1 / (stepX * stepX)},
+                      {1 / (stepY * stepY), -2 / (stepY * stepY), 1 / (stepY * stepY)}});
+
+  Eigen::VectorXd field(laplacian.GetNumUnknowns());
+  Eigen::VectorXd expected(laplacian.GetNumUnknowns());
+  for (int j = 1; j < y.size() - 1; j++) {
+    for (int i = 1; i < x.size() - 1; i++) {
+      const double qx = (x[i] - x[0]) * (x[i] - x[x.size() - 1]);
+      const double qy = (y[j] - y[0]) * (y[j] - y[y.size() - 1]);
+      field[laplacian.Index({i, j})] = qx * qy;
+      expected[laplacian.Index({i, j})] = 2 * qy + 2 * qx;
+    }
+  }
+  CHECK((laplacian.GetMatrix() * field - expected).cwiseAbs().maxCoeff() < 1e-9);
+
+  Eigen::VectorXd solution = expected;
+  laplacian.Solve(solution);
+  CHECK((solution - field).cwiseAbs().maxCoeff() < 1e-9);
+
+  CHECK_THROWS_AS(laplacian.Assemble({{1, -2, 1}}), std::invalid_argument);
+  CHECK_THROWS_AS(SparseOperator<double>({StencilAxis{Axis::Linspace(0, 1, 2)}}),
+                  std::invalid_argument);
+}
@@ -0,0 +1,78 @@
+#include <doctest/doctest.h>
+#include <constraintDerivation.h>
+#include <spectralScreening.h>
+
+#include <cmath>
+
+namespace {
+  /** largest growth rate of i P d_xx + Gamma on n Dirichlet unknowns, in closed form **/
+  double DiffusionGrowthRate(std::complex<double> p, std::complex<double> gamma, int n,
+                             double dx) {
+    double growth = -INFINITY;
+    for (int mode = 1; mode <= n; mode++) {
+      const double wave = std::sin(mode * M_PI / (2.0 * (n + 1)));
+      const double decay = 4.0 * wave * wave / (dx * dx);
+      growth = std::max(growth, gamma.real() + p.imag() * decay);
+    }
+    return growth;
+  }
+}  // namespace
+
+TEST_CASE("Spectral screening recovers the growth rate of the linear operator") {
+  using namespace CGLE;
+
+  Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  GridDetails details(8, 3, 24);
+  const Eigen::VectorXcd zero = Eigen::VectorXcd::Zero(24);
+  const LinearizedOperator linear = BuildLinearizedOperator(
+      constraint, details.GetDx(), zero, zero, BoundaryCondition::Dirichlet);
+  CHECK(linear.rows() == 88);
+  CHECK(linear.cols() == 88);
+
+  const double expected
+      = std::max(DiffusionGrowthRate(constraint.m_P1, constraint.m_Gamma1, 22, details.GetDx()),
+                 DiffusionGrowthRate(constraint.m_P1Prime, constraint.m_Gamma1Prime, 22,
+                                     details.GetDx()));
+  SpectralScreeningOptions options;
+  const SpectralScreeningResult result = ComputeLeadingEigenvalues(linear, options);
+  REQUIRE(result.converged);
+  CHECK(result.maxGrowthRate == doctest::Approx(expected).epsilon(1e-8));
+  CHECK(result.eigenvalues.size() == 6);
+  CHECK(result.shift > result.maxGrowthRate);
+  for (size_t k = 1; k < result.eigenvalues.size(); k++) {
+    CHECK(result.eigenvalues[k - 1].real() >= result.eigenvalues[k].real());
+  }
+
+  // damped, purely dispersive fields are stable
+  constraint.m_P1 = constraint.m_P1.real();
+  constraint.m_P1Prime = constraint.m_P1Prime.real();
+  constraint.m_Gamma1 = -0.5;
+  constraint.m_Gamma1Prime = -0.25;
+  const SpectralScreeningResult damped = ComputeLeadingEigenvalues(
+      BuildLinearizedOperator(constraint, details.GetDx(), zero, zero,
+                              BoundaryCondition::Periodic),
+      options);
+  REQUIRE(damped.converged);
+  CHECK(damped.maxGrowthRate == doctest::Approx(-0.25));
+  CHECK(damped.verdict == ScreeningVerdict::Stable);
+}
+
+TEST_CASE("Spectral screening of a soliton does not depend on the shift") {
+  using namespace CGLE;
+
+  const Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  const GridDetails details(8, 3, 24);
+  SpectralScreeningOptions options;
+  const SpectralScreeningResult result = ScreenStability(constraint, details, options);
+  REQUIRE(result.converged);
+  CHECK(result.verdict == ScreeningVerdict::Unstable);
+
+  options.shift = result.shift + 0.01 * std::abs(result.shift);
+  options.krylovDimension = 60;
+  const SpectralScreeningResult shifted = ScreenStability(constraint, details, options);
+  REQUIRE(shifted.converged);
+  CHECK(shifted.maxGrowthRate == doctest::Approx(result.maxGrowthRate).epsilon(1e-8));
+
+  options.timeIndex = details.GetTimeAxis().size();
+  CHECK_THROWS_AS(ScreenStability(constraint, details, options), std::invalid_argument);
+}
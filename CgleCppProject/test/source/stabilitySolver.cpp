@@ -0,0 +1,273 @@
+#include <doctest/doctest.h>
+#include <constraintDerivation.h>
+#include <gridDetails.h>
+#include <precisionComparison.h>
+#include <stabilitySolver.h>
+#include <tridiagonal.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <random>
+
+namespace {
+  CGLE::Constraint BrightBrightConstraint() {
+    using cd = std::complex<double>;
+    return CGLE::Constraint(1, "A", "Bright-Bright", 2, 0, 3, -8, 2, 0.002,
+                            cd(1.0417810279445396, 0.5295590088750854), 0, 0,
+                            cd(3.5000000000000036, 2.2563808753624817), 17.364923362962905,
+                            52.094770088888716, 0, 0, 1.0458028182282497, 1.31454380654842,
+                            -0.7291666666666667, cd(6.51161308, 1.75), cd(4.79791976, -2.9166),
+                            cd(2, 1), cd(3, -2.5), cd(1, -2.4), cd(-0.7291666666666667, 1.75),
+                            cd(0.6, -3), cd(-0.5, 2.25));
+  }
+}  // namespace
+
+TEST_CASE("Tridiagonal solve matches dense solve") {
+  using namespace CGLE;
+  using cd = std::complex<double>;
+
+  const int size = 17;
+  cd sub(0.3, -0.1), diag(4.0, 1.0), super(-0.2, 0.5);
+  TridiagonalSolver<cd> solver(size, sub, diag, super);
+
+  Eigen::MatrixXcd dense = Eigen::MatrixXcd::Zero(size, size);
+  Eigen::VectorXcd rhs(size);
+  for (int i = 0; i < size; i++) {
+    dense(i, i) = diag;
+    if (i > 0) dense(i, i - 1) = sub;
+    if (i + 1 < size) dense(i, i + 1) = super;
+    rhs[i] = cd(i, 1.0 / (i + 1));
+  }
+
+  Eigen::VectorXcd expected = dense.partialPivLu().solve(rhs);
+  Eigen::VectorXcd solution = rhs;
+  solver.Solve(solution);
+
+  CHECK((solution - expected).cwiseAbs().maxCoeff() < 1e-12);
+  CHECK((solver.Multiply(solution) - rhs).cwiseAbs().maxCoeff() < 1e-12);
+}
+
+TEST_CASE("Partitioned tridiagonal solve matches the serial solve") {
+  using namespace CGLE;
+  using cd = std::complex<double>;
+
+  const int size = 103;
+  cd sub(0.3, -0.1), diag(4.0, 1.0), super(-0.2, 0.5);
+  TridiagonalSolver<cd> serial(size, sub, diag, super);
+  PartitionedTridiagonalSolver<cd> partitioned;
+  partitioned.SetParallelism(4, 10);
+  partitioned.Factorize(size, sub, diag, super);
+  REQUIRE(partitioned.GetNumPartitions() == 4);
+
+  Eigen::VectorXcd rhs(size);
+  for (int i = 0; i < size; i++) rhs[i] = cd(std::sin(i), 1.0 / (i + 1));
+
+  Eigen::VectorXcd expected = rhs;
+  serial.Solve(expected);
+  Eigen::VectorXcd solution = rhs;
+  partitioned.Solve(solution);
+  CHECK((solution - expected).cwiseAbs().maxCoeff() < 1e-12);
+
+  // repeated solves and copies reuse the same workers and reduced system buffer
+  const size_t bytes = partitioned.GetBytes();
+  PartitionedTridiagonalSolver<cd> copy = partitioned;
+  for (int solve = 0; solve < 3; solve++) {
+    Eigen::VectorXcd again = rhs;
+    copy.Solve(again);
+    CHECK(again == solution);
+  }
+  CHECK(partitioned.GetBytes() == bytes);
+
+  // below the threshold the serial sweep is used
+  partitioned.SetParallelism(4, size + 1);
+  CHECK(partitioned.GetNumPartitions() == 1);
+}
+
+TEST_CASE("Cyclic tridiagonal solve matches dense solve") {
+  using namespace CGLE;
+  using cd = std::complex<double>;
+
+  const int size = 41;
+  cd sub(0.3, -0.1), diag(4.0, 1.0), super(-0.2, 0.5);
+  Eigen::MatrixXcd dense = Eigen::MatrixXcd::Zero(size, size);
+  Eigen::VectorXcd rhs(size);
+  for (int i = 0; i < size; i++) {
+    dense(i, i) = diag;
+    dense(i, (i + size - 1) % size) = sub;
+    dense(i, (i + 1) % size) = super;
+    rhs[i] = cd(std::cos(i), 1.0 / (i + 1));
+  }
+  Eigen::VectorXcd expected = dense.partialPivLu().solve(rhs);
+
+  // serial and partitioned underlying solves
+  for (int numThreads : {1, 3}) {
+    CyclicTridiagonalSolver<cd> solver;
+    solver.SetParallelism(numThreads, 10);
+    solver.Factorize(size, sub, diag, super);
+
+    Eigen::VectorXcd solution = rhs;
+    solver.Solve(solution);
+    CHECK((solution - expected).cwiseAbs().maxCoeff() < 1e-12);
+    CHECK((solver.Multiply(solution) - rhs).cwiseAbs().maxCoeff() < 1e-12);
+  }
+}
+
+TEST_CASE("Periodic boundaries commute with a circular shift") {
+  using namespace CGLE;
+
+  Constraint constraint = BrightBrightConstraint();
+  GridDetails details(8, 3, 24);
+  ReferenceGrid grid(constraint, details);
+  grid.PerturbGrid(0.1);
+
+  const int shift = 5;
+  auto rotate = [shift](const ReferenceGrid::FieldMatrix& field) {
+    const Eigen::Index rows = field.rows();
+    ReferenceGrid::FieldMatrix rotated(rows, field.cols());
+    rotated.bottomRows(rows - shift) = field.topRows(rows - shift);
+    rotated.topRows(shift) = field.bottomRows(shift);
+    return rotated;
+  };
+
+  ReferenceGrid::FieldMatrix fieldA = grid.GetPerturbedA();
+  ReferenceGrid::FieldMatrix fieldB = grid.GetPerturbedB();
+  ReferenceGrid::FieldMatrix shiftedA = rotate(fieldA);
+  ReferenceGrid::FieldMatrix shiftedB = rotate(fieldB);
+
+  StabilitySolver<DoublePrecision> solver(constraint, details);
+  solver.SetBoundaryCondition(BoundaryCondition::Periodic);
+  solver.Solve(fieldA, fieldB);
+  solver.Solve(shiftedA, shiftedB);
+
+  CHECK(fieldA.allFinite());
+  CHECK(fieldA.row(0).cwiseAbs().maxCoeff() > 0);
+  const double scaleA = fieldA.cwiseAbs().maxCoeff();
+  const double scaleB = fieldB.cwiseAbs().maxCoeff();
+  CHECK((rotate(fieldA) - shiftedA).cwiseAbs().maxCoeff() < 1e-12 * scaleA);
+  CHECK((rotate(fieldB) - shiftedB).cwiseAbs().maxCoeff() < 1e-12 * scaleB);
+}
+
+TEST_CASE("Stability solver enforces boundary conditions") {
+  using namespace CGLE;
+
+  Constraint constraint = BrightBrightConstraint();
+  GridDetails details(8, 3, 24);
+  ReferenceGrid grid(constraint, details);
+  grid.PerturbGrid(0.1);
+
+  StabilitySolver<DoublePrecision> solver(constraint, details);
+  solver.Solve(grid);
+
+  auto& fieldA = grid.GetPerturbedA();
+  CHECK(fieldA.row(0).cwiseAbs().maxCoeff() == 0);
+  CHECK(fieldA.row(fieldA.rows() - 1).cwiseAbs().maxCoeff() == 0);
+  CHECK(fieldA.col(fieldA.cols() - 1).cwiseAbs().maxCoeff() == 0);
+  CHECK(fieldA.allFinite());
+}
+
+TEST_CASE("Mixed precision tracks the double precision reference") {
+  using namespace CGLE;
+
+  Constraint constraint = BrightBrightConstraint();
+  GridDetails details(8, 3, 24);
+  PrecisionComparison comparison = ComparePrecisionModes(constraint, details, 0.1);
+
+  CHECK(comparison.maxReferenceAmplitude > 0);
+  CHECK(comparison.maxRelativeDeviation < 1e-4);
+}
+
+TEST_CASE("Newton-Krylov steps solve the rows fully implicitly") {
+  using namespace CGLE;
+  using cd = std::complex<double>;
+
+  Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 2);
+  const GridDetails details(Axis::Linspace(-8, 8, 65), Axis::Linspace(0, 0.3, 65));
+  ReferenceGrid grid(constraint, details);
+  std::mt19937_64 engine(1);
+  grid.PerturbGrid(0.1, engine);
+  // the rows a step reads before they are solved hold the perturbed values, boundaries pinned
+  ReferenceGrid::FieldMatrix initialA = grid.GetPerturbedA();
+  ReferenceGrid::FieldMatrix initialB = grid.GetPerturbedB();
+  const int numPositions = static_cast<int>(initialA.rows());
+  for (auto* field : {&initialA, &initialB}) {
+    field->row(0).setZero();
+    field->row(numPositions - 1).setZero();
+  }
+
+  StabilitySolver<DoublePrecision> solver(constraint, details);
+  ReferenceGrid::FieldMatrix semiA = initialA, semiB = initialB;
+  solver.Solve(semiA, semiB);
+  CHECK(solver.GetNewtonKrylovReport().newtonIterations == 0);
+
+  solver.SetStepScheme(StepScheme::NewtonKrylov);
+  ReferenceGrid::FieldMatrix fieldA = initialA, fieldB = initialB;
+  solver.Solve(fieldA, fieldB);
+  const NewtonKrylovReport& report = solver.GetNewtonKrylovReport();
+  CHECK(report.converged);
+  CHECK(report.newtonIterations >= 63);
+  CHECK(report.newtonIterations <= 63 * 6);
+  CHECK((fieldA - semiA).norm() > 1e-6 * semiA.norm());
+
+  // AA u = rhs with every current row value of the stencil taken from the solved row
+  const int numTimes = static_cast<int>(fieldA.cols());
+  using Matrix = ReferenceGrid::FieldMatrix;
+  auto rowResidual = [&](int field, const Matrix& solvedA, const Matrix& solvedB, int row) {
+    const auto& coeff = field == 0 ? solver.GetCoefficientsA() : solver.GetCoefficientsB();
+    const Matrix& self = field == 0 ? solvedA : solvedB;
+    const Matrix& prior = field == 0 ? initialA : initialB;
+    const bool hasLater = row + 1 < numTimes - 2;
+    double residual = 0, scale = 0;
+    for (int position = 1; position + 1 < numPositions; position++) {
+      const cd product = coeff.a * self(position - 1, row) + coeff.b * self(position, row)
+                         + coeff.c * self(position + 1, row);
+      const cd rhs = coeff.RightHandSide(
+          self(position - 1, row), self(position, row), self(position + 1, row),
+          solvedA(position, row), solvedB(position, row), solvedA(position + 1, row),
+          solvedB(position + 1, row), self(position, row - 1),
+          hasLater ? prior(position, row + 1) : cd(), hasLater);
+      residual = std::max(residual, std::abs(product - rhs));
+      // the terms largely cancel, so the residual is compared against their size
+      scale = std::max({scale, std::abs(coeff.c * self(position, row)), std::abs(rhs)});
+    }
+    return residual / scale;
+  };
+  for (int row : {1, 20, numTimes - 2}) {
+    CHECK(rowResidual(0, fieldA, fieldB, row) < 1e-9);
+    CHECK(rowResidual(1, fieldA, fieldB, row) < 1e-9);
+  }
+  // the semi-implicit rows take the current row of the stencil from the estimate ahead of the march
+  CHECK(rowResidual(0, semiA, semiB, 20) > 1e-6);
+
+  solver.SetBoundaryCondition(BoundaryCondition::Periodic);
+  fieldA = grid.GetPerturbedA();
+  fieldB = grid.GetPerturbedB();
+  solver.Solve(fieldA, fieldB);
+  CHECK(solver.GetNewtonKrylovReport().converged);
+  CHECK(fieldA.allFinite());
+}
+
+TEST_CASE("Newton-Krylov steps stay bounded where semi-implicit steps blow up") {
+  using namespace CGLE;
+
+  // a stiff gain turns AA near singular for dt around 1 / sqrt(Gamma1), the implicit operator not
+  Constraint base = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  Constraint stiff = base;
+  stiff.m_Gamma1 = stiff.m_Gamma1Prime = 1000;
+  const GridDetails details(Axis::Linspace(-8, 8, 65), Axis::Linspace(0, 3, 153));
+  ReferenceGrid grid(base, details);
+  std::mt19937_64 engine(1);
+  grid.PerturbGrid(0.1, engine);
+  const double initial = grid.GetPerturbedA().col(0).cwiseAbs().maxCoeff();
+
+  auto march = [&](StepScheme scheme) {
+    ReferenceGrid::FieldMatrix fieldA = grid.GetPerturbedA(), fieldB = grid.GetPerturbedB();
+    StabilitySolver<DoublePrecision> solver(stiff, details);
+    solver.SetStepScheme(scheme);
+    solver.Solve(fieldA, fieldB);
+    CHECK(solver.GetNewtonKrylovReport().converged);
+    return fieldA.middleCols(1, fieldA.cols() - 2).cwiseAbs().maxCoeff();
+  };
+  CHECK(march(StepScheme::SemiImplicit) > 1e6 * initial);
+  CHECK(march(StepScheme::NewtonKrylov) < initial);
+}
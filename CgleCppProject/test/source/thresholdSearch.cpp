@@ -0,0 +1,67 @@
+#include <doctest/doctest.h>
+#include <constraintDerivation.h>
+#include <thresholdSearch.h>
+
+#include <random>
+
+TEST_CASE("Stop conditions end the march at the requested row") {
+  using namespace CGLE;
+
+  Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  GridDetails details(8, 3, 24);
+  BasicGrid<DoublePrecision> grid(constraint, details);
+  std::mt19937_64 engine(5);
+  grid.PerturbGrid(0.1, engine);
+  const auto perturbed = grid.GetPerturbedA();
+
+  StabilitySolver<DoublePrecision> solver(constraint, details);
+  solver.SetStopCondition([](int timeIndex, const Eigen::Ref<DoublePrecision::FieldMatrix>&,
+                             const Eigen::Ref<DoublePrecision::FieldMatrix>&) {
+    return timeIndex == 3;
+  });
+  solver.Solve(grid);
+  CHECK(solver.GetLastSolvedRow() == 3);
+  CHECK(grid.GetPerturbedA().col(3) != perturbed.col(3));
+  // Dirichlet boundary positions are zeroed up front, interior cells of later rows are untouched
+  CHECK(grid.GetPerturbedA().block(1, 4, 22, 20) == perturbed.block(1, 4, 22, 20));
+
+  solver.SetStopCondition(nullptr);
+  solver.Solve(grid);
+  CHECK(solver.GetLastSolvedRow() == 22);
+}
+
+TEST_CASE("Threshold searches bracket the first unstable value of a dense sweep") {
+  using namespace CGLE;
+
+  Constraint constraint = ComputeConstraints(BRIGHT_BRIGHT, 1);
+  GridDetails details(8, 3, 24);
+  ThresholdSearch<DoublePrecision> search(constraint, details);
+  ThresholdSearchOptions options;
+  options.divergenceFactor = 2;
+  options.tolerance = 0.05;
+  options.numThreads = 1;
+
+  const ThresholdResult result = search.Run(options);
+  REQUIRE(result.bracketed);
+  CHECK(result.unstableBound - result.stableBound <= options.tolerance);
+  CHECK(result.probes.size() <= 12);
+  CHECK(result.GetLowerBound() <= result.GetThreshold());
+  CHECK(result.GetThreshold() <= result.GetUpperBound());
+
+  // brute force reference: the dense sweep turns unstable inside the bracket
+  double firstUnstable = -1;
+  for (int step = 0; step <= 200 && firstUnstable < 0; step++) {
+    const double value = 0.05 * step;
+    if (search.Probe(options, value).unstable) firstUnstable = value;
+  }
+  CHECK(firstUnstable >= result.stableBound);
+  CHECK(firstUnstable <= result.unstableBound + 0.05);
+
+  // a probe budget spent before a verdict changes is reported as not bracketed
+  options.lower = 0;
+  options.upper = 0.5 * result.stableBound;
+  options.maxProbes = 2;
+  const ThresholdResult flat = search.Run(options);
+  CHECK_FALSE(flat.bracketed);
+  CHECK(flat.probes.size() == 2);
+}
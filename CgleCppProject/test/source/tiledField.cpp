@@ -0,0 +1,59 @@
+#include <doctest/doctest.h>
+#include <grid.h>
+#include <tiledField.h>
+
+#include <complex>
+#include <memory>
+
+TEST_CASE("Tiled field copies only the tiles it writes to") {
+  using namespace CGLE;
+  using Field = TiledField<double>;
+
+  auto base = make_shared<Field::Matrix>(Field::Matrix::Constant(10, 10, 1.0));
+  Field field(base, 4);
+  field.Set(5, 9, 2.0);
+
+  CHECK(field(5, 9) == 2.0);
+  CHECK(field(0, 0) == 1.0);
+  CHECK((*base)(5, 9) == 1.0);
+  CHECK(field.GetNumModifiedTiles() == 1);
+  CHECK(field.GetExclusiveBytes() == 4 * 2 * sizeof(double));
+
+  // a copy shares every tile until it writes to one
+  Field copy = field;
+  CHECK(copy.GetExclusiveBytes() == 0);
+  copy.Set(5, 9, 3.0);
+  CHECK(copy(5, 9) == 3.0);
+  CHECK(field(5, 9) == 2.0);
+
+  const Field::Matrix& dense = copy.View();
+  CHECK(dense(5, 9) == 3.0);
+  CHECK(dense(4, 4) == 1.0);
+  CHECK(copy.IsMaterialized());
+}
+
+TEST_CASE("Forked grids share the ground truth") {
+  using namespace CGLE;
+
+  Constraint constraint;
+  constraint.m_CaseType = 1;
+  constraint.m_WaveType = "Bright-Bright";
+  constraint.m_Eta = 17.36;
+  constraint.m_Mu = 52.09;
+  constraint.m_k1 = complex<double>(1.04, 0.53);
+  constraint.m_W1 = complex<double>(3.5, 2.26);
+
+  GridDetails details(200, 3, 300);
+  Grid grid(constraint, details);
+  grid.PerturbGrid(0.2);
+
+  Grid fork = grid.Fork();
+  fork.PerturbGrid(0.2);
+
+  CHECK(&fork.GetGroundTruthA() == &grid.GetGroundTruthA());
+  CHECK(fork.GetPerturbedFieldA()(150, 10) == grid.GetPerturbedFieldA()(150, 10));
+
+  const size_t fieldBytes = details.GetNumXPts() * details.GetNumYPts() * sizeof(complex<float>);
+  // a deep copy would duplicate both perturbed fields, the fork only copies the line tiles
+  CHECK(fork.GetExclusiveBytes() < fieldBytes);
+}
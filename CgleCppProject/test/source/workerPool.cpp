@@ -0,0 +1,38 @@
+#include <doctest/doctest.h>
+#include <workerPool.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Worker pools run every worker on a persistent thread") {
+  using namespace CGLE;
+
+  WorkerPool pool(3);
+  REQUIRE(pool.GetNumThreads() == 3);
+
+  std::vector<std::thread::id> first(3), second(3);
+  pool.Run([&](int worker) { first[worker] = std::this_thread::get_id(); });
+  pool.Run([&](int worker) { second[worker] = std::this_thread::get_id(); });
+  CHECK(first == second);
+  CHECK(first[0] != std::this_thread::get_id());
+
+  std::vector<int> visits(10, 0);
+  pool.ParallelFor(10, [&](int index) { visits[index]++; });
+  CHECK((visits == std::vector<int>(10, 1)));
+
+  // nested runs execute inline instead of waiting on the busy workers
+  std::atomic<int> nested{0};
+  pool.Run([&](int) { pool.Run([&](int) { nested++; }); });
+  CHECK(nested == 9);
+
+  auto failing = [](int worker) {
+    if (worker == 1) throw std::runtime_error("worker failed");
+  };
+  CHECK_THROWS_AS(pool.Run(failing), std::runtime_error);
+  // the pool stays usable after a failed run
+  std::atomic<int> runs{0};
+  pool.Run([&](int) { runs++; });
+  CHECK(runs == 3);
+}